@@ -20,9 +20,11 @@
 // Qt includes
 #include <QCoreApplication>
 #include <QDebug>
+#include <QDir>
 #include <QScopedPointer>
 #include <QSignalSpy>
 #include <QStringList>
+#include <QTemporaryDir>
 #include <QTest>
 #include <QTime>
 #include <QTimer>
@@ -31,7 +33,9 @@
 
 // qCDashAPI includes
 #include "qGirderAPI.h"
+#include "qRestReplay.h"
 #include "qRestResult.h"
+#include "qRestTestHelpers.h"
 
 
 // --------------------------------------------------------------------------
@@ -46,6 +50,10 @@ private slots:
 
   void testFinishedSignal_data();
   void testFinishedSignal();
+
+  void testTokenRefresh();
+  void testTokenRefreshFailure();
+  void testCredentialsRefresh();
 private:
   QString LastTestResult;
 };
@@ -143,6 +151,114 @@ void qGirderAPITester::testFinishedSignal()
   this->LastTestResult = qGirderAPI::qVariantMapListToString(result);
 }
 
+// --------------------------------------------------------------------------
+void qGirderAPITester::testTokenRefresh()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("girder.rec");
+  QString serverUrl = "http://girder.test/api/v1";
+  // Requests with the same URL are served in order: first rejected, then
+  // accepted.
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << replyRecord("GET", serverUrl, "/item/1", QByteArray(), 401)
+    << replyRecord("GET", serverUrl, "/item/1", "{\"_id\": \"1\"}")
+    << replyRecord("GET", serverUrl, "/item/2", QByteArray(), 401)
+    << replyRecord("GET", serverUrl, "/item/2", "{\"_id\": \"2\"}")
+    << replyRecord("POST", serverUrl, "/api_key/token?key=secret",
+                   "{\"authToken\": {\"token\": \"new\"}}")));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(serverUrl);
+  girderAPI.setToken("old");
+  girderAPI.setApiKey("secret");
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  QSignalSpy finishedSpy(&girderAPI, SIGNAL(finished(QUuid)));
+  QSignalSpy refreshedSpy(&girderAPI, SIGNAL(tokenRefreshed(QByteArray)));
+
+  QUuid firstQueryId = girderAPI.get("/item/1");
+  QUuid secondQueryId = girderAPI.get("/item/2");
+
+  QList<QVariantMap> result;
+  QVERIFY(girderAPI.sync(firstQueryId, result));
+  QCOMPARE(result.value(0).value("_id").toString(), QString("1"));
+  QVERIFY(girderAPI.sync(secondQueryId, result));
+  QCOMPARE(result.value(0).value("_id").toString(), QString("2"));
+
+  // One refresh for both queries, each query finishes once.
+  QCOMPARE(refreshedSpy.count(), 1);
+  QCOMPARE(girderAPI.token(), QByteArray("new"));
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 5);
+  QCOMPARE(finishedSpy.count(), 3);
+  QVERIFY(!girderAPI.isRefreshingToken());
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPITester::testTokenRefreshFailure()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("girder.rec");
+  QString serverUrl = "http://girder.test/api/v1";
+  // The token request is not recorded, it fails.
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << replyRecord("GET", serverUrl, "/item/1", QByteArray(), 401)));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(serverUrl);
+  girderAPI.setToken("old");
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  // Without API key nor credentials, queries are not held.
+  QVERIFY(!girderAPI.refreshToken());
+  QVERIFY(!girderAPI.sync(girderAPI.get("/item/1")));
+  QCOMPARE(girderAPI.error(), qRestAPI::AuthenticationError);
+
+  girderAPI.setApiKey("secret");
+  QSignalSpy failedSpy(&girderAPI, SIGNAL(tokenRefreshFailed(QString)));
+  QVERIFY(!girderAPI.sync(girderAPI.get("/item/1")));
+  QCOMPARE(girderAPI.error(), qRestAPI::AuthenticationError);
+  QCOMPARE(failedSpy.count(), 1);
+  QCOMPARE(girderAPI.token(), QByteArray("old"));
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPITester::testCredentialsRefresh()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("girder.rec");
+  QString serverUrl = "http://girder.test/api/v1";
+  // 10 fast token requests, then a slow one.
+  QList<qRestRecord> records;
+  for (int index = 0; index <= 10; ++index)
+    {
+    qRestRecord record = getRecord(serverUrl, "/user/authentication",
+                                   "{\"authToken\": {\"token\": \"new\"}}");
+    record.FirstByteDelay = index < 10 ? 5 : 300;
+    record.LastByteDelay = record.FirstByteDelay;
+    records << record;
+    }
+  QVERIFY(writeRecording(recording, records));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(serverUrl);
+  girderAPI.setCredentials("user", "secret");
+  girderAPI.setHedgePercentile(0.5);
+  girderAPI.setMaximumHedgeRatio(1.);
+  QVERIFY(girderAPI.startReplay(recording, 1.));
+
+  // The token requests are not hedged.
+  QSignalSpy refreshedSpy(&girderAPI, SIGNAL(tokenRefreshed(QByteArray)));
+  for (int index = 0; index <= 10; ++index)
+    {
+    QVERIFY(girderAPI.refreshToken());
+    QTRY_VERIFY(!girderAPI.isRefreshingToken());
+    }
+  QCOMPARE(refreshedSpy.count(), 11);
+  QCOMPARE(girderAPI.token(), QByteArray("new"));
+  QCOMPARE(girderAPI.hedgesFired(), qint64(0));
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 11);
+}
+
 #define main qGirderAPITest
 QTEST_MAIN(qGirderAPITester)
 #undef main
@@ -0,0 +1,237 @@
+// Qt includes
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qGirderMetadataStore.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qGirderMetadataStoreTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testRefresh();
+  void testRootFolders();
+  void testLoad();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const char* ServerUrl = "http://girder.test/api/v1";
+
+// Writes an index of \a count entries, only the first one is written: a
+// folder of the collection "c1" whose parent type is \a parentType.
+bool writeIndex(const QString& fileName, const QString& serverUrl,
+                const QStringList& rootFolderIds, qint32 count, quint8 parentType)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_6);
+  stream << quint32(0x71474d53) << qint32(2) << serverUrl << rootFolderIds << count;
+  stream << quint8(1) << parentType << QString("s1") << QString("c1")
+         << QString("sub") << QString("t1") << qint64(0);
+  return true;
+}
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStoreTester::testRefresh()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QString recording = dir.filePath("girder.rec");
+  QString index = dir.filePath("girder.index");
+
+  // data (collection c1)
+  //  +- sub (folder s1)
+  //      +- a (item i1): a.txt
+  //      +- b (item i2): b.txt
+  //      +- c (item i3): c.txt
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << getRecord(ServerUrl, "/collection?limit=0",
+                 "[{\"_id\": \"c1\", \"name\": \"data\", \"updated\": \"t1\"}]")
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=c1&parentType=collection",
+                 "[{\"_id\": \"s1\", \"name\": \"sub\", \"updated\": \"t1\"}]")
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=s1&parentType=folder", "[]")
+    << getRecord(ServerUrl, "/item?folderId=s1&limit=0",
+                 "[{\"_id\": \"i1\", \"name\": \"a\", \"updated\": \"t1\", \"size\": 5},"
+                 " {\"_id\": \"i2\", \"name\": \"b\", \"updated\": \"t1\", \"size\": 3},"
+                 " {\"_id\": \"i3\", \"name\": \"c\", \"updated\": \"t1\", \"size\": 3}]")
+    << getRecord(ServerUrl, "/item/i1/files?limit=0",
+                 "[{\"_id\": \"f1\", \"name\": \"a.txt\", \"size\": 5, \"sha512\": \"aa\"}]")
+    << getRecord(ServerUrl, "/item/i2/files?limit=0",
+                 "[{\"_id\": \"f2\", \"name\": \"b.txt\", \"size\": 3}]")
+    << getRecord(ServerUrl, "/item/i3/files?limit=0",
+                 "[{\"_id\": \"f3\", \"name\": \"c.txt\", \"size\": 3}]")));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  {
+  qGirderMetadataStore store(&girderAPI, index);
+  QSignalSpy changedSpy(&store, SIGNAL(changed(QString)));
+  QVERIFY(store.refresh());
+  QVERIFY(store.isRefreshing());
+  QVERIFY(!store.refresh());
+  QVERIFY(store.wait());
+
+  QCOMPARE(store.summary()["queries"].toInt(), 7);
+  QCOMPARE(store.summary()["added"].toInt(), 8);
+  QCOMPARE(store.count(), 8);
+  QVERIFY(changedSpy.count() > 0);
+
+  QCOMPARE(store.collections().size(), 1);
+  QCOMPARE(store.folders("c1").size(), 1);
+  QCOMPARE(store.folders("c1")[0]["parentCollection"].toString(), QString("collection"));
+  QList<QVariantMap> items = store.items("s1");
+  QCOMPARE(items.size(), 3);
+  QCOMPARE(items[0]["_id"].toString(), QString("i1"));
+  QCOMPARE(items[0]["updated"].toString(), QString("t1"));
+  QCOMPARE(store.files("i1")[0]["sha512"].toString(), QString("aa"));
+  QCOMPARE(store.object("f2")["itemId"].toString(), QString("i2"));
+  QCOMPARE(store.object("f2")["_modelType"].toString(), QString("file"));
+  QCOMPARE(store.child("s1", "b")["_id"].toString(), QString("i2"));
+  QVERIFY(store.child("s1", "d").isEmpty());
+  QCOMPARE(store.path("f1"), QString("data/sub/a/a.txt"));
+  QVERIFY(QFile::exists(index));
+  }
+
+  // Only the files of the modified item are listed again.
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << getRecord(ServerUrl, "/collection?limit=0",
+                 "[{\"_id\": \"c1\", \"name\": \"data\", \"updated\": \"t1\"}]")
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=c1&parentType=collection",
+                 "[{\"_id\": \"s1\", \"name\": \"sub\", \"updated\": \"t2\"}]")
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=s1&parentType=folder", "[]")
+    << getRecord(ServerUrl, "/item?folderId=s1&limit=0",
+                 "[{\"_id\": \"i1\", \"name\": \"a\", \"updated\": \"t2\", \"size\": 6},"
+                 " {\"_id\": \"i2\", \"name\": \"b\", \"updated\": \"t1\", \"size\": 3}]")
+    << getRecord(ServerUrl, "/item/i1/files?limit=0",
+                 "[{\"_id\": \"f1\", \"name\": \"a.txt\", \"size\": 6, \"sha512\": \"bb\"}]")));
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  {
+  qGirderMetadataStore store(&girderAPI, index);
+  QCOMPARE(store.count(), 8);
+  QCOMPARE(store.path("f3"), QString("data/sub/c/c.txt"));
+  QSignalSpy changedSpy(&store, SIGNAL(changed(QString)));
+  QVERIFY(store.refresh());
+  QVERIFY(store.wait());
+
+  QVariantMap summary = store.summary();
+  QCOMPARE(summary["queries"].toInt(), 5);
+  QCOMPARE(summary["itemsSkipped"].toInt(), 1);
+  QCOMPARE(summary["removed"].toInt(), 2);
+  QCOMPARE(girderAPI.replayManager()->unmatchedCount(), 0);
+  QCOMPARE(store.count(), 6);
+  QVERIFY(!store.contains("i3"));
+  QVERIFY(!store.contains("f3"));
+  QCOMPARE(store.object("i1")["updated"].toString(), QString("t2"));
+  QCOMPARE(store.files("i1")[0]["size"].toLongLong(), qint64(6));
+  QCOMPARE(store.files("i2").size(), 1);
+  QVERIFY(changedSpy.count() > 0);
+  }
+
+  // The index is loaded in the order of the listings.
+  qGirderMetadataStore store(&girderAPI, index);
+  QCOMPARE(store.count(), 6);
+  QList<QVariantMap> items = store.items("s1");
+  QCOMPARE(items.size(), 2);
+  QCOMPARE(items[0]["_id"].toString(), QString("i1"));
+  QCOMPARE(items[1]["_id"].toString(), QString("i2"));
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStoreTester::testRootFolders()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("girder.rec");
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=root&parentType=folder", "[]")
+    << getRecord(ServerUrl, "/item?folderId=root&limit=0",
+                 "[{\"_id\": \"i1\", \"name\": \"a\", \"updated\": \"t1\", \"size\": 5}]")
+    << getRecord(ServerUrl, "/item/i1/files?limit=0",
+                 "[{\"_id\": \"f1\", \"name\": \"a.txt\", \"size\": 5}]")));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  qGirderMetadataStore store(&girderAPI);
+  store.setRootFolderIds(QStringList() << "root");
+  QSignalSpy refreshedSpy(&store, SIGNAL(refreshed(bool)));
+  store.setRefreshInterval(10);
+  QCOMPARE(store.refreshInterval(), 10);
+  QTRY_VERIFY(refreshedSpy.count() >= 1);
+  store.setRefreshInterval(0);
+  QVERIFY(store.wait());
+
+  QVERIFY(store.collections().isEmpty());
+  QCOMPARE(store.items("root").size(), 1);
+  QCOMPARE(store.path("f1"), QString("a/a.txt"));
+  QCOMPARE(store.count(), 2);
+  QCOMPARE(refreshedSpy.at(0).at(0).toBool(), true);
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStoreTester::testLoad()
+{
+  QTemporaryDir directory;
+  QString index = QDir(directory.path()).filePath("girder.index");
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+
+  QVERIFY(!qGirderMetadataStore(&girderAPI).save());
+
+  QVERIFY(writeIndex(index, ServerUrl, QStringList(), 1, 0));
+  qGirderMetadataStore store(&girderAPI, index);
+  QCOMPARE(store.count(), 1);
+  QCOMPARE(store.folders("c1").size(), 1);
+
+  // Corrupt indexes are ignored, the current index is kept.
+  QVERIFY(writeIndex(index, ServerUrl, QStringList(), 1, 7));
+  QVERIFY(!store.load());
+  QVERIFY(writeIndex(index, ServerUrl, QStringList(), 1000000000, 0));
+  QVERIFY(!store.load());
+  QCOMPARE(store.count(), 1);
+  QVERIFY(writeIndex(index, ServerUrl, QStringList(), 1, 0));
+  QFile file(index);
+  QVERIFY(file.resize(file.size() - 4));
+  QVERIFY(!store.load());
+  QCOMPARE(qGirderMetadataStore(&girderAPI, index).count(), 0);
+
+  // So are the indexes of another server or of other root folders.
+  QVERIFY(writeIndex(index, "http://other.test/api/v1", QStringList(), 1, 0));
+  QCOMPARE(qGirderMetadataStore(&girderAPI, index).count(), 0);
+  QVERIFY(writeIndex(index, ServerUrl, QStringList() << "root", 1, 0));
+  qGirderMetadataStore rootStore(&girderAPI, index);
+  QCOMPARE(rootStore.count(), 0);
+  rootStore.setRootFolderIds(QStringList() << "root");
+  QCOMPARE(rootStore.count(), 1);
+
+  // The saved index is loaded by a store of the same root folders only.
+  QVERIFY(rootStore.save());
+  QCOMPARE(qGirderMetadataStore(&girderAPI, index).count(), 0);
+  QVERIFY(!store.load());
+  rootStore.setRootFolderIds(QStringList());
+  QCOMPARE(rootStore.count(), 0);
+}
+
+#define main qGirderMetadataStoreTest
+QTEST_MAIN(qGirderMetadataStoreTester)
+#undef main
+
+#include "moc_qGirderMetadataStoreTest.cpp"
@@ -0,0 +1,123 @@
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qGirderSynchronizer.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qGirderSynchronizerTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testSynchronize();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const char* ServerUrl = "http://girder.test/api/v1";
+
+QByteArray readFile(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerTester::testSynchronize()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QString recording = dir.filePath("girder.rec");
+  QString mirror = dir.filePath("mirror");
+
+  // root
+  //  +- a.txt (item i1)
+  //  +- sub (folder s1)
+  //      +- pair (item i2)
+  //          +- b.txt
+  //          +- c.txt
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=root&parentType=folder",
+                 "[{\"_id\": \"s1\", \"name\": \"sub\"}]")
+    << getRecord(ServerUrl, "/item?folderId=root&limit=0",
+                 "[{\"_id\": \"i1\", \"name\": \"a.txt\", \"updated\": \"t1\", \"size\": 5}]")
+    << getRecord(ServerUrl, "/folder?limit=0&parentId=s1&parentType=folder", "[]")
+    << getRecord(ServerUrl, "/item?folderId=s1&limit=0",
+                 "[{\"_id\": \"i2\", \"name\": \"pair\", \"updated\": \"t1\", \"size\": 6}]")
+    << getRecord(ServerUrl, "/item/i1/files?limit=0",
+                 "[{\"_id\": \"f1\", \"name\": \"a.txt\", \"size\": 5}]")
+    << getRecord(ServerUrl, "/item/i2/files?limit=0",
+                 "[{\"_id\": \"f2\", \"name\": \"b.txt\", \"size\": 3},"
+                 " {\"_id\": \"f3\", \"name\": \"c.txt\", \"size\": 3}]")
+    << getRecord(ServerUrl, "/file/f1/download", "hello")
+    << getRecord(ServerUrl, "/file/f2/download", "bbb")
+    << getRecord(ServerUrl, "/file/f3/download", "ccc")));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  {
+  qGirderSynchronizer synchronizer(&girderAPI);
+  synchronizer.setMaximumConcurrentQueries(2);
+  QSignalSpy downloadedSpy(&synchronizer, SIGNAL(fileDownloaded(QString)));
+  QVERIFY(synchronizer.start("root", mirror));
+  QVERIFY(synchronizer.isRunning());
+  QVERIFY(synchronizer.wait());
+
+  QVariantMap summary = synchronizer.summary();
+  QCOMPARE(summary["folders"].toInt(), 1);
+  QCOMPARE(summary["items"].toInt(), 2);
+  QCOMPARE(summary["filesDownloaded"].toInt(), 3);
+  QCOMPARE(summary["filesSkipped"].toInt(), 0);
+  QCOMPARE(summary["bytesDownloaded"].toLongLong(), qint64(11));
+  QCOMPARE(downloadedSpy.count(), 3);
+  QCOMPARE(readFile(QDir(mirror).filePath("a.txt")), QByteArray("hello"));
+  QCOMPARE(readFile(QDir(mirror).filePath("sub/pair/b.txt")), QByteArray("bbb"));
+  QCOMPARE(readFile(QDir(mirror).filePath("sub/pair/c.txt")), QByteArray("ccc"));
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 9);
+  }
+
+  // Unchanged items are neither listed nor downloaded.
+  {
+  qGirderSynchronizer synchronizer(&girderAPI);
+  QVERIFY(synchronizer.start("root", mirror));
+  QVERIFY(synchronizer.wait());
+  QVariantMap summary = synchronizer.summary();
+  QCOMPARE(summary["filesDownloaded"].toInt(), 0);
+  QCOMPARE(summary["filesSkipped"].toInt(), 3);
+  QCOMPARE(summary["bytesSkipped"].toLongLong(), qint64(11));
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 9 + 4);
+  }
+
+  // Missing local files are downloaded again.
+  QVERIFY(QFile::remove(QDir(mirror).filePath("a.txt")));
+  {
+  qGirderSynchronizer synchronizer(&girderAPI);
+  QVERIFY(synchronizer.start("root", mirror));
+  QVERIFY(synchronizer.wait());
+  QVariantMap summary = synchronizer.summary();
+  QCOMPARE(summary["filesDownloaded"].toInt(), 1);
+  QCOMPARE(summary["filesSkipped"].toInt(), 2);
+  QCOMPARE(readFile(QDir(mirror).filePath("a.txt")), QByteArray("hello"));
+  }
+}
+
+#define main qGirderSynchronizerTest
+QTEST_MAIN(qGirderSynchronizerTester)
+#undef main
+
+#include "moc_qGirderSynchronizerTest.cpp"
@@ -0,0 +1,208 @@
+// Qt includes
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qGirderUploader.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qGirderUploaderTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testUpload();
+  void testResume();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const char* ServerUrl = "http://girder.test/api/v1";
+
+bool writeFile(const QString& fileName, const QByteArray& data)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  return file.write(data) == data.size();
+}
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderTester::testUpload()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QString recording = dir.filePath("girder.rec");
+  QString source = dir.filePath("source");
+
+  // source
+  //  +- a.txt
+  //  +- sub (folder s1)
+  //      +- b.txt
+  QVERIFY(dir.mkpath("source/sub"));
+  QVERIFY(writeFile(QDir(source).filePath("a.txt"), "hello"));
+  QVERIFY(writeFile(QDir(source).filePath("sub/b.txt"), "bbb"));
+
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << replyRecord("POST", ServerUrl, "/folder?name=sub&parentId=root&parentType=folder&reuseExisting=true",
+                   "{\"_id\": \"s1\"}")
+    << replyRecord("POST", ServerUrl, "/item?folderId=root&name=a.txt&reuseExisting=true", "{\"_id\": \"i1\"}")
+    << replyRecord("POST", ServerUrl, "/item?folderId=s1&name=b.txt&reuseExisting=true", "{\"_id\": \"i2\"}")
+    << getRecord(ServerUrl, "/item/i1/files?limit=0", "[]")
+    << getRecord(ServerUrl, "/item/i2/files?limit=0",
+                 "[{\"_id\": \"f0\", \"name\": \"notes.txt\"}, {\"_id\": \"f2\", \"name\": \"b.txt\"}]")
+    << replyRecord("POST", ServerUrl, "/file?name=a.txt&parentId=i1&parentType=item&size=5", "{\"_id\": \"u1\"}")
+    // b.txt is already in the reused item i2, its content is replaced.
+    << replyRecord("PUT", ServerUrl, "/file/f2/contents?size=3", "{\"_id\": \"u2\"}")
+    << replyRecord("POST", ServerUrl, "/file/chunk?offset=0&uploadId=u1", "{\"_id\": \"u1\", \"received\": 3}")
+    << replyRecord("POST", ServerUrl, "/file/chunk?offset=3&uploadId=u1", "{\"_id\": \"f1\", \"itemId\": \"i1\"}")
+    << replyRecord("POST", ServerUrl, "/file/chunk?offset=0&uploadId=u2", "{\"_id\": \"f2\", \"itemId\": \"i2\"}")));
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+  // The requests are recorded to check their headers.
+  QVERIFY(girderAPI.startRecording(dir.filePath("requests.rec")));
+
+  {
+  qGirderUploader uploader(&girderAPI);
+  uploader.setMaximumConcurrentUploads(2);
+  uploader.setChunkSize(3);
+  QSignalSpy uploadedSpy(&uploader, SIGNAL(fileUploaded(QString)));
+  QVERIFY(uploader.start(source, "root"));
+  QVERIFY(uploader.isRunning());
+  QVERIFY(uploader.wait());
+
+  QVariantMap summary = uploader.summary();
+  QCOMPARE(summary["folders"].toInt(), 1);
+  QCOMPARE(summary["files"].toInt(), 2);
+  QCOMPARE(summary["filesUploaded"].toInt(), 2);
+  QCOMPARE(summary["filesSkipped"].toInt(), 0);
+  QCOMPARE(summary["bytesUploaded"].toLongLong(), qint64(8));
+  QCOMPARE(uploadedSpy.count(), 2);
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 10);
+  QCOMPARE(girderAPI.replayManager()->unmatchedCount(), 0);
+  QVERIFY(QFile::exists(QDir(source).filePath(".girder-upload")));
+  }
+  girderAPI.stopRecording();
+
+  // Chunks are sent as binary data.
+  QFile requests(dir.filePath("requests.rec"));
+  QVERIFY(requests.open(QIODevice::ReadOnly));
+  QDataStream stream(&requests);
+  QVERIFY(qRestRecord::readHeader(stream));
+  int chunks = 0;
+  while (!stream.atEnd())
+    {
+    qRestRecord record;
+    stream >> record;
+    if (!record.Url.contains("/file/chunk"))
+      {
+      continue;
+      }
+    ++chunks;
+    QByteArray contentType;
+    foreach(const qRestRecord::RawHeaderPairs::value_type& header, record.RequestHeaders)
+      {
+      if (header.first.toLower() == "content-type")
+        {
+        contentType = header.second;
+        }
+      }
+    QCOMPARE(contentType, QByteArray("application/octet-stream"));
+    }
+  QCOMPARE(chunks, 3);
+
+  // Uploaded files are skipped.
+  {
+  qGirderUploader uploader(&girderAPI);
+  QVERIFY(uploader.start(source, "root"));
+  QVERIFY(uploader.wait());
+  QVariantMap summary = uploader.summary();
+  QCOMPARE(summary["filesUploaded"].toInt(), 0);
+  QCOMPARE(summary["filesSkipped"].toInt(), 2);
+  QCOMPARE(summary["bytesSkipped"].toLongLong(), qint64(8));
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 10);
+  }
+
+  // The journal is not used for another destination.
+  {
+  qGirderUploader uploader(&girderAPI);
+  QVERIFY(uploader.start(source, "other"));
+  QVERIFY(!uploader.wait());
+  QVariantMap summary = uploader.summary();
+  QCOMPARE(summary["filesSkipped"].toInt(), 0);
+  QCOMPARE(summary["filesFailed"].toInt(), 2);
+  QVERIFY(girderAPI.replayManager()->unmatchedCount() > 0);
+  }
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderTester::testResume()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QString source = dir.filePath("source");
+  QVERIFY(dir.mkpath("source"));
+  QVERIFY(writeFile(QDir(source).filePath("c.txt"), "hello"));
+
+  // The second chunk fails.
+  QString interrupted = dir.filePath("interrupted.rec");
+  QVERIFY(writeRecording(interrupted, QList<qRestRecord>()
+    << replyRecord("POST", ServerUrl, "/item?folderId=root&name=c.txt&reuseExisting=true", "{\"_id\": \"i3\"}")
+    << getRecord(ServerUrl, "/item/i3/files?limit=0", "[]")
+    << replyRecord("POST", ServerUrl, "/file?name=c.txt&parentId=i3&parentType=item&size=5", "{\"_id\": \"u3\"}")
+    << replyRecord("POST", ServerUrl, "/file/chunk?offset=0&uploadId=u3", "{\"_id\": \"u3\", \"received\": 3}")
+    << replyRecord("POST", ServerUrl, "/file/chunk?offset=3&uploadId=u3", "{\"message\": \"error\"}", 500)));
+  {
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(interrupted, 0.));
+  qGirderUploader uploader(&girderAPI);
+  uploader.setChunkSize(3);
+  QVERIFY(uploader.start(source, "root"));
+  QVERIFY(!uploader.wait());
+  QVariantMap summary = uploader.summary();
+  QCOMPARE(summary["filesFailed"].toInt(), 1);
+  QCOMPARE(summary["bytesUploaded"].toLongLong(), qint64(3));
+  QCOMPARE(summary["errors"].toStringList().size(), 1);
+  }
+
+  // The upload continues from the offset known by the server.
+  QString resumed = dir.filePath("resumed.rec");
+  QVERIFY(writeRecording(resumed, QList<qRestRecord>()
+    << replyRecord("GET", ServerUrl, "/file/offset?uploadId=u3", "{\"offset\": 3}")
+    << replyRecord("POST", ServerUrl, "/file/chunk?offset=3&uploadId=u3", "{\"_id\": \"f3\", \"itemId\": \"i3\"}")));
+  {
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(resumed, 0.));
+  qGirderUploader uploader(&girderAPI);
+  uploader.setChunkSize(3);
+  QVERIFY(uploader.start(source, "root"));
+  QVERIFY(uploader.wait());
+  QVariantMap summary = uploader.summary();
+  QCOMPARE(summary["filesUploaded"].toInt(), 1);
+  QCOMPARE(summary["filesResumed"].toInt(), 1);
+  QCOMPARE(summary["bytesUploaded"].toLongLong(), qint64(2));
+  QCOMPARE(summary["bytesSkipped"].toLongLong(), qint64(3));
+  QCOMPARE(girderAPI.replayManager()->servedCount(), 2);
+  QCOMPARE(girderAPI.replayManager()->unmatchedCount(), 0);
+  }
+}
+
+#define main qGirderUploaderTest
+QTEST_MAIN(qGirderUploaderTester)
+#undef main
+
+#include "moc_qGirderUploaderTest.cpp"
@@ -1,8 +1,17 @@
 // Qt includes
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHttpMultiPart>
+#include <QSignalSpy>
+#include <QTemporaryDir>
 #include <QTest>
 
 // qRestAPI includes
 #include "qRestAPI.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
 
 #include <QMap>
 
@@ -18,6 +27,22 @@ private slots:
 
   void testqVariantMapFlattened_data();
   void testqVariantMapFlattened();
+
+  void testqVariantMapListFlattened();
+
+  void testStreamingBufferSize();
+
+  void testProgressInterval_data();
+  void testProgressInterval();
+
+  void testEncodeBody();
+  void testPostBody();
+
+  void testNetworkManagers_data();
+  void testNetworkManagers();
+  void testSharedNetworkManager();
+  void testHedging();
+  void testServerSet();
 private:
   QVariantMap LastTestInputMap;
   QVariantMap LastTestOutputMap;
@@ -246,6 +271,447 @@ void qRestAPITester::testqVariantMapFlattened()
   QCOMPARE(output, expected);
 }
 
+// --------------------------------------------------------------------------
+void qRestAPITester::testqVariantMapListFlattened()
+{
+  QList<QVariantMap> input;
+  for (int index = 0; index < 1000; ++index)
+    {
+    QVariantMap submap;
+    submap["b_a"] = index;
+    submap["b_b"] = QVariantList() << submap << submap;
+
+    QVariantMap map;
+    map["a"] = index;
+    map["b"] = submap;
+    input << map;
+    }
+
+  QList<QVariantMap> output = qRestAPI::qVariantMapListFlattened(input);
+
+  QCOMPARE(output.size(), input.size());
+  for (int index = 0; index < input.size(); ++index)
+    {
+    QCOMPARE(output.at(index), qRestAPI::qVariantMapFlattened(input.at(index)));
+    }
+  QCOMPARE(output.at(10).value("b.b_b.b_a").toInt(), 10);
+}
+
+// --------------------------------------------------------------------------
+namespace
+{
+/// Device consuming the data written at a limited pace, like a socket.
+class SlowDevice : public QIODevice
+{
+public:
+  SlowDevice() : Pending(0), MaximumPending(0) {}
+
+  virtual bool open(OpenMode mode)
+  {
+    this->startTimer(1);
+    return QIODevice::open(mode | Unbuffered);
+  }
+  virtual qint64 bytesToWrite() const
+  {
+    return this->Pending;
+  }
+
+  QByteArray Data;
+  qint64 Pending;
+  qint64 MaximumPending;
+
+protected:
+  virtual qint64 readData(char*, qint64)
+  {
+    return -1;
+  }
+  virtual qint64 writeData(const char* data, qint64 maxSize)
+  {
+    this->Data.append(data, maxSize);
+    this->Pending += maxSize;
+    this->MaximumPending = qMax(this->MaximumPending, this->Pending);
+    return maxSize;
+  }
+  virtual void timerEvent(QTimerEvent*)
+  {
+    qint64 written = qMin(this->Pending, qint64(4096));
+    if (written > 0)
+      {
+      this->Pending -= written;
+      emit bytesWritten(written);
+      }
+  }
+};
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testStreamingBufferSize()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+
+  QByteArray data;
+  for (int index = 0; index < 256 * 1024; ++index)
+    {
+    data.append(static_cast<char>(index % 251));
+    }
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(data);
+  source.close();
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setStreamingBufferSize(16 * 1024);
+
+  SlowDevice output;
+  QUuid queryId = restAPI.get(&output, "/source.bin");
+  QVERIFY(!queryId.isNull());
+  QVERIFY(restAPI.sync(queryId));
+
+  QCOMPARE(output.Data, data);
+  QVERIFY(output.MaximumPending <= 16 * 1024);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testProgressInterval_data()
+{
+  QTest::addColumn<int>("progressInterval");
+  QTest::addColumn<bool>("everyChunk");
+  QTest::newRow("every chunk") << 0 << true;
+  QTest::newRow("throttled") << 60000 << false;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testProgressInterval()
+{
+  QFETCH(int, progressInterval);
+  QFETCH(bool, everyChunk);
+
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QByteArray data(64 * 1024, 'x');
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(data);
+  source.close();
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setProgressInterval(progressInterval);
+  // Small chunks are written into the slow device.
+  restAPI.setStreamingBufferSize(4096);
+  QSignalSpy progressSpy(&restAPI, SIGNAL(progress(QUuid,double)));
+  QSignalSpy aggregateSpy(&restAPI, SIGNAL(aggregateProgress(qint64,qint64,double,qint64)));
+
+  SlowDevice output;
+  QUuid queryId = restAPI.get(&output, "/source.bin");
+  QVERIFY(restAPI.sync(queryId));
+  QCOMPARE(output.Data, data);
+
+  if (everyChunk)
+    {
+    QVERIFY(progressSpy.count() >= 16);
+    }
+  else
+    {
+    // The first and the last progress only.
+    QCOMPARE(progressSpy.count(), 2);
+    }
+  QCOMPARE(progressSpy.last().at(1).toDouble(), 1.);
+  foreach(const QList<QVariant>& arguments, progressSpy)
+    {
+    QVERIFY(arguments.at(1).toDouble() >= 0. && arguments.at(1).toDouble() <= 1.);
+    }
+
+  // The finished transfer is removed from the aggregated progress.
+  QVERIFY(aggregateSpy.count() >= 2);
+  QCOMPARE(aggregateSpy.last().at(0).toLongLong(), qint64(0));
+  QCOMPARE(aggregateSpy.last().at(3).toLongLong(), qint64(0));
+  QCOMPARE(aggregateSpy.at(0).at(1).toLongLong(), qint64(data.size()));
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testEncodeBody()
+{
+  QVariantMap metadata;
+  metadata["modality"] = "CT";
+  QVariantMap body;
+  body["name"] = "a b&c+d";
+  body["tags"] = QVariantList() << "x" << "y";
+  body["metadata"] = metadata;
+  body["public"] = true;
+
+  QCOMPARE(qRestAPI::encodeBody(body, qRestAPI::FormUrlEncoded),
+           QByteArray("metadata=%7B%22modality%22%3A%22CT%22%7D"
+                      "&name=a%20b%26c%2Bd&public=true&tags=x&tags=y"));
+  QVERIFY(!qRestAPI::encodeBody(QVariantMap(), qRestAPI::FormUrlEncoded).isNull());
+
+  QCOMPARE(qRestAPI::encodeBody(metadata, qRestAPI::JsonEncoded),
+           QByteArray("{\"modality\":\"CT\"}"));
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+  // {"modality": "CT"}
+  QCOMPARE(qRestAPI::encodeBody(metadata, qRestAPI::CborEncoded),
+           QByteArray("\xa1\x68modality\x62" "CT"));
+#else
+  QVERIFY(qRestAPI::encodeBody(metadata, qRestAPI::CborEncoded).isNull());
+#endif
+
+  QCOMPARE(qRestAPI::bodyContentType(qRestAPI::JsonEncoded), QByteArray("application/json"));
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testPostBody()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+
+  QString replay = dir.filePath("replay.rec");
+  QVERIFY(writeRecording(replay, QList<qRestRecord>()
+    << replyRecord("POST", "http://data.test", "/item?folderId=f1", "{}")));
+
+  // The requests are recorded to check their headers.
+  qRestAPI restAPI;
+  restAPI.setServerUrl("http://data.test");
+  QVERIFY(restAPI.startReplay(replay, 0.));
+  QVERIFY(restAPI.startRecording(dir.filePath("requests.rec")));
+
+  qRestAPI::Parameters parameters;
+  parameters["folderId"] = "f1";
+  QVariantMap body;
+  body["name"] = "a";
+  QVERIFY(restAPI.sync(restAPI.post("/item", body, qRestAPI::JsonEncoded, parameters)));
+
+  QFile data(dir.filePath("data.bin"));
+  QVERIFY(data.open(QIODevice::WriteOnly));
+  data.write("content");
+  data.close();
+  QMap<QString, QString> files;
+  files["file"] = data.fileName();
+  QScopedPointer<QHttpMultiPart> fieldsOnly(qRestAPI::createFormData(body));
+  QVERIFY(fieldsOnly);
+  files["missing"] = dir.filePath("missing.bin");
+  QVERIFY(qRestAPI::createFormData(body, files) == 0);
+  files.remove("missing");
+  QVERIFY(restAPI.sync(restAPI.post(qRestAPI::createFormData(body, files), "/item", parameters)));
+  restAPI.stopRecording();
+
+  QFile recording(dir.filePath("requests.rec"));
+  QVERIFY(recording.open(QIODevice::ReadOnly));
+  QDataStream stream(&recording);
+  QVERIFY(qRestRecord::readHeader(stream));
+  QList<QByteArray> contentTypes;
+  while (!stream.atEnd())
+    {
+    qRestRecord record;
+    stream >> record;
+    foreach(const qRestRecord::RawHeaderPairs::value_type& header, record.RequestHeaders)
+      {
+      if (header.first.toLower() == "content-type")
+        {
+        contentTypes << header.second;
+        }
+      }
+    }
+  QCOMPARE(contentTypes.size(), 2);
+  QCOMPARE(contentTypes[0], QByteArray("application/json"));
+  QVERIFY(contentTypes[1].startsWith("multipart/form-data; boundary="));
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testNetworkManagers_data()
+{
+  QTest::addColumn<int>("policy");
+  QTest::newRow("least loaded") << static_cast<int>(qRestAPI::LeastLoadedManager);
+  QTest::newRow("hashed") << static_cast<int>(qRestAPI::HashedManager);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testNetworkManagers()
+{
+  QFETCH(int, policy);
+
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  for (int index = 0; index < 8; ++index)
+    {
+    QFile source(dir.filePath(QString("source%1.bin").arg(index)));
+    QVERIFY(source.open(QIODevice::WriteOnly));
+    source.write(QByteArray(1024, static_cast<char>('a' + index)));
+    }
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  QCOMPARE(restAPI.networkManagerCount(), 1);
+  restAPI.setNetworkManagerCount(3);
+  restAPI.setManagerSelectionPolicy(static_cast<qRestAPI::ManagerSelectionPolicy>(policy));
+  QCOMPARE(restAPI.networkManagerCount(), 3);
+
+  QList<QUuid> queryIds;
+  for (int index = 0; index < 8; ++index)
+    {
+    queryIds << restAPI.download(dir.filePath(QString("output%1.bin").arg(index)),
+                                 QString("/source%1.bin").arg(index));
+    }
+  // The removed managers finish their queries.
+  restAPI.setNetworkManagerCount(0);
+  QCOMPARE(restAPI.networkManagerCount(), 1);
+
+  for (int index = 0; index < queryIds.size(); ++index)
+    {
+    QVERIFY(restAPI.sync(queryIds[index]));
+    QFile output(dir.filePath(QString("output%1.bin").arg(index)));
+    QVERIFY(output.open(QIODevice::ReadOnly));
+    QCOMPARE(output.readAll(), QByteArray(1024, static_cast<char>('a' + index)));
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testSharedNetworkManager()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(QByteArray(1024, 'x'));
+  source.close();
+
+  QNetworkAccessManager* sharedManager = qRestAPI::sharedNetworkManager();
+  QVERIFY(sharedManager);
+  QCOMPARE(qRestAPI::sharedNetworkManager(), sharedManager);
+
+  qRestAPI firstAPI;
+  firstAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  firstAPI.setSharedNetworkManagerUsed(true);
+  QScopedPointer<qRestAPI> secondAPI(new qRestAPI);
+  secondAPI->setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  secondAPI->setSharedNetworkManagerUsed(true);
+  QVERIFY(secondAPI->isSharedNetworkManagerUsed());
+
+  QSignalSpy firstSpy(&firstAPI, SIGNAL(finished(QUuid)));
+  QUuid firstQuery = firstAPI.download(dir.filePath("first.bin"), "/source.bin");
+  QUuid secondQuery = secondAPI->download(dir.filePath("second.bin"), "/source.bin");
+  QUuid orphanQuery = secondAPI->download(dir.filePath("orphan.bin"), "/source.bin");
+  QVERIFY(secondAPI->sync(secondQuery));
+
+  // The queries of a deleted object do not reach the other objects.
+  secondAPI.reset();
+  QVERIFY(firstAPI.sync(firstQuery));
+  QTest::qWait(50);
+  QCOMPARE(firstSpy.count(), 1);
+  QCOMPARE(firstSpy.at(0).at(0).value<QUuid>(), firstQuery);
+  QVERIFY(!orphanQuery.isNull());
+  QVERIFY(QFile::exists(dir.filePath("second.bin")));
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testHedging()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("replay.rec");
+  // Responses are served in order: 10 fast queries, then a slow one whose
+  // hedging request gets a fast response.
+  QList<qint64> delays;
+  for (int index = 0; index < 10; ++index)
+    {
+    delays << 5;
+    }
+  delays << 5000 << 5;
+  QList<qRestRecord> records;
+  foreach(qint64 delay, delays)
+    {
+    qRestRecord record = withContentType(
+      getRecord("http://data.test", "/item", "[{\"_id\": \"a\"}]"), "application/json");
+    record.FirstByteDelay = delay;
+    record.LastByteDelay = delay;
+    records << record;
+    }
+  QVERIFY(writeRecording(recording, records));
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl("http://data.test");
+  QVERIFY(restAPI.startReplay(recording, 1.));
+  restAPI.setHedgePercentile(0.5);
+  restAPI.setMaximumHedgeRatio(1.);
+  QCOMPARE(restAPI.hedgePercentile(), 0.5);
+
+  for (int index = 0; index < 10; ++index)
+    {
+    QVERIFY(restAPI.sync(restAPI.get("/item")));
+    }
+  QCOMPARE(restAPI.hedgesFired(), qint64(0));
+
+  QElapsedTimer timer;
+  timer.start();
+  QList<QVariantMap> result;
+  QVERIFY(restAPI.sync(restAPI.get("/item"), result));
+  QVERIFY(timer.elapsed() < 2500);
+  QCOMPARE(result.size(), 1);
+  QCOMPARE(restAPI.hedgesFired(), qint64(1));
+  QCOMPARE(restAPI.hedgesWon(), qint64(1));
+  QCOMPARE(restAPI.replayManager()->servedCount(), 12);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPITester::testServerSet()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("replay.rec");
+  // The first server fails, the second one answers.
+  QList<qRestRecord> records;
+  QList<QByteArray> methods = QList<QByteArray>() << "GET" << "POST";
+  foreach(const QByteArray& method, methods)
+    {
+    records << replyRecord(method, "http://a.test", "/item", QByteArray(), 503)
+            << withContentType(replyRecord(method, "http://b.test", "/item", "[{\"_id\": \"a\"}]"),
+                               "application/json");
+    }
+  QVERIFY(writeRecording(recording, records));
+
+  qRestAPI restAPI;
+  restAPI.setServerUrls(QStringList() << "http://a.test" << "http://b.test");
+  QVERIFY(restAPI.startReplay(recording));
+  QCOMPARE(restAPI.serverUrl(), QString("http://a.test"));
+  QCOMPARE(restAPI.serverUrls().size(), 2);
+
+  // Writes go to the first server and are not sent again once delivered.
+  QVERIFY(!restAPI.sync(restAPI.post("/item")));
+  QList<QVariantMap> status = restAPI.serverStatus();
+  QCOMPARE(status.size(), 2);
+  QCOMPARE(status[0]["healthy"].toBool(), false);
+  QCOMPARE(status[0]["failures"].toInt(), 1);
+  QCOMPARE(status[1]["healthy"].toBool(), true);
+
+  // The failing server is avoided.
+  QVERIFY(restAPI.sync(restAPI.post("/item")));
+  QVERIFY(restAPI.sync(restAPI.get("/item")));
+  status = restAPI.serverStatus();
+  QVERIFY(status[1]["latency"].toDouble() >= 0.);
+
+  // Reads fail over to the other server.
+  restAPI.setServerUrls(QStringList() << "http://a.test" << "http://b.test");
+  for (int index = 0; index < 20 && restAPI.serverStatus()[0]["healthy"].toBool(); ++index)
+    {
+    QList<QVariantMap> result;
+    QVERIFY(restAPI.sync(restAPI.get("/item"), result));
+    QCOMPARE(result.size(), 1);
+    }
+  QCOMPARE(restAPI.serverStatus()[0]["healthy"].toBool(), false);
+  QCOMPARE(restAPI.replayManager()->unmatchedCount(), 0);
+
+  // Queries aborted by the client are not sent again and do not make their
+  // server unhealthy.
+  restAPI.setServerUrls(QStringList() << "http://a.test" << "http://b.test");
+  QUuid queryId = restAPI.get("/item");
+  restAPI.stopReplay();
+  QVERIFY(!restAPI.sync(queryId));
+  status = restAPI.serverStatus();
+  QCOMPARE(status[0]["healthy"].toBool(), true);
+  QCOMPARE(status[0]["failures"].toInt(), 0);
+  QCOMPARE(status[1]["healthy"].toBool(), true);
+}
+
 #define main qRestAPITest
 QTEST_MAIN(qRestAPITester)
 #undef main
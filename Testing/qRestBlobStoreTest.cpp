@@ -0,0 +1,210 @@
+// Qt includes
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestBlobStore.h"
+#include "qRestMetrics.h"
+
+// --------------------------------------------------------------------------
+class qRestBlobStoreTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testInsertRetrieve_data();
+  void testInsertRetrieve();
+  void testInvalidChecksum_data();
+  void testInvalidChecksum();
+  void testEviction();
+  void testDownload();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+QByteArray readFile(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+
+bool writeFile(const QString& fileName, const QByteArray& data)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  return file.write(data) == data.size();
+}
+
+QByteArray sha512(const QByteArray& data)
+{
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha512).toHex();
+}
+
+qint64 getCount(const qRestMetrics* metrics)
+{
+  qint64 count = 0;
+  foreach(const QVariantMap& series, metrics->snapshot())
+    {
+    if (series["method"].toString() == "GET")
+      {
+      count += series["count"].toLongLong();
+      }
+    }
+  return count;
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStoreTester::testInsertRetrieve_data()
+{
+  QTest::addColumn<int>("linkMode");
+  QTest::newRow("copy") << static_cast<int>(qRestBlobStore::CopyFiles);
+  QTest::newRow("hardlink") << static_cast<int>(qRestBlobStore::HardLinks);
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStoreTester::testInsertRetrieve()
+{
+  QFETCH(int, linkMode);
+
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QByteArray data(1000, 'a');
+  QVERIFY(writeFile(dir.filePath("source.bin"), data));
+
+  {
+  qRestBlobStore store(dir.filePath("store"));
+  store.setLinkMode(static_cast<qRestBlobStore::LinkMode>(linkMode));
+  QVERIFY(!store.contains(sha512(data), QCryptographicHash::Sha512));
+  QVERIFY(!store.retrieve(sha512(data), QCryptographicHash::Sha512, dir.filePath("output.bin")));
+  QVERIFY(store.insert(sha512(data), QCryptographicHash::Sha512, dir.filePath("source.bin")));
+  QVERIFY(store.contains(sha512(data), QCryptographicHash::Sha512));
+  QCOMPARE(store.count(), 1);
+  QCOMPARE(store.size(), qint64(data.size()));
+  }
+
+  // The content of the store is found again by a new instance.
+  qRestBlobStore store(dir.filePath("store"));
+  QCOMPARE(store.count(), 1);
+  QVERIFY(writeFile(dir.filePath("output.bin"), "previous"));
+  QVERIFY(store.retrieve(sha512(data), QCryptographicHash::Sha512, dir.filePath("output.bin")));
+  QCOMPARE(readFile(dir.filePath("output.bin")), data);
+  // Only the output file is left next to the source.
+  QCOMPARE(dir.entryList(QDir::Files | QDir::Hidden).size(), 2);
+
+  QVERIFY(store.remove(sha512(data), QCryptographicHash::Sha512));
+  QCOMPARE(store.count(), 0);
+  QVERIFY(!QFile::exists(store.filePath(sha512(data), QCryptographicHash::Sha512)));
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStoreTester::testInvalidChecksum_data()
+{
+  QTest::addColumn<QByteArray>("checksum");
+  QTest::newRow("empty") << QByteArray();
+  QTest::newRow("traversal") << QByteArray("../../escaped");
+  QTest::newRow("too short") << sha512("data").left(64);
+  QTest::newRow("not hexadecimal") << sha512("data").replace(0, 2, "zz");
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStoreTester::testInvalidChecksum()
+{
+  QFETCH(QByteArray, checksum);
+
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QVERIFY(writeFile(dir.filePath("source.bin"), "data"));
+  qRestBlobStore store(dir.filePath("store"));
+
+  QVERIFY(!store.insert(checksum, QCryptographicHash::Sha512, dir.filePath("source.bin")));
+  QVERIFY(!store.contains(checksum, QCryptographicHash::Sha512));
+  QVERIFY(store.filePath(checksum, QCryptographicHash::Sha512).isEmpty());
+  QVERIFY(!store.retrieve(checksum, QCryptographicHash::Sha512, dir.filePath("output.bin")));
+  QVERIFY(!store.remove(checksum, QCryptographicHash::Sha512));
+  QCOMPARE(store.count(), 0);
+  QVERIFY(!QFile::exists(dir.filePath("escaped")));
+  QVERIFY(!QFile::exists(dir.filePath("output.bin")));
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStoreTester::testEviction()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  qRestBlobStore store(dir.filePath("store"), 2500);
+
+  QList<QByteArray> blobs;
+  for (int index = 0; index < 3; ++index)
+    {
+    QByteArray data(1000, static_cast<char>('a' + index));
+    QString fileName = dir.filePath(QString("source%1.bin").arg(index));
+    QVERIFY(writeFile(fileName, data));
+    QVERIFY(store.insert(sha512(data), QCryptographicHash::Sha512, fileName));
+    blobs << data;
+    // Make the first blob the most recently used.
+    QTest::qWait(10);
+    if (index == 1)
+      {
+      QVERIFY(store.retrieve(sha512(blobs[0]), QCryptographicHash::Sha512, dir.filePath("output.bin")));
+      QTest::qWait(10);
+      }
+    }
+
+  QCOMPARE(store.count(), 2);
+  QVERIFY(store.size() <= store.maximumSize());
+  QVERIFY(store.contains(sha512(blobs[0]), QCryptographicHash::Sha512));
+  QVERIFY(!store.contains(sha512(blobs[1]), QCryptographicHash::Sha512));
+  QVERIFY(store.contains(sha512(blobs[2]), QCryptographicHash::Sha512));
+
+  store.setMaximumSize(1000);
+  QCOMPARE(store.count(), 1);
+  QVERIFY(store.contains(sha512(blobs[2]), QCryptographicHash::Sha512));
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStoreTester::testDownload()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QByteArray data(100000, 'x');
+  QVERIFY(writeFile(dir.filePath("source.bin"), data));
+
+  qRestBlobStore store(dir.filePath("store"));
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setBlobStore(&store);
+
+  QUuid queryId = restAPI.download(dir.filePath("output1.bin"), "/source.bin",
+                                   qRestAPI::Parameters(), qRestAPI::RawHeaders(),
+                                   sha512(data), QCryptographicHash::Sha512);
+  QVERIFY(restAPI.sync(queryId));
+  QVERIFY(store.contains(sha512(data), QCryptographicHash::Sha512));
+
+  // The source is not available anymore, the file comes from the store.
+  QVERIFY(QFile::remove(dir.filePath("source.bin")));
+  queryId = restAPI.download(dir.filePath("output2.bin"), "/source.bin",
+                             qRestAPI::Parameters(), qRestAPI::RawHeaders(),
+                             sha512(data), QCryptographicHash::Sha512);
+  QVERIFY(restAPI.sync(queryId));
+  QCOMPARE(readFile(dir.filePath("output2.bin")), data);
+  // Both queries are recorded in the metrics.
+  QCOMPARE(getCount(restAPI.metrics()), qint64(2));
+}
+
+#define main qRestBlobStoreTest
+QTEST_MAIN(qRestBlobStoreTester)
+#undef main
+
+#include "moc_qRestBlobStoreTest.cpp"
@@ -0,0 +1,192 @@
+// Qt includes
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QTimer>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestBlockingClient.h"
+#include "qRestReplay.h"
+#include "qRestResult.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qRestBlockingClientTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void initTestCase();
+
+  void testGet();
+  void testSendBody_data();
+  void testSendBody();
+  void testTimeOut();
+  void testNoReentrancy();
+  void testConcurrentCallers();
+
+protected slots:
+  void onTimeOut();
+
+private:
+  QTemporaryDir Directory;
+  bool TimerFired;
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+QString replayFileName;
+
+qRestAPI* createReplayAPI()
+{
+  qRestAPI* restAPI = new qRestAPI;
+  restAPI->startReplay(replayFileName, 1.);
+  return restAPI;
+}
+
+qRestRecord delayedRecord(const QByteArray& method, const QString& resource,
+                          const QByteArray& body, qint64 delay)
+{
+  qRestRecord record = withContentType(
+    replyRecord(method, "http://data.test", resource, body), "application/json");
+  record.FirstByteDelay = delay;
+  record.LastByteDelay = delay;
+  return record;
+}
+
+class CallerThread : public QThread
+{
+public:
+  CallerThread(qRestBlockingClient* client) : Client(client), Count(0) {}
+  void run()
+    {
+    QScopedPointer<qRestResult> result(this->Client->get("/items"));
+    this->Count = result->results().size();
+    }
+  qRestBlockingClient* Client;
+  int Count;
+};
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::initTestCase()
+{
+  replayFileName = QDir(this->Directory.path()).filePath("replay.rec");
+  QVERIFY(writeRecording(replayFileName, QList<qRestRecord>()
+    << delayedRecord("GET", "/items", "[{\"_id\": \"a\"}, {\"_id\": \"b\"}]", 10)
+    << delayedRecord("GET", "/slow", "[]", 2000)
+    << delayedRecord("POST", "/items", "[{\"_id\": \"c\"}]", 10)
+    << delayedRecord("PUT", "/items", "[{\"_id\": \"c\"}]", 10)));
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::onTimeOut()
+{
+  this->TimerFired = true;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::testGet()
+{
+  qRestBlockingClient client(&createReplayAPI);
+  client.setServerUrl("http://data.test");
+  QCOMPARE(client.serverUrl(), QString("http://data.test"));
+
+  QScopedPointer<qRestResult> result(client.get("/items"));
+  QVERIFY(result);
+  QVERIFY(result->error().isEmpty());
+  QCOMPARE(result->results().size(), 2);
+  QCOMPARE(result->results()[1]["_id"].toString(), QString("b"));
+  QCOMPARE(result->thread(), QThread::currentThread());
+
+  result.reset(client.get("/unknown"));
+  QVERIFY(!result->error().isEmpty());
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::testSendBody_data()
+{
+  QTest::addColumn<int>("operation");
+  QTest::newRow("post") << static_cast<int>(QNetworkAccessManager::PostOperation);
+  QTest::newRow("put") << static_cast<int>(QNetworkAccessManager::PutOperation);
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::testSendBody()
+{
+  QFETCH(int, operation);
+
+  qRestBlockingClient client(&createReplayAPI);
+  client.setServerUrl("http://data.test");
+
+  // The body must outlive the call: it is read once the call returned.
+  for (int index = 0; index < 3; ++index)
+    {
+    QScopedPointer<qRestResult> result(client.send(
+      static_cast<QNetworkAccessManager::Operation>(operation), "/items",
+      qRestAPI::Parameters(), qRestAPI::RawHeaders(), QByteArray(1000, 'x')));
+    QVERIFY(result->error().isEmpty());
+    QCOMPARE(result->results().size(), 1);
+    QCOMPARE(result->results()[0]["_id"].toString(), QString("c"));
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::testTimeOut()
+{
+  qRestBlockingClient client(&createReplayAPI);
+  client.setServerUrl("http://data.test");
+  client.setTimeOut(100);
+
+  QScopedPointer<qRestResult> result(client.get("/slow"));
+  QCOMPARE(result->errorType(), qRestAPI::TimeoutError);
+
+  // The abandoned query does not prevent the next ones.
+  client.setTimeOut(0);
+  result.reset(client.get("/items"));
+  QVERIFY(result->error().isEmpty());
+  QCOMPARE(result->results().size(), 2);
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::testNoReentrancy()
+{
+  qRestBlockingClient client(&createReplayAPI);
+  client.setServerUrl("http://data.test");
+
+  this->TimerFired = false;
+  QTimer::singleShot(0, this, SLOT(onTimeOut()));
+  QScopedPointer<qRestResult> result(client.get("/items"));
+  QVERIFY(result->error().isEmpty());
+  // The events of the calling thread are not processed while waiting.
+  QVERIFY(!this->TimerFired);
+  QTRY_VERIFY(this->TimerFired);
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClientTester::testConcurrentCallers()
+{
+  qRestBlockingClient client(&createReplayAPI);
+  client.setServerUrl("http://data.test");
+
+  QList<CallerThread*> threads;
+  for (int index = 0; index < 4; ++index)
+    {
+    threads << new CallerThread(&client);
+    threads.last()->start();
+    }
+  foreach(CallerThread* thread, threads)
+    {
+    QVERIFY(thread->wait(5000));
+    QCOMPARE(thread->Count, 2);
+    }
+  qDeleteAll(threads);
+}
+
+#define main qRestBlockingClientTest
+QTEST_MAIN(qRestBlockingClientTester)
+#undef main
+
+#include "moc_qRestBlockingClientTest.cpp"
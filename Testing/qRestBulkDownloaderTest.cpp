@@ -0,0 +1,124 @@
+// Qt includes
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestBulkDownloader.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qRestBulkDownloaderTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testDownload();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const char* ServerUrl = "http://data.test";
+
+bool writeFile(const QString& fileName, const QByteArray& data)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  return file.write(data) == data.size();
+}
+
+QByteArray readFile(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderTester::testDownload()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QString recording = dir.filePath("data.rec");
+
+  // "b" fails once, "missing" is not on the server.
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << getRecord(ServerUrl, "/a", "aaaa")
+    << getRecord(ServerUrl, "/b", QByteArray(), 503)
+    << getRecord(ServerUrl, "/b", "bbbbbb")
+    << getRecord(ServerUrl, "/c", "cc")));
+
+  // "c" is already present.
+  QVERIFY(writeFile(dir.filePath("c.txt"), "cc"));
+
+  QList<qRestDownloadEntry> manifest;
+  manifest << qRestDownloadEntry("/a", dir.filePath("a.txt"));
+  manifest << qRestDownloadEntry("/b", dir.filePath("b.txt"));
+  qRestDownloadEntry c("/c", dir.filePath("c.txt"));
+  c.Size = 2;
+  c.Checksum = QCryptographicHash::hash("cc", QCryptographicHash::Sha256).toHex();
+  c.ChecksumAlgorithm = QCryptographicHash::Sha256;
+  manifest << c;
+  manifest << qRestDownloadEntry("/missing", dir.filePath("missing.txt"));
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(ServerUrl);
+  QVERIFY(restAPI.startReplay(recording, 0.));
+
+  qRestBulkDownloader downloader(&restAPI);
+  downloader.setMaximumConcurrentDownloads(2);
+  downloader.setMaximumRetries(1);
+  downloader.setRetryDelay(0);
+  QSignalSpy entrySpy(&downloader, SIGNAL(entryFinished(int,int)));
+  QVERIFY(downloader.start(manifest));
+  QVERIFY(downloader.isRunning());
+  QVERIFY(!downloader.wait());
+
+  QCOMPARE(downloader.status(0), qRestBulkDownloader::Downloaded);
+  QCOMPARE(downloader.attempts(0), 1);
+  QCOMPARE(downloader.status(1), qRestBulkDownloader::Downloaded);
+  QCOMPARE(downloader.attempts(1), 2);
+  QCOMPARE(downloader.status(2), qRestBulkDownloader::Skipped);
+  QCOMPARE(downloader.attempts(2), 0);
+  QCOMPARE(downloader.status(3), qRestBulkDownloader::Failed);
+  QCOMPARE(downloader.attempts(3), 2);
+  QVERIFY(!downloader.errorString(3).isEmpty());
+  QCOMPARE(entrySpy.count(), 4);
+
+  QVariantMap summary = downloader.summary();
+  QCOMPARE(summary["entries"].toInt(), 4);
+  QCOMPARE(summary["downloaded"].toInt(), 2);
+  QCOMPARE(summary["skipped"].toInt(), 1);
+  QCOMPARE(summary["failed"].toInt(), 1);
+  QCOMPARE(summary["retries"].toInt(), 2);
+  QCOMPARE(summary["bytesDownloaded"].toLongLong(), qint64(10));
+  QCOMPARE(summary["bytesSkipped"].toLongLong(), qint64(2));
+  QCOMPARE(readFile(dir.filePath("a.txt")), QByteArray("aaaa"));
+  QCOMPARE(readFile(dir.filePath("b.txt")), QByteArray("bbbbbb"));
+  QVERIFY(!QFile::exists(dir.filePath("missing.txt")));
+
+  // A file whose content does not match the checksum is downloaded again.
+  QVERIFY(writeFile(dir.filePath("c.txt"), "xx"));
+  QVERIFY(downloader.start(manifest.mid(2, 1)));
+  QVERIFY(downloader.wait());
+  QCOMPARE(downloader.status(0), qRestBulkDownloader::Downloaded);
+  QCOMPARE(readFile(dir.filePath("c.txt")), QByteArray("cc"));
+}
+
+#define main qRestBulkDownloaderTest
+QTEST_MAIN(qRestBulkDownloaderTester)
+#undef main
+
+#include "moc_qRestBulkDownloaderTest.cpp"
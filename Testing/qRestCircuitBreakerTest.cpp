@@ -0,0 +1,183 @@
+// Qt includes
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestCircuitBreaker.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qRestCircuitBreakerTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testTrip();
+  void testEndpoints();
+  void testSlowCalls();
+  void testWindowSize();
+  void testQueries();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const QUrl ItemUrl("http://data.test/api/v1/item");
+const QUrl FileUrl("http://data.test/api/v1/file/1234/download");
+
+void recordFailures(qRestCircuitBreaker& breaker, const QUrl& url, int count)
+{
+  for (int index = 0; index < count; ++index)
+    {
+    breaker.recordResult(url, true, 0, 10);
+    }
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerTester::testTrip()
+{
+  qRestCircuitBreaker breaker;
+  breaker.setMinimumRequests(4);
+  breaker.setFailureRatio(0.5);
+  breaker.setOpenDuration(100);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Closed);
+
+  // Client errors do not count as failures.
+  for (int index = 0; index < 4; ++index)
+    {
+    breaker.recordResult(ItemUrl, true, 404, 10);
+    }
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Closed);
+
+  breaker.recordResult(ItemUrl, true, 503, 10);
+  recordFailures(breaker, ItemUrl, 4);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Open);
+  QVERIFY(!breaker.allowRequest(ItemUrl));
+
+  // A single trial query is sent once the open duration elapsed.
+  QTest::qWait(150);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::HalfOpen);
+  bool trial = false;
+  QVERIFY(breaker.allowRequest(ItemUrl, &trial));
+  QVERIFY(trial);
+  QVERIFY(!breaker.allowRequest(ItemUrl));
+
+  // Only the outcome of the trial query is considered.
+  breaker.recordResult(ItemUrl, false, 200, 10);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::HalfOpen);
+  // The place of an aborted trial is given back.
+  breaker.releaseTrial(ItemUrl);
+  QVERIFY(breaker.allowRequest(ItemUrl, &trial));
+  QVERIFY(trial);
+  breaker.recordResult(ItemUrl, true, 0, 10, true);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Open);
+
+  QTest::qWait(150);
+  QVERIFY(breaker.allowRequest(ItemUrl, &trial));
+  breaker.recordResult(ItemUrl, false, 200, 10, trial);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Closed);
+  QVERIFY(breaker.allowRequest(ItemUrl, &trial));
+  QVERIFY(!trial);
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerTester::testEndpoints()
+{
+  qRestCircuitBreaker breaker;
+  breaker.setMinimumRequests(2);
+  QCOMPARE(breaker.endpoint(FileUrl), QString("http://data.test"));
+  breaker.setResourcePrefixes(QStringList() << "/api/v1" << "/api/v1/file");
+  QCOMPARE(breaker.endpoint(FileUrl), QString("http://data.test/api/v1/file"));
+  QCOMPARE(breaker.endpoint(ItemUrl), QString("http://data.test/api/v1"));
+  QCOMPARE(breaker.endpoint(QUrl("https://data.test:8443/")), QString("https://data.test:8443"));
+
+  recordFailures(breaker, FileUrl, 2);
+  QCOMPARE(breaker.state(FileUrl), qRestCircuitBreaker::Open);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Closed);
+
+  breaker.reset();
+  QCOMPARE(breaker.state(FileUrl), qRestCircuitBreaker::Closed);
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerTester::testSlowCalls()
+{
+  qRestCircuitBreaker breaker;
+  breaker.setMinimumRequests(2);
+  for (int index = 0; index < 2; ++index)
+    {
+    breaker.recordResult(ItemUrl, false, 200, 5000);
+    }
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Closed);
+
+  breaker.setSlowCallDuration(1000);
+  for (int index = 0; index < 2; ++index)
+    {
+    breaker.recordResult(ItemUrl, false, 200, 5000);
+    }
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Open);
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerTester::testWindowSize()
+{
+  // The minimum is clamped to the window, or the endpoint could never open.
+  qRestCircuitBreaker breaker;
+  breaker.setWindowSize(5);
+  breaker.setMinimumRequests(10);
+  QCOMPARE(breaker.minimumRequests(), 5);
+  recordFailures(breaker, ItemUrl, 5);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Open);
+
+  breaker.setWindowSize(3);
+  QCOMPARE(breaker.minimumRequests(), 3);
+  breaker.setWindowSize(20);
+  QCOMPARE(breaker.minimumRequests(), 3);
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerTester::testQueries()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("replay.rec");
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << getRecord("http://data.test/api/v1", "/item", QByteArray(), 503)));
+
+  qRestCircuitBreaker breaker;
+  breaker.setMinimumRequests(2);
+  qRestAPI restAPI;
+  restAPI.setServerUrl("http://data.test/api/v1");
+  restAPI.setCircuitBreaker(&breaker);
+  QCOMPARE(restAPI.circuitBreaker(), &breaker);
+  QVERIFY(restAPI.startReplay(recording, 0.));
+
+  for (int index = 0; index < 2; ++index)
+    {
+    QVERIFY(!restAPI.sync(restAPI.get("/item")));
+    QCOMPARE(restAPI.error(), qRestAPI::NetworkError);
+    }
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Open);
+
+  // The query fails without being sent.
+  QVERIFY(!restAPI.sync(restAPI.get("/item")));
+  QCOMPARE(restAPI.error(), qRestAPI::CircuitOpenError);
+  QCOMPARE(restAPI.replayManager()->servedCount(), 2);
+
+  // The failure of the trial query opens the endpoint again.
+  breaker.setOpenDuration(0);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::HalfOpen);
+  QVERIFY(!restAPI.sync(restAPI.get("/item")));
+  QCOMPARE(restAPI.error(), qRestAPI::NetworkError);
+  QCOMPARE(restAPI.replayManager()->servedCount(), 3);
+  breaker.setOpenDuration(30000);
+  QCOMPARE(breaker.state(ItemUrl), qRestCircuitBreaker::Open);
+}
+
+#define main qRestCircuitBreakerTest
+QTEST_MAIN(qRestCircuitBreakerTester)
+#undef main
+
+#include "moc_qRestCircuitBreakerTest.cpp"
@@ -0,0 +1,97 @@
+// Qt includes
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestCompactResult.h"
+
+// --------------------------------------------------------------------------
+class qRestCompactResultTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testRoundTrip();
+  void testColumnTypes();
+  void testRow();
+};
+
+// --------------------------------------------------------------------------
+void qRestCompactResultTester::testRoundTrip()
+{
+  QVariantMap nested;
+  nested["x"] = 1;
+
+  QVariantMap first;
+  first["_id"] = "5f0f1a";
+  first["name"] = "first";
+  first["size"] = 10;
+  first["public"] = true;
+  first["meta"] = nested;
+
+  QVariantMap second;
+  second["_id"] = "5f0f1b";
+  second["name"] = "second";
+  second["description"] = "only in the second row";
+
+  QList<QVariantMap> input;
+  input << first << second;
+
+  qRestCompactResult result = qRestCompactResult::fromVariantMapList(input);
+  QCOMPARE(result.rowCount(), 2);
+  QCOMPARE(result.columnCount(), 6);
+  QCOMPARE(result.toVariantMapList(), input);
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResultTester::testColumnTypes()
+{
+  qRestCompactResult result;
+  int size = result.internKey("size");
+  int name = result.internKey("name");
+  QCOMPARE(result.internKey("size"), size);
+
+  int row = result.appendRow();
+  result.setValue(row, size, 10);
+  result.setValue(row, name, "a");
+  QCOMPARE(result.columnType(size), qRestCompactResult::IntColumn);
+  QCOMPARE(result.columnType(name), qRestCompactResult::StringColumn);
+
+  row = result.appendRow();
+  result.setValue(row, size, 2.5);
+  result.setValue(row, name, 3);
+  QCOMPARE(result.columnType(size), qRestCompactResult::DoubleColumn);
+  QCOMPARE(result.columnType(name), qRestCompactResult::VariantColumn);
+
+  QCOMPARE(result.value(0, size).toDouble(), 10.);
+  QCOMPARE(result.value(1, size).toDouble(), 2.5);
+  QCOMPARE(result.value(0, name), QVariant("a"));
+  QCOMPARE(result.value(1, name), QVariant(3));
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResultTester::testRow()
+{
+  qRestCompactResult result;
+  int row = result.appendRow();
+  result.setValue(row, "name", "a");
+  row = result.appendRow();
+  result.setValue(row, "size", 2);
+
+  qRestCompactResult::Row first = result.row(0);
+  QVERIFY(first.contains("name"));
+  QVERIFY(!first.contains("size"));
+  QVERIFY(!first.contains("unknown"));
+  QCOMPARE(first.value("name").toString(), QString("a"));
+  QCOMPARE(first.value("size", -1).toInt(), -1);
+  QCOMPARE(first.toMap().size(), 1);
+
+  qRestCompactResult::Row second = result.row(1);
+  QCOMPARE(second.index(), 1);
+  QCOMPARE(second.value("size").toInt(), 2);
+}
+
+#define main qRestCompactResultTest
+QTEST_MAIN(qRestCompactResultTester)
+#undef main
+
+#include "moc_qRestCompactResultTest.cpp"
@@ -0,0 +1,219 @@
+// Qt includes
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestFileSink.h"
+#include "qRestResult.h"
+
+// --------------------------------------------------------------------------
+class qRestFileSinkTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testWrite_data();
+  void testWrite();
+  void testCancel();
+  void testPermissions();
+  void testDownload();
+  void testDownloadChecksum_data();
+  void testDownloadChecksum();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+QByteArray readFile(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testWrite_data()
+{
+  QTest::addColumn<int>("writeMode");
+  QTest::addColumn<qint64>("preallocatedSize");
+
+  QTest::newRow("buffered") << static_cast<int>(qRestFileSink::BufferedWrites) << qint64(0);
+  QTest::newRow("buffered-preallocated") << static_cast<int>(qRestFileSink::BufferedWrites) << qint64(300000);
+  QTest::newRow("mapped") << static_cast<int>(qRestFileSink::MemoryMappedWrites) << qint64(300000);
+  QTest::newRow("mapped-larger-than-preallocated") << static_cast<int>(qRestFileSink::MemoryMappedWrites) << qint64(1000);
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testWrite()
+{
+  QFETCH(int, writeMode);
+  QFETCH(qint64, preallocatedSize);
+
+  QTemporaryDir directory;
+  QString fileName = QDir(directory.path()).filePath("data.bin");
+
+  QByteArray data;
+  for (int index = 0; index < 300000; ++index)
+    {
+    data.append(static_cast<char>(index % 251));
+    }
+
+  qRestFileSink sink(fileName);
+  sink.setWriteMode(static_cast<qRestFileSink::WriteMode>(writeMode));
+  sink.setBufferSize(64 * 1024);
+  QVERIFY(sink.open(QIODevice::WriteOnly));
+  if (preallocatedSize > 0)
+    {
+    QVERIFY(sink.preallocate(preallocatedSize));
+    }
+  for (int offset = 0; offset < data.size(); offset += 10000)
+    {
+    QCOMPARE(sink.write(data.mid(offset, 10000)), qint64(10000));
+    }
+  QVERIFY(!QFile::exists(fileName));
+  sink.close();
+
+  QVERIFY(sink.isCommitted());
+  QCOMPARE(readFile(fileName), data);
+  QCOMPARE(QDir(directory.path()).entryList(QDir::Files | QDir::Hidden).size(), 1);
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testCancel()
+{
+  QTemporaryDir directory;
+  QString fileName = QDir(directory.path()).filePath("data.bin");
+
+  QFile existing(fileName);
+  QVERIFY(existing.open(QIODevice::WriteOnly));
+  existing.write("previous");
+  existing.close();
+
+  qRestFileSink sink(fileName);
+  QVERIFY(sink.open(QIODevice::WriteOnly));
+  sink.write("partial");
+  sink.cancel();
+  sink.close();
+
+  QVERIFY(!sink.isCommitted());
+  QCOMPARE(readFile(fileName), QByteArray("previous"));
+  QCOMPARE(QDir(directory.path()).entryList(QDir::Files | QDir::Hidden).size(), 1);
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testPermissions()
+{
+#if defined(Q_OS_WIN)
+  QSKIP("File permissions are not POSIX permissions on Windows");
+#else
+  QTemporaryDir directory;
+  QString fileName = QDir(directory.path()).filePath("data.bin");
+
+  // New files are readable by everyone.
+  qRestFileSink sink(fileName);
+  QVERIFY(sink.open(QIODevice::WriteOnly));
+  sink.write("data");
+  sink.close();
+  QVERIFY(sink.isCommitted());
+  QFile::Permissions permissions = QFile::permissions(fileName);
+  QVERIFY(permissions & QFile::ReadOwner);
+  QVERIFY(permissions & QFile::WriteOwner);
+  QVERIFY(permissions & QFile::ReadGroup);
+  QVERIFY(permissions & QFile::ReadOther);
+
+  // Replaced files keep their permissions.
+  QVERIFY(QFile::setPermissions(fileName, QFile::ReadOwner | QFile::WriteOwner));
+  qRestFileSink replacingSink(fileName);
+  QVERIFY(replacingSink.open(QIODevice::WriteOnly));
+  replacingSink.write("other");
+  replacingSink.close();
+  QVERIFY(replacingSink.isCommitted());
+  permissions = QFile::permissions(fileName);
+  QVERIFY(permissions & QFile::WriteOwner);
+  QVERIFY(!(permissions & QFile::ReadGroup));
+  QVERIFY(!(permissions & QFile::ReadOther));
+#endif
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testDownload()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+
+  QByteArray data(100000, 'x');
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(data);
+  source.close();
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setMemoryMappedDownloads(true);
+
+  QUuid queryId = restAPI.download(dir.filePath("output.bin"), "/source.bin");
+  QVERIFY(!queryId.isNull());
+  QVERIFY(restAPI.sync(queryId));
+  QCOMPARE(readFile(dir.filePath("output.bin")), data);
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testDownloadChecksum_data()
+{
+  QTest::addColumn<bool>("validChecksum");
+  QTest::newRow("valid") << true;
+  QTest::newRow("invalid") << false;
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkTester::testDownloadChecksum()
+{
+  QFETCH(bool, validChecksum);
+
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+
+  QByteArray data(100000, 'x');
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(data);
+  source.close();
+
+  QByteArray checksum = QCryptographicHash::hash(
+    validChecksum ? data : QByteArray("other"), QCryptographicHash::Sha256).toHex();
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setChecksumAlgorithms(QList<QCryptographicHash::Algorithm>() << QCryptographicHash::Md5);
+
+  QUuid queryId = restAPI.download(dir.filePath("output.bin"), "/source.bin",
+                                   qRestAPI::Parameters(), qRestAPI::RawHeaders(),
+                                   checksum, QCryptographicHash::Sha256);
+  QVERIFY(!queryId.isNull());
+
+  QScopedPointer<qRestResult> result(restAPI.takeResult(queryId));
+  QCOMPARE(result.isNull(), !validChecksum);
+  QCOMPARE(QFile::exists(dir.filePath("output.bin")), validChecksum);
+  if (validChecksum)
+    {
+    QCOMPARE(result->checksum(QCryptographicHash::Md5),
+             QCryptographicHash::hash(data, QCryptographicHash::Md5));
+    }
+  else
+    {
+    QCOMPARE(restAPI.error(), qRestAPI::IntegrityError);
+    }
+}
+
+#define main qRestFileSinkTest
+QTEST_MAIN(qRestFileSinkTester)
+#undef main
+
+#include "moc_qRestFileSinkTest.cpp"
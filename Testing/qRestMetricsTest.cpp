@@ -0,0 +1,117 @@
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestMetrics.h"
+#include "qRestResult.h"
+
+// --------------------------------------------------------------------------
+class qRestMetricsTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testResourcePattern_data();
+  void testResourcePattern();
+  void testRecord();
+  void testQueryTiming();
+};
+
+// --------------------------------------------------------------------------
+void qRestMetricsTester::testResourcePattern_data()
+{
+  QTest::addColumn<QString>("resource");
+  QTest::addColumn<QString>("pattern");
+
+  QTest::newRow("plain") << "/api/v1/user/me" << "/api/v1/user/me";
+  QTest::newRow("object id") << "/api/v1/item/5e8d1c2f9a1b2c3d4e5f6a7b/files"
+                             << "/api/v1/item/{id}/files";
+  QTest::newRow("number") << "/midas/item/123" << "/midas/item/{id}";
+  QTest::newRow("uuid") << "/job/0f8fad5b-d9cb-469f-a165-70867728950e"
+                        << "/job/{id}";
+  QTest::newRow("query") << "/api/v1/item?folderId=5e8d1c2f9a1b2c3d4e5f6a7b"
+                         << "/api/v1/item";
+  QTest::newRow("short hex word") << "/api/v1/face/cafe" << "/api/v1/face/cafe";
+}
+
+// --------------------------------------------------------------------------
+void qRestMetricsTester::testResourcePattern()
+{
+  QFETCH(QString, resource);
+  QFETCH(QString, pattern);
+  QCOMPARE(qRestMetrics::resourcePattern(resource), pattern);
+}
+
+// --------------------------------------------------------------------------
+void qRestMetricsTester::testRecord()
+{
+  qRestMetrics metrics;
+  for (int latency = 1; latency <= 100; ++latency)
+    {
+    qRestTiming timing;
+    timing.Queued = 1000;
+    timing.LastByte = 1000 + latency;
+    timing.BytesReceived = 10;
+    metrics.record("GET", QString("/item/%1").arg(latency), timing,
+                   latency % 10 == 0 ? qRestAPI::NetworkError : qRestAPI::UnknownError);
+    }
+
+  QCOMPARE(metrics.count("GET", "/item/42"), qint64(100));
+  QCOMPARE(metrics.count("PUT", "/item/42"), qint64(0));
+  QCOMPARE(metrics.latencyPercentile("PUT", "/item/42", 0.5), qint64(-1));
+  // Buckets are within 20% of the actual value.
+  qint64 median = metrics.latencyPercentile("GET", "/item/42", 0.5);
+  QVERIFY(median >= 45 && median <= 60);
+  QCOMPARE(metrics.latencyPercentile("GET", "/item/42", 1.), qint64(100));
+
+  QList<QVariantMap> snapshot = metrics.snapshot();
+  QCOMPARE(snapshot.size(), 1);
+  QCOMPARE(snapshot[0]["method"].toString(), QString("GET"));
+  QCOMPARE(snapshot[0]["resource"].toString(), QString("/item/{id}"));
+  QCOMPARE(snapshot[0]["errors"].toLongLong(), qint64(10));
+  QCOMPARE(snapshot[0]["errorCounts"].toMap()[QString::number(qRestAPI::NetworkError)].toLongLong(), qint64(10));
+  QCOMPARE(snapshot[0]["bytesReceived"].toLongLong(), qint64(1000));
+  QCOMPARE(snapshot[0]["latencyMin"].toLongLong(), qint64(1));
+  QCOMPARE(snapshot[0]["latencyMax"].toLongLong(), qint64(100));
+
+  metrics.reset();
+  QVERIFY(metrics.snapshot().isEmpty());
+}
+
+// --------------------------------------------------------------------------
+void qRestMetricsTester::testQueryTiming()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(QByteArray(1000, 'x'));
+  source.close();
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  QUuid queryId = restAPI.download(dir.filePath("output.bin"), "/source.bin");
+  QVERIFY(!queryId.isNull());
+
+  QScopedPointer<qRestResult> result(restAPI.takeResult(queryId));
+  QVERIFY(!result.isNull());
+  const qRestTiming& timing = result->timing();
+  QVERIFY(timing.Queued >= 0);
+  QVERIFY(timing.QueuedWallTime > 0);
+  QVERIFY(timing.Dispatched >= timing.Queued);
+  QVERIFY(timing.LastByte >= timing.Dispatched);
+  QVERIFY(timing.FinishedDelivered >= timing.LastByte);
+  QVERIFY(timing.totalTime() >= 0);
+
+  QString resource = QUrl::fromLocalFile(dir.filePath("source.bin")).path();
+  QCOMPARE(restAPI.metrics()->count("GET", resource), qint64(1));
+}
+
+#define main qRestMetricsTest
+QTEST_MAIN(qRestMetricsTester)
+#undef main
+
+#include "moc_qRestMetricsTest.cpp"
@@ -0,0 +1,214 @@
+// Qt includes
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qMidasAPI.h"
+#include "qRestAPI.h"
+#include "qRestPreparedRequest.h"
+#include "qRestReplay.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qRestPreparedRequestTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void initTestCase();
+
+  void testExecute();
+  void testCreateUrl();
+  void testOtherAPI();
+
+  void benchmarkGet();
+  void benchmarkExecute();
+
+private:
+  QTemporaryDir Directory;
+  QString Recording;
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const char* ServerUrl = "http://data.test";
+
+QList<QByteArray> recordedHeaders(const QString& fileName, const QByteArray& name)
+{
+  QList<QByteArray> values;
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return values;
+    }
+  QDataStream stream(&file);
+  if (!qRestRecord::readHeader(stream))
+    {
+    return values;
+    }
+  while (!stream.atEnd())
+    {
+    qRestRecord record;
+    stream >> record;
+    QByteArray value;
+    foreach(const qRestRecord::RawHeaderPairs::value_type& header, record.RequestHeaders)
+      {
+      if (header.first == name)
+        {
+        value = header.second;
+        }
+      }
+    values << value;
+    }
+  return values;
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestPreparedRequestTester::initTestCase()
+{
+  this->Recording = QDir(this->Directory.path()).filePath("replay.rec");
+  QVERIFY(writeRecording(this->Recording, QList<qRestRecord>()
+    << withContentType(getRecord(ServerUrl, "/item?folderId=f1&limit=5",
+                                 "[{\"_id\": \"a\"}, {\"_id\": \"b\"}]"),
+                       "application/json")
+    << withContentType(getRecord(ServerUrl, "/item?folderId=f2&limit=", "[]"),
+                       "application/json")
+    << withContentType(getRecord(ServerUrl, "/api/json?method=midas.item.get&id=7",
+                                 "{\"stat\": \"ok\", \"code\": \"0\", \"message\": \"\","
+                                 " \"data\": {\"item_id\": \"7\"}}"),
+                       "application/json")));
+}
+
+// --------------------------------------------------------------------------
+void qRestPreparedRequestTester::testExecute()
+{
+  qRestAPI restAPI;
+  restAPI.setServerUrl(ServerUrl);
+  QVERIFY(restAPI.startReplay(this->Recording, 0.));
+  QString requests = QDir(this->Directory.path()).filePath("requests.rec");
+  QVERIFY(restAPI.startRecording(requests));
+
+  qRestAPI::RawHeaders rawHeaders;
+  rawHeaders["X-Client"] = "poller";
+  qRestPreparedRequest prepared = restAPI.prepare(
+    QNetworkAccessManager::GetOperation, "/item",
+    QStringList() << "folderId" << "limit", rawHeaders);
+  QVERIFY(prepared.isValid());
+  QCOMPARE(prepared.parameterNames().size(), 2);
+
+  QList<QVariantMap> result;
+  QVERIFY(restAPI.sync(restAPI.execute(prepared, QStringList() << "f1" << "5"), result));
+  QCOMPARE(result.size(), 2);
+  QCOMPARE(result[1]["_id"].toString(), QString("b"));
+
+  // Missing values are sent empty, the new default headers are sent.
+  qRestAPI::RawHeaders defaultRawHeaders;
+  defaultRawHeaders["Girder-Token"] = "t2";
+  restAPI.setDefaultRawHeaders(defaultRawHeaders);
+  QVERIFY(restAPI.sync(restAPI.execute(prepared, QStringList() << "f2"), result));
+  QVERIFY(result.isEmpty());
+  restAPI.stopRecording();
+
+  QCOMPARE(recordedHeaders(requests, "X-Client"),
+           QList<QByteArray>() << "poller" << "poller");
+  QCOMPARE(recordedHeaders(requests, "Girder-Token"),
+           QList<QByteArray>() << QByteArray() << "t2");
+
+  QVERIFY(!restAPI.sync(restAPI.execute(qRestPreparedRequest())));
+}
+
+// --------------------------------------------------------------------------
+void qRestPreparedRequestTester::testCreateUrl()
+{
+  // The URL is composed by the subclass.
+  qMidasAPI midasAPI;
+  midasAPI.setServerUrl(ServerUrl);
+  QVERIFY(midasAPI.startReplay(this->Recording, 0.));
+  qRestPreparedRequest prepared = midasAPI.prepare(
+    QNetworkAccessManager::GetOperation, "midas.item.get", QStringList() << "id");
+  QList<QVariantMap> result;
+  QVERIFY(midasAPI.sync(midasAPI.execute(prepared, QStringList() << "7"), result));
+  QCOMPARE(result.size(), 1);
+  QCOMPARE(result[0]["item_id"].toString(), QString("7"));
+}
+
+// --------------------------------------------------------------------------
+void qRestPreparedRequestTester::testOtherAPI()
+{
+  qRestAPI::RawHeaders defaultRawHeaders;
+  defaultRawHeaders["Girder-Token"] = "t1";
+  QScopedPointer<qRestAPI> firstAPI(new qRestAPI);
+  firstAPI->setServerUrl(ServerUrl);
+  firstAPI->setDefaultRawHeaders(defaultRawHeaders);
+  QVERIFY(firstAPI->startReplay(this->Recording, 0.));
+  qRestPreparedRequest prepared = firstAPI->prepare(
+    QNetworkAccessManager::GetOperation, "/item", QStringList() << "folderId" << "limit");
+  QVERIFY(firstAPI->sync(firstAPI->execute(prepared, QStringList() << "f1" << "5")));
+  firstAPI.reset();
+
+  // The request built by the first object is not reused by another one,
+  // even if it is allocated at the same address.
+  defaultRawHeaders["Girder-Token"] = "t2";
+  qRestAPI secondAPI;
+  secondAPI.setServerUrl(ServerUrl);
+  secondAPI.setDefaultRawHeaders(defaultRawHeaders);
+  QVERIFY(secondAPI.startReplay(this->Recording, 0.));
+  QString requests = QDir(this->Directory.path()).filePath("other.rec");
+  QVERIFY(secondAPI.startRecording(requests));
+  QVERIFY(secondAPI.sync(secondAPI.execute(prepared, QStringList() << "f1" << "5")));
+  secondAPI.stopRecording();
+  QCOMPARE(recordedHeaders(requests, "Girder-Token"), QList<QByteArray>() << "t2");
+}
+
+// --------------------------------------------------------------------------
+void qRestPreparedRequestTester::benchmarkGet()
+{
+  qRestAPI restAPI;
+  restAPI.setServerUrl(ServerUrl);
+  qRestAPI::RawHeaders defaultRawHeaders;
+  defaultRawHeaders["Girder-Token"] = "token";
+  defaultRawHeaders["User-Agent"] = "qRestAPI";
+  restAPI.setDefaultRawHeaders(defaultRawHeaders);
+  QVERIFY(restAPI.startReplay(this->Recording, 0.));
+
+  qRestAPI::Parameters parameters;
+  parameters["folderId"] = "f1";
+  parameters["limit"] = "5";
+  QBENCHMARK
+    {
+    // The result is taken so that the queries do not pile up.
+    delete restAPI.takeResult(restAPI.get("/item", parameters));
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestPreparedRequestTester::benchmarkExecute()
+{
+  qRestAPI restAPI;
+  restAPI.setServerUrl(ServerUrl);
+  qRestAPI::RawHeaders defaultRawHeaders;
+  defaultRawHeaders["Girder-Token"] = "token";
+  defaultRawHeaders["User-Agent"] = "qRestAPI";
+  restAPI.setDefaultRawHeaders(defaultRawHeaders);
+  QVERIFY(restAPI.startReplay(this->Recording, 0.));
+
+  qRestPreparedRequest prepared = restAPI.prepare(
+    QNetworkAccessManager::GetOperation, "/item",
+    QStringList() << "folderId" << "limit");
+  QStringList values = QStringList() << "f1" << "5";
+  QBENCHMARK
+    {
+    // The result is taken so that the queries do not pile up.
+    delete restAPI.takeResult(restAPI.execute(prepared, values));
+    }
+}
+
+#define main qRestPreparedRequestTest
+QTEST_MAIN(qRestPreparedRequestTester)
+#undef main
+
+#include "moc_qRestPreparedRequestTest.cpp"
@@ -0,0 +1,186 @@
+// Qt includes
+#include <QBuffer>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestReplay.h"
+#include "qRestResult.h"
+
+// --------------------------------------------------------------------------
+class qRestReplayTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testRecordStream();
+  void testRecordReplay_data();
+  void testRecordReplay();
+  void testUnmatched();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+void writeFile(const QString& fileName, const QByteArray& data)
+{
+  QFile file(fileName);
+  if (file.open(QIODevice::WriteOnly))
+    {
+    file.write(data);
+    }
+}
+
+QByteArray readFile(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayTester::testRecordStream()
+{
+  qRestRecord record;
+  record.Method = "GET";
+  record.Url = "http://localhost/api/v1/item/1";
+  record.RequestHeaders << qMakePair(QByteArray("Girder-Token"), QByteArray("abc"));
+  record.HttpStatusCode = 200;
+  record.ReasonPhrase = "OK";
+  record.ResponseHeaders << qMakePair(QByteArray("Content-Type"), QByteArray("application/json"));
+  record.Body = "{\"_id\": \"1\"}";
+  record.Offset = 12;
+  record.FirstByteDelay = 20;
+  record.LastByteDelay = 30;
+
+  QByteArray data;
+  QDataStream output(&data, QIODevice::WriteOnly);
+  qRestRecord::writeHeader(output);
+  output << record;
+
+  QDataStream input(data);
+  QVERIFY(qRestRecord::readHeader(input));
+  qRestRecord copy;
+  input >> copy;
+  QCOMPARE(input.status(), QDataStream::Ok);
+  QCOMPARE(copy.Method, record.Method);
+  QCOMPARE(copy.Url, record.Url);
+  QCOMPARE(copy.RequestHeaders, record.RequestHeaders);
+  QCOMPARE(copy.HttpStatusCode, record.HttpStatusCode);
+  QCOMPARE(copy.ReasonPhrase, record.ReasonPhrase);
+  QCOMPARE(copy.ResponseHeaders, record.ResponseHeaders);
+  QCOMPARE(copy.Body, record.Body);
+  QCOMPARE(copy.Offset, record.Offset);
+  QCOMPARE(copy.FirstByteDelay, record.FirstByteDelay);
+  QCOMPARE(copy.LastByteDelay, record.LastByteDelay);
+
+  QDataStream invalid(QByteArray("not a recording"));
+  QVERIFY(!qRestRecord::readHeader(invalid));
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayTester::testRecordReplay_data()
+{
+  QTest::addColumn<double>("speed");
+  QTest::newRow("recorded") << 1.;
+  QTest::newRow("accelerated") << 100.;
+  QTest::newRow("immediate") << 0.;
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayTester::testRecordReplay()
+{
+  QFETCH(double, speed);
+
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  dir.mkdir("server");
+  QString serverPath = dir.filePath("server");
+
+  QByteArray document("[{\"name\": \"item\"}]");
+  QByteArray data;
+  for (int index = 0; index < 200000; ++index)
+    {
+    data.append(static_cast<char>(index % 251));
+    }
+  writeFile(QDir(serverPath).filePath("document.json"), document);
+  writeFile(QDir(serverPath).filePath("data.bin"), data);
+
+  QString recording = dir.filePath("queries.rec");
+  {
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(serverPath).toString());
+  QVERIFY(restAPI.startRecording(recording));
+  QVERIFY(restAPI.isRecording());
+
+  QUuid queryId = restAPI.get("/document.json");
+  QVERIFY(restAPI.sync(queryId));
+  QScopedPointer<qRestResult> result(restAPI.takeResult(queryId));
+  QCOMPARE(result->response(), document);
+
+  QVERIFY(restAPI.sync(restAPI.download(dir.filePath("recorded.bin"), "/data.bin")));
+  QVERIFY(!restAPI.sync(restAPI.get("/missing.json")));
+  restAPI.stopRecording();
+  QVERIFY(!restAPI.isRecording());
+  }
+
+  // The server is not needed anymore.
+  QVERIFY(QDir(serverPath).removeRecursively());
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(serverPath).toString());
+  QVERIFY(restAPI.startReplay(recording, speed));
+  QVERIFY(restAPI.replayManager());
+  QCOMPARE(restAPI.replayManager()->count(), 3);
+
+  QUuid queryId = restAPI.get("/document.json");
+  QVERIFY(restAPI.sync(queryId));
+  QScopedPointer<qRestResult> result(restAPI.takeResult(queryId));
+  QCOMPARE(result->response(), document);
+  QVERIFY(result->timing().FirstByte >= 0);
+
+  QVERIFY(restAPI.sync(restAPI.download(dir.filePath("replayed.bin"), "/data.bin")));
+  QCOMPARE(readFile(dir.filePath("replayed.bin")), data);
+
+  QVERIFY(!restAPI.sync(restAPI.get("/missing.json")));
+  QCOMPARE(restAPI.error(), qRestAPI::NetworkError);
+
+  QCOMPARE(restAPI.replayManager()->servedCount(), 3);
+  QCOMPARE(restAPI.replayManager()->unmatchedCount(), 0);
+
+  restAPI.stopReplay();
+  QVERIFY(!restAPI.replayManager());
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayTester::testUnmatched()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("empty.rec");
+  {
+  qRestAPI restAPI;
+  QVERIFY(restAPI.startRecording(recording));
+  }
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl("http://localhost");
+  QVERIFY(!restAPI.startReplay(QDir(directory.path()).filePath("missing.rec")));
+  QVERIFY(restAPI.startReplay(recording, 0.));
+  QCOMPARE(restAPI.replayManager()->count(), 0);
+
+  QVERIFY(!restAPI.sync(restAPI.get("/item")));
+  QCOMPARE(restAPI.replayManager()->unmatchedCount(), 1);
+}
+
+#define main qRestReplayTest
+QTEST_MAIN(qRestReplayTester)
+#undef main
+
+#include "moc_qRestReplayTest.cpp"
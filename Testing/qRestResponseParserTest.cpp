@@ -0,0 +1,250 @@
+// Qt includes
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+#include <QCborMap>
+#include <QCborValue>
+#endif
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qRestAPI.h"
+#include "qRestCompactResult.h"
+#include "qRestReplay.h"
+#include "qRestResponseParser.h"
+#include "qRestResult.h"
+#include "qRestTestHelpers.h"
+
+// --------------------------------------------------------------------------
+class qRestResponseParserTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testMessagePack();
+  void testMessagePackInvalid_data();
+  void testMessagePackInvalid();
+  void testJson();
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+  void testCbor();
+#endif
+  void testRegistry();
+  void testDefaultParsing();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+const char* ServerUrl = "http://data.test";
+
+// [{"_id": "a", "size": 5}, {"_id": "b", "size": 300}]
+const char messagePackItems[] =
+  "\x92"
+  "\x82" "\xa3_id" "\xa1" "a" "\xa4size" "\x05"
+  "\x82" "\xa3_id" "\xa1" "b" "\xa4size" "\xcd\x01\x2c";
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testMessagePack()
+{
+  qRestMessagePackParser parser;
+  QVariant value;
+  QString error;
+  QVERIFY(parser.parse(QByteArray(messagePackItems, sizeof(messagePackItems) - 1), value, error));
+
+  QList<QVariantMap> result;
+  qRestResponseParser::appendToVariantMapList(result, value);
+  QCOMPARE(result.size(), 2);
+  QCOMPARE(result[0]["_id"].toString(), QString("a"));
+  QCOMPARE(result[0]["size"].toLongLong(), qint64(5));
+  QCOMPARE(result[1]["size"].toLongLong(), qint64(300));
+
+  // nil, true, -1, 1.5, "hé", bin, uint64, timestamp 32
+  const char scalars[] =
+    "\x98"
+    "\xc0" "\xc3" "\xff"
+    "\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00"
+    "\xd9\x03h\xc3\xa9"
+    "\xc4\x02\x00\x01"
+    "\xcf\xff\xff\xff\xff\xff\xff\xff\xff"
+    "\xd6\xff\x00\x00\x00\x3c";
+  QVERIFY(parser.parse(QByteArray(scalars, sizeof(scalars) - 1), value, error));
+  QVariantList list = value.toList();
+  QCOMPARE(list.size(), 8);
+  QVERIFY(list[0].isNull());
+  QCOMPARE(list[1].toBool(), true);
+  QCOMPARE(list[2].toLongLong(), qint64(-1));
+  QCOMPARE(list[3].toDouble(), 1.5);
+  QCOMPARE(list[4].toString(), QString::fromUtf8("h\xc3\xa9"));
+  QCOMPARE(list[5].toByteArray(), QByteArray("\x00\x01", 2));
+  QCOMPARE(list[6].toULongLong(), Q_UINT64_C(0xffffffffffffffff));
+  QCOMPARE(list[7].toDateTime().toMSecsSinceEpoch(), qint64(60000));
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testMessagePackInvalid_data()
+{
+  QTest::addColumn<QByteArray>("data");
+  QTest::newRow("truncated array") << QByteArray("\x92\x01", 2);
+  QTest::newRow("truncated string") << QByteArray("\xa5" "abc", 4);
+  QTest::newRow("truncated integer") << QByteArray("\xcd\x01", 2);
+  QTest::newRow("huge map") << QByteArray("\xdf\xff\xff\xff\xff", 5);
+  QTest::newRow("invalid type") << QByteArray("\xc1", 1);
+  QTest::newRow("trailing data") << QByteArray("\x01\x02", 2);
+  QTest::newRow("too deep") << QByteArray(1000, '\x91');
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testMessagePackInvalid()
+{
+  QFETCH(QByteArray, data);
+  qRestMessagePackParser parser;
+  QVariant value;
+  QString error;
+  QVERIFY(!parser.parse(data, value, error));
+  QVERIFY(!error.isEmpty());
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testJson()
+{
+  qRestJsonParser parser;
+  QVariant value;
+  QString error;
+  QVERIFY(parser.parse("{\"_id\": \"a\", \"size\": 5}", value, error));
+  QCOMPARE(value.toMap()["size"].toLongLong(), qint64(5));
+
+  QVERIFY(parser.parse("true", value, error));
+  QCOMPARE(value.toBool(), true);
+  QList<QVariantMap> result;
+  qRestResponseParser::appendToVariantMapList(result, value);
+  QVERIFY(result.isEmpty());
+
+  QVERIFY(!parser.parse("{\"_id\": ", value, error));
+  QVERIFY(!error.isEmpty());
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testCbor()
+{
+  QCborMap map;
+  map.insert(QString("_id"), QString("a"));
+  map.insert(QString("size"), 5);
+  qRestCborParser parser;
+  QVariant value;
+  QString error;
+  QVERIFY(parser.parse(QCborValue(map).toCbor(), value, error));
+  QCOMPARE(value.toMap()["_id"].toString(), QString("a"));
+  QCOMPARE(value.toMap()["size"].toLongLong(), qint64(5));
+
+  QVERIFY(!parser.parse(QByteArray("\xa1\x61", 2), value, error));
+}
+#endif
+
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testRegistry()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("data.rec");
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << withContentType(getRecord(ServerUrl, "/items",
+                                 QByteArray(messagePackItems, sizeof(messagePackItems) - 1)),
+                       "application/msgpack")
+    << withContentType(getRecord(ServerUrl, "/item", "{\"_id\": \"c\"}"),
+                       "application/json; charset=utf-8")
+    << withContentType(getRecord(ServerUrl, "/invalid", "\xc1"), "application/msgpack")
+    << withContentType(getRecord(ServerUrl, "/text", "hello"), "text/plain")));
+
+  QVERIFY(qRestAPI().responseParser("application/json") != 0);
+  QVERIFY(qRestAPI().responseParser("application/msgpack") != 0);
+
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  girderAPI.setAcceptedContentTypes(QList<QByteArray>()
+    << "application/msgpack" << "application/json");
+  QCOMPARE(girderAPI.acceptedContentTypes().size(), 2);
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+
+  QList<QVariantMap> result;
+  QVERIFY(girderAPI.sync(girderAPI.get("/items"), result));
+  QCOMPARE(result.size(), 2);
+  QCOMPARE(result[1]["_id"].toString(), QString("b"));
+
+  QVERIFY(girderAPI.sync(girderAPI.get("/item"), result));
+  QCOMPARE(result.size(), 1);
+  QCOMPARE(result[0]["_id"].toString(), QString("c"));
+
+  QVERIFY(!girderAPI.sync(girderAPI.get("/invalid"), result));
+  QCOMPARE(girderAPI.error(), qRestAPI::ResponseParseError);
+
+  girderAPI.setCompactResults(true);
+  QUuid queryId = girderAPI.get("/items");
+  QScopedPointer<qRestResult> restResult(girderAPI.takeResult(queryId));
+  QVERIFY(restResult);
+  QCOMPARE(restResult->contentType(), QByteArray("application/msgpack"));
+  QCOMPARE(restResult->compactResults().rowCount(), 2);
+
+  // Unregistered content types are left to the parser of the class.
+  girderAPI.setCompactResults(false);
+  girderAPI.unregisterResponseParser("application/msgpack");
+  QVERIFY(girderAPI.responseParser("application/msgpack") == 0);
+  qRestAPI restAPI;
+  restAPI.setServerUrl(ServerUrl);
+  QVERIFY(restAPI.startReplay(recording, 0.));
+  QVERIFY(restAPI.sync(restAPI.get("/text"), result));
+  QVERIFY(result.isEmpty());
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParserTester::testDefaultParsing()
+{
+  QTemporaryDir directory;
+  QString recording = QDir(directory.path()).filePath("data.rec");
+  QVERIFY(writeRecording(recording, QList<qRestRecord>()
+    << withContentType(getRecord(ServerUrl, "/item", "{\"_id\": \"c\"}"),
+                       "application/json")
+    << withContentType(getRecord(ServerUrl, "/text", "{\"_id\": \"c\"}"), "text/plain")
+    << getRecord(ServerUrl, "/items", "[{\"_id\": \"a\"}, {\"_id\": \"b\"}]")));
+
+  // qRestAPI parses the JSON responses and gives an empty result for the
+  // content types without a parser, as well as for a missing content type.
+  qRestAPI restAPI;
+  restAPI.setServerUrl(ServerUrl);
+  QVERIFY(restAPI.startReplay(recording, 0.));
+  QList<QVariantMap> result;
+  QVERIFY(restAPI.sync(restAPI.get("/item"), result));
+  QCOMPARE(result.size(), 1);
+  QCOMPARE(result[0]["_id"].toString(), QString("c"));
+  QVERIFY(restAPI.sync(restAPI.get("/text"), result));
+  QVERIFY(result.isEmpty());
+  QVERIFY(restAPI.sync(restAPI.get("/items"), result));
+  QVERIFY(result.isEmpty());
+
+  // qGirderAPI parses them all with the JSON parser.
+  qGirderAPI girderAPI;
+  girderAPI.setServerUrl(ServerUrl);
+  QVERIFY(girderAPI.startReplay(recording, 0.));
+  QVERIFY(girderAPI.sync(girderAPI.get("/text"), result));
+  QCOMPARE(result.size(), 1);
+  QVERIFY(girderAPI.sync(girderAPI.get("/items"), result));
+  QCOMPARE(result.size(), 2);
+  QCOMPARE(result[1]["_id"].toString(), QString("b"));
+
+  girderAPI.setCompactResults(true);
+  QScopedPointer<qRestResult> restResult(girderAPI.takeResult(girderAPI.get("/items")));
+  QVERIFY(restResult);
+  QCOMPARE(restResult->compactResults().rowCount(), 2);
+
+  // Without the JSON parser, qGirderAPI gives an empty result too.
+  girderAPI.setCompactResults(false);
+  girderAPI.unregisterResponseParser("application/json");
+  QVERIFY(girderAPI.sync(girderAPI.get("/items"), result));
+  QVERIFY(result.isEmpty());
+}
+
+#define main qRestResponseParserTest
+QTEST_MAIN(qRestResponseParserTester)
+#undef main
+
+#include "moc_qRestResponseParserTest.cpp"
@@ -0,0 +1,96 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestTestHelpers_h
+#define __qRestTestHelpers_h
+
+// Qt includes
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QNetworkReply>
+
+// qRestAPI includes
+#include "qRestReplay.h"
+
+// Helpers shared by the tests that replay recorded replies.
+
+// --------------------------------------------------------------------------
+/// Returns the reply \a httpStatusCode with \a body to the query \a method
+/// of \a serverUrl + \a resource. Replies 401 fail with an authentication
+/// error, the other replies from 400 with a content error.
+inline qRestRecord replyRecord(const QByteArray& method, const QString& serverUrl,
+                               const QString& resource,
+                               const QByteArray& body = QByteArray(),
+                               int httpStatusCode = 200)
+{
+  qRestRecord record;
+  record.Method = method;
+  record.Url = serverUrl + resource;
+  record.HttpStatusCode = httpStatusCode;
+  record.Body = body;
+  if (httpStatusCode == 401)
+    {
+    record.NetworkError = QNetworkReply::AuthenticationRequiredError;
+    record.ErrorString = "Unauthorized";
+    }
+  else if (httpStatusCode >= 400)
+    {
+    record.NetworkError = QNetworkReply::UnknownContentError;
+    record.ErrorString = QString("Server replied %1").arg(httpStatusCode);
+    }
+  return record;
+}
+
+// --------------------------------------------------------------------------
+/// Returns the reply to a GET query, see replyRecord().
+inline qRestRecord getRecord(const QString& serverUrl, const QString& resource,
+                             const QByteArray& body = QByteArray(),
+                             int httpStatusCode = 200)
+{
+  return replyRecord("GET", serverUrl, resource, body, httpStatusCode);
+}
+
+// --------------------------------------------------------------------------
+/// Returns \a record with the Content-Type response header \a contentType.
+inline qRestRecord withContentType(qRestRecord record, const QByteArray& contentType)
+{
+  record.ResponseHeaders << qMakePair(QByteArray("Content-Type"), contentType);
+  return record;
+}
+
+// --------------------------------------------------------------------------
+/// Writes a recording of \a records that can be replayed by
+/// qRestAPI::startReplay().
+inline bool writeRecording(const QString& fileName, const QList<qRestRecord>& records)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  qRestRecord::writeHeader(stream);
+  foreach(const qRestRecord& record, records)
+    {
+    stream << record;
+    }
+  file.close();
+  return stream.status() == QDataStream::Ok;
+}
+
+#endif
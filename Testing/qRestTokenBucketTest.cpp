@@ -0,0 +1,120 @@
+// Qt includes
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestTokenBucket.h"
+
+// --------------------------------------------------------------------------
+class qRestTokenBucketTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testUnlimited();
+  void testRate();
+  void testThrottledDownload();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+qint64 simulatedTime = 0;
+
+qint64 simulatedClock()
+{
+  return simulatedTime;
+}
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucketTester::testUnlimited()
+{
+  qRestTokenBucket bucket;
+  QVERIFY(!bucket.isLimited());
+  QVERIFY(bucket.available() > qint64(1) << 40);
+  bucket.consume(1000000);
+  QCOMPARE(bucket.delay(1000000), 0);
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucketTester::testRate()
+{
+  qRestTokenBucket bucket(100 * 1024);
+  simulatedTime = 0;
+  bucket.setClock(&simulatedClock);
+  QVERIFY(bucket.isLimited());
+  QCOMPARE(bucket.burstSize(), qint64(25 * 1024));
+  // The bucket starts full.
+  QCOMPARE(bucket.available(), bucket.burstSize());
+
+  bucket.consume(bucket.available());
+  QCOMPARE(bucket.available(), qint64(0));
+  QCOMPARE(bucket.delay(10 * 1024), 100);
+  simulatedTime += 50;
+  QCOMPARE(bucket.available(), qint64(5 * 1024));
+  QCOMPARE(bucket.delay(10 * 1024), 50);
+  simulatedTime += 50;
+  QCOMPARE(bucket.available(), qint64(10 * 1024));
+  QCOMPARE(bucket.delay(10 * 1024), 0);
+
+  // Tokens do not accumulate beyond the burst size.
+  simulatedTime += 10000;
+  QCOMPARE(bucket.available(), bucket.burstSize());
+
+  // The tokens are kept when the rate changes, up to the new burst size.
+  bucket.setRate(32 * 1024);
+  QCOMPARE(bucket.available(), qint64(16 * 1024));
+  bucket.consume(16 * 1024);
+  simulatedTime += 125;
+  QCOMPARE(bucket.available(), qint64(4 * 1024));
+
+  // Requests larger than the burst size are clamped.
+  bucket.setBurstSize(4096);
+  QCOMPARE(bucket.available(), qint64(4096));
+  QCOMPARE(bucket.delay(1000000), 0);
+
+  bucket.setRate(0);
+  QVERIFY(!bucket.isLimited());
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucketTester::testThrottledDownload()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+
+  QByteArray data(64 * 1024, 'x');
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(data);
+  source.close();
+
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setDownloadRateLimit(128 * 1024);
+  QCOMPARE(restAPI.downloadRateLimit(), qint64(128 * 1024));
+
+  QElapsedTimer timer;
+  timer.start();
+  QUuid queryId = restAPI.download(dir.filePath("output.bin"), "/source.bin");
+  QVERIFY(!queryId.isNull());
+  // The first 32 KiB fill the bucket, the remaining data takes 250 ms. Only
+  // a loose lower bound is checked, the download can not be faster.
+  QVERIFY(restAPI.setDownloadRateLimit(queryId, 128 * 1024));
+  QVERIFY(restAPI.sync(queryId));
+  QVERIFY(timer.elapsed() >= 125);
+
+  QFile output(dir.filePath("output.bin"));
+  QVERIFY(output.open(QIODevice::ReadOnly));
+  QCOMPARE(output.readAll(), data);
+}
+
+#define main qRestTokenBucketTest
+QTEST_MAIN(qRestTokenBucketTester)
+#undef main
+
+#include "moc_qRestTokenBucketTest.cpp"
@@ -0,0 +1,112 @@
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestResult.h"
+#include "qRestTracer.h"
+
+// --------------------------------------------------------------------------
+class qRestTracerTester : public  QObject
+{
+  Q_OBJECT
+private slots:
+  void testTraceParent();
+  void testTracer();
+};
+
+// --------------------------------------------------------------------------
+namespace
+{
+class RecordingTracer : public qRestTracer
+{
+public:
+  virtual void spanStarted(const qRestSpan& span)
+  {
+    this->Started << span;
+  }
+  virtual void spanFinished(const qRestSpan& span, const qRestTiming& timing,
+                            qRestAPI::ErrorType errorCode, const QString& errorString)
+  {
+    Q_UNUSED(errorString);
+    this->Finished << span;
+    this->Timings << timing;
+    this->ErrorCodes << errorCode;
+  }
+
+  QList<qRestSpan> Started;
+  QList<qRestSpan> Finished;
+  QList<qRestTiming> Timings;
+  QList<qRestAPI::ErrorType> ErrorCodes;
+};
+}
+
+// --------------------------------------------------------------------------
+void qRestTracerTester::testTraceParent()
+{
+  QByteArray traceParent = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+  qRestSpan parent = qRestSpan::fromTraceParent(traceParent);
+  QCOMPARE(parent.TraceId, QByteArray("4bf92f3577b34da6a3ce929d0e0e4736"));
+  QCOMPARE(parent.ParentSpanId, QByteArray("00f067aa0ba902b7"));
+  QCOMPARE(static_cast<int>(parent.Flags), 1);
+
+  qRestSpan child = qRestSpan::create(parent);
+  QVERIFY(child.isValid());
+  QCOMPARE(child.TraceId, parent.TraceId);
+  QCOMPARE(child.ParentSpanId, parent.ParentSpanId);
+  QCOMPARE(child.SpanId.size(), 16);
+  QCOMPARE(qRestSpan::fromTraceParent(child.traceParent()).ParentSpanId, child.SpanId);
+
+  qRestSpan root = qRestSpan::create();
+  QCOMPARE(root.TraceId.size(), 32);
+  QVERIFY(root.ParentSpanId.isEmpty());
+  QVERIFY(root.TraceId != child.TraceId);
+
+  QVERIFY(!qRestSpan::fromTraceParent("00-xyz-00f067aa0ba902b7-01").isValid());
+  QVERIFY(qRestSpan::fromTraceParent("00-00000000000000000000000000000000-00f067aa0ba902b7-01").TraceId.isEmpty());
+}
+
+// --------------------------------------------------------------------------
+void qRestTracerTester::testTracer()
+{
+  QTemporaryDir directory;
+  QDir dir(directory.path());
+  QFile source(dir.filePath("source.bin"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write(QByteArray(1000, 'x'));
+  source.close();
+
+  RecordingTracer tracer;
+  qRestAPI restAPI;
+  restAPI.setServerUrl(QUrl::fromLocalFile(directory.path()).toString());
+  restAPI.setTracer(&tracer);
+  restAPI.setTraceContextPropagation(true);
+  QByteArray traceParent = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+  QVERIFY(restAPI.setParentTraceContext(traceParent));
+  QCOMPARE(restAPI.parentTraceContext(), traceParent);
+  QVERIFY(!restAPI.setParentTraceContext("invalid"));
+
+  QUuid queryId = restAPI.download(dir.filePath("output.bin"), "/source.bin");
+  QCOMPARE(tracer.Started.size(), 1);
+  QCOMPARE(tracer.Started[0].QueryId, queryId);
+  QCOMPARE(tracer.Started[0].Method, QByteArray("GET"));
+
+  QScopedPointer<qRestResult> result(restAPI.takeResult(queryId));
+  QVERIFY(!result.isNull());
+  QCOMPARE(result->span().TraceId, QByteArray("4bf92f3577b34da6a3ce929d0e0e4736"));
+  QCOMPARE(result->span().SpanId, tracer.Started[0].SpanId);
+
+  QCOMPARE(tracer.Finished.size(), 1);
+  QCOMPARE(tracer.Finished[0].SpanId, tracer.Started[0].SpanId);
+  QCOMPARE(tracer.ErrorCodes[0], qRestAPI::UnknownError);
+  QVERIFY(tracer.Timings[0].totalTime() >= 0);
+}
+
+#define main qRestTracerTest
+QTEST_MAIN(qRestTracerTester)
+#undef main
+
+#include "moc_qRestTracerTest.cpp"
@@ -18,26 +18,130 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QNetworkReply>
 #include <QUrl>
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-#include <QJSEngine>
-#include <QJSValue>
-#else
-#include <QScriptEngine>
-#include <QScriptValue>
-#endif
 
 // qRestAPI includes
 #include "qGirderAPI.h"
+#include "qGirderAPI_p.h"
+#include "qRestCompactResult.h"
+#include "qRestResponseParser.h"
 #include "qRestResult.h"
 
+static const char* tokenHeader = "Girder-Token";
+
+// --------------------------------------------------------------------------
+// qGirderAPIPrivate methods
+
+// --------------------------------------------------------------------------
+qGirderAPIPrivate::qGirderAPIPrivate(qGirderAPI* object)
+  : q_ptr(object)
+{
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPIPrivate::init()
+{
+  Q_Q(qGirderAPI);
+  QObject::connect(q, SIGNAL(finished(QUuid)),
+                   this, SLOT(queryFinished(QUuid)));
+}
+
+// --------------------------------------------------------------------------
+bool qGirderAPIPrivate::canRefreshToken() const
+{
+  return !this->ApiKey.isEmpty() || !this->Login.isEmpty();
+}
+
+// --------------------------------------------------------------------------
+QByteArray qGirderAPIPrivate::parseToken(const QByteArray& response)
+{
+  // e.g. {"authToken": {"token": "...", "expires": "..."}, ...}
+  QList<QVariantMap> result;
+  qGirderAPI::parseGirderAPIv1Response(response, result);
+  if (result.isEmpty())
+    {
+    return QByteArray();
+    }
+  return result.first().value("authToken").toMap().value("token").toString().toLatin1();
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPIPrivate::queryFinished(const QUuid& queryId)
+{
+  Q_Q(qGirderAPI);
+  this->ResentQueries.remove(queryId);
+  if (queryId != this->RefreshQueryId)
+    {
+    return;
+    }
+  this->RefreshQueryId = QUuid();
+
+  QByteArray token;
+  QString error;
+  QScopedPointer<qRestResult> result(q->takeResult(queryId));
+  if (result)
+    {
+    token = qGirderAPIPrivate::parseToken(result->response());
+    if (token.isEmpty())
+      {
+      error = "No token in the response";
+      }
+    }
+  else
+    {
+    error = q->errorString();
+    }
+
+  if (token.isEmpty())
+    {
+    QList<QUuid> heldQueries = this->HeldQueries;
+    this->HeldQueries.clear();
+    emit q->tokenRefreshFailed(error);
+    foreach(const QUuid& heldQueryId, heldQueries)
+      {
+      q->failQuery(heldQueryId, "Failed to renew the token: " + error,
+                   qRestAPI::AuthenticationError);
+      }
+    return;
+    }
+
+  q->setToken(token);
+  emit q->tokenRefreshed(token);
+  this->resendHeldQueries();
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPIPrivate::resendHeldQueries()
+{
+  Q_Q(qGirderAPI);
+  if (!this->RefreshQueryId.isNull())
+    {
+    return;
+    }
+  QList<QUuid> heldQueries = this->HeldQueries;
+  this->HeldQueries.clear();
+  foreach(const QUuid& queryId, heldQueries)
+    {
+    this->ResentQueries.insert(queryId);
+    if (!q->resendQuery(queryId))
+      {
+      this->ResentQueries.remove(queryId);
+      q->failQuery(queryId, "Failed to send the query again", qRestAPI::AuthenticationError);
+      }
+    }
+}
+
 // --------------------------------------------------------------------------
 // qGirderAPI methods
 
 // --------------------------------------------------------------------------
 qGirderAPI::qGirderAPI(QObject* _parent)
   : Superclass(_parent)
+  , d_ptr(new qGirderAPIPrivate(this))
 {
+  Q_D(qGirderAPI);
+  d->init();
 }
 
 // --------------------------------------------------------------------------
@@ -45,38 +149,36 @@ qGirderAPI::~qGirderAPI()
 {
 }
 
+// --------------------------------------------------------------------------
+/// Parses the Girder JSON \a response into \a value.
+static bool parseGirderJson(const QByteArray& response, QVariant& value)
+{
+  QString error;
+  return qRestJsonParser().parse(response, value, error);
+}
+
 // --------------------------------------------------------------------------
 bool qGirderAPI::parseGirderAPIv1Response(const QByteArray& response, QList<QVariantMap>& result)
 {
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-  QJSEngine scriptEngine;
-  QJSValue scriptValue = scriptEngine
-    .evaluate("JSON.parse")
-    .callWithInstance(QJSValue(), QJSValueList() << QString(response));
-#else
-  QScriptEngine scriptEngine;
-  QScriptValue scriptValue = scriptEngine
-    .evaluate("JSON.parse")
-    .call(QScriptValue(), QScriptValueList() << QString(response));
-#endif
-
-  // e.g. {["key1": "value1", ...]} or {"key1": "value1", ...}
-  if (scriptValue.isArray())
-    {
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    quint32 length = scriptValue.property("length").toUInt();
-#else
-    quint32 length = scriptValue.property("length").toUInt32();
-#endif
-    for(quint32 i = 0; i < length; ++i)
-      {
-      qRestAPI::appendScriptValueToVariantMapList(result, scriptValue.property(i));
-      }
+  // e.g. [{"key1": "value1", ...}, ...] or {"key1": "value1", ...}
+  QVariant value;
+  if (!parseGirderJson(response, value))
+    {
+    return false;
     }
-  else
+  qRestResponseParser::appendToVariantMapList(result, value);
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderAPI::parseGirderAPIv1Response(const QByteArray& response, qRestCompactResult& result)
+{
+  QVariant value;
+  if (!parseGirderJson(response, value))
     {
-    qRestAPI::appendScriptValueToVariantMapList(result, scriptValue);
+    return false;
     }
+  qRestResponseParser::appendToCompactResult(result, value);
   return true;
 }
 
@@ -92,6 +194,124 @@ bool qGirderAPI::parseGirderAPIv1Response(qRestResult* restResult, const QByteAr
 // --------------------------------------------------------------------------
 void qGirderAPI::parseResponse(qRestResult* restResult, const QByteArray& response)
 {
-  Q_UNUSED(response);
-  qGirderAPI::parseGirderAPIv1Response(restResult, response);
+  // Girder replies are JSON, also when the Content-Type header is missing.
+  if (!this->parseRegisteredResponse(restResult, response, "application/json"))
+    {
+    restResult->setResult(QList<QVariantMap>());
+    }
+}
+
+// --------------------------------------------------------------------------
+QByteArray qGirderAPI::token()const
+{
+  return this->defaultRawHeaders().value(tokenHeader);
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPI::setToken(const QByteArray& token)
+{
+  qRestAPI::RawHeaders rawHeaders = this->defaultRawHeaders();
+  if (token.isEmpty())
+    {
+    rawHeaders.remove(tokenHeader);
+    }
+  else
+    {
+    rawHeaders[tokenHeader] = token;
+    }
+  this->setDefaultRawHeaders(rawHeaders);
+}
+
+// --------------------------------------------------------------------------
+QString qGirderAPI::apiKey()const
+{
+  Q_D(const qGirderAPI);
+  return d->ApiKey;
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPI::setApiKey(const QString& apiKey)
+{
+  Q_D(qGirderAPI);
+  d->ApiKey = apiKey;
+}
+
+// --------------------------------------------------------------------------
+void qGirderAPI::setCredentials(const QString& login, const QString& password)
+{
+  Q_D(qGirderAPI);
+  d->Login = login;
+  d->Password = password;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderAPI::refreshToken()
+{
+  Q_D(qGirderAPI);
+  if (!d->canRefreshToken())
+    {
+    return false;
+    }
+  if (!d->RefreshQueryId.isNull())
+    {
+    return true;
+    }
+  // The expired token is not sent, a null value removes the default header.
+  qRestAPI::RawHeaders rawHeaders;
+  rawHeaders[tokenHeader] = QByteArray();
+  qRestAPI::Parameters parameters;
+  if (!d->ApiKey.isEmpty())
+    {
+    parameters["key"] = d->ApiKey;
+    d->RefreshQueryId = this->post("/api_key/token", parameters, rawHeaders);
+    }
+  else
+    {
+    rawHeaders["Authorization"] = "Basic " +
+      QString("%1:%2").arg(d->Login, d->Password).toUtf8().toBase64();
+    d->RefreshQueryId = this->get("/user/authentication", parameters, rawHeaders);
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderAPI::isRefreshingToken()const
+{
+  Q_D(const qGirderAPI);
+  return !d->RefreshQueryId.isNull();
+}
+
+// --------------------------------------------------------------------------
+bool qGirderAPI::canHedgeQuery(const QNetworkRequest& request)
+{
+  return !request.url().path().endsWith("/user/authentication");
+}
+
+// --------------------------------------------------------------------------
+bool qGirderAPI::holdFailedQuery(const QUuid& queryId, QNetworkReply* reply)
+{
+  Q_D(qGirderAPI);
+  if (reply->error() != QNetworkReply::AuthenticationRequiredError ||
+      queryId == d->RefreshQueryId || !d->canRefreshToken())
+    {
+    return false;
+    }
+  QByteArray sentToken = reply->request().rawHeader(tokenHeader);
+  bool tokenRenewed = sentToken != this->token();
+  if (!tokenRenewed && d->ResentQueries.contains(queryId))
+    {
+    // The new token is rejected as well.
+    return false;
+    }
+  d->HeldQueries << queryId;
+  if (tokenRenewed)
+    {
+    // The query was sent before the token was renewed.
+    QMetaObject::invokeMethod(d, "resendHeldQueries", Qt::QueuedConnection);
+    }
+  else
+    {
+    this->refreshToken();
+    }
+  return true;
 }
@@ -24,24 +24,86 @@
 
 #include "qRestAPI_Export.h"
 
+class qGirderAPIPrivate;
+
+/// qGirderAPI communicates with a Girder server through its RESTful API.
+///
+/// Requests are authenticated by the "Girder-Token" raw header (see
+/// token()). If an API key or credentials are set, queries rejected because
+/// the token expired are held while a new token is requested, then sent
+/// again with the new token. A single refresh is made for all the queries
+/// rejected with the same token, and the callers only see the queries
+/// finish once they are sent again.
+/// Usage:
+/// <code>
+/// qGirderAPI girder;
+/// girder.setServerUrl("https://data.kitware.com/api/v1");
+/// girder.setApiKey(apiKey);
+/// girder.refreshToken();
+/// QUuid queryId = girder.get("/item/" + itemId);
+/// </code>
 class qRestAPI_EXPORT qGirderAPI : public qRestAPI
 {
   Q_OBJECT
 
+  /// Token sent in the "Girder-Token" raw header of the requests, stored in
+  /// the default raw headers.
+  Q_PROPERTY(QByteArray token READ token WRITE setToken)
+
   typedef qRestAPI Superclass;
 
 public:
   explicit qGirderAPI(QObject*parent = 0);
   virtual ~qGirderAPI();
 
+  QByteArray token()const;
+  void setToken(const QByteArray& token);
+
+  /// API key used to request new tokens ("POST /api_key/token").
+  QString apiKey()const;
+  void setApiKey(const QString& apiKey);
+
+  /// Login and password used to request new tokens when no API key is set
+  /// ("GET /user/authentication").
+  void setCredentials(const QString& login, const QString& password);
+
+  /// Requests a new token using the API key or the credentials.
+  /// tokenRefreshed() or tokenRefreshFailed() is emitted once done.
+  /// Returns false if neither an API key nor credentials are set. Nothing is
+  /// done if a refresh is already in progress.
+  bool refreshToken();
+  bool isRefreshingToken()const;
+
+  /// Parse a Girder JSON \a response into \a result.
+  /// Returns false if \a response is not valid JSON.
   static bool parseGirderAPIv1Response(const QByteArray& response, QList<QVariantMap>& result);
 
+  /// Parse a Girder JSON \a response directly into a compact \a result.
+  /// \sa qRestAPI::compactResults
+  static bool parseGirderAPIv1Response(const QByteArray& response, qRestCompactResult& result);
+
   static bool parseGirderAPIv1Response(qRestResult* restResult, const QByteArray& response);
 
+signals:
+  void tokenRefreshed(const QByteArray& token);
+  /// Emitted when a new token could not be obtained. The held queries fail
+  /// with an AuthenticationError.
+  void tokenRefreshFailed(const QString& error);
+
 protected:
   void parseResponse(qRestResult* restResult, const QByteArray& response);
 
+  /// Holds the queries rejected with an authentication error until a new
+  /// token is obtained.
+  virtual bool holdFailedQuery(const QUuid& queryId, QNetworkReply* reply);
+
+  /// The token requests are not hedged, to not send the credentials twice.
+  virtual bool canHedgeQuery(const QNetworkRequest& request);
+
 private:
+  QScopedPointer<qGirderAPIPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qGirderAPI);
   Q_DISABLE_COPY(qGirderAPI);
 };
 
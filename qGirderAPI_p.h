@@ -0,0 +1,71 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderAPI_p_h
+#define __qGirderAPI_p_h
+
+// Qt includes
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QUuid>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+
+// --------------------------------------------------------------------------
+class qGirderAPIPrivate : public QObject
+{
+  Q_OBJECT
+
+  Q_DECLARE_PUBLIC(qGirderAPI);
+
+  qGirderAPI* const q_ptr;
+
+public:
+  qGirderAPIPrivate(qGirderAPI* object);
+
+  void init();
+
+  /// Returns true if an API key or credentials are set.
+  bool canRefreshToken() const;
+
+  /// Returns the token of a "/api_key/token" or "/user/authentication"
+  /// response, empty if none.
+  static QByteArray parseToken(const QByteArray& response);
+
+public slots:
+  /// Handles the end of the token refresh.
+  void queryFinished(const QUuid& queryId);
+  /// Sends again the held queries unless the token is being refreshed.
+  void resendHeldQueries();
+
+public:
+  QString ApiKey;
+  QString Login;
+  QString Password;
+
+  /// Query renewing the token, null if none is in progress.
+  QUuid RefreshQueryId;
+  /// Queries rejected by the server, waiting for a new token.
+  QList<QUuid> HeldQueries;
+  /// Queries sent again with a new token. They are not held twice for the
+  /// same token.
+  QSet<QUuid> ResentQueries;
+};
+
+#endif
@@ -0,0 +1,890 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDataStream>
+#include <QEventLoop>
+#include <QFile>
+#include <QSet>
+
+// qRestAPI includes
+#include "qGirderMetadataStore.h"
+#include "qGirderMetadataStore_p.h"
+#include "qRestFileSink.h"
+#include "qRestResult.h"
+
+// "qGMS"
+static const quint32 indexMagic = 0x71474d53;
+static const qint32 indexVersion = 2;
+
+// --------------------------------------------------------------------------
+namespace
+{
+QString parentKey(const qGirderMetadataStorePrivate::Entry& entry)
+{
+  return entry.EntryType == qGirderMetadataStorePrivate::Entry::Collection ?
+    QString() : entry.ParentId;
+}
+}
+
+// --------------------------------------------------------------------------
+// qGirderMetadataStorePrivate methods
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStorePrivate::Entry::operator==(const Entry& other) const
+{
+  return this->EntryType == other.EntryType &&
+    this->ParentType == other.ParentType &&
+    this->Id == other.Id &&
+    this->ParentId == other.ParentId &&
+    this->Name == other.Name &&
+    this->Updated == other.Updated &&
+    this->Size == other.Size &&
+    this->Sha512 == other.Sha512 &&
+    this->MimeType == other.MimeType;
+}
+
+// --------------------------------------------------------------------------
+qGirderMetadataStorePrivate::qGirderMetadataStorePrivate(qGirderMetadataStore* object)
+  : q_ptr(object)
+  , MaximumConcurrentQueries(4)
+  , Running(false)
+  , Cancelled(false)
+  , QueryCount(0)
+  , FolderCount(0)
+  , ItemCount(0)
+  , ItemsSkipped(0)
+  , Added(0)
+  , Removed(0)
+  , Elapsed(0)
+{
+}
+
+// --------------------------------------------------------------------------
+qGirderMetadataStorePrivate::Entry qGirderMetadataStorePrivate::entry(
+  Entry::Type type, const QVariantMap& object)
+{
+  Entry entry;
+  entry.EntryType = type;
+  entry.Id = object.value("_id").toString();
+  entry.Name = object.value("name").toString();
+  entry.Updated = object.value(type == Entry::File ? "created" : "updated").toString();
+  entry.Size = object.value("size").toLongLong();
+  if (type == Entry::File)
+    {
+    entry.Sha512 = object.value("sha512").toString();
+    entry.MimeType = object.value("mimeType").toString();
+    }
+  return entry;
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderMetadataStorePrivate::toMap(const Entry& entry)
+{
+  static const char* modelTypes[] = {"collection", "folder", "item", "file"};
+  QVariantMap map;
+  map["_id"] = entry.Id;
+  map["_modelType"] = modelTypes[entry.EntryType];
+  map["name"] = entry.Name;
+  map[entry.EntryType == Entry::File ? "created" : "updated"] = entry.Updated;
+  map["size"] = entry.Size;
+  switch (entry.EntryType)
+    {
+    case Entry::Folder:
+      map["parentId"] = entry.ParentId;
+      map["parentCollection"] = modelTypes[entry.ParentType];
+      break;
+    case Entry::Item:
+      map["folderId"] = entry.ParentId;
+      break;
+    case Entry::File:
+      map["itemId"] = entry.ParentId;
+      map["sha512"] = entry.Sha512;
+      map["mimeType"] = entry.MimeType;
+      break;
+    default:
+      break;
+    }
+  return map;
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qGirderMetadataStorePrivate::children(const QString& parentId,
+                                                         Entry::Type type) const
+{
+  QList<QVariantMap> children;
+  foreach(const QString& id, this->Children.value(parentId))
+    {
+    QHash<QString, Entry>::const_iterator object = this->Objects.constFind(id);
+    if (object != this->Objects.constEnd() &&
+        object->EntryType == type && parentKey(*object) == parentId)
+      {
+      children << toMap(*object);
+      }
+    }
+  return children;
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::replaceChildren(const QString& parentId, Entry::Type type,
+                                                  const QList<Entry>& children)
+{
+  Q_Q(qGirderMetadataStore);
+  QStringList previousIds = this->Children.value(parentId);
+  QSet<QString> newIds;
+  foreach(const Entry& child, children)
+    {
+    newIds.insert(child.Id);
+    }
+
+  // Children are ordered by type: the sub-folders of a folder are listed
+  // before its items.
+  QStringList before;
+  QStringList after;
+  foreach(const QString& id, previousIds)
+    {
+    QHash<QString, Entry>::const_iterator object = this->Objects.constFind(id);
+    if (object == this->Objects.constEnd() || parentKey(*object) != parentId)
+      {
+      // Moved to another parent.
+      continue;
+      }
+    if (object->EntryType < type)
+      {
+      before << id;
+      }
+    else if (object->EntryType > type)
+      {
+      after << id;
+      }
+    else if (!newIds.contains(id))
+      {
+      this->removeObject(id);
+      }
+    }
+
+  bool changed = false;
+  QStringList ids = before;
+  foreach(const Entry& child, children)
+    {
+    ids << child.Id;
+    QHash<QString, Entry>::iterator object = this->Objects.find(child.Id);
+    if (object == this->Objects.end())
+      {
+      this->Objects.insert(child.Id, child);
+      ++this->Added;
+      }
+    else if (*object != child)
+      {
+      *object = child;
+      changed = true;
+      }
+    }
+  ids << after;
+
+  changed = changed || ids != previousIds;
+  if (ids.isEmpty())
+    {
+    this->Children.remove(parentId);
+    }
+  else
+    {
+    this->Children.insert(parentId, ids);
+    }
+  if (changed)
+    {
+    emit q->changed(parentId);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::removeObject(const QString& id)
+{
+  foreach(const QString& childId, this->Children.take(id))
+    {
+    QHash<QString, Entry>::const_iterator child = this->Objects.constFind(childId);
+    if (child != this->Objects.constEnd() && parentKey(*child) == id)
+      {
+      this->removeObject(childId);
+      }
+    }
+  if (this->Objects.remove(id))
+    {
+    ++this->Removed;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::removeUnreachable()
+{
+  QStringList parents = this->RootFolderIds.isEmpty() ?
+    QStringList() << QString() : this->RootFolderIds;
+  QSet<QString> reachable;
+  QHash<QString, QStringList> children;
+  while (!parents.isEmpty())
+    {
+    QString parentId = parents.takeFirst();
+    QStringList childIds;
+    foreach(const QString& id, this->Children.value(parentId))
+      {
+      QHash<QString, Entry>::const_iterator object = this->Objects.constFind(id);
+      if (object != this->Objects.constEnd() && parentKey(*object) == parentId &&
+          !reachable.contains(id))
+        {
+        reachable.insert(id);
+        childIds << id;
+        parents << id;
+        }
+      }
+    if (!childIds.isEmpty())
+      {
+      children.insert(parentId, childIds);
+      }
+    }
+  this->Removed += this->Objects.size() - reachable.size();
+  for (QHash<QString, Entry>::iterator object = this->Objects.begin();
+       object != this->Objects.end();)
+    {
+    object = reachable.contains(object.key()) ? object + 1 : this->Objects.erase(object);
+    }
+  this->Children = children;
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::writeEntry(QDataStream& stream, const Entry& entry)
+{
+  stream << entry.EntryType << entry.ParentType << entry.Id << entry.ParentId
+         << entry.Name << entry.Updated << entry.Size;
+  if (entry.EntryType == Entry::File)
+    {
+    stream << entry.Sha512 << entry.MimeType;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::readEntry(QDataStream& stream, Entry& entry)
+{
+  stream >> entry.EntryType >> entry.ParentType >> entry.Id >> entry.ParentId
+         >> entry.Name >> entry.Updated >> entry.Size;
+  if (entry.EntryType == Entry::File)
+    {
+    stream >> entry.Sha512 >> entry.MimeType;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::sendQueries()
+{
+  while (!this->Cancelled && this->GirderAPI &&
+         this->PendingQueries.size() < this->MaximumConcurrentQueries &&
+         !this->Queue.isEmpty())
+    {
+    this->sendQuery(this->Queue.takeFirst());
+    }
+  if (this->PendingQueries.isEmpty() &&
+      (this->Cancelled || !this->GirderAPI || this->Queue.isEmpty()))
+    {
+    this->finish();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::sendQuery(const Task& task)
+{
+  qRestAPI::Parameters parameters;
+  parameters["limit"] = "0";
+  QString resource;
+  switch (task.TaskType)
+    {
+    case Task::ListCollections:
+      resource = "/collection";
+      break;
+    case Task::ListFolders:
+      resource = "/folder";
+      parameters["parentType"] = task.ParentType == Entry::Collection ? "collection" : "folder";
+      parameters["parentId"] = task.Id;
+      break;
+    case Task::ListItems:
+      resource = "/item";
+      parameters["folderId"] = task.Id;
+      break;
+    case Task::ListFiles:
+      resource = "/item/" + task.Id + "/files";
+      break;
+    }
+  QUuid queryId = this->GirderAPI->get(resource, parameters);
+  if (queryId.isNull())
+    {
+    this->Errors << QString("Failed to send the query %1 for %2").arg(resource).arg(task.Id);
+    return;
+    }
+  ++this->QueryCount;
+  this->PendingQueries.insert(queryId, task);
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::queryFinished(const QUuid& queryId)
+{
+  if (!this->PendingQueries.contains(queryId) || !this->GirderAPI)
+    {
+    return;
+    }
+  Task task = this->PendingQueries.take(queryId);
+  QScopedPointer<qRestResult> result(this->GirderAPI->takeResult(queryId));
+  if (!result)
+    {
+    // The listed children are kept until the next refresh.
+    this->Errors << QString("%1: %2").arg(task.Id).arg(this->GirderAPI->errorString());
+    }
+  else
+    {
+    switch (task.TaskType)
+      {
+      case Task::ListCollections:
+        this->processCollections(result->results());
+        break;
+      case Task::ListFolders:
+        this->processFolders(task, result->results());
+        break;
+      case Task::ListItems:
+        this->processItems(task, result->results());
+        break;
+      case Task::ListFiles:
+        this->processFiles(task, result->results());
+        break;
+      }
+    }
+  this->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::processCollections(const QList<QVariantMap>& collections)
+{
+  QList<Entry> entries;
+  foreach(const QVariantMap& collection, collections)
+    {
+    Entry collectionEntry = entry(Entry::Collection, collection);
+    entries << collectionEntry;
+    Task listFolders;
+    listFolders.TaskType = Task::ListFolders;
+    listFolders.Id = collectionEntry.Id;
+    listFolders.ParentType = Entry::Collection;
+    this->Queue << listFolders;
+    }
+  this->replaceChildren(QString(), Entry::Collection, entries);
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::processFolders(const Task& task, const QList<QVariantMap>& folders)
+{
+  QList<Entry> entries;
+  foreach(const QVariantMap& folder, folders)
+    {
+    ++this->FolderCount;
+    Entry folderEntry = entry(Entry::Folder, folder);
+    folderEntry.ParentId = task.Id;
+    folderEntry.ParentType = task.ParentType;
+    entries << folderEntry;
+    Task listFolders;
+    listFolders.TaskType = Task::ListFolders;
+    listFolders.Id = folderEntry.Id;
+    listFolders.ParentType = Entry::Folder;
+    this->Queue << listFolders;
+    Task listItems = listFolders;
+    listItems.TaskType = Task::ListItems;
+    this->Queue << listItems;
+    }
+  this->replaceChildren(task.Id, Entry::Folder, entries);
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::processItems(const Task& task, const QList<QVariantMap>& items)
+{
+  QList<Entry> entries;
+  foreach(const QVariantMap& item, items)
+    {
+    ++this->ItemCount;
+    Entry itemEntry = entry(Entry::Item, item);
+    itemEntry.ParentId = task.Id;
+
+    // The files of items that did not change are not listed again.
+    QHash<QString, Entry>::const_iterator previous = this->Objects.constFind(itemEntry.Id);
+    bool indexed = previous != this->Objects.constEnd() &&
+      previous->EntryType == Entry::Item && !previous->Updated.isEmpty();
+    if (indexed && previous->Updated == itemEntry.Updated && previous->Size == itemEntry.Size)
+      {
+      ++this->ItemsSkipped;
+      entries << itemEntry;
+      continue;
+      }
+
+    Task listFiles;
+    listFiles.TaskType = Task::ListFiles;
+    listFiles.Id = itemEntry.Id;
+    listFiles.Object = itemEntry;
+    this->Queue << listFiles;
+    // The update time and size are set once the files are indexed, so
+    // that the files are listed again if the listing fails.
+    itemEntry.Updated = indexed ? previous->Updated : QString();
+    itemEntry.Size = indexed ? previous->Size : itemEntry.Size;
+    entries << itemEntry;
+    }
+  this->replaceChildren(task.Id, Entry::Item, entries);
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::processFiles(const Task& task, const QList<QVariantMap>& files)
+{
+  Q_Q(qGirderMetadataStore);
+  QList<Entry> entries;
+  foreach(const QVariantMap& file, files)
+    {
+    Entry fileEntry = entry(Entry::File, file);
+    fileEntry.ParentId = task.Id;
+    entries << fileEntry;
+    }
+  this->replaceChildren(task.Id, Entry::File, entries);
+
+  QHash<QString, Entry>::iterator item = this->Objects.find(task.Id);
+  if (item != this->Objects.end() && item->EntryType == Entry::Item &&
+      (item->Updated != task.Object.Updated || item->Size != task.Object.Size))
+    {
+    item->Updated = task.Object.Updated;
+    item->Size = task.Object.Size;
+    emit q->changed(item->ParentId);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::finish()
+{
+  Q_Q(qGirderMetadataStore);
+  if (!this->Running)
+    {
+    return;
+    }
+  this->Running = false;
+  this->Elapsed = this->Clock.elapsed();
+  bool success = !this->Cancelled && this->Errors.isEmpty();
+  if (success)
+    {
+    // E.g. the content of a previous root folder.
+    this->removeUnreachable();
+    }
+  if (!this->FileName.isEmpty() && !q->save())
+    {
+    this->Errors << QString("Failed to save the index %1").arg(this->FileName);
+    success = false;
+    }
+  emit q->refreshed(success);
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStorePrivate::refreshTimeout()
+{
+  Q_Q(qGirderMetadataStore);
+  q->refresh();
+}
+
+// --------------------------------------------------------------------------
+// qGirderMetadataStore methods
+
+// --------------------------------------------------------------------------
+qGirderMetadataStore::qGirderMetadataStore(qGirderAPI* girderAPI,
+                                           const QString& fileName,
+                                           QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new qGirderMetadataStorePrivate(this))
+{
+  Q_D(qGirderMetadataStore);
+  d->GirderAPI = girderAPI;
+  d->FileName = fileName;
+  QObject::connect(girderAPI, SIGNAL(finished(QUuid)),
+                   d, SLOT(queryFinished(QUuid)));
+  QObject::connect(&d->RefreshTimer, SIGNAL(timeout()),
+                   d, SLOT(refreshTimeout()));
+  if (!fileName.isEmpty())
+    {
+    this->load();
+    }
+}
+
+// --------------------------------------------------------------------------
+qGirderMetadataStore::~qGirderMetadataStore()
+{
+}
+
+// --------------------------------------------------------------------------
+QString qGirderMetadataStore::fileName()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->FileName;
+}
+
+// --------------------------------------------------------------------------
+int qGirderMetadataStore::maximumConcurrentQueries()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->MaximumConcurrentQueries;
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStore::setMaximumConcurrentQueries(int count)
+{
+  Q_D(qGirderMetadataStore);
+  d->MaximumConcurrentQueries = qMax(1, count);
+}
+
+// --------------------------------------------------------------------------
+int qGirderMetadataStore::refreshInterval()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->RefreshTimer.isActive() ? d->RefreshTimer.interval() : 0;
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStore::setRefreshInterval(int msecs)
+{
+  Q_D(qGirderMetadataStore);
+  if (msecs <= 0)
+    {
+    d->RefreshTimer.stop();
+    return;
+    }
+  d->RefreshTimer.start(msecs);
+}
+
+// --------------------------------------------------------------------------
+QStringList qGirderMetadataStore::rootFolderIds()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->RootFolderIds;
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStore::setRootFolderIds(const QStringList& folderIds)
+{
+  Q_D(qGirderMetadataStore);
+  if (folderIds == d->RootFolderIds)
+    {
+    return;
+    }
+  d->RootFolderIds = folderIds;
+  if (!d->Running && !d->FileName.isEmpty())
+    {
+    // The index of the previous root folders is not used.
+    this->clear();
+    this->load();
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStore::refresh()
+{
+  Q_D(qGirderMetadataStore);
+  if (d->Running || !d->GirderAPI)
+    {
+    return false;
+    }
+  d->Queue.clear();
+  d->QueryCount = 0;
+  d->FolderCount = 0;
+  d->ItemCount = 0;
+  d->ItemsSkipped = 0;
+  d->Added = 0;
+  d->Removed = 0;
+  d->Elapsed = 0;
+  d->Errors.clear();
+  d->Cancelled = false;
+  d->Running = true;
+  d->Clock.start();
+
+  if (d->RootFolderIds.isEmpty())
+    {
+    d->Queue << qGirderMetadataStorePrivate::Task();
+    }
+  foreach(const QString& folderId, d->RootFolderIds)
+    {
+    qGirderMetadataStorePrivate::Task listFolders;
+    listFolders.TaskType = qGirderMetadataStorePrivate::Task::ListFolders;
+    listFolders.Id = folderId;
+    d->Queue << listFolders;
+    qGirderMetadataStorePrivate::Task listItems = listFolders;
+    listItems.TaskType = qGirderMetadataStorePrivate::Task::ListItems;
+    d->Queue << listItems;
+    }
+  d->sendQueries();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStore::cancel()
+{
+  Q_D(qGirderMetadataStore);
+  if (!d->Running)
+    {
+    return;
+    }
+  d->Cancelled = true;
+  d->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStore::isRefreshing()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->Running;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStore::wait()
+{
+  Q_D(qGirderMetadataStore);
+  if (d->Running)
+    {
+    QEventLoop eventLoop;
+    QObject::connect(this, SIGNAL(refreshed(bool)),
+                     &eventLoop, SLOT(quit()));
+    eventLoop.exec();
+    }
+  return !d->Cancelled && d->Errors.isEmpty();
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderMetadataStore::object(const QString& id)const
+{
+  Q_D(const qGirderMetadataStore);
+  QHash<QString, qGirderMetadataStorePrivate::Entry>::const_iterator object =
+    d->Objects.constFind(id);
+  if (object == d->Objects.constEnd())
+    {
+    return QVariantMap();
+    }
+  return qGirderMetadataStorePrivate::toMap(*object);
+}
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStore::contains(const QString& id)const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->Objects.contains(id);
+}
+
+// --------------------------------------------------------------------------
+QString qGirderMetadataStore::path(const QString& id)const
+{
+  Q_D(const qGirderMetadataStore);
+  QStringList names;
+  QHash<QString, qGirderMetadataStorePrivate::Entry>::const_iterator object =
+    d->Objects.constFind(id);
+  while (object != d->Objects.constEnd())
+    {
+    names.prepend(object->Name);
+    if (object->EntryType == qGirderMetadataStorePrivate::Entry::Collection)
+      {
+      break;
+      }
+    object = d->Objects.constFind(object->ParentId);
+    }
+  return names.join("/");
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qGirderMetadataStore::collections()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->children(QString(), qGirderMetadataStorePrivate::Entry::Collection);
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qGirderMetadataStore::folders(const QString& parentId)const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->children(parentId, qGirderMetadataStorePrivate::Entry::Folder);
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qGirderMetadataStore::items(const QString& folderId)const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->children(folderId, qGirderMetadataStorePrivate::Entry::Item);
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qGirderMetadataStore::files(const QString& itemId)const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->children(itemId, qGirderMetadataStorePrivate::Entry::File);
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderMetadataStore::child(const QString& parentId, const QString& name)const
+{
+  Q_D(const qGirderMetadataStore);
+  foreach(const QString& id, d->Children.value(parentId))
+    {
+    QHash<QString, qGirderMetadataStorePrivate::Entry>::const_iterator object =
+      d->Objects.constFind(id);
+    if (object != d->Objects.constEnd() && object->Name == name &&
+        parentKey(*object) == parentId)
+      {
+      return qGirderMetadataStorePrivate::toMap(*object);
+      }
+    }
+  return QVariantMap();
+}
+
+// --------------------------------------------------------------------------
+int qGirderMetadataStore::count()const
+{
+  Q_D(const qGirderMetadataStore);
+  return d->Objects.size();
+}
+
+// --------------------------------------------------------------------------
+void qGirderMetadataStore::clear()
+{
+  Q_D(qGirderMetadataStore);
+  d->Objects.clear();
+  d->Children.clear();
+}
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStore::load()
+{
+  Q_D(qGirderMetadataStore);
+  QFile file(d->FileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_6);
+  quint32 magic = 0;
+  qint32 version = 0;
+  stream >> magic >> version;
+  if (magic != indexMagic || version != indexVersion)
+    {
+    return false;
+    }
+  QString serverUrl;
+  QStringList rootFolderIds;
+  qint32 count = 0;
+  stream >> serverUrl >> rootFolderIds >> count;
+  if (stream.status() != QDataStream::Ok || count < 0)
+    {
+    return false;
+    }
+  // The index of another server or of other root folders is not used.
+  if (serverUrl != (d->GirderAPI ? d->GirderAPI->serverUrl() : QString()) ||
+      rootFolderIds != d->RootFolderIds)
+    {
+    return false;
+    }
+  // The count is not trusted to reserve memory, the file may be truncated.
+  QHash<QString, qGirderMetadataStorePrivate::Entry> objects;
+  QHash<QString, QStringList> children;
+  for (qint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index)
+    {
+    qGirderMetadataStorePrivate::Entry entry;
+    qGirderMetadataStorePrivate::readEntry(stream, entry);
+    if (entry.EntryType > qGirderMetadataStorePrivate::Entry::File ||
+        entry.ParentType > qGirderMetadataStorePrivate::Entry::Folder)
+      {
+      return false;
+      }
+    // Entries are saved in the order of their parent listing.
+    children[parentKey(entry)] << entry.Id;
+    objects.insert(entry.Id, entry);
+    }
+  if (stream.status() != QDataStream::Ok)
+    {
+    return false;
+    }
+  d->Objects = objects;
+  d->Children = children;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderMetadataStore::save()const
+{
+  Q_D(const qGirderMetadataStore);
+  if (d->FileName.isEmpty())
+    {
+    return false;
+    }
+  QList<const qGirderMetadataStorePrivate::Entry*> entries;
+  for (QHash<QString, QStringList>::const_iterator children = d->Children.constBegin();
+       children != d->Children.constEnd(); ++children)
+    {
+    foreach(const QString& id, children.value())
+      {
+      QHash<QString, qGirderMetadataStorePrivate::Entry>::const_iterator object =
+        d->Objects.constFind(id);
+      if (object != d->Objects.constEnd() && parentKey(*object) == children.key())
+        {
+        entries << &object.value();
+        }
+      }
+    }
+
+  QString temporaryFileName = d->FileName + ".part";
+  QFile file(temporaryFileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_6);
+  stream << indexMagic << indexVersion
+         << (d->GirderAPI ? d->GirderAPI->serverUrl() : QString()) << d->RootFolderIds
+         << static_cast<qint32>(entries.size());
+  foreach(const qGirderMetadataStorePrivate::Entry* entry, entries)
+    {
+    qGirderMetadataStorePrivate::writeEntry(stream, *entry);
+    }
+  file.close();
+  if (stream.status() != QDataStream::Ok)
+    {
+    QFile::remove(temporaryFileName);
+    return false;
+    }
+  // The previous index is replaced at once, it is never missing.
+  if (!qRestFileSink::renameOverwrite(temporaryFileName, d->FileName))
+    {
+    QFile::remove(temporaryFileName);
+    return false;
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderMetadataStore::summary()const
+{
+  Q_D(const qGirderMetadataStore);
+  QVariantMap summary;
+  summary["queries"] = d->QueryCount;
+  summary["folders"] = d->FolderCount;
+  summary["items"] = d->ItemCount;
+  summary["itemsSkipped"] = d->ItemsSkipped;
+  summary["added"] = d->Added;
+  summary["removed"] = d->Removed;
+  summary["elapsed"] = d->Running ? d->Clock.elapsed() : d->Elapsed;
+  summary["errors"] = d->Errors;
+  return summary;
+}
@@ -0,0 +1,155 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderMetadataStore_h
+#define __qGirderMetadataStore_h
+
+// Qt includes
+#include <QList>
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "qRestAPI_Export.h"
+
+class qGirderAPI;
+class qGirderMetadataStorePrivate;
+
+/// qGirderMetadataStore is a local index of the collections, folders, items
+/// and files of a Girder server.
+///
+/// Listing and lookup queries are answered from memory, without sending
+/// queries to the server. The index is kept up to date by refresh(),
+/// periodically if refreshInterval() is set, and saved in a compact binary
+/// file so that the next session starts from the previous index.
+///
+/// A refresh lists the sub-folders and items of each folder. The files of
+/// an item are only listed again if its update time or size changed, which
+/// is where most of the queries of a full walk are. The children of a
+/// folder are replaced as soon as their listing is received: lookups see
+/// either the previous or the new content of a folder, and objects that
+/// were removed from the server are removed with their descendants.
+/// changed() is emitted for each folder whose content changed.
+///
+/// Objects are returned as maps with the keys "_id", "_modelType", "name",
+/// "updated" ("created" for files) and "size", the parent keys of Girder
+/// ("parentId" and "parentCollection" for folders, "folderId" for items,
+/// "itemId" for files), and "sha512" and "mimeType" for files.
+///
+/// Usage:
+/// <code>
+/// qGirderMetadataStore store(&girderAPI, cacheDirectory + "/girder.index");
+/// store.setRefreshInterval(5 * 60 * 1000);
+/// store.refresh();
+/// QList<QVariantMap> items = store.items(folderId);
+/// </code>
+class qRestAPI_EXPORT qGirderMetadataStore : public QObject
+{
+  Q_OBJECT
+
+  /// Maximum number of queries sent at the same time. Default is 4.
+  Q_PROPERTY(int maximumConcurrentQueries READ maximumConcurrentQueries WRITE setMaximumConcurrentQueries)
+
+  /// Interval in milliseconds between automatic refreshes. 0 (default)
+  /// disables them.
+  Q_PROPERTY(int refreshInterval READ refreshInterval WRITE setRefreshInterval)
+
+  typedef QObject Superclass;
+
+public:
+  /// The index is loaded from \a fileName if it exists, and saved to it
+  /// after each refresh. No file is used if \a fileName is empty.
+  /// The server URL of \a girderAPI must be set before.
+  explicit qGirderMetadataStore(qGirderAPI* girderAPI,
+                                const QString& fileName = QString(),
+                                QObject* parent = 0);
+  virtual ~qGirderMetadataStore();
+
+  QString fileName()const;
+
+  int maximumConcurrentQueries()const;
+  void setMaximumConcurrentQueries(int count);
+
+  int refreshInterval()const;
+  void setRefreshInterval(int msecs);
+
+  /// Folders whose content is indexed. All the collections are indexed if
+  /// empty (default). The root folders themselves are not in the index,
+  /// their content is returned by folders() and items().
+  /// Changing them loads the index saved for the new root folders, if any.
+  QStringList rootFolderIds()const;
+  void setRootFolderIds(const QStringList& folderIds);
+
+  /// Starts refreshing the index. Returns false if a refresh is in
+  /// progress.
+  bool refresh();
+  /// Stops sending queries. The listings already received are kept.
+  void cancel();
+  bool isRefreshing()const;
+  /// Blocks until the refresh is finished. Returns true if it succeeded.
+  bool wait();
+
+  /// Returns the object \a id, or an empty map if it is not in the index.
+  QVariantMap object(const QString& id)const;
+  bool contains(const QString& id)const;
+  /// Returns the path of the object \a id from its collection or root
+  /// folder, e.g. "collection/folder/item/file".
+  QString path(const QString& id)const;
+
+  QList<QVariantMap> collections()const;
+  /// Returns the sub-folders of the collection or folder \a parentId.
+  QList<QVariantMap> folders(const QString& parentId)const;
+  QList<QVariantMap> items(const QString& folderId)const;
+  QList<QVariantMap> files(const QString& itemId)const;
+  /// Returns the child named \a name of the collection, folder or item
+  /// \a parentId, or an empty map.
+  QVariantMap child(const QString& parentId, const QString& name)const;
+
+  /// Number of objects in the index.
+  int count()const;
+  /// Removes all the objects from the index.
+  void clear();
+
+  /// Loads the index from fileName(), replacing the current one.
+  /// Returns false and keeps the current index if the file is missing or
+  /// corrupt, or was saved for another server URL or other root folders.
+  bool load();
+  /// Saves the index to fileName(), replacing the previous file at once.
+  /// Returns false if fileName() is empty.
+  bool save()const;
+
+  /// Counts of the current or last refresh: "queries", "folders", "items",
+  /// "itemsSkipped" (items whose files were not listed again), "added",
+  /// "removed", "elapsed" (milliseconds) and "errors" (list of strings).
+  QVariantMap summary()const;
+
+signals:
+  /// Emitted when children of the collection, folder or item \a parentId
+  /// were added, removed or modified. \a parentId is empty for the list of
+  /// collections.
+  void changed(const QString& parentId);
+  void refreshed(bool success);
+
+private:
+  QScopedPointer<qGirderMetadataStorePrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qGirderMetadataStore);
+  Q_DISABLE_COPY(qGirderMetadataStore);
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderMetadataStore_p_h
+#define __qGirderMetadataStore_p_h
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QUuid>
+#include <QVariantMap>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qGirderMetadataStore.h"
+
+class QDataStream;
+
+// --------------------------------------------------------------------------
+class qGirderMetadataStorePrivate : public QObject
+{
+  Q_OBJECT
+
+  Q_DECLARE_PUBLIC(qGirderMetadataStore);
+
+  qGirderMetadataStore* const q_ptr;
+
+public:
+  qGirderMetadataStorePrivate(qGirderMetadataStore* object);
+
+  /// Indexed object. Only the fields returned by the lookups are kept.
+  struct Entry
+  {
+    enum Type
+    {
+      Collection = 0,
+      Folder,
+      Item,
+      File
+    };
+    Entry() : EntryType(Folder), ParentType(Folder), Size(0) {}
+    bool operator==(const Entry& other) const;
+    bool operator!=(const Entry& other) const { return !(*this == other); }
+
+    quint8 EntryType;
+    /// Collection or Folder, for folders.
+    quint8 ParentType;
+    QString Id;
+    /// Empty for collections.
+    QString ParentId;
+    QString Name;
+    /// Update time of collections, folders and items, creation time of
+    /// files. The update time of an item is the one of its indexed files.
+    QString Updated;
+    qint64 Size;
+    QString Sha512;
+    QString MimeType;
+  };
+
+  struct Task
+  {
+    enum Type
+    {
+      ListCollections = 0,
+      ListFolders,
+      ListItems,
+      ListFiles
+    };
+    Task() : TaskType(ListCollections), ParentType(Entry::Folder) {}
+    Type TaskType;
+    /// Id of the parent collection, folder or item.
+    QString Id;
+    /// Collection or Folder, for ListFolders tasks.
+    quint8 ParentType;
+    /// Item of ListFiles tasks, as listed by the server.
+    Entry Object;
+  };
+
+  /// Sends queries until MaximumConcurrentQueries are in progress.
+  void sendQueries();
+  void sendQuery(const Task& task);
+  void finish();
+
+  void processCollections(const QList<QVariantMap>& collections);
+  void processFolders(const Task& task, const QList<QVariantMap>& folders);
+  void processItems(const Task& task, const QList<QVariantMap>& items);
+  void processFiles(const Task& task, const QList<QVariantMap>& files);
+
+  static Entry entry(Entry::Type type, const QVariantMap& object);
+  static QVariantMap toMap(const Entry& entry);
+  QList<QVariantMap> children(const QString& parentId, Entry::Type type) const;
+
+  /// Replaces the children of type \a type of \a parentId and emits
+  /// changed() if they differ.
+  void replaceChildren(const QString& parentId, Entry::Type type,
+                       const QList<Entry>& children);
+  /// Removes \a id and its descendants.
+  void removeObject(const QString& id);
+  /// Removes the objects that are not under the indexed collections or
+  /// root folders.
+  void removeUnreachable();
+
+  static void writeEntry(QDataStream& stream, const Entry& entry);
+  static void readEntry(QDataStream& stream, Entry& entry);
+
+public slots:
+  void queryFinished(const QUuid& queryId);
+  void refreshTimeout();
+
+public:
+  QPointer<qGirderAPI> GirderAPI;
+  QString FileName;
+  int MaximumConcurrentQueries;
+  QTimer RefreshTimer;
+  QStringList RootFolderIds;
+
+  /// Objects by id, and ids of the children by parent id (the empty id for
+  /// the collections), in the order of the server listings.
+  QHash<QString, Entry> Objects;
+  QHash<QString, QStringList> Children;
+
+  bool Running;
+  bool Cancelled;
+  QElapsedTimer Clock;
+  QList<Task> Queue;
+  QHash<QUuid, Task> PendingQueries;
+
+  int QueryCount;
+  int FolderCount;
+  int ItemCount;
+  int ItemsSkipped;
+  int Added;
+  int Removed;
+  qint64 Elapsed;
+  QStringList Errors;
+};
+
+#endif
@@ -0,0 +1,583 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+
+// qRestAPI includes
+#include "qGirderSynchronizer.h"
+#include "qGirderSynchronizer_p.h"
+#include "qRestResult.h"
+
+// "qGSM"
+static const quint32 manifestMagic = 0x7147534d;
+static const qint32 manifestVersion = 1;
+
+// --------------------------------------------------------------------------
+// qGirderSynchronizerPrivate methods
+
+// --------------------------------------------------------------------------
+qGirderSynchronizerPrivate::qGirderSynchronizerPrivate(qGirderSynchronizer* object)
+  : q_ptr(object)
+  , MaximumConcurrentQueries(4)
+  , Running(false)
+  , Cancelled(false)
+  , FolderCount(0)
+  , ItemCount(0)
+  , FilesDownloaded(0)
+  , FilesSkipped(0)
+  , FilesFailed(0)
+  , BytesDownloaded(0)
+  , BytesSkipped(0)
+  , Elapsed(0)
+{
+}
+
+// --------------------------------------------------------------------------
+QString qGirderSynchronizerPrivate::safeName(const QString& name)
+{
+  QString safe = name;
+  safe.replace('/', '_');
+  safe.replace('\\', '_');
+  if (safe.isEmpty() || safe == "." || safe == "..")
+    {
+    safe = "_";
+    }
+  return safe;
+}
+
+// --------------------------------------------------------------------------
+QString qGirderSynchronizerPrivate::joinPath(const QString& path, const QString& name)
+{
+  return path.isEmpty() ? name : path + '/' + name;
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderSynchronizerPrivate::fileEntry(const QVariantMap& file, const QString& path)
+{
+  QVariantMap entry;
+  entry["path"] = path;
+  entry["size"] = file.value("size").toLongLong();
+  entry["sha512"] = file.value("sha512").toString();
+  entry["created"] = file.value("created").toString();
+  return entry;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderSynchronizerPrivate::isFileUpToDate(const QVariantMap& file, const QString& path) const
+{
+  QVariantMap entry = this->PreviousFiles.value(file.value("_id").toString()).toMap();
+  QVariantMap current = fileEntry(file, path);
+  if (entry.isEmpty() ||
+      entry.value("path") != current.value("path") ||
+      entry.value("size") != current.value("size") ||
+      entry.value("sha512") != current.value("sha512") ||
+      entry.value("created") != current.value("created"))
+    {
+    return false;
+    }
+  QFileInfo fileInfo(QDir(this->Directory).filePath(path));
+  return fileInfo.isFile() && fileInfo.size() == current.value("size").toLongLong();
+}
+
+// --------------------------------------------------------------------------
+bool qGirderSynchronizerPrivate::loadManifest()
+{
+  this->PreviousFiles.clear();
+  this->PreviousItems.clear();
+  QFile file(this->ManifestFileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_6);
+  quint32 magic = 0;
+  qint32 version = 0;
+  stream >> magic >> version;
+  if (magic != manifestMagic || version != manifestVersion)
+    {
+    return false;
+    }
+  QVariantMap files;
+  QVariantMap items;
+  stream >> files >> items;
+  if (stream.status() != QDataStream::Ok)
+    {
+    return false;
+    }
+  this->PreviousFiles = files;
+  this->PreviousItems = items;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderSynchronizerPrivate::saveManifest() const
+{
+  QVariantMap files = this->Files;
+  QVariantMap items = this->Items;
+  if (this->Cancelled || !this->Errors.isEmpty())
+    {
+    // Entries of the folders that were not walked are still valid.
+    for (QVariantMap::const_iterator it = this->PreviousFiles.constBegin();
+         it != this->PreviousFiles.constEnd(); ++it)
+      {
+      if (!files.contains(it.key()))
+        {
+        files.insert(it.key(), it.value());
+        }
+      }
+    for (QVariantMap::const_iterator it = this->PreviousItems.constBegin();
+         it != this->PreviousItems.constEnd(); ++it)
+      {
+      if (!items.contains(it.key()) && !this->ItemEntries.contains(it.key()))
+        {
+        items.insert(it.key(), it.value());
+        }
+      }
+    }
+
+  QString temporaryFileName = this->ManifestFileName + ".part";
+  QFile file(temporaryFileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_6);
+  stream << manifestMagic << manifestVersion << files << items;
+  file.close();
+  if (stream.status() != QDataStream::Ok)
+    {
+    QFile::remove(temporaryFileName);
+    return false;
+    }
+  QFile::remove(this->ManifestFileName);
+  return QFile::rename(temporaryFileName, this->ManifestFileName);
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::sendQueries()
+{
+  while (!this->Cancelled && this->GirderAPI &&
+         this->PendingQueries.size() < this->MaximumConcurrentQueries &&
+         (!this->ListQueue.isEmpty() || !this->DownloadQueue.isEmpty()))
+    {
+    Task task = !this->ListQueue.isEmpty() ?
+      this->ListQueue.takeFirst() : this->DownloadQueue.takeFirst();
+    this->sendQuery(task);
+    }
+  if (this->PendingQueries.isEmpty() &&
+      (this->Cancelled || !this->GirderAPI ||
+       (this->ListQueue.isEmpty() && this->DownloadQueue.isEmpty())))
+    {
+    this->finish();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::sendQuery(const Task& task)
+{
+  qRestAPI::Parameters parameters;
+  parameters["limit"] = "0";
+  QUuid queryId;
+  switch (task.TaskType)
+    {
+    case Task::ListFolders:
+      parameters["parentType"] = "folder";
+      parameters["parentId"] = task.Id;
+      queryId = this->GirderAPI->get("/folder", parameters);
+      break;
+    case Task::ListItems:
+      parameters["folderId"] = task.Id;
+      queryId = this->GirderAPI->get("/item", parameters);
+      break;
+    case Task::ListFiles:
+      queryId = this->GirderAPI->get("/item/" + task.Id + "/files", parameters);
+      break;
+    case Task::Download:
+      {
+      QString fileName = QDir(this->Directory).filePath(task.Path);
+      QDir().mkpath(QFileInfo(fileName).absolutePath());
+      QByteArray sha512 = task.Object.value("sha512").toString().toLatin1();
+      if (sha512.isEmpty())
+        {
+        queryId = this->GirderAPI->download(fileName, "/file/" + task.Id + "/download");
+        }
+      else
+        {
+        queryId = this->GirderAPI->download(fileName, "/file/" + task.Id + "/download",
+                                            qRestAPI::Parameters(), qRestAPI::RawHeaders(),
+                                            sha512, QCryptographicHash::Sha512);
+        }
+      break;
+      }
+    }
+  if (queryId.isNull())
+    {
+    this->Errors << QString("Failed to send the query for %1").arg(task.Path);
+    if (task.TaskType == Task::Download)
+      {
+      this->processDownload(task, false);
+      }
+    return;
+    }
+  this->PendingQueries.insert(queryId, task);
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::queryFinished(const QUuid& queryId)
+{
+  if (!this->PendingQueries.contains(queryId) || !this->GirderAPI)
+    {
+    return;
+    }
+  Task task = this->PendingQueries.take(queryId);
+  QScopedPointer<qRestResult> result(this->GirderAPI->takeResult(queryId));
+  if (!result)
+    {
+    this->Errors << QString("%1: %2").arg(task.Path).arg(this->GirderAPI->errorString());
+    }
+  switch (task.TaskType)
+    {
+    case Task::ListFolders:
+      if (result)
+        {
+        this->processFolders(task, result->results());
+        }
+      break;
+    case Task::ListItems:
+      if (result)
+        {
+        this->processItems(task, result->results());
+        }
+      break;
+    case Task::ListFiles:
+      if (result)
+        {
+        this->processFiles(task, result->results());
+        }
+      break;
+    case Task::Download:
+      this->processDownload(task, !result.isNull());
+      break;
+    }
+  this->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::processFolders(const Task& task, const QList<QVariantMap>& folders)
+{
+  foreach(const QVariantMap& folder, folders)
+    {
+    ++this->FolderCount;
+    QString folderPath = joinPath(task.Path, safeName(folder.value("name").toString()));
+    Task listFolders;
+    listFolders.TaskType = Task::ListFolders;
+    listFolders.Id = folder.value("_id").toString();
+    listFolders.Path = folderPath;
+    this->ListQueue << listFolders;
+    Task listItems = listFolders;
+    listItems.TaskType = Task::ListItems;
+    this->ListQueue << listItems;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::processItems(const Task& task, const QList<QVariantMap>& items)
+{
+  foreach(const QVariantMap& item, items)
+    {
+    ++this->ItemCount;
+    QString itemId = item.value("_id").toString();
+
+    // Items that did not change since the previous run are not listed.
+    QVariantMap previousItem = this->PreviousItems.value(itemId).toMap();
+    bool upToDate = !previousItem.isEmpty() &&
+        previousItem.value("updated") == item.value("updated") &&
+        previousItem.value("size").toLongLong() == item.value("size").toLongLong();
+    QStringList fileIds = previousItem.value("files").toStringList();
+    foreach(const QString& fileId, fileIds)
+      {
+      QVariantMap entry = this->PreviousFiles.value(fileId).toMap();
+      QFileInfo fileInfo(QDir(this->Directory).filePath(entry.value("path").toString()));
+      upToDate = upToDate && !entry.isEmpty() && fileInfo.isFile() &&
+          fileInfo.size() == entry.value("size").toLongLong();
+      }
+    if (upToDate)
+      {
+      foreach(const QString& fileId, fileIds)
+        {
+        QVariantMap entry = this->PreviousFiles.value(fileId).toMap();
+        this->Files.insert(fileId, entry);
+        ++this->FilesSkipped;
+        this->BytesSkipped += entry.value("size").toLongLong();
+        }
+      this->Items.insert(itemId, previousItem);
+      continue;
+      }
+
+    Task listFiles;
+    listFiles.TaskType = Task::ListFiles;
+    listFiles.Id = itemId;
+    listFiles.Path = task.Path;
+    listFiles.Object = item;
+    this->ListQueue << listFiles;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::processFiles(const Task& task, const QList<QVariantMap>& files)
+{
+  QString itemId = task.Id;
+  QString itemPath = files.size() == 1 ? task.Path :
+    joinPath(task.Path, safeName(task.Object.value("name").toString()));
+
+  QStringList fileIds;
+  foreach(const QVariantMap& file, files)
+    {
+    fileIds << file.value("_id").toString();
+    }
+  QVariantMap itemEntry;
+  itemEntry["updated"] = task.Object.value("updated");
+  itemEntry["size"] = task.Object.value("size").toLongLong();
+  itemEntry["files"] = fileIds;
+  this->ItemEntries.insert(itemId, itemEntry);
+  this->ItemPendingFiles.insert(itemId, files.size());
+  this->ItemFailed.insert(itemId, false);
+  if (files.isEmpty())
+    {
+    this->Items.insert(itemId, itemEntry);
+    return;
+    }
+
+  foreach(const QVariantMap& file, files)
+    {
+    QString path = joinPath(itemPath, safeName(file.value("name").toString()));
+    if (this->isFileUpToDate(file, path))
+      {
+      ++this->FilesSkipped;
+      this->BytesSkipped += file.value("size").toLongLong();
+      this->Files.insert(file.value("_id").toString(), fileEntry(file, path));
+      this->fileDone(itemId, true);
+      continue;
+      }
+    Task download;
+    download.TaskType = Task::Download;
+    download.Id = file.value("_id").toString();
+    download.Path = path;
+    download.Object = file;
+    download.ItemId = itemId;
+    this->DownloadQueue << download;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::processDownload(const Task& task, bool success)
+{
+  Q_Q(qGirderSynchronizer);
+  if (success)
+    {
+    ++this->FilesDownloaded;
+    this->BytesDownloaded += task.Object.value("size").toLongLong();
+    this->Files.insert(task.Id, fileEntry(task.Object, task.Path));
+    emit q->fileDownloaded(task.Path);
+    }
+  else
+    {
+    ++this->FilesFailed;
+    }
+  this->fileDone(task.ItemId, success);
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::fileDone(const QString& itemId, bool success)
+{
+  if (!success)
+    {
+    this->ItemFailed[itemId] = true;
+    }
+  int pending = --this->ItemPendingFiles[itemId];
+  if (pending == 0 && !this->ItemFailed.value(itemId))
+    {
+    this->Items.insert(itemId, this->ItemEntries.value(itemId));
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizerPrivate::finish()
+{
+  Q_Q(qGirderSynchronizer);
+  if (!this->Running)
+    {
+    return;
+    }
+  this->Running = false;
+  this->Elapsed = this->Clock.elapsed();
+  if (!this->saveManifest())
+    {
+    this->Errors << QString("Failed to save the manifest %1").arg(this->ManifestFileName);
+    }
+  emit q->finished(!this->Cancelled && this->Errors.isEmpty());
+}
+
+// --------------------------------------------------------------------------
+// qGirderSynchronizer methods
+
+// --------------------------------------------------------------------------
+qGirderSynchronizer::qGirderSynchronizer(qGirderAPI* girderAPI, QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new qGirderSynchronizerPrivate(this))
+{
+  Q_D(qGirderSynchronizer);
+  d->GirderAPI = girderAPI;
+  QObject::connect(girderAPI, SIGNAL(finished(QUuid)),
+                   d, SLOT(queryFinished(QUuid)));
+}
+
+// --------------------------------------------------------------------------
+qGirderSynchronizer::~qGirderSynchronizer()
+{
+}
+
+// --------------------------------------------------------------------------
+int qGirderSynchronizer::maximumConcurrentQueries()const
+{
+  Q_D(const qGirderSynchronizer);
+  return d->MaximumConcurrentQueries;
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizer::setMaximumConcurrentQueries(int count)
+{
+  Q_D(qGirderSynchronizer);
+  d->MaximumConcurrentQueries = qMax(1, count);
+}
+
+// --------------------------------------------------------------------------
+QString qGirderSynchronizer::manifestFileName()const
+{
+  Q_D(const qGirderSynchronizer);
+  return d->ManifestFileName;
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizer::setManifestFileName(const QString& fileName)
+{
+  Q_D(qGirderSynchronizer);
+  d->ManifestFileName = fileName;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderSynchronizer::start(const QString& folderId, const QString& directory)
+{
+  Q_D(qGirderSynchronizer);
+  if (d->Running || !d->GirderAPI || !QDir().mkpath(directory))
+    {
+    return false;
+    }
+  d->Directory = directory;
+  if (d->ManifestFileName.isEmpty())
+    {
+    d->ManifestFileName = QDir(directory).filePath(".girder-sync");
+    }
+  d->loadManifest();
+  d->Files.clear();
+  d->Items.clear();
+  d->ItemPendingFiles.clear();
+  d->ItemFailed.clear();
+  d->ItemEntries.clear();
+  d->ListQueue.clear();
+  d->DownloadQueue.clear();
+  d->FolderCount = 0;
+  d->ItemCount = 0;
+  d->FilesDownloaded = 0;
+  d->FilesSkipped = 0;
+  d->FilesFailed = 0;
+  d->BytesDownloaded = 0;
+  d->BytesSkipped = 0;
+  d->Elapsed = 0;
+  d->Errors.clear();
+  d->Cancelled = false;
+  d->Running = true;
+  d->Clock.start();
+
+  qGirderSynchronizerPrivate::Task listFolders;
+  listFolders.TaskType = qGirderSynchronizerPrivate::Task::ListFolders;
+  listFolders.Id = folderId;
+  d->ListQueue << listFolders;
+  qGirderSynchronizerPrivate::Task listItems = listFolders;
+  listItems.TaskType = qGirderSynchronizerPrivate::Task::ListItems;
+  d->ListQueue << listItems;
+  d->sendQueries();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qGirderSynchronizer::cancel()
+{
+  Q_D(qGirderSynchronizer);
+  if (!d->Running)
+    {
+    return;
+    }
+  d->Cancelled = true;
+  d->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+bool qGirderSynchronizer::isRunning()const
+{
+  Q_D(const qGirderSynchronizer);
+  return d->Running;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderSynchronizer::wait()
+{
+  Q_D(qGirderSynchronizer);
+  if (d->Running)
+    {
+    QEventLoop eventLoop;
+    QObject::connect(this, SIGNAL(finished(bool)),
+                     &eventLoop, SLOT(quit()));
+    eventLoop.exec();
+    }
+  return !d->Cancelled && d->Errors.isEmpty();
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderSynchronizer::summary()const
+{
+  Q_D(const qGirderSynchronizer);
+  QVariantMap summary;
+  summary["folders"] = d->FolderCount;
+  summary["items"] = d->ItemCount;
+  summary["filesDownloaded"] = d->FilesDownloaded;
+  summary["filesSkipped"] = d->FilesSkipped;
+  summary["filesFailed"] = d->FilesFailed;
+  summary["bytesDownloaded"] = d->BytesDownloaded;
+  summary["bytesSkipped"] = d->BytesSkipped;
+  summary["elapsed"] = d->Running ? d->Clock.elapsed() : d->Elapsed;
+  summary["errors"] = d->Errors;
+  return summary;
+}
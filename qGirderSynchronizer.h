@@ -0,0 +1,105 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderSynchronizer_h
+#define __qGirderSynchronizer_h
+
+// Qt includes
+#include <QObject>
+#include <QScopedPointer>
+#include <QVariantMap>
+
+#include "qRestAPI_Export.h"
+
+class qGirderAPI;
+class qGirderSynchronizerPrivate;
+
+/// qGirderSynchronizer mirrors a Girder folder hierarchy into a local
+/// directory.
+///
+/// Sub-folders, items and files are listed concurrently. A manifest stored
+/// in the local directory keeps the id, size, update time and sha512 of the
+/// files synchronized by the previous runs: items whose update time and size
+/// did not change are not listed again, and files are only downloaded if
+/// they are new, changed, or missing locally.
+///
+/// A folder is stored as a directory. An item with a single file is stored
+/// as that file, an item with several files as a directory named after the
+/// item.
+///
+/// Usage:
+/// <code>
+/// qGirderSynchronizer synchronizer(&girderAPI);
+/// synchronizer.setMaximumConcurrentQueries(8);
+/// synchronizer.start(folderId, "/data/mirror");
+/// synchronizer.wait();
+/// qDebug() << synchronizer.summary();
+/// </code>
+class qRestAPI_EXPORT qGirderSynchronizer : public QObject
+{
+  Q_OBJECT
+
+  /// Maximum number of queries sent at the same time. Default is 4.
+  Q_PROPERTY(int maximumConcurrentQueries READ maximumConcurrentQueries WRITE setMaximumConcurrentQueries)
+
+  typedef QObject Superclass;
+
+public:
+  explicit qGirderSynchronizer(qGirderAPI* girderAPI, QObject* parent = 0);
+  virtual ~qGirderSynchronizer();
+
+  int maximumConcurrentQueries()const;
+  void setMaximumConcurrentQueries(int count);
+
+  /// Location of the manifest. Defaults to ".girder-sync" in the local
+  /// directory.
+  QString manifestFileName()const;
+  void setManifestFileName(const QString& fileName);
+
+  /// Starts synchronizing the content of the folder \a folderId into
+  /// \a directory. Returns false if a synchronization is in progress or if
+  /// the directory can not be created.
+  bool start(const QString& folderId, const QString& directory);
+  /// Stops sending queries. The queries in progress are completed and the
+  /// manifest is saved before finished() is emitted.
+  void cancel();
+  bool isRunning()const;
+
+  /// Blocks until the synchronization is finished. Returns true if all the
+  /// files were synchronized.
+  bool wait();
+
+  /// Counts of the current or last synchronization: "folders", "items",
+  /// "filesDownloaded", "filesSkipped", "filesFailed", "bytesDownloaded",
+  /// "bytesSkipped", "elapsed" (milliseconds) and "errors" (list of
+  /// strings).
+  QVariantMap summary()const;
+
+signals:
+  /// Emitted when a file is downloaded. \a fileName is relative to the
+  /// local directory.
+  void fileDownloaded(const QString& fileName);
+  void finished(bool success);
+
+private:
+  QScopedPointer<qGirderSynchronizerPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qGirderSynchronizer);
+  Q_DISABLE_COPY(qGirderSynchronizer);
+};
+
+#endif
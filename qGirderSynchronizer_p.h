@@ -0,0 +1,133 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderSynchronizer_p_h
+#define __qGirderSynchronizer_p_h
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QUuid>
+#include <QVariantMap>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qGirderSynchronizer.h"
+
+// --------------------------------------------------------------------------
+class qGirderSynchronizerPrivate : public QObject
+{
+  Q_OBJECT
+
+  Q_DECLARE_PUBLIC(qGirderSynchronizer);
+
+  qGirderSynchronizer* const q_ptr;
+
+public:
+  qGirderSynchronizerPrivate(qGirderSynchronizer* object);
+
+  struct Task
+  {
+    enum Type
+    {
+      ListFolders = 0,
+      ListItems,
+      ListFiles,
+      Download
+    };
+    Task() : TaskType(ListFolders) {}
+    Type TaskType;
+    /// Id of the folder, item or file.
+    QString Id;
+    /// Local path of the folder or of the file, relative to Directory.
+    QString Path;
+    /// Item of ListFiles tasks, file of Download tasks.
+    QVariantMap Object;
+    QString ItemId;
+  };
+
+  /// Sends queries until MaximumConcurrentQueries are in progress.
+  void sendQueries();
+  void sendQuery(const Task& task);
+  void finish();
+
+  void processFolders(const Task& task, const QList<QVariantMap>& folders);
+  void processItems(const Task& task, const QList<QVariantMap>& items);
+  void processFiles(const Task& task, const QList<QVariantMap>& files);
+  void processDownload(const Task& task, bool success);
+  /// Marks a file of an item as synchronized, or not, and records the
+  /// item in the manifest once all its files are synchronized.
+  void fileDone(const QString& itemId, bool success);
+
+  /// Returns true if the file described by \a file and stored in \a path
+  /// matches its entry in the previous manifest and exists locally.
+  bool isFileUpToDate(const QVariantMap& file, const QString& path) const;
+  static QString safeName(const QString& name);
+  /// Appends \a name to the relative \a path.
+  static QString joinPath(const QString& path, const QString& name);
+  static QVariantMap fileEntry(const QVariantMap& file, const QString& path);
+
+  bool loadManifest();
+  bool saveManifest() const;
+
+public slots:
+  void queryFinished(const QUuid& queryId);
+
+public:
+  QPointer<qGirderAPI> GirderAPI;
+  int MaximumConcurrentQueries;
+  QString ManifestFileName;
+
+  QString Directory;
+  bool Running;
+  bool Cancelled;
+  QElapsedTimer Clock;
+
+  /// Listings are sent before downloads so that the hierarchy is walked
+  /// while files are downloaded.
+  QList<Task> ListQueue;
+  QList<Task> DownloadQueue;
+  QHash<QUuid, Task> PendingQueries;
+
+  /// Manifest of the previous run, and of the current one. Files are keyed
+  /// by file id, items by item id.
+  QVariantMap PreviousFiles;
+  QVariantMap PreviousItems;
+  QVariantMap Files;
+  QVariantMap Items;
+  /// Items whose files are being synchronized: number of files left and
+  /// whether one failed.
+  QHash<QString, int> ItemPendingFiles;
+  QHash<QString, bool> ItemFailed;
+  QHash<QString, QVariantMap> ItemEntries;
+
+  int FolderCount;
+  int ItemCount;
+  int FilesDownloaded;
+  int FilesSkipped;
+  int FilesFailed;
+  qint64 BytesDownloaded;
+  qint64 BytesSkipped;
+  qint64 Elapsed;
+  QStringList Errors;
+};
+
+#endif
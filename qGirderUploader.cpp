@@ -0,0 +1,713 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QEventLoop>
+#include <QFileInfo>
+
+// qRestAPI includes
+#include "qGirderUploader.h"
+#include "qGirderUploader_p.h"
+#include "qRestResult.h"
+
+// "qGUJ"
+static const quint32 journalMagic = 0x7147554a;
+static const qint32 journalVersion = 2;
+
+// --------------------------------------------------------------------------
+// qGirderUploaderPrivate methods
+
+// --------------------------------------------------------------------------
+qGirderUploaderPrivate::qGirderUploaderPrivate(qGirderUploader* object)
+  : q_ptr(object)
+  , MaximumConcurrentUploads(4)
+  , ChunkSize(16 * 1024 * 1024)
+  , Running(false)
+  , Cancelled(false)
+  , FolderCount(0)
+  , FileCount(0)
+  , FilesUploaded(0)
+  , FilesResumed(0)
+  , FilesSkipped(0)
+  , FilesFailed(0)
+  , BytesUploaded(0)
+  , BytesSkipped(0)
+  , BytesTotal(0)
+  , Elapsed(0)
+{
+}
+
+// --------------------------------------------------------------------------
+QString qGirderUploaderPrivate::parentPath(const QString& path)
+{
+  int separator = path.lastIndexOf('/');
+  return separator < 0 ? QString() : path.left(separator);
+}
+
+// --------------------------------------------------------------------------
+QString qGirderUploaderPrivate::fileName(const QString& path)
+{
+  return path.mid(path.lastIndexOf('/') + 1);
+}
+
+// --------------------------------------------------------------------------
+bool qGirderUploaderPrivate::openJournal()
+{
+  this->JournalFolders.clear();
+  this->JournalUploads.clear();
+  this->JournalFiles.clear();
+
+  QScopedPointer<QFile> journal(new QFile(this->JournalFileName));
+  bool valid = false;
+  if (journal->open(QIODevice::ReadOnly))
+    {
+    QDataStream stream(journal.data());
+    stream.setVersion(QDataStream::Qt_4_6);
+    quint32 magic = 0;
+    qint32 version = 0;
+    QString serverUrl;
+    QString folderId;
+    stream >> magic >> version;
+    if (magic == journalMagic && version == journalVersion)
+      {
+      stream >> serverUrl >> folderId;
+      }
+    // The folder ids of a journal are only valid for its destination.
+    valid = stream.status() == QDataStream::Ok &&
+        magic == journalMagic && version == journalVersion &&
+        serverUrl == this->GirderAPI->serverUrl() && folderId == this->FolderId;
+    while (valid && !stream.atEnd())
+      {
+      qint32 type = 0;
+      QString path;
+      QVariantMap values;
+      stream >> type >> path >> values;
+      if (stream.status() != QDataStream::Ok)
+        {
+        // The last record may be incomplete if the application stopped
+        // while writing it.
+        break;
+        }
+      switch (type)
+        {
+        case FolderRecord:
+          this->JournalFolders.insert(path, values.value("id").toString());
+          break;
+        case UploadRecord:
+          this->JournalUploads.insert(path, values);
+          break;
+        case FileRecord:
+          this->JournalUploads.remove(path);
+          this->JournalFiles.insert(path, values);
+          break;
+        default:
+          break;
+        }
+      }
+    journal->close();
+    }
+
+  // Records are appended to a valid journal, a new one is started otherwise.
+  QIODevice::OpenMode mode = valid ? QIODevice::Append : QIODevice::WriteOnly | QIODevice::Truncate;
+  if (!journal->open(mode))
+    {
+    return false;
+    }
+  this->JournalStream.setDevice(journal.data());
+  this->JournalStream.setVersion(QDataStream::Qt_4_6);
+  if (!valid)
+    {
+    this->JournalStream << journalMagic << journalVersion
+                        << this->GirderAPI->serverUrl() << this->FolderId;
+    }
+  this->Journal.reset(journal.take());
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::writeJournal(RecordType type, const QString& path,
+                                          const QVariantMap& values)
+{
+  if (!this->Journal)
+    {
+    return;
+    }
+  this->JournalStream << static_cast<qint32>(type) << path << values;
+  this->Journal->flush();
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::scan()
+{
+  QDir directory(this->Directory);
+  QString journalPath = QFileInfo(this->JournalFileName).absoluteFilePath();
+  QStringList directories;
+  QDirIterator it(this->Directory, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext())
+    {
+    it.next();
+    QFileInfo fileInfo = it.fileInfo();
+    QString path = directory.relativeFilePath(fileInfo.absoluteFilePath());
+    if (fileInfo.isDir())
+      {
+      directories << path;
+      continue;
+      }
+    if (!fileInfo.isFile() || fileInfo.absoluteFilePath() == journalPath)
+      {
+      continue;
+      }
+    ++this->FileCount;
+    Upload file;
+    file.Path = path;
+    file.DirectoryPath = parentPath(path);
+    file.Size = fileInfo.size();
+    file.Modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    QVariantMap done = this->JournalFiles.value(path);
+    if (!done.isEmpty() &&
+        done.value("size").toLongLong() == file.Size &&
+        done.value("modified").toLongLong() == file.Modified)
+      {
+      ++this->FilesSkipped;
+      this->BytesSkipped += file.Size;
+      continue;
+      }
+    this->BytesTotal += file.Size;
+    this->DirectoryFiles[file.DirectoryPath] << file;
+    }
+
+  // Parents are sorted before their children.
+  directories.sort();
+  foreach(const QString& path, directories)
+    {
+    ++this->FolderCount;
+    if (this->JournalFolders.contains(path))
+      {
+      this->FolderIds.insert(path, this->JournalFolders.value(path));
+      this->queueFiles(path);
+      }
+    else
+      {
+      this->PendingFolders << path;
+      }
+    }
+  this->queueFiles(QString());
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::queueFiles(const QString& directoryPath)
+{
+  this->FileQueue << this->DirectoryFiles.take(directoryPath);
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::queueNextStep(const Upload& file)
+{
+  Task task;
+  task.File = file;
+  if (file.ItemId.isEmpty())
+    {
+    task.TaskType = Task::CreateItem;
+    }
+  else if (file.UploadId.isEmpty() && !file.FilesListed)
+    {
+    task.TaskType = Task::ListFiles;
+    }
+  else if (file.UploadId.isEmpty())
+    {
+    task.TaskType = Task::InitUpload;
+    }
+  else if (file.Resumed && file.Offset == 0)
+    {
+    task.TaskType = Task::QueryOffset;
+    }
+  else
+    {
+    task.TaskType = Task::SendChunk;
+    }
+  this->StepQueue << task;
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::sendQueries()
+{
+  while (!this->Cancelled && this->GirderAPI &&
+         this->PendingQueries.size() < this->MaximumConcurrentUploads)
+    {
+    if (!this->StepQueue.isEmpty())
+      {
+      Task task = this->StepQueue.takeFirst();
+      this->sendQuery(task);
+      continue;
+      }
+    bool folderSent = false;
+    for (int index = 0; index < this->PendingFolders.size(); ++index)
+      {
+      QString path = this->PendingFolders.at(index);
+      if (this->FolderIds.contains(parentPath(path)))
+        {
+        this->PendingFolders.removeAt(index);
+        Task task;
+        task.TaskType = Task::CreateFolder;
+        task.Path = path;
+        this->sendQuery(task);
+        folderSent = true;
+        break;
+        }
+      }
+    if (folderSent)
+      {
+      continue;
+      }
+    if (this->FileQueue.isEmpty())
+      {
+      break;
+      }
+    Upload file = this->FileQueue.takeFirst();
+    // Uploads started by a previous run are resumed.
+    QVariantMap started = this->JournalUploads.value(file.Path);
+    if (!started.isEmpty() &&
+        started.value("size").toLongLong() == file.Size &&
+        started.value("modified").toLongLong() == file.Modified)
+      {
+      file.ItemId = started.value("itemId").toString();
+      file.UploadId = started.value("uploadId").toString();
+      file.Resumed = true;
+      }
+    this->queueNextStep(file);
+    }
+
+  if (this->PendingQueries.isEmpty() &&
+      (this->Cancelled || !this->GirderAPI ||
+       (this->StepQueue.isEmpty() && this->FileQueue.isEmpty() && this->PendingFolders.isEmpty())))
+    {
+    this->finish();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::sendQuery(Task& task)
+{
+  qRestAPI::Parameters parameters;
+  QUuid queryId;
+  const Upload& file = task.File;
+  switch (task.TaskType)
+    {
+    case Task::CreateFolder:
+      parameters["parentType"] = "folder";
+      parameters["parentId"] = this->FolderIds.value(parentPath(task.Path));
+      parameters["name"] = fileName(task.Path);
+      parameters["reuseExisting"] = "true";
+      queryId = this->GirderAPI->post("/folder", parameters);
+      break;
+    case Task::CreateItem:
+      parameters["folderId"] = this->FolderIds.value(file.DirectoryPath);
+      parameters["name"] = fileName(file.Path);
+      parameters["reuseExisting"] = "true";
+      queryId = this->GirderAPI->post("/item", parameters);
+      break;
+    case Task::ListFiles:
+      parameters["limit"] = "0";
+      queryId = this->GirderAPI->get(QString("/item/%1/files").arg(file.ItemId), parameters);
+      break;
+    case Task::InitUpload:
+      parameters["size"] = QString::number(file.Size);
+      if (!file.FileId.isEmpty())
+        {
+        queryId = this->GirderAPI->put(QString("/file/%1/contents").arg(file.FileId), parameters);
+        break;
+        }
+      parameters["parentType"] = "item";
+      parameters["parentId"] = file.ItemId;
+      parameters["name"] = fileName(file.Path);
+      queryId = this->GirderAPI->post("/file", parameters);
+      break;
+    case Task::QueryOffset:
+      parameters["uploadId"] = file.UploadId;
+      queryId = this->GirderAPI->get("/file/offset", parameters);
+      break;
+    case Task::SendChunk:
+      {
+      QFile input(QDir(this->Directory).filePath(file.Path));
+      if (!input.open(QIODevice::ReadOnly) || !input.seek(file.Offset))
+        {
+        this->fileFailed(file, input.errorString());
+        return;
+        }
+      task.Chunk = new QBuffer(this);
+      task.Chunk->setData(input.read(qMin(this->ChunkSize, file.Size - file.Offset)));
+      parameters["uploadId"] = file.UploadId;
+      parameters["offset"] = QString::number(file.Offset);
+      qRestAPI::RawHeaders rawHeaders;
+      rawHeaders["Content-Type"] = "application/octet-stream";
+      queryId = this->GirderAPI->post(task.Chunk, "/file/chunk", parameters, rawHeaders);
+      break;
+      }
+    }
+  if (queryId.isNull())
+    {
+    delete task.Chunk;
+    task.Chunk = 0;
+    QString error = "Failed to send the query";
+    if (task.TaskType == Task::CreateFolder)
+      {
+      this->folderFailed(task.Path, error);
+      }
+    else
+      {
+      this->fileFailed(file, error);
+      }
+    return;
+    }
+  this->PendingQueries.insert(queryId, task);
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::queryFinished(const QUuid& queryId)
+{
+  Q_Q(qGirderUploader);
+  if (!this->PendingQueries.contains(queryId) || !this->GirderAPI)
+    {
+    return;
+    }
+  Task task = this->PendingQueries.take(queryId);
+  QScopedPointer<qRestResult> result(this->GirderAPI->takeResult(queryId));
+  QString error = result ? QString() : this->GirderAPI->errorString();
+  QVariantMap response = result ? result->results().value(0) : QVariantMap();
+  qint64 chunkSize = task.Chunk ? task.Chunk->size() : 0;
+  delete task.Chunk;
+
+  Upload file = task.File;
+  switch (task.TaskType)
+    {
+    case Task::CreateFolder:
+      if (!result)
+        {
+        this->folderFailed(task.Path, error);
+        break;
+        }
+      this->FolderIds.insert(task.Path, response.value("_id").toString());
+      {
+      QVariantMap values;
+      values["id"] = response.value("_id");
+      this->writeJournal(FolderRecord, task.Path, values);
+      }
+      this->queueFiles(task.Path);
+      break;
+    case Task::CreateItem:
+      if (!result)
+        {
+        this->fileFailed(file, error);
+        break;
+        }
+      file.ItemId = response.value("_id").toString();
+      this->queueNextStep(file);
+      break;
+    case Task::ListFiles:
+      if (!result)
+        {
+        this->fileFailed(file, error);
+        break;
+        }
+      // A file of the same name in a reused item is replaced rather than
+      // added next to it.
+      foreach(const QVariantMap& itemFile, result->results())
+        {
+        if (itemFile.value("name").toString() == fileName(file.Path))
+          {
+          file.FileId = itemFile.value("_id").toString();
+          break;
+          }
+        }
+      file.FilesListed = true;
+      this->queueNextStep(file);
+      break;
+    case Task::InitUpload:
+      if (!result)
+        {
+        this->fileFailed(file, error);
+        break;
+        }
+      if (response.contains("itemId"))
+        {
+        // Empty files are created without any chunk.
+        file.Offset = file.Size;
+        break;
+        }
+      file.UploadId = response.value("_id").toString();
+      file.Offset = 0;
+      file.Resumed = false;
+      {
+      QVariantMap values;
+      values["size"] = file.Size;
+      values["modified"] = file.Modified;
+      values["itemId"] = file.ItemId;
+      values["uploadId"] = file.UploadId;
+      this->writeJournal(UploadRecord, file.Path, values);
+      }
+      this->queueNextStep(file);
+      break;
+    case Task::QueryOffset:
+      if (!result)
+        {
+        // The upload expired, it is started again.
+        file.UploadId.clear();
+        file.Resumed = false;
+        this->queueNextStep(file);
+        break;
+        }
+      file.Offset = response.value("offset").toLongLong();
+      ++this->FilesResumed;
+      this->BytesSkipped += file.Offset;
+      this->BytesTotal -= file.Offset;
+      this->queueNextStep(file);
+      break;
+    case Task::SendChunk:
+      if (!result)
+        {
+        this->fileFailed(file, error);
+        break;
+        }
+      file.Offset += chunkSize;
+      this->BytesUploaded += chunkSize;
+      emit q->progress(this->BytesUploaded, this->BytesTotal);
+      if (file.Offset < file.Size)
+        {
+        this->queueNextStep(file);
+        }
+      break;
+    }
+
+  if (task.TaskType == Task::SendChunk || task.TaskType == Task::InitUpload)
+    {
+    if (result && file.Offset >= file.Size)
+      {
+      ++this->FilesUploaded;
+      QVariantMap values;
+      values["size"] = file.Size;
+      values["modified"] = file.Modified;
+      values["itemId"] = file.ItemId;
+      values["fileId"] = response.value("_id");
+      this->writeJournal(FileRecord, file.Path, values);
+      emit q->fileUploaded(file.Path);
+      }
+    }
+  this->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::folderFailed(const QString& path, const QString& error)
+{
+  // The content of the directory can not be uploaded.
+  this->Errors << QString("%1: %2").arg(path).arg(error);
+  QString prefix = path + '/';
+  foreach(const QString& pendingPath, this->PendingFolders)
+    {
+    if (pendingPath.startsWith(prefix))
+      {
+      this->PendingFolders.removeAll(pendingPath);
+      this->FilesFailed += this->DirectoryFiles.take(pendingPath).size();
+      }
+    }
+  this->FilesFailed += this->DirectoryFiles.take(path).size();
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::fileFailed(const Upload& file, const QString& error)
+{
+  ++this->FilesFailed;
+  this->Errors << QString("%1: %2").arg(file.Path).arg(error);
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploaderPrivate::finish()
+{
+  Q_Q(qGirderUploader);
+  if (!this->Running)
+    {
+    return;
+    }
+  this->Running = false;
+  this->Elapsed = this->Clock.elapsed();
+  this->JournalStream.setDevice(NULL);
+  this->Journal.reset();
+  emit q->finished(!this->Cancelled && this->Errors.isEmpty());
+}
+
+// --------------------------------------------------------------------------
+// qGirderUploader methods
+
+// --------------------------------------------------------------------------
+qGirderUploader::qGirderUploader(qGirderAPI* girderAPI, QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new qGirderUploaderPrivate(this))
+{
+  Q_D(qGirderUploader);
+  d->GirderAPI = girderAPI;
+  QObject::connect(girderAPI, SIGNAL(finished(QUuid)),
+                   d, SLOT(queryFinished(QUuid)));
+}
+
+// --------------------------------------------------------------------------
+qGirderUploader::~qGirderUploader()
+{
+}
+
+// --------------------------------------------------------------------------
+int qGirderUploader::maximumConcurrentUploads()const
+{
+  Q_D(const qGirderUploader);
+  return d->MaximumConcurrentUploads;
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploader::setMaximumConcurrentUploads(int count)
+{
+  Q_D(qGirderUploader);
+  d->MaximumConcurrentUploads = qMax(1, count);
+}
+
+// --------------------------------------------------------------------------
+qint64 qGirderUploader::chunkSize()const
+{
+  Q_D(const qGirderUploader);
+  return d->ChunkSize;
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploader::setChunkSize(qint64 size)
+{
+  Q_D(qGirderUploader);
+  d->ChunkSize = qMax(Q_INT64_C(1), size);
+}
+
+// --------------------------------------------------------------------------
+QString qGirderUploader::journalFileName()const
+{
+  Q_D(const qGirderUploader);
+  return d->JournalFileName;
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploader::setJournalFileName(const QString& fileName)
+{
+  Q_D(qGirderUploader);
+  d->JournalFileName = fileName;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderUploader::start(const QString& directory, const QString& folderId)
+{
+  Q_D(qGirderUploader);
+  if (d->Running || !d->GirderAPI || !QFileInfo(directory).isDir())
+    {
+    return false;
+    }
+  d->Directory = QFileInfo(directory).absoluteFilePath();
+  if (d->JournalFileName.isEmpty())
+    {
+    d->JournalFileName = QDir(d->Directory).filePath(".girder-upload");
+    }
+  d->FolderId = folderId;
+  if (!d->openJournal())
+    {
+    return false;
+    }
+  d->FolderIds.clear();
+  d->FolderIds.insert(QString(), folderId);
+  d->PendingFolders.clear();
+  d->DirectoryFiles.clear();
+  d->StepQueue.clear();
+  d->FileQueue.clear();
+  d->FolderCount = 0;
+  d->FileCount = 0;
+  d->FilesUploaded = 0;
+  d->FilesResumed = 0;
+  d->FilesSkipped = 0;
+  d->FilesFailed = 0;
+  d->BytesUploaded = 0;
+  d->BytesSkipped = 0;
+  d->BytesTotal = 0;
+  d->Elapsed = 0;
+  d->Errors.clear();
+  d->Cancelled = false;
+  d->Running = true;
+  d->Clock.start();
+
+  d->scan();
+  d->sendQueries();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qGirderUploader::cancel()
+{
+  Q_D(qGirderUploader);
+  if (!d->Running)
+    {
+    return;
+    }
+  d->Cancelled = true;
+  d->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+bool qGirderUploader::isRunning()const
+{
+  Q_D(const qGirderUploader);
+  return d->Running;
+}
+
+// --------------------------------------------------------------------------
+bool qGirderUploader::wait()
+{
+  Q_D(qGirderUploader);
+  if (d->Running)
+    {
+    QEventLoop eventLoop;
+    QObject::connect(this, SIGNAL(finished(bool)),
+                     &eventLoop, SLOT(quit()));
+    eventLoop.exec();
+    }
+  return !d->Cancelled && d->Errors.isEmpty();
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qGirderUploader::summary()const
+{
+  Q_D(const qGirderUploader);
+  qint64 elapsed = d->Running ? d->Clock.elapsed() : d->Elapsed;
+  QVariantMap summary;
+  summary["folders"] = d->FolderCount;
+  summary["files"] = d->FileCount;
+  summary["filesUploaded"] = d->FilesUploaded;
+  summary["filesResumed"] = d->FilesResumed;
+  summary["filesSkipped"] = d->FilesSkipped;
+  summary["filesFailed"] = d->FilesFailed;
+  summary["bytesUploaded"] = d->BytesUploaded;
+  summary["bytesSkipped"] = d->BytesSkipped;
+  summary["bytesPerSecond"] = elapsed > 0 ? d->BytesUploaded * 1000. / elapsed : 0.;
+  summary["elapsed"] = elapsed;
+  summary["errors"] = d->Errors;
+  return summary;
+}
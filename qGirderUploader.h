@@ -0,0 +1,117 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderUploader_h
+#define __qGirderUploader_h
+
+// Qt includes
+#include <QObject>
+#include <QScopedPointer>
+#include <QVariantMap>
+
+#include "qRestAPI_Export.h"
+
+class qGirderAPI;
+class qGirderUploaderPrivate;
+
+/// qGirderUploader uploads a local directory into a Girder folder.
+///
+/// Sub-directories are created as folders, and each file as an item
+/// containing the file. Existing folders and items with the same name are
+/// reused, and the content of a file of the same name in a reused item is
+/// replaced ("PUT /file/{id}/contents"). Several files are uploaded at the
+/// same time, in chunks.
+///
+/// Progress is written to a journal in the local directory: the folders
+/// created, the uploads started and the files completed. When an upload is
+/// interrupted, starting it again skips the completed files and resumes the
+/// started uploads from the offset received by the server
+/// ("GET /file/offset"). Files are uploaded again if their size or
+/// modification time changed. The journal is discarded when the upload is
+/// started to another server or folder.
+///
+/// Usage:
+/// <code>
+/// qGirderUploader uploader(&girderAPI);
+/// uploader.setMaximumConcurrentUploads(8);
+/// uploader.start("/data/study", folderId);
+/// uploader.wait();
+/// qDebug() << uploader.summary();
+/// </code>
+class qRestAPI_EXPORT qGirderUploader : public QObject
+{
+  Q_OBJECT
+
+  /// Maximum number of queries sent at the same time. Default is 4.
+  Q_PROPERTY(int maximumConcurrentUploads READ maximumConcurrentUploads WRITE setMaximumConcurrentUploads)
+
+  /// Size in bytes of the chunks sent. Default is 16 MiB.
+  Q_PROPERTY(qint64 chunkSize READ chunkSize WRITE setChunkSize)
+
+  typedef QObject Superclass;
+
+public:
+  explicit qGirderUploader(qGirderAPI* girderAPI, QObject* parent = 0);
+  virtual ~qGirderUploader();
+
+  int maximumConcurrentUploads()const;
+  void setMaximumConcurrentUploads(int count);
+
+  qint64 chunkSize()const;
+  void setChunkSize(qint64 size);
+
+  /// Location of the journal. Defaults to ".girder-upload" in the local
+  /// directory.
+  QString journalFileName()const;
+  void setJournalFileName(const QString& fileName);
+
+  /// Starts uploading the content of \a directory into the folder
+  /// \a folderId. Returns false if an upload is in progress or if the
+  /// directory or the journal can not be opened.
+  bool start(const QString& directory, const QString& folderId);
+  /// Stops sending queries. The queries in progress are completed before
+  /// finished() is emitted, the upload can be resumed later.
+  void cancel();
+  bool isRunning()const;
+
+  /// Blocks until the upload is finished. Returns true if all the files
+  /// were uploaded.
+  bool wait();
+
+  /// Counts of the current or last upload: "folders", "files",
+  /// "filesUploaded", "filesResumed", "filesSkipped", "filesFailed",
+  /// "bytesUploaded", "bytesSkipped", "bytesPerSecond", "elapsed"
+  /// (milliseconds) and "errors" (list of strings).
+  QVariantMap summary()const;
+
+signals:
+  /// Emitted when a file is uploaded. \a fileName is relative to the local
+  /// directory.
+  void fileUploaded(const QString& fileName);
+  /// Emitted when a chunk is sent. \a bytesTotal is the size of the files to
+  /// upload, excluding the skipped ones.
+  void progress(qint64 bytesUploaded, qint64 bytesTotal);
+  void finished(bool success);
+
+private:
+  QScopedPointer<qGirderUploaderPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qGirderUploader);
+  Q_DISABLE_COPY(qGirderUploader);
+};
+
+#endif
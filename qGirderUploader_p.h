@@ -0,0 +1,164 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qGirderUploader_p_h
+#define __qGirderUploader_p_h
+
+// Qt includes
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QUuid>
+#include <QVariantMap>
+
+// qRestAPI includes
+#include "qGirderAPI.h"
+#include "qGirderUploader.h"
+
+class QBuffer;
+
+// --------------------------------------------------------------------------
+class qGirderUploaderPrivate : public QObject
+{
+  Q_OBJECT
+
+  Q_DECLARE_PUBLIC(qGirderUploader);
+
+  qGirderUploader* const q_ptr;
+
+public:
+  qGirderUploaderPrivate(qGirderUploader* object);
+
+  /// A local file being uploaded.
+  struct Upload
+  {
+    Upload() : Size(0), Modified(0), FilesListed(false), Offset(0), Resumed(false) {}
+    /// Path relative to Directory, and of its directory.
+    QString Path;
+    QString DirectoryPath;
+    qint64 Size;
+    qint64 Modified;
+    QString ItemId;
+    /// Existing file of the item whose content is replaced, if any.
+    bool FilesListed;
+    QString FileId;
+    QString UploadId;
+    qint64 Offset;
+    bool Resumed;
+  };
+
+  struct Task
+  {
+    enum Type
+    {
+      CreateFolder = 0,
+      CreateItem,
+      ListFiles,
+      InitUpload,
+      QueryOffset,
+      SendChunk
+    };
+    Task() : TaskType(CreateFolder), Chunk(0) {}
+    Type TaskType;
+    /// Directory of CreateFolder tasks.
+    QString Path;
+    /// Upload of the other tasks.
+    Upload File;
+    QBuffer* Chunk;
+  };
+
+  /// Journal records.
+  enum RecordType
+  {
+    FolderRecord = 0,
+    UploadRecord,
+    FileRecord
+  };
+
+  bool openJournal();
+  void writeJournal(RecordType type, const QString& path, const QVariantMap& values);
+
+  /// Lists the local directories and files.
+  void scan();
+  /// Sends queries until MaximumConcurrentUploads are in progress.
+  void sendQueries();
+  void sendQuery(Task& task);
+  /// Queues the files of \a directoryPath once its folder exists.
+  void queueFiles(const QString& directoryPath);
+  /// Queues the next step of the upload of \a file.
+  void queueNextStep(const Upload& file);
+  /// Fails the files of the directory \a path and of its sub-directories.
+  void folderFailed(const QString& path, const QString& error);
+  void fileFailed(const Upload& file, const QString& error);
+  void finish();
+
+  static QString parentPath(const QString& path);
+  static QString fileName(const QString& path);
+
+public slots:
+  void queryFinished(const QUuid& queryId);
+
+public:
+  QPointer<qGirderAPI> GirderAPI;
+  int MaximumConcurrentUploads;
+  qint64 ChunkSize;
+  QString JournalFileName;
+
+  QString Directory;
+  QString FolderId;
+  bool Running;
+  bool Cancelled;
+  QElapsedTimer Clock;
+
+  QScopedPointer<QFile> Journal;
+  QDataStream JournalStream;
+  /// Content of the journal of the previous runs, keyed by relative path.
+  QHash<QString, QString> JournalFolders;
+  QHash<QString, QVariantMap> JournalUploads;
+  QHash<QString, QVariantMap> JournalFiles;
+
+  /// Folder ids by relative directory path, "" being the target folder.
+  QHash<QString, QString> FolderIds;
+  /// Directories to create, parents first.
+  QStringList PendingFolders;
+  /// Files by relative directory path, waiting for their folder.
+  QHash<QString, QList<Upload> > DirectoryFiles;
+  /// Steps of the uploads in progress are sent before new uploads.
+  QList<Task> StepQueue;
+  QList<Upload> FileQueue;
+  QHash<QUuid, Task> PendingQueries;
+
+  int FolderCount;
+  int FileCount;
+  int FilesUploaded;
+  int FilesResumed;
+  int FilesSkipped;
+  int FilesFailed;
+  qint64 BytesUploaded;
+  qint64 BytesSkipped;
+  qint64 BytesTotal;
+  qint64 Elapsed;
+  QStringList Errors;
+};
+
+#endif
@@ -19,32 +19,294 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QAtomicInt>
+#include <QDateTime>
 #include <QDebug>
 #include <QEventLoop>
+#include <QFileInfo>
 #include <QIODevice>
+#include <QNetworkCookieJar>
+#include <QPointer>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QSslSocket>
 #include <QStringList>
+#include <QThreadPool>
+#include <QThreadStorage>
 #include <QTimer>
+#include <QVector>
 #include <QUuid>
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+#include <QHttpMultiPart>
+#endif
 #if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
 #include <QJSValueIterator>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QUrlQuery>
 #else
+#include <QScriptEngine>
 #include <QScriptValueIterator>
 #endif
+#if (QT_VERSION >= QT_VERSION_CHECK(5,10,0))
+#include <QRandomGenerator>
+#endif
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+#include <QCborValue>
+#endif
 
 // qRestAPI includes
 #include "qRestAPI.h"
 #include "qRestAPI_p.h"
 
+#include "qRestBlobStore.h"
+#include "qRestCannedReply.h"
+#include "qRestCircuitBreaker.h"
+#include "qRestCompactResult.h"
+#include "qRestFileSink.h"
+#include "qRestMetrics.h"
+#include "qRestPreparedRequest.h"
+#include "qRestReplay.h"
+#include "qRestResponseParser.h"
+#include "qRestTracer.h"
 #include "qRestResult.h"
 
+// STD includes
+#include <cmath>
+#include <cstring>
+
 // --------------------------------------------------------------------------
 // Static file local error messages
 static QString unknownErrorStr = "Unknown error";
 static QString unknownUuidStr = "Unknown uuid %1";
 static QString timeoutErrorStr = "Request timed out";
 
+// Time constant in milliseconds of the moving average of the transfer rate.
+static const double transferRateTimeConstant = 2000.;
+
+// Weight of the last query in the moving average of the server latencies.
+static const double serverLatencyWeight = 0.3;
+
+// Number of queries of a method and resource pattern recorded by the
+// metrics before their latency percentile is used to hedge queries.
+static const qint64 minimumHedgeSamples = 10;
+
+// Network managers shared by the qRestAPI objects of each thread, deleted
+// when the thread finishes.
+static QThreadStorage<QNetworkAccessManager*> sharedNetworkManagers;
+
+// Last request generation given to a qRestAPI object.
+static QAtomicInt requestGenerations;
+
+// --------------------------------------------------------------------------
+namespace
+{
+
+// --------------------------------------------------------------------------
+/// Returns a request generation that no qRestAPI object used before, so
+/// that a prepared request is never reused by another object.
+int nextRequestGeneration()
+{
+  return requestGenerations.fetchAndAddOrdered(1) + 1;
+}
+
+// --------------------------------------------------------------------------
+bool hasRawHeader(const qRestAPI::RawHeaders& rawHeaders, const QByteArray& name)
+{
+  foreach(const QByteArray& headerName, rawHeaders.keys())
+    {
+    if (headerName.toLower() == name.toLower())
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+// --------------------------------------------------------------------------
+/// Returns the text sent for a form field: maps are encoded as JSON.
+QString formFieldText(const QVariant& value)
+{
+  if (value.userType() == QMetaType::QVariantMap)
+    {
+    return QString::fromUtf8(qRestAPI::encodeBody(value.toMap(), qRestAPI::JsonEncoded));
+    }
+  return value.toString();
+}
+
+// --------------------------------------------------------------------------
+/// Returns the texts sent for a form field, one per value of a list.
+QStringList formFieldTexts(const QVariant& value)
+{
+  QStringList texts;
+  if (value.userType() == QMetaType::QVariantList ||
+      value.userType() == QMetaType::QStringList)
+    {
+    foreach(const QVariant& item, value.toList())
+      {
+      texts << formFieldText(item);
+      }
+    }
+  else
+    {
+    texts << formFieldText(value);
+    }
+  return texts;
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+// --------------------------------------------------------------------------
+QString quotedFormName(QString name)
+{
+  return "\"" + name.replace('\\', "\\\\").replace('"', "\\\"") + "\"";
+}
+#endif
+
+// --------------------------------------------------------------------------
+/// Returns the other request of a hedged query, 0 if the query is not
+/// hedged.
+QNetworkReply* hedgePartner(QNetworkReply* reply)
+{
+  return qobject_cast<QNetworkReply*>(reply->property("hedgePartner").value<QObject*>());
+}
+
+// --------------------------------------------------------------------------
+void setHedgePartner(QNetworkReply* reply, QNetworkReply* partner)
+{
+  reply->setProperty("hedgePartner",
+                     partner ? QVariant::fromValue<QObject*>(partner) : QVariant());
+}
+
+// --------------------------------------------------------------------------
+int randomIndex(int count)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5,10,0))
+  return static_cast<int>(QRandomGenerator::global()->bounded(count));
+#else
+  return qrand() % count;
+#endif
+}
+
+// --------------------------------------------------------------------------
+/// Returns true if the server of \a reply did not answer or answered with
+/// a server error.
+bool isServerFailure(QNetworkReply* reply)
+{
+  int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  return (reply->error() != QNetworkReply::NoError && statusCode == 0) || statusCode >= 500;
+}
+
+// --------------------------------------------------------------------------
+/// Returns true if the request of \a reply did not reach the server.
+bool isUndelivered(QNetworkReply* reply)
+{
+  return reply->property("circuitOpen").toBool() ||
+    reply->error() == QNetworkReply::ConnectionRefusedError ||
+    reply->error() == QNetworkReply::HostNotFoundError;
+}
+
+// --------------------------------------------------------------------------
+/// Returns true if the client aborted \a reply, e.g. a discarded hedge or
+/// a stopped replay. Queries that timed out are aborted too but are not
+/// cancelled.
+bool isCancelled(QNetworkReply* reply)
+{
+  return reply->error() == QNetworkReply::OperationCanceledError &&
+    !reply->property("timedOut").toBool();
+}
+
+} // end of anonymous namespace
+
+// --------------------------------------------------------------------------
+// qRestThrottledDevice methods
+
+// --------------------------------------------------------------------------
+qRestThrottledDevice::qRestThrottledDevice(const QByteArray& data, QObject* parent)
+  : QIODevice(parent)
+  , Data(data)
+  , Offset(0)
+  , ResumeTimer(new QTimer(this))
+{
+  this->ResumeTimer->setSingleShot(true);
+  QObject::connect(this->ResumeTimer, SIGNAL(timeout()),
+                   this, SLOT(resume()));
+}
+
+// --------------------------------------------------------------------------
+void qRestThrottledDevice::addBucket(qRestTokenBucket* bucket)
+{
+  this->Buckets << bucket;
+}
+
+// --------------------------------------------------------------------------
+bool qRestThrottledDevice::isSequential() const
+{
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestThrottledDevice::atEnd() const
+{
+  return this->Offset >= this->Data.size();
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestThrottledDevice::bytesAvailable() const
+{
+  return this->Data.size() - this->Offset + QIODevice::bytesAvailable();
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestThrottledDevice::readData(char* data, qint64 maxSize)
+{
+  qint64 remaining = this->Data.size() - this->Offset;
+  if (remaining == 0)
+    {
+    return -1;
+    }
+  qint64 size = qMin(maxSize, remaining);
+  foreach(qRestTokenBucket* bucket, this->Buckets)
+    {
+    size = qMin(size, bucket->available());
+    }
+  if (size > 0)
+    {
+    memcpy(data, this->Data.constData() + this->Offset, size);
+    this->Offset += size;
+    foreach(qRestTokenBucket* bucket, this->Buckets)
+      {
+      bucket->consume(size);
+      }
+    }
+  if (this->Offset < this->Data.size() && !this->ResumeTimer->isActive())
+    {
+    int delay = 0;
+    foreach(qRestTokenBucket* bucket, this->Buckets)
+      {
+      delay = qMax(delay, bucket->delay(this->Data.size() - this->Offset));
+      }
+    this->ResumeTimer->start(qBound(0, delay, qRestTokenBucket::maximumWaitInterval()));
+    }
+  return size;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestThrottledDevice::writeData(const char* data, qint64 maxSize)
+{
+  Q_UNUSED(data);
+  Q_UNUSED(maxSize);
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+void qRestThrottledDevice::resume()
+{
+  if (!this->atEnd())
+    {
+    emit readyRead();
+    }
+}
+
 // --------------------------------------------------------------------------
 // qRestAPIPrivate methods
 
@@ -53,9 +315,39 @@ qRestAPIPrivate::StaticInit qRestAPIPrivate::_staticInit;
 // --------------------------------------------------------------------------
 qRestAPIPrivate::qRestAPIPrivate(qRestAPI* object)
   : q_ptr(object)
+  , WriteServer(0)
+  , ServerRetryInterval(30000)
+  , RequestGeneration(nextRequestGeneration())
   , NetworkManager(NULL)
+  , NetworkManagerCount(1)
+  , ManagerSelection(qRestAPI::LeastLoadedManager)
+  , SharedNetworkManager(false)
   , TimeOut(0)
   , SuppressSslErrors(true)
+  , CompactResults(false)
+  , MemoryMappedDownloads(false)
+  , BlobStore(NULL)
+  , CircuitBreaker(NULL)
+  , HedgePercentile(0.)
+  , HedgeMinimumDelay(10)
+  , MaximumHedgeRatio(0.05)
+  , HedgesScheduled(0)
+  , HedgesFired(0)
+  , HedgesWon(0)
+  , StreamingBufferSize(0)
+  , Metrics(new qRestMetrics)
+  , TraceContextPropagation(false)
+  , Tracer(NULL)
+  , ProgressInterval(0)
+  , ActiveTransfers(0)
+  , ProgressDone(0)
+  , ProgressTotal(0)
+  , TransferredBytes(0)
+  , LastTransferredBytes(0)
+  , LastAggregateProgress(-1)
+  , TransferRate(0.)
+  , RecordingStart(0)
+  , ReplayManager(NULL)
   , ErrorCode(qRestAPI::UnknownError)
   , ErrorString(unknownErrorStr)
 {
@@ -64,7 +356,14 @@ qRestAPIPrivate::qRestAPIPrivate(qRestAPI* object)
 // --------------------------------------------------------------------------
 qRestAPIPrivate::~qRestAPIPrivate()
 {
-  NetworkManager->deleteLater();
+  foreach(QNetworkAccessManager* manager, ManagerLoads.keys())
+    {
+    manager->deleteLater();
+    }
+  if (ReplayManager)
+    {
+    ReplayManager->deleteLater();
+    }
 }
 
 // --------------------------------------------------------------------------
@@ -77,533 +376,2784 @@ void qRestAPIPrivate::staticInit()
 // --------------------------------------------------------------------------
 void qRestAPIPrivate::init()
 {
-  this->NetworkManager = new QNetworkAccessManager();
-  QObject::connect(this->NetworkManager, SIGNAL(finished(QNetworkReply*)),
+  QList<qRestResponseParser*> parsers;
+  parsers << new qRestJsonParser << new qRestMessagePackParser;
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+  parsers << new qRestCborParser;
+#endif
+  foreach(qRestResponseParser* parser, parsers)
+    {
+    QSharedPointer<qRestResponseParser> sharedParser(parser);
+    foreach(const QByteArray& contentType, parser->contentTypes())
+      {
+      this->ResponseParsers.insert(contentType, sharedParser);
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+QNetworkAccessManager* qRestAPIPrivate::createNetworkManager()
+{
+  QNetworkAccessManager* manager = new QNetworkAccessManager();
+  // The load is released before the reply is processed, so that queries
+  // sent from the finished() signal see the manager available.
+  QObject::connect(manager, SIGNAL(finished(QNetworkReply*)),
+                   this, SLOT(releaseManager(QNetworkReply*)));
+  QObject::connect(manager, SIGNAL(finished(QNetworkReply*)),
                    this, SLOT(processReply(QNetworkReply*)));
 #ifndef QRESTAPI_QT_NO_SSL
   if (QSslSocket::supportsSsl())
     {
-    QObject::connect(this->NetworkManager, SIGNAL(sslErrors(QNetworkReply*, QList<QSslError>)),
+    QObject::connect(manager, SIGNAL(sslErrors(QNetworkReply*, QList<QSslError>)),
           this, SLOT(onSslErrors(QNetworkReply*, QList<QSslError>)));
     }
 #endif
+  manager->setProxy(this->Proxy);
+  if (this->NetworkManager)
+    {
+    // The cookie jar stays owned by the first manager.
+    QNetworkCookieJar* cookieJar = this->NetworkManager->cookieJar();
+    manager->setCookieJar(cookieJar);
+    cookieJar->setParent(this->NetworkManager);
+    }
+  this->ManagerLoads.insert(manager, 0);
+  return manager;
 }
 
 // --------------------------------------------------------------------------
-void qRestAPI::setHttpNetworkProxy(const QNetworkProxy &proxy)
+void qRestAPIPrivate::releaseManager(QNetworkReply* reply)
 {
-  Q_D(qRestAPI);
-
-  if (d->NetworkManager != NULL)
+  QNetworkAccessManager* manager = reply->manager();
+  QHash<QNetworkAccessManager*, int>::iterator load = this->ManagerLoads.find(manager);
+  if (load == this->ManagerLoads.end())
+    {
+    return;
+    }
+  if (load.value() > 0)
+    {
+    --load.value();
+    }
+  if (load.value() == 0 && !this->NetworkManagers.contains(manager))
     {
-    d->NetworkManager->setProxy(proxy);
+    this->ManagerLoads.erase(load);
+    manager->deleteLater();
     }
 }
 
 // --------------------------------------------------------------------------
-QNetworkReply* qRestAPI::sendRequest(QNetworkAccessManager::Operation operation,
-    const QUrl& url,
-    const qRestAPI::RawHeaders& rawHeaders,
-    const QByteArray &data)
+void qRestAPIPrivate::processSharedReply()
 {
-  Q_D(qRestAPI);
-  QNetworkRequest queryRequest;
-  queryRequest.setUrl(url);
-
-  for (QMapIterator<QByteArray, QByteArray> it(d->DefaultRawHeaders); it.hasNext();)
-    {
-    it.next();
-    queryRequest.setRawHeader(it.key(), it.value());
-    }
-
-  for (QMapIterator<QByteArray, QByteArray> it(rawHeaders); it.hasNext();)
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  if (reply)
     {
-    it.next();
-    queryRequest.setRawHeader(it.key(), it.value());
+    this->processReply(reply);
     }
+}
 
-  QNetworkReply* queryReply;
-  switch (operation)
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::onSharedReplySslErrors(const QList<QSslError>& errors)
+{
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  if (reply)
     {
-    case QNetworkAccessManager::GetOperation:
-      queryReply = d->NetworkManager->get(queryRequest);
-      break;
-    case QNetworkAccessManager::DeleteOperation:
-      queryReply = d->NetworkManager->deleteResource(queryRequest);
-      break;
-    case QNetworkAccessManager::PutOperation:
-      queryReply = d->NetworkManager->put(queryRequest, data);
-      break;
-    case QNetworkAccessManager::PostOperation:
-      queryReply = d->NetworkManager->post(queryRequest, data);
-      break;
-    case QNetworkAccessManager::HeadOperation:
-      queryReply = d->NetworkManager->head(queryRequest);
-      break;
-    default:
-      // TODO
-      return 0;
+    this->onSslErrors(reply, errors);
     }
+}
 
-  if (d->TimeOut > 0)
+// --------------------------------------------------------------------------
+QNetworkAccessManager* qRestAPI::sharedNetworkManager()
+{
+  if (!sharedNetworkManagers.hasLocalData())
     {
-    QTimer* timeOut = new QTimer(queryReply);
-    timeOut->setSingleShot(true);
-    QObject::connect(timeOut, SIGNAL(timeout()),
-                     d, SLOT(queryTimeOut()));
-    timeOut->start(d->TimeOut);
+    sharedNetworkManagers.setLocalData(new QNetworkAccessManager());
     }
+  return sharedNetworkManagers.localData();
+}
 
-  QUuid queryId = QUuid::createUuid();
-  queryReply->setProperty("uuid", queryId.toString());
-
-  qRestResult* result = new qRestResult(queryId);
-  d->results[queryId] = result;
-//  QObject::connect(this, SIGNAL(resultReceived(QUuid,QList<QVariantMap>)),
-//                   result, SLOT(setResult(QList<QVariantMap>)));
-//  QObject::connect(this, SIGNAL(errorReceived(QUuid,QString)),
-//                   result, SLOT(setError(QString)));
+// --------------------------------------------------------------------------
+bool qRestAPI::isSharedNetworkManagerUsed() const
+{
+  Q_D(const qRestAPI);
+  return d->SharedNetworkManager;
+}
 
-  return queryReply;
+// --------------------------------------------------------------------------
+void qRestAPI::setSharedNetworkManagerUsed(bool shared)
+{
+  Q_D(qRestAPI);
+  d->SharedNetworkManager = shared;
 }
 
 // --------------------------------------------------------------------------
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-QVariantMap qRestAPI::scriptValueToMap(const QJSValue& value)
-#else
-QVariantMap qRestAPI::scriptValueToMap(const QScriptValue& value)
-#endif
+void qRestAPI::setHttpNetworkProxy(const QNetworkProxy &proxy)
 {
-#if QT_VERSION >= 0x040700
-  return value.toVariant().toMap();
-#else
-  QVariantMap result;
-  for (QScriptValueIterator it(value); it.hasNext();)
+  Q_D(qRestAPI);
+
+  d->Proxy = proxy;
+  foreach(QNetworkAccessManager* manager, d->NetworkManagers)
     {
-    it.next();
-    result.insert(it.name(), it.value().toVariant());
+    manager->setProxy(proxy);
+    }
+  if (d->SharedNetworkManager)
+    {
+    qRestAPI::sharedNetworkManager()->setProxy(proxy);
     }
-  return result;
-#endif
 }
 
 // --------------------------------------------------------------------------
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-void qRestAPI::appendScriptValueToVariantMapList(QList<QVariantMap>& result, const QJSValue& data)
-#else
-void qRestAPI::appendScriptValueToVariantMapList(QList<QVariantMap>& result, const QScriptValue& data)
-#endif
+int qRestAPI::networkManagerCount() const
 {
-  QVariantMap map = scriptValueToMap(data);
-  if (!map.isEmpty())
-    {
-    result << scriptValueToMap(data);
-    }
+  Q_D(const qRestAPI);
+  return d->NetworkManagerCount;
 }
 
 // --------------------------------------------------------------------------
-QVariantMap qRestAPI::qVariantMapFlattened(const QVariantMap& map)
+void qRestAPI::setNetworkManagerCount(int count)
 {
-  QVariantMap output;
-  foreach(const QString& key, map.keys())
+  Q_D(qRestAPI);
+  count = qMax(count, 1);
+  d->NetworkManagerCount = count;
+  if (d->NetworkManagers.isEmpty())
     {
-    QVariant value = map.value(key);
-    if (value.canConvert<QVariantMap>())
-      {
-      value = QVariant::fromValue(QVariantList() << value.toMap());
-      }
-    if (value.canConvert<QVariantList>())
-      {
-      foreach(const QVariant& item, value.toList())
-        {
-        QVariantMap subMap = qRestAPI::qVariantMapFlattened(item.toMap());
-        foreach(const QString& subKey, subMap.keys())
-          {
-          output.insert(QString("%1.%2").arg(key).arg(subKey), subMap.value(subKey));
-          }
-        }
-      }
-    else
+    // The managers are created when the first query is sent.
+    return;
+    }
+  while (d->NetworkManagers.size() < count)
+    {
+    d->NetworkManagers << d->createNetworkManager();
+    }
+  while (d->NetworkManagers.size() > count)
+    {
+    // The managers with queries in progress are deleted by releaseManager().
+    QNetworkAccessManager* manager = d->NetworkManagers.takeLast();
+    if (d->ManagerLoads.value(manager) == 0)
       {
-      output.insert(key, value);
+      d->ManagerLoads.remove(manager);
+      manager->deleteLater();
       }
     }
-  return output;
 }
 
 // --------------------------------------------------------------------------
-void qRestAPIPrivate::processReply(QNetworkReply* reply)
+qRestAPI::ManagerSelectionPolicy qRestAPI::managerSelectionPolicy() const
 {
-  Q_Q(qRestAPI);
-  QUuid queryId(reply->property("uuid").toString());
+  Q_D(const qRestAPI);
+  return d->ManagerSelection;
+}
 
-  qRestResult* restResult = results[queryId];
+// --------------------------------------------------------------------------
+void qRestAPI::setManagerSelectionPolicy(ManagerSelectionPolicy policy)
+{
+  Q_D(qRestAPI);
+  d->ManagerSelection = policy;
+}
+
+// --------------------------------------------------------------------------
+qRestSpan qRestAPIPrivate::createSpan() const
+{
+  if (!this->TraceContextPropagation && !this->Tracer)
+    {
+    return qRestSpan();
+    }
+  return qRestSpan::create(this->ParentSpan);
+}
+
+// --------------------------------------------------------------------------
+QNetworkRequest qRestAPIPrivate::createRequest(const QUrl& url, const qRestAPI::RawHeaders& rawHeaders,
+                                               const qRestSpan& span)
+{
+  QNetworkRequest queryRequest = this->createBaseRequest(rawHeaders);
+  queryRequest.setUrl(url);
+  this->setTraceContext(queryRequest, span);
+  return queryRequest;
+}
+
+// --------------------------------------------------------------------------
+QNetworkRequest qRestAPIPrivate::createBaseRequest(const qRestAPI::RawHeaders& rawHeaders) const
+{
+  QNetworkRequest queryRequest;
+  for (QMapIterator<QByteArray, QByteArray> it(this->DefaultRawHeaders); it.hasNext();)
+    {
+    it.next();
+    queryRequest.setRawHeader(it.key(), it.value());
+    }
+
+  for (QMapIterator<QByteArray, QByteArray> it(rawHeaders); it.hasNext();)
+    {
+    it.next();
+    queryRequest.setRawHeader(it.key(), it.value());
+    }
+
+  if (!this->AcceptHeader.isEmpty() && !queryRequest.hasRawHeader("Accept"))
+    {
+    queryRequest.setRawHeader("Accept", this->AcceptHeader);
+    }
+  return queryRequest;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::setTraceContext(QNetworkRequest& request, const qRestSpan& span) const
+{
+  if (this->TraceContextPropagation && span.isValid() &&
+      !request.hasRawHeader("traceparent"))
+    {
+    request.setRawHeader("traceparent", span.traceParent());
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::trackReply(QNetworkReply* queryReply)
+{
+  QHash<QNetworkAccessManager*, int>::iterator load =
+    this->ManagerLoads.find(queryReply->manager());
+  if (load != this->ManagerLoads.end())
+    {
+    ++load.value();
+    }
+  else if (queryReply->manager() && queryReply->manager() != this->ReplayManager)
+    {
+    // The shared manager reports the replies of all the qRestAPI objects
+    // of its thread, only the replies of this object are followed. They
+    // are deleted with the object.
+    queryReply->setParent(this);
+    QObject::connect(queryReply, SIGNAL(finished()),
+                     this, SLOT(processSharedReply()));
+#ifndef QRESTAPI_QT_NO_SSL
+    if (QSslSocket::supportsSsl())
+      {
+      QObject::connect(queryReply, SIGNAL(sslErrors(QList<QSslError>)),
+                       this, SLOT(onSharedReplySslErrors(QList<QSslError>)));
+      }
+#endif
+    }
+
+  if (this->TimeOut > 0)
+    {
+    QTimer* timeOut = new QTimer(queryReply);
+    timeOut->setSingleShot(true);
+    QObject::connect(timeOut, SIGNAL(timeout()),
+                     this, SLOT(queryTimeOut()));
+    timeOut->start(this->TimeOut);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::registerReply(QNetworkReply* queryReply,
+                                    QNetworkAccessManager::Operation operation,
+                                    qint64 queued, const qRestSpan& span,
+                                    qRestResult* result)
+{
+  this->trackReply(queryReply);
+
+  if (result)
+    {
+    // The query is sent again, it keeps its id, span and queued time.
+    queryReply->setProperty("uuid", result->queryId().toString());
+    result->Timing.Dispatched = qRestTiming::now();
+    result->Timing.Encrypted = -1;
+    result->Timing.RequestSent = -1;
+    result->Timing.FirstByte = -1;
+    result->Timing.LastByte = -1;
+    this->connectReply(queryReply);
+    return;
+    }
+
+  QUuid queryId = QUuid::createUuid();
+  queryReply->setProperty("uuid", queryId.toString());
+
+  result = new qRestResult(queryId);
+  this->results[queryId] = result;
+  switch (operation)
+    {
+    case QNetworkAccessManager::GetOperation: result->Method = "GET"; break;
+    case QNetworkAccessManager::HeadOperation: result->Method = "HEAD"; break;
+    case QNetworkAccessManager::PutOperation: result->Method = "PUT"; break;
+    case QNetworkAccessManager::PostOperation: result->Method = "POST"; break;
+    case QNetworkAccessManager::DeleteOperation: result->Method = "DELETE"; break;
+    default:
+      result->Method = queryReply->request().attribute(QNetworkRequest::CustomVerbAttribute).toByteArray();
+    }
+  result->Url = queryReply->url();
+  result->Timing.QueuedWallTime = QDateTime::currentMSecsSinceEpoch() - (qRestTiming::now() - queued);
+  result->Timing.Queued = queued;
+  result->Timing.Dispatched = qRestTiming::now();
+  result->Span = span;
+  result->Span.QueryId = queryId;
+  result->Span.Method = result->Method;
+  result->Span.Url = result->Url;
+
+  this->connectReply(queryReply);
+
+  if (this->Tracer && result->Span.isValid())
+    {
+    this->Tracer->spanStarted(result->Span);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::scheduleHedge(QNetworkReply* queryReply)
+{
+  Q_Q(qRestAPI);
+  if (this->HedgePercentile <= 0. || queryReply->isFinished() ||
+      queryReply->property("circuitOpen").toBool() ||
+      !q->canHedgeQuery(queryReply->request()))
+    {
+    return;
+    }
+  qRestResult* result = this->replyResult(queryReply);
+  QString resource = queryReply->url().path();
+  if (!result || this->Metrics->count(result->Method, resource) < minimumHedgeSamples)
+    {
+    return;
+    }
+  qint64 delay = qMax(static_cast<qint64>(this->HedgeMinimumDelay),
+                      this->Metrics->latencyPercentile(result->Method, resource,
+                                                       this->HedgePercentile));
+  ++this->HedgesScheduled;
+  // The timer is deleted with the reply.
+  QTimer* hedgeTimer = new QTimer(queryReply);
+  hedgeTimer->setSingleShot(true);
+  QObject::connect(hedgeTimer, SIGNAL(timeout()),
+                   this, SLOT(sendHedge()));
+  hedgeTimer->start(static_cast<int>(delay));
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::sendHedge()
+{
+  QTimer* timer = qobject_cast<QTimer*>(this->sender());
+  Q_ASSERT(timer);
+  QNetworkReply* queryReply = qobject_cast<QNetworkReply*>(timer->parent());
+  if (!queryReply || queryReply->isFinished() ||
+      this->HedgesFired >= this->MaximumHedgeRatio * this->HedgesScheduled)
+    {
+    return;
+    }
+  // A hedge would take the place of a trial query of a recovering
+  // endpoint.
+  if (this->CircuitBreaker &&
+      this->CircuitBreaker->state(queryReply->url()) != qRestCircuitBreaker::Closed)
+    {
+    return;
+    }
+  QNetworkReply* hedgeReply = this->sendQuery(queryReply->operation(),
+                                              queryReply->request(), QByteArray());
+  if (!hedgeReply)
+    {
+    return;
+    }
+  if (hedgeReply->property("circuitOpen").toBool())
+    {
+    hedgeReply->setProperty("hedgeDiscarded", true);
+    return;
+    }
+  ++this->HedgesFired;
+  hedgeReply->setProperty("uuid", queryReply->property("uuid"));
+  hedgeReply->setProperty("hedge", true);
+  setHedgePartner(queryReply, hedgeReply);
+  setHedgePartner(hedgeReply, queryReply);
+  this->trackReply(hedgeReply);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::connectReply(QNetworkReply* queryReply)
+{
+  QObject::connect(queryReply, SIGNAL(metaDataChanged()),
+                   this, SLOT(queryMetaDataChanged()));
+  QObject::connect(queryReply, SIGNAL(downloadProgress(qint64,qint64)),
+                   this, SLOT(queryDownloadProgress(qint64,qint64)));
+  QObject::connect(queryReply, SIGNAL(uploadProgress(qint64,qint64)),
+                   this, SLOT(queryUploadProgress(qint64,qint64)));
+#if (QT_VERSION >= QT_VERSION_CHECK(5,1,0)) && !defined(QRESTAPI_QT_NO_SSL)
+  QObject::connect(queryReply, SIGNAL(encrypted()),
+                   this, SLOT(queryEncrypted()));
+#endif
+#if (QT_VERSION >= QT_VERSION_CHECK(6,3,0))
+  QObject::connect(queryReply, SIGNAL(requestSent()),
+                   this, SLOT(queryRequestSent()));
+#endif
+//  QObject::connect(this, SIGNAL(resultReceived(QUuid,QList<QVariantMap>)),
+//                   result, SLOT(setResult(QList<QVariantMap>)));
+//  QObject::connect(this, SIGNAL(errorReceived(QUuid,QString)),
+//                   result, SLOT(setError(QString)));
+}
+
+// --------------------------------------------------------------------------
+int qRestAPIPrivate::serverIndex(const QByteArray& encodedUrl) const
+{
+  // The longest match, in case a server URL is a prefix of another one.
+  int index = -1;
+  for (int server = 0; server < this->Servers.size(); ++server)
+    {
+    const QByteArray& serverUrl = this->Servers.at(server).Url;
+    if (encodedUrl.startsWith(serverUrl) &&
+        (index < 0 || serverUrl.size() > this->Servers.at(index).Url.size()))
+      {
+      index = server;
+      }
+    }
+  return index;
+}
+
+// --------------------------------------------------------------------------
+int qRestAPIPrivate::readServer()
+{
+  qint64 now = qRestTiming::now();
+  QList<int> healthy;
+  int leastRecentlyFailed = 0;
+  for (int server = 0; server < this->Servers.size(); ++server)
+    {
+    const qRestServerState& state = this->Servers.at(server);
+    if (state.UnhealthyUntil <= now)
+      {
+      healthy << server;
+      }
+    if (state.UnhealthyUntil < this->Servers.at(leastRecentlyFailed).UnhealthyUntil)
+      {
+      leastRecentlyFailed = server;
+      }
+    }
+  if (healthy.isEmpty())
+    {
+    return leastRecentlyFailed;
+    }
+  if (healthy.size() == 1)
+    {
+    return healthy.first();
+    }
+  // Two random choices: the load spreads across the servers while the
+  // slow ones receive fewer requests. Servers without latency yet are
+  // preferred so that they get measured.
+  int first = randomIndex(healthy.size());
+  int second = randomIndex(healthy.size() - 1);
+  if (second >= first)
+    {
+    ++second;
+    }
+  const qRestServerState& firstServer = this->Servers.at(healthy.at(first));
+  const qRestServerState& secondServer = this->Servers.at(healthy.at(second));
+  double firstLatency = firstServer.Samples > 0 ? firstServer.Latency : 0.;
+  double secondLatency = secondServer.Samples > 0 ? secondServer.Latency : 0.;
+  return healthy.at(secondLatency < firstLatency ? second : first);
+}
+
+// --------------------------------------------------------------------------
+int qRestAPIPrivate::writeServer()
+{
+  qint64 now = qRestTiming::now();
+  if (this->Servers.at(this->WriteServer).UnhealthyUntil <= now)
+    {
+    return this->WriteServer;
+    }
+  for (int server = 0; server < this->Servers.size(); ++server)
+    {
+    if (this->Servers.at(server).UnhealthyUntil <= now)
+      {
+      this->WriteServer = server;
+      break;
+      }
+    }
+  return this->WriteServer;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::selectServer(QNetworkAccessManager::Operation operation,
+                                   QNetworkRequest& request)
+{
+  if (this->Servers.size() < 2)
+    {
+    return;
+    }
+  QByteArray encodedUrl = request.url().toEncoded();
+  int current = this->serverIndex(encodedUrl);
+  if (current < 0)
+    {
+    return;
+    }
+  bool read = operation == QNetworkAccessManager::GetOperation ||
+    operation == QNetworkAccessManager::HeadOperation;
+  int server = read ? this->readServer() : this->writeServer();
+  if (server != current)
+    {
+    request.setUrl(QUrl::fromEncoded(
+      this->Servers.at(server).Url + encodedUrl.mid(this->Servers.at(current).Url.size())));
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::recordServerResult(QNetworkReply* reply, qRestResult* result)
+{
+  // A query aborted by the client tells nothing about its server.
+  if (this->Servers.size() < 2 || reply->property("circuitOpen").toBool() ||
+      isCancelled(reply))
+    {
+    return;
+    }
+  int index = this->serverIndex(reply->url().toEncoded());
+  if (index < 0)
+    {
+    return;
+    }
+  qRestServerState& server = this->Servers[index];
+  if (isServerFailure(reply))
+    {
+    ++server.Failures;
+    server.UnhealthyUntil = qRestTiming::now() + this->ServerRetryInterval;
+    return;
+    }
+  server.Failures = 0;
+  server.UnhealthyUntil = 0;
+  qint64 latency = qRestTiming::interval(result->Timing.Dispatched, result->Timing.LastByte);
+  if (latency < 0)
+    {
+    return;
+    }
+  server.Latency = server.Samples == 0 ? latency :
+    serverLatencyWeight * latency + (1. - serverLatencyWeight) * server.Latency;
+  ++server.Samples;
+}
+
+// --------------------------------------------------------------------------
+bool qRestAPIPrivate::failOver(const QUuid& queryId, QNetworkReply* reply, qRestResult* result)
+{
+  Q_Q(qRestAPI);
+  // Queries aborted by the client, e.g. by stopReplay(), are not sent
+  // again.
+  if (this->Servers.size() < 2 || !result->Resendable || isCancelled(reply) ||
+      this->FailOvers.value(queryId) >= this->Servers.size() - 1 ||
+      this->serverIndex(reply->url().toEncoded()) < 0)
+    {
+    return false;
+    }
+  bool read = reply->operation() == QNetworkAccessManager::GetOperation ||
+    reply->operation() == QNetworkAccessManager::HeadOperation;
+  if (!isUndelivered(reply) && !(read && isServerFailure(reply)))
+    {
+    return false;
+    }
+  // A rejected request does not make its server unhealthy, it is avoided
+  // while its circuit is open.
+  if (reply->property("circuitOpen").toBool())
+    {
+    int index = this->serverIndex(reply->url().toEncoded());
+    this->Servers[index].UnhealthyUntil =
+      qRestTiming::now() + qMin(this->ServerRetryInterval,
+                                this->CircuitBreaker ? this->CircuitBreaker->openDuration() : 0);
+    }
+  this->finishProgress(result);
+  if (!q->resendQuery(queryId))
+    {
+    return false;
+    }
+  this->FailOvers[queryId] += 1;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+QNetworkReply* qRestAPIPrivate::rejectQuery(QNetworkAccessManager::Operation operation,
+                                            const QNetworkRequest& request, bool* trial)
+{
+  *trial = false;
+  if (!this->CircuitBreaker || this->CircuitBreaker->allowRequest(request.url(), trial))
+    {
+    return 0;
+    }
+  qRestCannedReply* reply = new qRestCannedReply(operation, request, this);
+  reply->setNetworkError(QNetworkReply::UnknownNetworkError,
+                         QString("Circuit breaker open for %1")
+                         .arg(this->CircuitBreaker->endpoint(request.url())));
+  reply->setProperty("circuitOpen", true);
+  QObject::connect(reply, SIGNAL(finished()),
+                   this, SLOT(processSharedReply()));
+  reply->start();
+  return reply;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::tagTrial(QNetworkReply* reply, const QNetworkRequest& request,
+                               bool trial)
+{
+  if (!trial)
+    {
+    return;
+    }
+  if (reply)
+    {
+    reply->setProperty("circuitTrial", true);
+    }
+  else
+    {
+    this->CircuitBreaker->releaseTrial(request.url());
+    }
+}
+
+// --------------------------------------------------------------------------
+template <typename Body>
+QNetworkReply* qRestAPIPrivate::sendQuery(QNetworkAccessManager::Operation operation,
+                                          const QNetworkRequest& serverRequest,
+                                          const Body& data)
+{
+  QNetworkRequest request = serverRequest;
+  this->selectServer(operation, request);
+  bool trial = false;
+  QNetworkReply* queryReply = this->rejectQuery(operation, request, &trial);
+  if (queryReply)
+    {
+    return queryReply;
+    }
+  switch (operation)
+    {
+    case QNetworkAccessManager::GetOperation:
+      queryReply = this->networkManager(request.url())->get(request);
+      break;
+    case QNetworkAccessManager::DeleteOperation:
+      queryReply = this->networkManager(request.url())->deleteResource(request);
+      break;
+    case QNetworkAccessManager::PutOperation:
+      queryReply = this->networkManager(request.url())->put(request, data);
+      break;
+    case QNetworkAccessManager::PostOperation:
+      queryReply = this->networkManager(request.url())->post(request, data);
+      break;
+    case QNetworkAccessManager::HeadOperation:
+      queryReply = this->networkManager(request.url())->head(request);
+      break;
+    default:
+      // TODO
+      break;
+    }
+  this->tagTrial(queryReply, request, trial);
+  return queryReply;
+}
+
+// --------------------------------------------------------------------------
+QNetworkReply* qRestAPI::sendRequest(QNetworkAccessManager::Operation operation,
+    const QUrl& url,
+    const qRestAPI::RawHeaders& rawHeaders,
+    const QByteArray &data)
+{
+  Q_D(qRestAPI);
+  qint64 queued = qRestTiming::now();
+  qRestSpan span = d->createSpan();
+  QNetworkRequest queryRequest = d->createRequest(url, rawHeaders, span);
+
+  QNetworkReply* queryReply = d->sendQuery(operation, queryRequest, data);
+  if (!queryReply)
+    {
+    return 0;
+    }
+
+  d->registerReply(queryReply, operation, queued, span);
+
+  // The request is kept so that the query can be sent again.
+  qRestResult* result = d->replyResult(queryReply);
+  result->Operation = operation;
+  result->RequestHeaders = rawHeaders;
+  result->RequestBody = data;
+  result->Resendable = true;
+
+  return queryReply;
+}
+
+// --------------------------------------------------------------------------
+QNetworkReply* qRestAPI::sendRequest(QNetworkAccessManager::Operation operation,
+    const QUrl& url,
+    const qRestAPI::RawHeaders& rawHeaders,
+    QIODevice* data)
+{
+  Q_D(qRestAPI);
+  qint64 queued = qRestTiming::now();
+  qRestSpan span = d->createSpan();
+  QNetworkRequest queryRequest = d->createRequest(url, rawHeaders, span);
+  // Without a content length, the network manager reads the whole
+  // sequential device before sending the request.
+  if (data->isSequential() &&
+      !queryRequest.header(QNetworkRequest::ContentLengthHeader).isValid())
+    {
+    queryRequest.setHeader(QNetworkRequest::ContentLengthHeader,
+                           data->bytesAvailable());
+    }
+
+  QNetworkReply* queryReply = d->sendQuery(operation, queryRequest, data);
+  if (!queryReply)
+    {
+    return 0;
+    }
+
+  d->registerReply(queryReply, operation, queued, span);
+
+  return queryReply;
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+// --------------------------------------------------------------------------
+QNetworkReply* qRestAPI::sendRequest(QNetworkAccessManager::Operation operation,
+    const QUrl& url,
+    const qRestAPI::RawHeaders& rawHeaders,
+    QHttpMultiPart* data)
+{
+  Q_D(qRestAPI);
+  qint64 queued = qRestTiming::now();
+  qRestSpan span = d->createSpan();
+  // The network manager sets the Content-Type header with the boundary of
+  // the parts if it is not set.
+  QNetworkRequest queryRequest = d->createRequest(url, rawHeaders, span);
+
+  QNetworkReply* queryReply = d->sendQuery(operation, queryRequest, data);
+  if (!queryReply)
+    {
+    return 0;
+    }
+
+  d->registerReply(queryReply, operation, queued, span);
+
+  return queryReply;
+}
+#endif
+
+// --------------------------------------------------------------------------
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+QVariantMap qRestAPI::scriptValueToMap(const QJSValue& value)
+#else
+QVariantMap qRestAPI::scriptValueToMap(const QScriptValue& value)
+#endif
+{
+#if QT_VERSION >= 0x040700
+  return value.toVariant().toMap();
+#else
+  QVariantMap result;
+  for (QScriptValueIterator it(value); it.hasNext();)
+    {
+    it.next();
+    result.insert(it.name(), it.value().toVariant());
+    }
+  return result;
+#endif
+}
+
+// --------------------------------------------------------------------------
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+void qRestAPI::appendScriptValueToVariantMapList(QList<QVariantMap>& result, const QJSValue& data)
+#else
+void qRestAPI::appendScriptValueToVariantMapList(QList<QVariantMap>& result, const QScriptValue& data)
+#endif
+{
+  QVariantMap map = scriptValueToMap(data);
+  if (!map.isEmpty())
+    {
+    result << scriptValueToMap(data);
+    }
+}
+
+// --------------------------------------------------------------------------
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+void qRestAPI::appendScriptValueToCompactResult(qRestCompactResult& result, const QJSValue& data)
+{
+  QJSValueIterator it(data);
+#else
+void qRestAPI::appendScriptValueToCompactResult(qRestCompactResult& result, const QScriptValue& data)
+{
+  QScriptValueIterator it(data);
+#endif
+  if (!it.hasNext())
+    {
+    return;
+    }
+  int row = result.appendRow();
+  while (it.hasNext())
+    {
+    it.next();
+    result.setValue(row, result.internKey(it.name()), it.value().toVariant());
+    }
+}
+
+// --------------------------------------------------------------------------
+namespace
+{
+
+// --------------------------------------------------------------------------
+enum FlattenedValueKind
+{
+  FlattenedLeaf,
+  FlattenedMap,
+  FlattenedList
+};
+
+// --------------------------------------------------------------------------
+FlattenedValueKind flattenedValueKind(const QVariant& value)
+{
+  // Fast path for the types found in parsed JSON documents, it avoids the
+  // more expensive conversion checks below.
+  switch (value.userType())
+    {
+    case QMetaType::QVariantMap:
+      return FlattenedMap;
+    case QMetaType::QVariantList:
+      return FlattenedList;
+    case QMetaType::QString:
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+      return FlattenedLeaf;
+    default:
+      break;
+    }
+  if (!value.isValid())
+    {
+    return FlattenedLeaf;
+    }
+  if (value.canConvert<QVariantMap>())
+    {
+    return FlattenedMap;
+    }
+  if (value.canConvert<QVariantList>())
+    {
+    return FlattenedList;
+    }
+  return FlattenedLeaf;
+}
+
+// --------------------------------------------------------------------------
+/// State of a map (or of a list of maps) being flattened.
+/// Maps and lists are implicitly shared, storing them does not copy
+/// their content.
+struct FlattenFrame
+{
+  FlattenFrame()
+    : IsList(false), ListIndex(0), PrefixLength(0) {}
+
+  QVariantMap Map;
+  QVariantMap::const_iterator Iterator;
+  QVariantList List;
+  bool IsList;
+  int ListIndex;
+  /// Length of the key prefix associated with the frame.
+  int PrefixLength;
+};
+
+// --------------------------------------------------------------------------
+FlattenFrame mapFrame(const QVariantMap& map, int prefixLength)
+{
+  FlattenFrame frame;
+  frame.Map = map;
+  frame.Iterator = frame.Map.constBegin();
+  frame.PrefixLength = prefixLength;
+  return frame;
+}
+
+// --------------------------------------------------------------------------
+FlattenFrame listFrame(const QVariantList& list, int prefixLength)
+{
+  FlattenFrame frame;
+  frame.List = list;
+  frame.IsList = true;
+  frame.PrefixLength = prefixLength;
+  return frame;
+}
+
+// --------------------------------------------------------------------------
+/// Flatten the maps in [Begin, End[ of Input into Output.
+class FlattenTask : public QRunnable
+{
+public:
+  FlattenTask(const QList<QVariantMap>& input, QVariantMap* output,
+              int begin, int end, QSemaphore& done)
+    : Input(input), Output(output), Begin(begin), End(end), Done(done) {}
+
+  void run()
+  {
+    for (int index = this->Begin; index < this->End; ++index)
+      {
+      this->Output[index] = qRestAPI::qVariantMapFlattened(this->Input.at(index));
+      }
+    this->Done.release();
+  }
+
+private:
+  const QList<QVariantMap>& Input;
+  QVariantMap* Output;
+  int Begin;
+  int End;
+  QSemaphore& Done;
+};
+
+} // end of anonymous namespace
+
+// --------------------------------------------------------------------------
+QVariantMap qRestAPI::qVariantMapFlattened(const QVariantMap& map)
+{
+  // Depth-first traversal equivalent to a recursive one: values are
+  // inserted in the same order, so that the last value found for a given
+  // key is the one kept.
+  QVariantMap output;
+  QString key;
+  QVector<FlattenFrame> stack;
+  stack.append(mapFrame(map, 0));
+  while (!stack.isEmpty())
+    {
+    FlattenFrame& frame = stack.last();
+    if (frame.IsList)
+      {
+      if (frame.ListIndex >= frame.List.size())
+        {
+        stack.pop_back();
+        continue;
+        }
+      // Items that are not maps do not contribute to the output.
+      QVariantMap itemMap = frame.List.at(frame.ListIndex++).toMap();
+      int prefixLength = frame.PrefixLength;
+      stack.append(mapFrame(itemMap, prefixLength));
+      continue;
+      }
+
+    if (frame.Iterator == frame.Map.constEnd())
+      {
+      stack.pop_back();
+      continue;
+      }
+    key.truncate(frame.PrefixLength);
+    key.append(frame.Iterator.key());
+    QVariant value = frame.Iterator.value();
+    ++frame.Iterator;
+
+    switch (flattenedValueKind(value))
+      {
+      case FlattenedMap:
+        key.append(QLatin1Char('.'));
+        stack.append(mapFrame(value.toMap(), key.size()));
+        break;
+      case FlattenedList:
+        key.append(QLatin1Char('.'));
+        stack.append(listFrame(value.toList(), key.size()));
+        break;
+      default:
+        output.insert(key, value);
+        break;
+      }
+    }
+  return output;
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qRestAPI::qVariantMapListFlattened(const QList<QVariantMap>& list)
+{
+  // Below this number of maps per task, the cost of dispatching the work to
+  // other threads outweighs the gain.
+  const int minimumMapsPerTask = 64;
+
+  QThreadPool* threadPool = QThreadPool::globalInstance();
+  int taskCount = qMin(threadPool->maxThreadCount() * 4, list.size() / minimumMapsPerTask);
+
+  QList<QVariantMap> result;
+  result.reserve(list.size());
+  if (taskCount <= 1)
+    {
+    foreach(const QVariantMap& map, list)
+      {
+      result << qRestAPI::qVariantMapFlattened(map);
+      }
+    return result;
+    }
+
+  QVector<QVariantMap> output(list.size());
+  QSemaphore done;
+  QVariantMap* outputData = output.data();
+  int mapsPerTask = (list.size() + taskCount - 1) / taskCount;
+  for (int task = 0; task < taskCount; ++task)
+    {
+    int begin = qMin(task * mapsPerTask, list.size());
+    int end = qMin(begin + mapsPerTask, list.size());
+    FlattenTask* flattenTask = new FlattenTask(list, outputData, begin, end, done);
+    // The last task and the tasks that can not be started right away are run
+    // in the calling thread. It ensures progress even if all the threads of
+    // the pool are busy (e.g. when called from a task of the same pool).
+    if (task == taskCount - 1 || !threadPool->tryStart(flattenTask))
+      {
+      flattenTask->run();
+      delete flattenTask;
+      }
+    }
+  done.acquire(taskCount);
+  foreach(const QVariantMap& map, output)
+    {
+    result << map;
+    }
+  return result;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::processReply(QNetworkReply* reply)
+{
+  Q_Q(qRestAPI);
+  if (reply->property("hedgeDiscarded").toBool())
+    {
+    reply->deleteLater();
+    return;
+    }
+  QUuid queryId(reply->property("uuid").toString());
+
+  // The first response of a hedged query is used, unless it failed while
+  // the other request is still in progress.
+  QNetworkReply* partner = hedgePartner(reply);
+  if (partner)
+    {
+    setHedgePartner(reply, 0);
+    setHedgePartner(partner, 0);
+    if (reply->error() != QNetworkReply::NoError && !partner->isFinished())
+      {
+      reply->deleteLater();
+      return;
+      }
+    partner->setProperty("hedgeDiscarded", true);
+    partner->abort();
+    if (reply->property("hedge").toBool())
+      {
+      ++this->HedgesWon;
+      }
+    }
+
+  qRestResult* restResult = results[queryId];
   Q_ASSERT(restResult);
+  if (restResult->Timing.LastByte < 0)
+    {
+    restResult->Timing.LastByte = qRestTiming::now();
+    }
+
+  // Subclasses may hold failed queries to send them again later, e.g. once
+  // their credentials are renewed.
+  if (reply->error() != QNetworkReply::NoError && restResult->Resendable &&
+      q->holdFailedQuery(queryId, reply))
+    {
+    this->finishProgress(restResult);
+    reply->close();
+    reply->deleteLater();
+    return;
+    }
+
+  // Throttled downloads are reported once the received data is written.
+  if (reply->error() == QNetworkReply::NoError && restResult->deferDownloadFinish(reply))
+    {
+    QObject::connect(restResult, SIGNAL(downloadDrained(QNetworkReply*)),
+                     this, SLOT(processReply(QNetworkReply*)), Qt::UniqueConnection);
+    return;
+    }
+
+  if (this->CircuitBreaker && !reply->property("circuitOpen").toBool())
+    {
+    bool trial = reply->property("circuitTrial").toBool();
+    // A query aborted by the client tells nothing about its endpoint.
+    if (isCancelled(reply))
+      {
+      if (trial)
+        {
+        this->CircuitBreaker->releaseTrial(reply->url());
+        }
+      }
+    else
+      {
+      this->CircuitBreaker->recordResult(
+        reply->url(), reply->error() != QNetworkReply::NoError,
+        reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(),
+        qRestTiming::interval(restResult->Timing.Dispatched, restResult->Timing.LastByte),
+        trial);
+      }
+    }
+  this->recordServerResult(reply, restResult);
+  if (reply->error() != QNetworkReply::NoError &&
+      this->failOver(queryId, reply, restResult))
+    {
+    reply->close();
+    reply->deleteLater();
+    return;
+    }
+
+  // Downloaded data must be stored and verified before the result is
+  // reported.
+  bool transferSucceeded = restResult->finishDownload(reply);
+  if (transferSucceeded && reply->error() == QNetworkReply::NoError)
+    {
+    transferSucceeded = restResult->finishChecksums();
+    }
+
+  if (reply->error() != QNetworkReply::NoError)
+    {
+    qRestAPI::ErrorType errorCode = qRestAPI::NetworkError;
+    switch (reply->error())
+      {
+    case QNetworkReply::TimeoutError:
+      errorCode = qRestAPI::TimeoutError;
+      break;
+    case QNetworkReply::SslHandshakeFailedError:
+      errorCode = qRestAPI::SslError;
+      break;
+    case QNetworkReply::AuthenticationRequiredError:
+      errorCode = qRestAPI::AuthenticationError;
+      break;
+    default:
+      ;
+      }
+    if (reply->property("circuitOpen").toBool())
+      {
+      errorCode = qRestAPI::CircuitOpenError;
+      }
+    restResult->setError(queryId.toString() + ": " +
+                         QString::number(static_cast<int>(reply->error())) + ": " +
+                         reply->errorString(),
+                         errorCode);
+    }
+  else if (!transferSucceeded)
+    {
+    restResult->setError(queryId.toString() + ": " + restResult->TransferError,
+                         restResult->TransferErrorCode);
+    }
+  else
+    {
+    // Verified downloads are kept to be reused by later downloads of the
+    // same content.
+    qRestFileSink* sink = qobject_cast<qRestFileSink*>(restResult->ioDevice);
+    if (this->BlobStore && sink && sink->isCommitted() &&
+        restResult->ExpectedChecksumAlgorithm >= 0)
+      {
+      this->BlobStore->insert(
+        restResult->ExpectedChecksum,
+        static_cast<QCryptographicHash::Algorithm>(restResult->ExpectedChecksumAlgorithm),
+        sink->fileName());
+      }
+    restResult->Reponse = reply->readAll();
+    restResult->ContentType =
+      reply->rawHeader("Content-Type").split(';').first().trimmed().toLower();
+    restResult->Timing.ParseStarted = qRestTiming::now();
+    q->parseResponse(restResult, restResult->response());
+    restResult->Timing.ParseFinished = qRestTiming::now();
+    }
+
+  if (this->RecordingFile)
+    {
+    QByteArray body = restResult->RecordDownload ? restResult->RecordedDownload :
+      reply->error() == QNetworkReply::NoError ? restResult->Reponse : reply->readAll();
+    this->recordReply(restResult, reply, body);
+    restResult->RecordedDownload.clear();
+    }
+
+  #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+    foreach(const QNetworkReply::RawHeaderPair& rawHeaderPair, reply->rawHeaderPairs())
+      {
+      restResult->setRawHeader(rawHeaderPair.first, rawHeaderPair.second);
+      }
+  #else
+    foreach(const QByteArray& headerName, reply->rawHeaderList())
+      {
+      restResult->setRawHeader(headerName, reply->rawHeader(headerName));
+      }
+  #endif
+
+  reply->close();
+  reply->deleteLater();
+
+  restResult->Span.HttpStatusCode =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+  this->reportFinished(queryId, restResult);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::reportFinished(const QUuid& queryId, qRestResult* restResult)
+{
+  Q_Q(qRestAPI);
+  this->finishProgress(restResult);
+
+  // The result may be taken and deleted by the receivers of finished().
+  qRestSpan span = restResult->Span;
+  QString errorString = restResult->Error;
+  qRestTiming timing = restResult->Timing;
+  QByteArray method = restResult->Method;
+  QString resource = restResult->Url.path();
+  qRestAPI::ErrorType errorCode = restResult->ErrorCode;
+
+  this->FailOvers.remove(queryId);
+  // The receivers may also delete the qRestAPI object.
+  QPointer<qRestAPI> guard(q);
+  q->emit finished(queryId);
+  if (!guard)
+    {
+    return;
+    }
+
+  timing.FinishedDelivered = qRestTiming::now();
+  if (this->results.value(queryId) == restResult)
+    {
+    restResult->Timing.FinishedDelivered = timing.FinishedDelivered;
+    }
+  if (!method.isEmpty())
+    {
+    this->Metrics->record(method, resource, timing, errorCode);
+    }
+  if (this->Tracer && span.isValid())
+    {
+    this->Tracer->spanFinished(span, timing, errorCode, errorString);
+    }
+}
+
+void qRestAPIPrivate::onSslErrors(QNetworkReply* reply, const QList<QSslError>& errors)
+{
+#ifdef QRESTAPI_QT_NO_SSL
+  Q_UNUSED(reply)
+  Q_UNUSED(errors)
+#else
+  if (!this->SuppressSslErrors)
+    {
+    QString errorString;
+    foreach (const QSslError& error, errors)
+      {
+      if (!errorString.isEmpty())
+        {
+        errorString.append(", ");
+        }
+      errorString.append(error.errorString());
+      }
+
+    QString plural(errors.empty() ? " has" : "s have");
+    QString error = QString("SSL error%1 occurred: %2").arg(plural).arg(errorString);
+
+    QUuid queryId(reply->property("uuid").toString());
+    qRestResult* restResult = results[queryId];
+
+    restResult->setError(error, qRestAPI::SslError);
+    }
+  else
+    {
+    reply->ignoreSslErrors();
+    }
+#endif
+}
+
+// --------------------------------------------------------------------------
+QNetworkAccessManager* qRestAPIPrivate::networkManager(const QUrl& url)
+{
+  if (this->ReplayManager)
+    {
+    return this->ReplayManager;
+    }
+  if (this->SharedNetworkManager)
+    {
+    return qRestAPI::sharedNetworkManager();
+    }
+  if (this->NetworkManagers.isEmpty())
+    {
+    this->NetworkManager = this->createNetworkManager();
+    this->NetworkManagers << this->NetworkManager;
+    while (this->NetworkManagers.size() < this->NetworkManagerCount)
+      {
+      this->NetworkManagers << this->createNetworkManager();
+      }
+    }
+  if (this->NetworkManagers.size() == 1)
+    {
+    return this->NetworkManager;
+    }
+  if (this->ManagerSelection == qRestAPI::HashedManager)
+    {
+    uint index = qHash(url.toString()) % static_cast<uint>(this->NetworkManagers.size());
+    return this->NetworkManagers.at(static_cast<int>(index));
+    }
+  QNetworkAccessManager* leastLoaded = this->NetworkManager;
+  int leastLoad = this->ManagerLoads.value(leastLoaded);
+  foreach(QNetworkAccessManager* manager, this->NetworkManagers)
+    {
+    int load = this->ManagerLoads.value(manager);
+    if (load < leastLoad)
+      {
+      leastLoaded = manager;
+      leastLoad = load;
+      }
+    }
+  return leastLoaded;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::recordReply(qRestResult* result, QNetworkReply* reply, const QByteArray& body)
+{
+  const qRestTiming& timing = result->Timing;
+  qRestRecord record;
+  record.Method = result->Method;
+  record.Url = result->Url.toString();
+  foreach(const QByteArray& headerName, reply->request().rawHeaderList())
+    {
+    record.RequestHeaders << qMakePair(headerName, reply->request().rawHeader(headerName));
+    }
+  record.RequestSize = timing.BytesSent;
+  record.HttpStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  record.ReasonPhrase = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray();
+  foreach(const QByteArray& headerName, reply->rawHeaderList())
+    {
+    record.ResponseHeaders << qMakePair(headerName, reply->rawHeader(headerName));
+    }
+  record.Body = body;
+  record.NetworkError = reply->error();
+  if (reply->error() != QNetworkReply::NoError)
+    {
+    record.ErrorString = reply->errorString();
+    }
+  record.Offset = qMax(Q_INT64_C(0), timing.Queued - this->RecordingStart);
+  record.LastByteDelay = qMax(Q_INT64_C(0), qRestTiming::interval(timing.Dispatched, timing.LastByte));
+  record.FirstByteDelay = timing.FirstByte >= 0 ?
+    qMax(Q_INT64_C(0), qRestTiming::interval(timing.Dispatched, timing.FirstByte)) :
+    record.LastByteDelay;
+
+  this->RecordingStream << record;
+  // Complete records are kept if the application stops unexpectedly.
+  this->RecordingFile->flush();
+}
+
+// --------------------------------------------------------------------------
+qRestResult* qRestAPIPrivate::replyResult(QNetworkReply* reply) const
+{
+  if (!reply)
+    {
+    return NULL;
+    }
+  return this->results.value(QUuid(reply->property("uuid").toString()));
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::postponeTimeOut(QNetworkReply* reply)
+{
+  // We received some progress so we postpone the timeout if any.
+  QTimer* timer = reply ? reply->findChild<QTimer*>() : NULL;
+  if (timer && timer->isActive())
+    {
+    timer->start();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::queryMetaDataChanged()
+{
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  qRestResult* result = this->replyResult(reply);
+  if (result && result->Timing.FirstByte < 0)
+    {
+    result->Timing.FirstByte = qRestTiming::now();
+    }
+  this->postponeTimeOut(reply);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::queryDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+  Q_UNUSED(bytesTotal);
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  qRestResult* result = this->replyResult(reply);
+  if (result)
+    {
+    if (result->Timing.FirstByte < 0 && bytesReceived > 0)
+      {
+      result->Timing.FirstByte = qRestTiming::now();
+      }
+    result->Timing.BytesReceived = bytesReceived;
+    }
+  this->postponeTimeOut(reply);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::queryUploadProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+  Q_UNUSED(bytesTotal);
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  qRestResult* result = this->replyResult(reply);
+  if (result)
+    {
+    result->Timing.BytesSent = bytesSent;
+    }
+  this->postponeTimeOut(reply);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::queryEncrypted()
+{
+  qRestResult* result = this->replyResult(qobject_cast<QNetworkReply*>(this->sender()));
+  if (result)
+    {
+    result->Timing.Encrypted = qRestTiming::now();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::queryRequestSent()
+{
+  qRestResult* result = this->replyResult(qobject_cast<QNetworkReply*>(this->sender()));
+  if (result)
+    {
+    result->Timing.RequestSent = qRestTiming::now();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::downloadProgress(qint64 bytesWritten, qint64 bytesTotal)
+{
+  qRestResult* result = qobject_cast<qRestResult*>(this->sender());
+  Q_ASSERT(result);
+  if (!result)
+    {
+    return;
+    }
+  this->updateProgress(result, bytesWritten, bytesTotal);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::uploadProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  Q_ASSERT(reply);
+  qRestResult* result = this->replyResult(reply);
+  if (!result)
+    {
+    return;
+    }
+  this->updateProgress(result, bytesSent, bytesTotal);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::updateProgress(qRestResult* result, qint64 bytesDone, qint64 bytesTotal)
+{
+  Q_Q(qRestAPI);
+  if (!result->ProgressActive)
+    {
+    result->ProgressActive = true;
+    ++this->ActiveTransfers;
+    }
+  this->TransferredBytes += qMax(qint64(0), bytesDone - result->ProgressDone);
+  this->ProgressDone += bytesDone - result->ProgressDone;
+  this->ProgressTotal += qMax(qint64(0), bytesTotal) - qMax(qint64(0), result->ProgressTotal);
+  result->ProgressDone = bytesDone;
+  result->ProgressTotal = bytesTotal;
+
+  // The progress of a query is unknown until its size is known.
+  if (bytesTotal > 0)
+    {
+    qint64 now = qRestTiming::now();
+    int interval = result->ProgressInterval >= 0 ? result->ProgressInterval : this->ProgressInterval;
+    if (bytesDone >= bytesTotal || result->LastProgress < 0 ||
+        now - result->LastProgress >= interval)
+      {
+      result->LastProgress = now;
+      q->emit progress(result->queryId(), static_cast<double>(bytesDone) / bytesTotal);
+      }
+    }
+  this->updateAggregateProgress(false);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::finishProgress(qRestResult* result)
+{
+  if (!result->ProgressActive)
+    {
+    return;
+    }
+  result->ProgressActive = false;
+  --this->ActiveTransfers;
+  this->ProgressDone -= result->ProgressDone;
+  this->ProgressTotal -= qMax(qint64(0), result->ProgressTotal);
+  this->updateAggregateProgress(true);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::updateAggregateProgress(bool force)
+{
+  Q_Q(qRestAPI);
+  qint64 now = qRestTiming::now();
+  if (!force && this->LastAggregateProgress >= 0 &&
+      now - this->LastAggregateProgress < this->ProgressInterval)
+    {
+    return;
+    }
+  qint64 elapsed = this->LastAggregateProgress >= 0 ? now - this->LastAggregateProgress : 0;
+  if (elapsed > 0)
+    {
+    // Exponentially weighted moving average of the rate, the weight of a
+    // sample depends on the time it covers.
+    double rate = (this->TransferredBytes - this->LastTransferredBytes) * 1000. / elapsed;
+    double alpha = 1. - std::exp(-static_cast<double>(elapsed) / transferRateTimeConstant);
+    this->TransferRate += alpha * (rate - this->TransferRate);
+    }
+  this->LastAggregateProgress = now;
+  this->LastTransferredBytes = this->TransferredBytes;
+
+  qint64 remainingTime = -1;
+  if (this->ActiveTransfers == 0)
+    {
+    remainingTime = 0;
+    }
+  else if (this->ProgressTotal > 0 && this->TransferRate > 0.)
+    {
+    remainingTime = static_cast<qint64>(
+          qMax(qint64(0), this->ProgressTotal - this->ProgressDone) * 1000. / this->TransferRate);
+    }
+  q->emit aggregateProgress(this->ProgressDone, this->ProgressTotal,
+                            this->TransferRate, remainingTime);
+
+  if (this->ActiveTransfers == 0)
+    {
+    // The next transfers start from scratch.
+    this->LastAggregateProgress = -1;
+    this->TransferRate = 0.;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::queryTimeOut()
+{
+  QTimer* timer = qobject_cast<QTimer*>(this->sender());
+  Q_ASSERT(timer);
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(timer->parent());
+  Q_ASSERT(reply);
+  reply->setProperty("timedOut", true);
+  reply->abort();
+  //reply->setError(QNetworkReply::TimeoutError,
+  //   q->tr("Time out: No progress for %1 seconds.").arg(timer->interval()));
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPIPrivate::sendDevice(QNetworkAccessManager::Operation operation,
+                                  QIODevice* input, const QString& resource,
+                                  const qRestAPI::Parameters& parameters,
+                                  const qRestAPI::RawHeaders& rawHeaders,
+                                  int expectedChecksumAlgorithm,
+                                  const QByteArray& expectedChecksum)
+{
+  Q_Q(qRestAPI);
+
+  QUrl url = q->createUrl(resource, parameters);
+  if (!input->isOpen() && !input->open(QIODevice::ReadOnly))
+    {
+    return this->failedQuery("Could not open file for upload!", qRestAPI::FileError);
+    }
+
+  QByteArray data = input->readAll();
+
+  // The data is paced by the upload rate limits, which can be set or changed
+  // while it is sent.
+  qRestThrottledDevice* body = new qRestThrottledDevice(data);
+  body->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+  body->addBucket(&this->UploadBucket);
+
+  QNetworkReply* queryReply = q->sendRequest(operation, url, rawHeaders, body);
+  QUuid queryId (queryReply->property("uuid").toString());
+  body->setParent(queryReply);
+
+  qRestResult* result = this->results[queryId];
+  result->ioDevice = input;
+  body->addBucket(&result->UploadBucket);
+  foreach(QCryptographicHash::Algorithm algorithm, this->ChecksumAlgorithms)
+    {
+    result->addChecksumAlgorithm(algorithm);
+    }
+  if (expectedChecksumAlgorithm >= 0)
+    {
+    result->setExpectedChecksum(
+      static_cast<QCryptographicHash::Algorithm>(expectedChecksumAlgorithm), expectedChecksum);
+    }
+  result->updateChecksums(data);
+  QObject::connect(queryReply, SIGNAL(uploadProgress(qint64,qint64)),
+                   this, SLOT(uploadProgress(qint64,qint64)));
+  QObject::connect(queryReply, SIGNAL(finished()),
+                   result, SLOT(uploadFinished()));
+
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPIPrivate::sendBody(QNetworkAccessManager::Operation operation,
+                                const QString& resource, const QVariantMap& body,
+                                qRestAPI::BodyEncoding encoding,
+                                const qRestAPI::Parameters& parameters,
+                                const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_Q(qRestAPI);
+  QByteArray data = qRestAPI::encodeBody(body, encoding);
+  if (data.isNull())
+    {
+    return this->failedQuery("Unsupported body encoding", qRestAPI::UnknownError);
+    }
+  qRestAPI::RawHeaders headers = rawHeaders;
+  if (!hasRawHeader(headers, "Content-Type"))
+    {
+    headers["Content-Type"] = qRestAPI::bodyContentType(encoding);
+    }
+  QUrl url = q->createUrl(resource, parameters);
+  QNetworkReply* queryReply = q->sendRequest(operation, url, headers, data);
+  return QUuid(queryReply->property("uuid").toString());
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+// --------------------------------------------------------------------------
+QUuid qRestAPIPrivate::sendMultiPart(QNetworkAccessManager::Operation operation,
+                                     QHttpMultiPart* multiPart, const QString& resource,
+                                     const qRestAPI::Parameters& parameters,
+                                     const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_Q(qRestAPI);
+  if (!multiPart)
+    {
+    return this->failedQuery("No multipart body", qRestAPI::FileError);
+    }
+  QUrl url = q->createUrl(resource, parameters);
+  QNetworkReply* queryReply = q->sendRequest(operation, url, rawHeaders, multiPart);
+  if (!queryReply)
+    {
+    delete multiPart;
+    return this->failedQuery("Multipart bodies are only sent by PUT and POST requests",
+                             qRestAPI::UnknownError);
+    }
+  multiPart->setParent(queryReply);
+  QObject::connect(queryReply, SIGNAL(uploadProgress(qint64,qint64)),
+                   this, SLOT(uploadProgress(qint64,qint64)));
+  return QUuid(queryReply->property("uuid").toString());
+}
+#endif
+
+// --------------------------------------------------------------------------
+QUuid qRestAPIPrivate::unsentQuery(const QByteArray& method, const QUrl& url,
+                                   const QString& error, qRestAPI::ErrorType errorCode)
+{
+  QUuid queryId = QUuid::createUuid();
+  qRestResult* restResult = new qRestResult(queryId);
+  restResult->Method = method;
+  restResult->Url = url;
+  restResult->Timing.QueuedWallTime = QDateTime::currentMSecsSinceEpoch();
+  restResult->Timing.Queued = qRestTiming::now();
+  if (errorCode != qRestAPI::UnknownError)
+    {
+    restResult->setError(queryId.toString() + ": " + error, errorCode);
+    }
+  else
+    {
+    restResult->setResult();
+    }
+  if (!method.isEmpty())
+    {
+    restResult->Span = this->createSpan();
+    restResult->Span.QueryId = queryId;
+    restResult->Span.Method = method;
+    restResult->Span.Url = url;
+    if (this->Tracer && restResult->Span.isValid())
+      {
+      this->Tracer->spanStarted(restResult->Span);
+      }
+    }
+  this->results[queryId] = restResult;
+  // finished() is emitted once the caller knows the id of the query.
+  QMetaObject::invokeMethod(this, "finishUnsentQuery", Qt::QueuedConnection,
+                            Q_ARG(QUuid, queryId));
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPIPrivate::failedQuery(const QString& error, qRestAPI::ErrorType errorCode)
+{
+  return this->unsentQuery(QByteArray(), QUrl(), error, errorCode);
+}
+
+// --------------------------------------------------------------------------
+void qRestAPIPrivate::finishUnsentQuery(const QUuid& queryId)
+{
+  Q_Q(qRestAPI);
+  qRestResult* restResult = this->results.value(queryId);
+  if (!restResult)
+    {
+    // The result was already taken.
+    q->emit finished(queryId);
+    return;
+    }
+  this->reportFinished(queryId, restResult);
+}
+
+// --------------------------------------------------------------------------
+// qRestAPI methods
+
+// --------------------------------------------------------------------------
+qRestAPI::qRestAPI(QObject* _parent)
+  : Superclass(_parent)
+  , d_ptr(new qRestAPIPrivate(this))
+{
+  Q_D(qRestAPI);
+  d->init();
+}
+
+// --------------------------------------------------------------------------
+qRestAPI::~qRestAPI()
+{
+}
+
+// --------------------------------------------------------------------------
+QString qRestAPI::serverUrl()const
+{
+  Q_D(const qRestAPI);
+  return d->ServerUrl;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setServerUrl(const QString& serverUrl)
+{
+  this->setServerUrls(QStringList() << serverUrl);
+}
+
+// --------------------------------------------------------------------------
+QStringList qRestAPI::serverUrls()const
+{
+  Q_D(const qRestAPI);
+  QStringList urls;
+  foreach(const qRestServerState& server, d->Servers)
+    {
+    urls << QUrl::fromEncoded(server.Url).toString();
+    }
+  return urls;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setServerUrls(const QStringList& serverUrls)
+{
+  Q_D(qRestAPI);
+  d->ServerUrl = serverUrls.value(0);
+  d->Servers.clear();
+  foreach(const QString& url, serverUrls)
+    {
+    qRestServerState server;
+    server.Url = QUrl(url).toEncoded();
+    d->Servers << server;
+    }
+  d->WriteServer = 0;
+  d->RequestGeneration = nextRequestGeneration();
+}
+
+// --------------------------------------------------------------------------
+int qRestAPI::serverRetryInterval()const
+{
+  Q_D(const qRestAPI);
+  return d->ServerRetryInterval;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setServerRetryInterval(int msecs)
+{
+  Q_D(qRestAPI);
+  d->ServerRetryInterval = qMax(msecs, 0);
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qRestAPI::serverStatus()const
+{
+  Q_D(const qRestAPI);
+  QList<QVariantMap> status;
+  qint64 now = qRestTiming::now();
+  foreach(const qRestServerState& server, d->Servers)
+    {
+    QVariantMap map;
+    map["url"] = QUrl::fromEncoded(server.Url).toString();
+    map["healthy"] = server.UnhealthyUntil <= now;
+    map["latency"] = server.Samples > 0 ? server.Latency : -1.;
+    map["failures"] = server.Failures;
+    status << map;
+    }
+  return status;
+}
+
+// --------------------------------------------------------------------------
+int qRestAPI::timeOut()const
+{
+  Q_D(const qRestAPI);
+  return d->TimeOut;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setTimeOut(int msecs)
+{
+  Q_D(qRestAPI);
+  d->TimeOut = msecs;
+}
+
+// --------------------------------------------------------------------------
+qRestAPI::RawHeaders qRestAPI::defaultRawHeaders()const
+{
+  Q_D(const qRestAPI);
+  return d->DefaultRawHeaders;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setDefaultRawHeaders(const qRestAPI::RawHeaders& defaultRawHeaders)
+{
+  Q_D(qRestAPI);
+  d->DefaultRawHeaders = defaultRawHeaders;
+  d->RequestGeneration = nextRequestGeneration();
+}
+
+// --------------------------------------------------------------------------
+bool qRestAPI::suppressSslErrors()const
+{
+  Q_D(const qRestAPI);
+  return d->SuppressSslErrors;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setSuppressSslErrors(bool suppressSslErrors)
+{
+  Q_D(qRestAPI);
+  d->SuppressSslErrors = suppressSslErrors;
+}
+
+// --------------------------------------------------------------------------
+bool qRestAPI::compactResults()const
+{
+  Q_D(const qRestAPI);
+  return d->CompactResults;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setCompactResults(bool compactResults)
+{
+  Q_D(qRestAPI);
+  d->CompactResults = compactResults;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::registerResponseParser(qRestResponseParser* parser)
+{
+  Q_D(qRestAPI);
+  QSharedPointer<qRestResponseParser> sharedParser(parser);
+  foreach(const QByteArray& contentType, parser->contentTypes())
+    {
+    d->ResponseParsers.insert(contentType.toLower(), sharedParser);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::unregisterResponseParser(const QByteArray& contentType)
+{
+  Q_D(qRestAPI);
+  d->ResponseParsers.remove(contentType.toLower());
+}
+
+// --------------------------------------------------------------------------
+qRestResponseParser* qRestAPI::responseParser(const QByteArray& contentType)const
+{
+  Q_D(const qRestAPI);
+  return d->ResponseParsers.value(contentType.toLower()).data();
+}
+
+// --------------------------------------------------------------------------
+QList<QByteArray> qRestAPI::acceptedContentTypes()const
+{
+  Q_D(const qRestAPI);
+  return d->AcceptedContentTypes;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setAcceptedContentTypes(const QList<QByteArray>& contentTypes)
+{
+  Q_D(qRestAPI);
+  d->AcceptedContentTypes = contentTypes;
+  d->RequestGeneration = nextRequestGeneration();
+  // Preference decreases with the position, e.g.
+  // "application/msgpack, application/json;q=0.9"
+  d->AcceptHeader.clear();
+  for (int index = 0; index < contentTypes.size(); ++index)
+    {
+    if (index > 0)
+      {
+      d->AcceptHeader += ", ";
+      }
+    d->AcceptHeader += contentTypes.at(index);
+    if (index > 0)
+      {
+      d->AcceptHeader += ";q=" + QByteArray::number(qMax(1, 10 - index) / 10., 'g', 1);
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qRestAPI::memoryMappedDownloads()const
+{
+  Q_D(const qRestAPI);
+  return d->MemoryMappedDownloads;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setMemoryMappedDownloads(bool memoryMapped)
+{
+  Q_D(qRestAPI);
+  d->MemoryMappedDownloads = memoryMapped;
+}
+
+// --------------------------------------------------------------------------
+QUrl qRestAPI::createUrl(const QString& resource, const qRestAPI::Parameters& parameters)
+{
+  Q_D(qRestAPI);
+  QUrl url(d->ServerUrl + resource);
+#if (QT_VERSION < QT_VERSION_CHECK(5,0,0))
+  foreach(const QString& parameter, parameters.keys())
+    {
+    url.addQueryItem(parameter, parameters[parameter]);
+    }
+#else
+  QUrlQuery urlQuery(url);
+  foreach(const QString& parameter, parameters.keys())
+    {
+    urlQuery.addQueryItem(parameter, parameters[parameter]);
+    }
+  url.setQuery(urlQuery);
+#endif
+  return url;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::parseResponse(qRestResult* restResult, const QByteArray& response)
+{
+  if (!this->parseRegisteredResponse(restResult, response))
+    {
+    QList<QVariantMap> result;
+    restResult->setResult(result);
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qRestAPI::parseRegisteredResponse(qRestResult* restResult, const QByteArray& response,
+                                       const QByteArray& defaultContentType)
+{
+  Q_D(qRestAPI);
+  QSharedPointer<qRestResponseParser> parser =
+    d->ResponseParsers.value(restResult->contentType());
+  if (!parser && !defaultContentType.isEmpty())
+    {
+    parser = d->ResponseParsers.value(defaultContentType);
+    }
+  if (!parser)
+    {
+    return false;
+    }
+  QVariant value;
+  QString error;
+  if (!parser->parse(response, value, error))
+    {
+    restResult->setError(restResult->queryId().toString() + ": " + error,
+                         qRestAPI::ResponseParseError);
+    return true;
+    }
+  if (d->CompactResults)
+    {
+    qRestCompactResult result;
+    qRestResponseParser::appendToCompactResult(result, value);
+    restResult->setResult(result);
+    }
+  else
+    {
+    QList<QVariantMap> result;
+    qRestResponseParser::appendToVariantMapList(result, value);
+    restResult->setResult(result);
+    }
+  return true;
+}
 
-  if (reply->error() != QNetworkReply::NoError)
+// --------------------------------------------------------------------------
+QUuid qRestAPI::get(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  QUrl url = createUrl(resource, parameters);
+  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::GetOperation, url, rawHeaders);
+  d->scheduleHedge(queryReply);
+  QUuid queryId(queryReply->property("uuid").toString());
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::get(QIODevice* output, const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+
+  QUrl url = createUrl(resource, parameters);
+
+  if (!output->open(QIODevice::WriteOnly))
     {
-    qRestAPI::ErrorType errorCode = qRestAPI::NetworkError;
-    switch (reply->error())
+    QUuid queryId;
+    // TODO How to raise the error? We do not have a qRestResult object yet...
+    //    emit errorReceived(queryId, "Cannot open device for writing.");
+    return queryId;
+    }
+
+  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::GetOperation, url, rawHeaders);
+  QUuid queryId = QUuid(queryReply->property("uuid").toString());
+  qRestResult* result = d->results[queryId];
+  result->ioDevice = output;
+  // The output may already contain data when the request fails.
+  result->Resendable = false;
+  result->DownloadReply = queryReply;
+  result->SharedDownloadBucket = &d->DownloadBucket;
+  result->StreamingBufferSize = d->StreamingBufferSize;
+  result->updateReadBufferSize();
+  result->RecordDownload = !d->RecordingFile.isNull();
+  foreach(QCryptographicHash::Algorithm algorithm, d->ChecksumAlgorithms)
+    {
+    result->addChecksumAlgorithm(algorithm);
+    }
+
+  // Progress is reported for the data written into the output device, which
+  // may lag behind the data received when the download is throttled.
+  connect(result, SIGNAL(downloadProgress(qint64,qint64)),
+          d, SLOT(downloadProgress(qint64,qint64)));
+  connect(queryReply, SIGNAL(readyRead()),
+          result, SLOT(downloadReadyRead()));
+  if (d->StreamingBufferSize > 0)
+    {
+    connect(output, SIGNAL(bytesWritten(qint64)),
+            result, SLOT(drainDownload()));
+    }
+  connect(queryReply, SIGNAL(finished()),
+          result, SLOT(downloadFinished()));
+
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::head(const QString  resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  QUrl url = createUrl(resource, parameters);
+  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::HeadOperation, url, rawHeaders);
+  d->scheduleHedge(queryReply);
+  QUuid queryId = QUuid(queryReply->property("uuid").toString());
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::download(const QString& fileName, const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+
+  qRestFileSink* output = new qRestFileSink(fileName);
+  if (d->MemoryMappedDownloads)
+    {
+    output->setWriteMode(qRestFileSink::MemoryMappedWrites);
+    }
+
+  QUuid queryId = get(output, resource, parameters, rawHeaders);
+  if (!d->results.contains(queryId))
+    {
+    delete output;
+    return queryId;
+    }
+
+  output->setParent(d->results[queryId]);
+
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::download(const QString& fileName, const QString& resource,
+                         const Parameters& parameters, const RawHeaders& rawHeaders,
+                         const QByteArray& expectedChecksum,
+                         QCryptographicHash::Algorithm algorithm)
+{
+  Q_D(qRestAPI);
+  if (d->BlobStore && d->BlobStore->retrieve(expectedChecksum, algorithm, fileName))
+    {
+    // The query is completed without sending any request.
+    return d->unsentQuery("GET", this->createUrl(resource, parameters),
+                          QString(), qRestAPI::UnknownError);
+    }
+
+  QUuid queryId = this->download(fileName, resource, parameters, rawHeaders);
+  this->setExpectedChecksum(queryId, algorithm, expectedChecksum);
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+qRestPreparedRequest qRestAPI::prepare(QNetworkAccessManager::Operation operation,
+                                       const QString& resource,
+                                       const QStringList& parameterNames,
+                                       const RawHeaders& rawHeaders)
+{
+  qRestPreparedRequest prepared;
+  prepared.Valid = true;
+  prepared.Operation = operation;
+  prepared.Resource = resource;
+  prepared.ParameterNames = parameterNames;
+  prepared.RawHeaders = rawHeaders;
+  foreach(const QString& name, parameterNames)
+    {
+    prepared.EncodedNames << QUrl::toPercentEncoding(name) + '=';
+    }
+  return prepared;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::execute(const qRestPreparedRequest& prepared, const QStringList& values,
+                        const QByteArray& data)
+{
+  Q_D(qRestAPI);
+  if (!prepared.isValid())
+    {
+    return d->failedQuery("Invalid prepared request", UnknownError);
+    }
+  if (prepared.Generation != d->RequestGeneration)
+    {
+    // The URL is composed by createUrl() so that subclasses can add their
+    // own path and parameters.
+    QUrl url = this->createUrl(prepared.Resource, Parameters());
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    prepared.BaseQuery = url.query(QUrl::FullyEncoded).toLatin1();
+    url.setQuery(QString());
+#else
+    prepared.BaseQuery = url.encodedQuery();
+    url.setEncodedQuery(QByteArray());
+#endif
+    prepared.BaseUrl = url;
+    prepared.Request = d->createBaseRequest(prepared.RawHeaders);
+    prepared.Generation = d->RequestGeneration;
+    }
+
+  qint64 queued = qRestTiming::now();
+  qRestSpan span = d->createSpan();
+
+  QByteArray query = prepared.BaseQuery;
+  for (int index = 0; index < prepared.EncodedNames.size(); ++index)
+    {
+    if (!query.isEmpty())
       {
-    case QNetworkReply::TimeoutError:
-      errorCode = qRestAPI::TimeoutError;
-      break;
-    case QNetworkReply::SslHandshakeFailedError:
-      errorCode = qRestAPI::SslError;
-      break;
-    case QNetworkReply::AuthenticationRequiredError:
-      errorCode = qRestAPI::AuthenticationError;
-      break;
-    default:
-      ;
+      query += '&';
       }
-    restResult->setError(queryId.toString() + ": " +
-                         QString::number(static_cast<int>(reply->error())) + ": " +
-                         reply->errorString(),
-                         errorCode);
+    query += prepared.EncodedNames.at(index);
+    query += QUrl::toPercentEncoding(values.value(index));
     }
-  else
+  QUrl url = prepared.BaseUrl;
+  if (!query.isEmpty())
     {
-    restResult->Reponse = reply->readAll();
-    q->parseResponse(restResult, restResult->response());
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    url.setQuery(QString::fromLatin1(query));
+#else
+    url.setEncodedQuery(query);
+#endif
     }
 
-  #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
-    foreach(const QNetworkReply::RawHeaderPair& rawHeaderPair, reply->rawHeaderPairs())
+  QNetworkRequest queryRequest = prepared.Request;
+  queryRequest.setUrl(url);
+  d->setTraceContext(queryRequest, span);
+
+  QNetworkReply* queryReply = d->sendQuery(prepared.Operation, queryRequest, data);
+  if (!queryReply)
+    {
+    return d->failedQuery("Unsupported operation", UnknownError);
+    }
+  d->registerReply(queryReply, prepared.Operation, queued, span);
+
+  qRestResult* result = d->replyResult(queryReply);
+  result->Operation = prepared.Operation;
+  result->RequestHeaders = prepared.RawHeaders;
+  result->RequestBody = data;
+  result->Resendable = true;
+
+  return result->queryId();
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::del(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  QUrl url = createUrl(resource, parameters);
+  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::DeleteOperation, url, rawHeaders);
+  QUuid queryId(queryReply->property("uuid").toString());
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::post(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  QUrl url = createUrl(resource, parameters);
+  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::PostOperation, url, rawHeaders);
+  QUuid queryId(queryReply->property("uuid").toString());
+  return queryId;
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::put(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  QUrl url = createUrl(resource, parameters);
+  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::PutOperation, url, rawHeaders);
+  QUuid queryId(queryReply->property("uuid").toString());
+  return queryId;
+}
+
+QUuid qRestAPI::put(QIODevice *input, const QString &resource, const qRestAPI::Parameters &parameters, const qRestAPI::RawHeaders &rawHeaders)
+{
+  Q_D(qRestAPI);
+  return d->sendDevice(QNetworkAccessManager::PutOperation, input, resource, parameters, rawHeaders);
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::post(QIODevice* input, const QString& resource, const Parameters& parameters, const RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  return d->sendDevice(QNetworkAccessManager::PostOperation, input, resource, parameters, rawHeaders);
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::post(const QString& resource, const QVariantMap& body, BodyEncoding encoding,
+                     const Parameters& parameters, const RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  return d->sendBody(QNetworkAccessManager::PostOperation, resource, body, encoding,
+                     parameters, rawHeaders);
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::put(const QString& resource, const QVariantMap& body, BodyEncoding encoding,
+                    const Parameters& parameters, const RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  return d->sendBody(QNetworkAccessManager::PutOperation, resource, body, encoding,
+                     parameters, rawHeaders);
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+// --------------------------------------------------------------------------
+QUuid qRestAPI::post(QHttpMultiPart* multiPart, const QString& resource,
+                     const Parameters& parameters, const RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  return d->sendMultiPart(QNetworkAccessManager::PostOperation, multiPart, resource,
+                          parameters, rawHeaders);
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::put(QHttpMultiPart* multiPart, const QString& resource,
+                    const Parameters& parameters, const RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  return d->sendMultiPart(QNetworkAccessManager::PutOperation, multiPart, resource,
+                          parameters, rawHeaders);
+}
+
+// --------------------------------------------------------------------------
+QHttpMultiPart* qRestAPI::createFormData(const QVariantMap& fields,
+                                         const QMap<QString, QString>& files)
+{
+  QScopedPointer<QHttpMultiPart> multiPart(new QHttpMultiPart(QHttpMultiPart::FormDataType));
+  for (QVariantMap::const_iterator it = fields.constBegin(); it != fields.constEnd(); ++it)
+    {
+    foreach(const QString& text, formFieldTexts(it.value()))
       {
-      restResult->setRawHeader(rawHeaderPair.first, rawHeaderPair.second);
+      QHttpPart part;
+      part.setHeader(QNetworkRequest::ContentDispositionHeader,
+                     "form-data; name=" + quotedFormName(it.key()));
+      part.setBody(text.toUtf8());
+      multiPart->append(part);
       }
-  #else
-    foreach(const QByteArray& headerName, reply->rawHeaderList())
+    }
+  for (QMap<QString, QString>::const_iterator it = files.constBegin(); it != files.constEnd(); ++it)
+    {
+    QFile* file = new QFile(it.value(), multiPart.data());
+    if (!file->open(QIODevice::ReadOnly))
       {
-      restResult->setRawHeader(headerName, reply->rawHeader(headerName));
+      return 0;
       }
-  #endif
-
-  reply->close();
-  reply->deleteLater();
-
-  q->emit finished(queryId);
+    QHttpPart part;
+    part.setHeader(QNetworkRequest::ContentDispositionHeader,
+                   "form-data; name=" + quotedFormName(it.key()) +
+                   "; filename=" + quotedFormName(QFileInfo(it.value()).fileName()));
+    part.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    part.setBodyDevice(file);
+    multiPart->append(part);
+    }
+  return multiPart.take();
 }
+#endif
 
-void qRestAPIPrivate::onSslErrors(QNetworkReply* reply, const QList<QSslError>& errors)
+// --------------------------------------------------------------------------
+QByteArray qRestAPI::encodeBody(const QVariantMap& body, BodyEncoding encoding)
 {
-#ifdef QRESTAPI_QT_NO_SSL
-  Q_UNUSED(reply)
-  Q_UNUSED(errors)
-#else
-  if (!this->SuppressSslErrors)
+  switch (encoding)
     {
-    QString errorString;
-    foreach (const QSslError& error, errors)
+    case FormUrlEncoded:
       {
-      if (!errorString.isEmpty())
+      // Not null, even if empty.
+      QByteArray data("");
+      for (QVariantMap::const_iterator it = body.constBegin(); it != body.constEnd(); ++it)
         {
-        errorString.append(", ");
+        foreach(const QString& text, formFieldTexts(it.value()))
+          {
+          if (!data.isEmpty())
+            {
+            data += '&';
+            }
+          data += QUrl::toPercentEncoding(it.key()) + '=' + QUrl::toPercentEncoding(text);
+          }
         }
-      errorString.append(error.errorString());
+      return data;
+      }
+    case JsonEncoded:
+      {
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+      return QJsonDocument(QJsonObject::fromVariantMap(body)).toJson(QJsonDocument::Compact);
+#else
+      QScriptEngine scriptEngine;
+      return scriptEngine.evaluate("JSON.stringify")
+        .call(QScriptValue(), QScriptValueList() << scriptEngine.toScriptValue(body))
+        .toString().toUtf8();
+#endif
       }
+    case CborEncoded:
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+      return QCborValue::fromVariant(body).toCbor();
+#else
+      break;
+#endif
+    }
+  return QByteArray();
+}
+
+// --------------------------------------------------------------------------
+QByteArray qRestAPI::bodyContentType(BodyEncoding encoding)
+{
+  switch (encoding)
+    {
+    case FormUrlEncoded:
+      return "application/x-www-form-urlencoded";
+    case JsonEncoded:
+      return "application/json";
+    case CborEncoded:
+      return "application/cbor";
+    }
+  return QByteArray();
+}
+
+// --------------------------------------------------------------------------
+QUuid qRestAPI::upload(const QString& fileName, const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+{
+  Q_D(qRestAPI);
+  QIODevice* input = new QFile(fileName);
+
+  QUuid queryId = this->put(input, resource, parameters, rawHeaders);
+
+  input->setParent(d->results[queryId]);
+
+  return queryId;
+}
 
-    QString plural(errors.empty() ? " has" : "s have");
-    QString error = QString("SSL error%1 occurred: %2").arg(plural).arg(errorString);
+// --------------------------------------------------------------------------
+QUuid qRestAPI::upload(const QString& fileName, const QString& resource,
+                       const Parameters& parameters, const RawHeaders& rawHeaders,
+                       const QByteArray& expectedChecksum,
+                       QCryptographicHash::Algorithm algorithm)
+{
+  Q_D(qRestAPI);
+  QIODevice* input = new QFile(fileName);
 
-    QUuid queryId(reply->property("uuid").toString());
-    qRestResult* restResult = results[queryId];
+  QUuid queryId = d->sendDevice(QNetworkAccessManager::PutOperation, input, resource,
+                                parameters, rawHeaders, algorithm, expectedChecksum);
 
-    restResult->setError(error, qRestAPI::SslError);
-    }
-  else
-    {
-    reply->ignoreSslErrors();
-    }
-#endif
+  input->setParent(d->results[queryId]);
+
+  return queryId;
 }
 
 // --------------------------------------------------------------------------
-void qRestAPIPrivate::queryProgress(qint64 bytesTransmitted, qint64 bytesTotal)
+QList<QCryptographicHash::Algorithm> qRestAPI::checksumAlgorithms()const
 {
-  Q_UNUSED(bytesTransmitted);
-  Q_UNUSED(bytesTotal);
-  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
-  // We received some progress so we postpone the timeout if any.
-  QTimer* timer = reply->findChild<QTimer*>();
-  if (timer)
-    {
-    timer->start();
-    }
+  Q_D(const qRestAPI);
+  return d->ChecksumAlgorithms;
 }
 
 // --------------------------------------------------------------------------
-void qRestAPIPrivate::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+void qRestAPI::setChecksumAlgorithms(const QList<QCryptographicHash::Algorithm>& algorithms)
 {
-  Q_Q(qRestAPI);
-  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
-  QUuid queryId(reply->property("uuid").toString());
-  double progress = static_cast<double>(bytesReceived) / bytesTotal;
-  q->emit progress(queryId, progress);
+  Q_D(qRestAPI);
+  d->ChecksumAlgorithms = algorithms;
 }
 
 // --------------------------------------------------------------------------
-void qRestAPIPrivate::uploadProgress(qint64 bytesSent, qint64 bytesTotal)
+bool qRestAPI::traceContextPropagation()const
 {
-  Q_Q(qRestAPI);
-  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
-  Q_ASSERT(reply);
-  if (!reply)
+  Q_D(const qRestAPI);
+  return d->TraceContextPropagation;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setTraceContextPropagation(bool propagate)
+{
+  Q_D(qRestAPI);
+  d->TraceContextPropagation = propagate;
+}
+
+// --------------------------------------------------------------------------
+QByteArray qRestAPI::parentTraceContext()const
+{
+  Q_D(const qRestAPI);
+  if (d->ParentSpan.TraceId.isEmpty())
     {
-    return;
+    return QByteArray();
     }
-  QUuid queryId(reply->property("uuid").toString());
-  double progress = static_cast<double>(bytesSent) / bytesTotal;
-  q->emit progress(queryId, progress);
+  qRestSpan parent = d->ParentSpan;
+  parent.SpanId = parent.ParentSpanId;
+  return parent.traceParent();
 }
 
 // --------------------------------------------------------------------------
-void qRestAPIPrivate::queryTimeOut()
+bool qRestAPI::setParentTraceContext(const QByteArray& traceParent)
 {
-  QTimer* timer = qobject_cast<QTimer*>(this->sender());
-  Q_ASSERT(timer);
-  QNetworkReply* reply = qobject_cast<QNetworkReply*>(timer->parent());
-  Q_ASSERT(reply);
-  reply->abort();
-  //reply->setError(QNetworkReply::TimeoutError,
-  //   q->tr("Time out: No progress for %1 seconds.").arg(timer->interval()));
+  Q_D(qRestAPI);
+  qRestSpan parent = qRestSpan::fromTraceParent(traceParent);
+  if (!traceParent.isEmpty() && parent.TraceId.isEmpty())
+    {
+    return false;
+    }
+  d->ParentSpan = parent;
+  return true;
 }
 
 // --------------------------------------------------------------------------
-// qRestAPI methods
+qRestTracer* qRestAPI::tracer()const
+{
+  Q_D(const qRestAPI);
+  return d->Tracer;
+}
 
 // --------------------------------------------------------------------------
-qRestAPI::qRestAPI(QObject* _parent)
-  : Superclass(_parent)
-  , d_ptr(new qRestAPIPrivate(this))
+void qRestAPI::setTracer(qRestTracer* tracer)
 {
   Q_D(qRestAPI);
-  d->init();
+  d->Tracer = tracer;
 }
 
 // --------------------------------------------------------------------------
-qRestAPI::~qRestAPI()
+int qRestAPI::progressInterval()const
 {
+  Q_D(const qRestAPI);
+  return d->ProgressInterval;
 }
 
 // --------------------------------------------------------------------------
-QString qRestAPI::serverUrl()const
+void qRestAPI::setProgressInterval(int msecs)
 {
-  Q_D(const qRestAPI);
-  return d->ServerUrl;
+  Q_D(qRestAPI);
+  d->ProgressInterval = qMax(0, msecs);
 }
 
 // --------------------------------------------------------------------------
-void qRestAPI::setServerUrl(const QString& serverUrl)
+bool qRestAPI::setProgressInterval(const QUuid& queryId, int msecs)
 {
   Q_D(qRestAPI);
-  d->ServerUrl = serverUrl;
+  qRestResult* result = d->results.value(queryId);
+  if (!result)
+    {
+    return false;
+    }
+  result->ProgressInterval = qMax(0, msecs);
+  return true;
 }
 
 // --------------------------------------------------------------------------
-int qRestAPI::timeOut()const
+qRestMetrics* qRestAPI::metrics()const
 {
   Q_D(const qRestAPI);
-  return d->TimeOut;
+  return d->Metrics.data();
 }
 
 // --------------------------------------------------------------------------
-void qRestAPI::setTimeOut(int msecs)
+qint64 qRestAPI::streamingBufferSize()const
+{
+  Q_D(const qRestAPI);
+  return d->StreamingBufferSize;
+}
+
+// --------------------------------------------------------------------------
+void qRestAPI::setStreamingBufferSize(qint64 size)
 {
   Q_D(qRestAPI);
-  d->TimeOut = msecs;
+  d->StreamingBufferSize = qMax(qint64(0), size);
 }
 
 // --------------------------------------------------------------------------
-qRestAPI::RawHeaders qRestAPI::defaultRawHeaders()const
+qint64 qRestAPI::downloadRateLimit()const
 {
   Q_D(const qRestAPI);
-  return d->DefaultRawHeaders;
+  return d->DownloadBucket.rate();
 }
 
 // --------------------------------------------------------------------------
-void qRestAPI::setDefaultRawHeaders(const qRestAPI::RawHeaders& defaultRawHeaders)
+void qRestAPI::setDownloadRateLimit(qint64 bytesPerSecond)
 {
   Q_D(qRestAPI);
-  d->DefaultRawHeaders = defaultRawHeaders;
+  d->DownloadBucket.setRate(bytesPerSecond);
+  foreach(qRestResult* result, d->results)
+    {
+    result->updateReadBufferSize();
+    }
 }
 
 // --------------------------------------------------------------------------
-bool qRestAPI::suppressSslErrors()const
+qint64 qRestAPI::uploadRateLimit()const
 {
   Q_D(const qRestAPI);
-  return d->SuppressSslErrors;
+  return d->UploadBucket.rate();
 }
 
 // --------------------------------------------------------------------------
-void qRestAPI::setSuppressSslErrors(bool suppressSslErrors)
+void qRestAPI::setUploadRateLimit(qint64 bytesPerSecond)
 {
   Q_D(qRestAPI);
-  d->SuppressSslErrors = suppressSslErrors;
+  d->UploadBucket.setRate(bytesPerSecond);
 }
 
 // --------------------------------------------------------------------------
-QUrl qRestAPI::createUrl(const QString& resource, const qRestAPI::Parameters& parameters)
+bool qRestAPI::setDownloadRateLimit(const QUuid& queryId, qint64 bytesPerSecond)
 {
   Q_D(qRestAPI);
-  QUrl url(d->ServerUrl + resource);
-#if (QT_VERSION < QT_VERSION_CHECK(5,0,0))
-  foreach(const QString& parameter, parameters.keys())
+  qRestResult* result = d->results.value(queryId);
+  if (!result || !result->DownloadReply)
     {
-    url.addQueryItem(parameter, parameters[parameter]);
+    return false;
     }
-#else
-  QUrlQuery urlQuery(url);
-  foreach(const QString& parameter, parameters.keys())
+  result->DownloadBucket.setRate(bytesPerSecond);
+  result->updateReadBufferSize();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestAPI::setUploadRateLimit(const QUuid& queryId, qint64 bytesPerSecond)
+{
+  Q_D(qRestAPI);
+  qRestResult* result = d->results.value(queryId);
+  if (!result || result->DownloadReply || !result->ioDevice)
     {
-    urlQuery.addQueryItem(parameter, parameters[parameter]);
+    return false;
     }
-  url.setQuery(urlQuery);
-#endif
-  return url;
+  result->UploadBucket.setRate(bytesPerSecond);
+  return true;
 }
 
 // --------------------------------------------------------------------------
-void qRestAPI::parseResponse(qRestResult* restResult, const QByteArray& response)
+double qRestAPI::hedgePercentile()const
 {
-  Q_UNUSED(response);
-  QList<QVariantMap> result;
-  restResult->setResult(result);
+  Q_D(const qRestAPI);
+  return d->HedgePercentile;
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::get(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+void qRestAPI::setHedgePercentile(double percentile)
 {
-  QUrl url = createUrl(resource, parameters);
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::GetOperation, url, rawHeaders);
-  QUuid queryId(queryReply->property("uuid").toString());
-  return queryId;
+  Q_D(qRestAPI);
+  d->HedgePercentile = qBound(0., percentile, 1.);
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::get(QIODevice* output, const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+int qRestAPI::hedgeMinimumDelay()const
 {
-  Q_D(qRestAPI);
+  Q_D(const qRestAPI);
+  return d->HedgeMinimumDelay;
+}
 
-  QUrl url = createUrl(resource, parameters);
+// --------------------------------------------------------------------------
+void qRestAPI::setHedgeMinimumDelay(int msecs)
+{
+  Q_D(qRestAPI);
+  d->HedgeMinimumDelay = qMax(msecs, 0);
+}
 
-  if (!output->open(QIODevice::WriteOnly))
-    {
-    QUuid queryId;
-    // TODO How to raise the error? We do not have a qRestResult object yet...
-    //    emit errorReceived(queryId, "Cannot open device for writing.");
-    return queryId;
-    }
+// --------------------------------------------------------------------------
+double qRestAPI::maximumHedgeRatio()const
+{
+  Q_D(const qRestAPI);
+  return d->MaximumHedgeRatio;
+}
 
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::GetOperation, url, rawHeaders);
-  QUuid queryId = QUuid(queryReply->property("uuid").toString());
-  qRestResult* result = new qRestResult(queryId, queryReply);
-  result->ioDevice = output;
+// --------------------------------------------------------------------------
+void qRestAPI::setMaximumHedgeRatio(double ratio)
+{
+  Q_D(qRestAPI);
+  d->MaximumHedgeRatio = qMax(ratio, 0.);
+}
 
-  connect(queryReply, SIGNAL(downloadProgress(qint64,qint64)),
-          d, SLOT(downloadProgress(qint64,qint64)));
-  connect(queryReply, SIGNAL(readyRead()),
-          result, SLOT(downloadReadyRead()));
-  connect(queryReply, SIGNAL(finished()),
-          result, SLOT(downloadFinished()));
+// --------------------------------------------------------------------------
+qint64 qRestAPI::hedgesFired()const
+{
+  Q_D(const qRestAPI);
+  return d->HedgesFired;
+}
 
-  return queryId;
+// --------------------------------------------------------------------------
+qint64 qRestAPI::hedgesWon()const
+{
+  Q_D(const qRestAPI);
+  return d->HedgesWon;
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::head(const QString  resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+qRestBlobStore* qRestAPI::blobStore()const
 {
-  QUrl url = createUrl(resource, parameters);
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::HeadOperation, url, rawHeaders);
-  QUuid queryId = QUuid(queryReply->property("uuid").toString());
-  return queryId;
+  Q_D(const qRestAPI);
+  return d->BlobStore;
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::download(const QString& fileName, const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+void qRestAPI::setBlobStore(qRestBlobStore* store)
 {
-  Q_UNUSED(rawHeaders);
   Q_D(qRestAPI);
+  d->BlobStore = store;
+}
 
-  QIODevice* output = new QFile(fileName);
-
-  QUuid queryId = get(output, resource, parameters);
-
-  output->setParent(d->results[queryId]);
-
-  return queryId;
+// --------------------------------------------------------------------------
+qRestCircuitBreaker* qRestAPI::circuitBreaker()const
+{
+  Q_D(const qRestAPI);
+  return d->CircuitBreaker;
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::del(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+void qRestAPI::setCircuitBreaker(qRestCircuitBreaker* breaker)
 {
-  QUrl url = createUrl(resource, parameters);
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::DeleteOperation, url, rawHeaders);
-  QUuid queryId(queryReply->property("uuid").toString());
-  return queryId;
+  Q_D(qRestAPI);
+  d->CircuitBreaker = breaker;
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::post(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+bool qRestAPI::holdFailedQuery(const QUuid& queryId, QNetworkReply* reply)
 {
-  QUrl url = createUrl(resource, parameters);
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::PostOperation, url, rawHeaders);
-  QUuid queryId(queryReply->property("uuid").toString());
-  return queryId;
+  Q_UNUSED(queryId);
+  Q_UNUSED(reply);
+  return false;
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::put(const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+bool qRestAPI::canHedgeQuery(const QNetworkRequest& request)
 {
-  QUrl url = createUrl(resource, parameters);
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::PutOperation, url, rawHeaders);
-  QUuid queryId(queryReply->property("uuid").toString());
-  return queryId;
+  Q_UNUSED(request);
+  return true;
 }
 
-QUuid qRestAPI::put(QIODevice *input, const QString &resource, const qRestAPI::Parameters &parameters, const qRestAPI::RawHeaders &rawHeaders)
+// --------------------------------------------------------------------------
+bool qRestAPI::resendQuery(const QUuid& queryId)
 {
   Q_D(qRestAPI);
-
-  QUrl url = createUrl(resource, parameters);
-  if (!input->isOpen() && !input->open(QIODevice::ReadOnly))
+  qRestResult* result = d->results.value(queryId);
+  if (!result || result->done || !result->Resendable)
+    {
+    return false;
+    }
+  QNetworkRequest queryRequest = d->createRequest(result->Url, result->RequestHeaders, result->Span);
+  QNetworkReply* queryReply = d->sendQuery(result->Operation, queryRequest, result->RequestBody);
+  if (!queryReply)
     {
-    QUuid uid = QUuid::createUuid();
-    qRestResult* restResult = new qRestResult(uid);
-    restResult->setError(uid.toString() + ": " +
-                         "Could not open file for upload!",
-                         qRestAPI::FileError);
-    d->results[uid] = restResult;
-    return uid;
+    return false;
     }
+  d->registerReply(queryReply, result->Operation, result->Timing.Queued, result->Span, result);
+  return true;
+}
 
-  QByteArray data = input->readAll();
+// --------------------------------------------------------------------------
+void qRestAPI::failQuery(const QUuid& queryId, const QString& error, ErrorType errorCode)
+{
+  Q_D(qRestAPI);
+  qRestResult* result = d->results.value(queryId);
+  if (!result || result->done)
+    {
+    return;
+    }
+  result->setError(queryId.toString() + ": " + error, errorCode);
+  d->reportFinished(queryId, result);
+}
 
-  QNetworkReply* queryReply = sendRequest(QNetworkAccessManager::PutOperation, url, rawHeaders, data);
-  QUuid queryId (queryReply->property("uuid").toString());
+// --------------------------------------------------------------------------
+bool qRestAPI::startRecording(const QString& fileName)
+{
+  Q_D(qRestAPI);
+  this->stopRecording();
+  QScopedPointer<QFile> file(new QFile(fileName));
+  if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  d->RecordingStream.setDevice(file.data());
+  qRestRecord::writeHeader(d->RecordingStream);
+  d->RecordingFile.reset(file.take());
+  d->RecordingStart = qRestTiming::now();
+  return true;
+}
 
-  qRestResult* result = d->results[queryId];
-  result->ioDevice = input;
-  connect(queryReply, SIGNAL(uploadProgress(qint64,qint64)),
-          d, SLOT(uploadProgress(qint64,qint64)));
-  connect(queryReply, SIGNAL(finished()),
-          result, SLOT(uploadFinished()));
+// --------------------------------------------------------------------------
+void qRestAPI::stopRecording()
+{
+  Q_D(qRestAPI);
+  if (!d->RecordingFile)
+    {
+    return;
+    }
+  d->RecordingStream.setDevice(NULL);
+  d->RecordingFile->close();
+  d->RecordingFile.reset();
+}
 
-  return queryId;
+// --------------------------------------------------------------------------
+bool qRestAPI::isRecording()const
+{
+  Q_D(const qRestAPI);
+  return !d->RecordingFile.isNull();
 }
 
 // --------------------------------------------------------------------------
-QUuid qRestAPI::upload(const QString& fileName, const QString& resource, const Parameters& parameters, const qRestAPI::RawHeaders& rawHeaders)
+bool qRestAPI::startReplay(const QString& fileName, double speed)
 {
   Q_D(qRestAPI);
-  QIODevice* input = new QFile(fileName);
+  QScopedPointer<qRestReplayNetworkAccessManager> manager(new qRestReplayNetworkAccessManager);
+  if (!manager->load(fileName))
+    {
+    return false;
+    }
+  manager->setSpeed(speed);
+  this->stopReplay();
+  d->ReplayManager = manager.take();
+  QObject::connect(d->ReplayManager, SIGNAL(finished(QNetworkReply*)),
+                   d, SLOT(processReply(QNetworkReply*)));
+  return true;
+}
 
-  QUuid queryId = this->put(input, resource, parameters, rawHeaders);
+// --------------------------------------------------------------------------
+void qRestAPI::stopReplay()
+{
+  Q_D(qRestAPI);
+  if (!d->ReplayManager)
+    {
+    return;
+    }
+  // Replies in progress are deleted with the manager, they are aborted so
+  // that their queries finish.
+  foreach(qRestCannedReply* reply, d->ReplayManager->findChildren<qRestCannedReply*>())
+    {
+    reply->abort();
+    }
+  d->ReplayManager->deleteLater();
+  d->ReplayManager = NULL;
+}
 
-  input->setParent(d->results[queryId]);
+// --------------------------------------------------------------------------
+qRestReplayNetworkAccessManager* qRestAPI::replayManager()const
+{
+  Q_D(const qRestAPI);
+  return d->ReplayManager;
+}
 
-  return queryId;
+// --------------------------------------------------------------------------
+bool qRestAPI::setExpectedChecksum(const QUuid& queryId,
+                                   QCryptographicHash::Algorithm algorithm,
+                                   const QByteArray& checksum)
+{
+  Q_D(qRestAPI);
+  qRestResult* result = d->results.value(queryId);
+  if (!result || result->done)
+    {
+    return false;
+    }
+  result->setExpectedChecksum(algorithm, checksum);
+  return true;
 }
 
 // --------------------------------------------------------------------------
@@ -622,15 +3172,15 @@ bool qRestAPI::sync(const QUuid& queryId, QList<QVariantMap>& result)
     {
     bool ok = d->results[queryId]->waitForDone();
     qRestResult* queryResult = d->results.take(queryId);
+    result = queryResult->results();
     if (!ok)
       {
       QVariantMap map;
       map["queryError"] = queryResult->Error;
-      queryResult->Result.push_front(map);
+      result.push_front(map);
       d->ErrorCode = queryResult->errorType();
       d->ErrorString = queryResult->error();
       }
-    result = queryResult->Result;
     delete queryResult;
     return ok;
     }
@@ -22,6 +22,7 @@
 #define __qRestAPI_h
 
 // Qt includes
+#include <QCryptographicHash>
 #include <QObject>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -38,10 +39,19 @@
 template <class Key, class T> class QMap;
 typedef QMap<QString, QVariant> QVariantMap;
 
+class QHttpMultiPart;
 class QNetworkReply;
 class qRestAPIPrivate;
 
+class qRestBlobStore;
+class qRestCircuitBreaker;
+class qRestCompactResult;
+class qRestMetrics;
+class qRestPreparedRequest;
+class qRestReplayNetworkAccessManager;
+class qRestResponseParser;
 class qRestResult;
+class qRestTracer;
 
 /// qRestAPI is a simple interface class to communicate with web services
 /// through a public RESTful API.
@@ -78,6 +88,81 @@ class qRestAPI_EXPORT qRestAPI : public QObject
   /// Suppress SSL errors. Can be used to bypass self-signed certificates.
   Q_PROPERTY(bool suppressSslErrors READ suppressSslErrors WRITE setSuppressSslErrors)
 
+  /// Store parsed results as a qRestCompactResult instead of a list of
+  /// QVariantMap. This reduces memory usage for large listings. It is only
+  /// honored by parsers supporting it (e.g. qGirderAPI).
+  /// \sa qRestResult::compactResults()
+  Q_PROPERTY(bool compactResults READ compactResults WRITE setCompactResults)
+
+  /// Write downloaded files using memory mapping instead of buffered writes.
+  /// It is only used when the size of the file is known in advance.
+  /// \sa qRestFileSink::MemoryMappedWrites
+  Q_PROPERTY(bool memoryMappedDownloads READ memoryMappedDownloads WRITE setMemoryMappedDownloads)
+
+  /// Adds a W3C "traceparent" header to the requests so that they can be
+  /// correlated with the server logs, unless the header is already set
+  /// explicitly. False by default.
+  /// \sa setParentTraceContext(), qRestResult::span()
+  Q_PROPERTY(bool traceContextPropagation READ traceContextPropagation WRITE setTraceContextPropagation)
+
+  /// Minimum interval in milliseconds between two progress() signals of a
+  /// query, and between two aggregateProgress() signals. 0 (default) emits
+  /// them for every chunk of data transferred.
+  Q_PROPERTY(int progressInterval READ progressInterval WRITE setProgressInterval)
+
+  /// Maximum number of bytes buffered in memory by get(QIODevice*) and
+  /// download(), both by the reply and by the output device. When the output
+  /// device has streamingBufferSize bytes to write (see
+  /// QIODevice::bytesToWrite()), reading is paused until the device emits
+  /// bytesWritten(). It applies to the queries sent after it is set.
+  /// 0 (default) means no limit: the reply buffers everything that the
+  /// output device does not consume.
+  Q_PROPERTY(qint64 streamingBufferSize READ streamingBufferSize WRITE setStreamingBufferSize)
+
+  /// Maximum rate in bytes per second of the data received by get(QIODevice*)
+  /// and download(), shared by all the queries. 0 (default) means no limit.
+  Q_PROPERTY(qint64 downloadRateLimit READ downloadRateLimit WRITE setDownloadRateLimit)
+
+  /// Maximum rate in bytes per second of the data sent by put(QIODevice*)
+  /// and upload(), shared by all the queries. 0 (default) means no limit.
+  Q_PROPERTY(qint64 uploadRateLimit READ uploadRateLimit WRITE setUploadRateLimit)
+
+  /// Hedges the queries sent by get() and head(): when a query is not
+  /// finished after the hedgePercentile latency of its method and resource
+  /// pattern (see qRestMetrics::latencyPercentile()), the same request is
+  /// sent again. The first response received is used, the other request is
+  /// aborted. A failed response is only used if the other request failed
+  /// too. Queries are hedged once metrics() has recorded 10 queries of the
+  /// same method and resource pattern.
+  /// 0 (default) disables hedging, e.g. 0.95 hedges the queries slower than
+  /// 95% of the previous ones.
+  /// get(QIODevice*), download() and the other methods are not hedged, nor
+  /// the requests for which canHedgeQuery() returns false.
+  /// \sa hedgesFired(), hedgesWon()
+  Q_PROPERTY(double hedgePercentile READ hedgePercentile WRITE setHedgePercentile)
+
+  /// Minimum time in milliseconds before a query is hedged, 10 by default.
+  Q_PROPERTY(int hedgeMinimumDelay READ hedgeMinimumDelay WRITE setHedgeMinimumDelay)
+
+  /// Maximum ratio of hedged queries to the queries that could be hedged,
+  /// which caps the extra load on the server. 0.05 by default.
+  Q_PROPERTY(double maximumHedgeRatio READ maximumHedgeRatio WRITE setMaximumHedgeRatio)
+
+  /// Number of network managers sending the queries, 1 by default.
+  /// Each manager has its own connections, limited by Qt to 6 per host, and
+  /// with Qt >= 4.8 its own thread for the HTTP protocol, TLS and
+  /// decompression. Using more managers raises the number of concurrent
+  /// transfers to a host and spreads their processing across cores.
+  /// \sa setManagerSelectionPolicy()
+  Q_PROPERTY(int networkManagerCount READ networkManagerCount WRITE setNetworkManagerCount)
+
+  /// Send the queries using the network manager shared by the qRestAPI
+  /// objects of the current thread instead of managers owned by this
+  /// object, so that connections, TLS sessions, cache and proxy are shared.
+  /// networkManagerCount is then ignored. False by default.
+  /// \sa sharedNetworkManager()
+  Q_PROPERTY(bool sharedNetworkManagerUsed READ isSharedNetworkManagerUsed WRITE setSharedNetworkManagerUsed)
+
   typedef QObject Superclass;
 
 public:
@@ -98,10 +183,38 @@ public:
     AuthenticationError = 5,
     /// Error is raised if a file could not be opened
     FileError = 6,
+    /// The checksum of the transferred data does not match the expected one
+    IntegrityError = 7,
+    /// The query was not sent because the circuit breaker of its endpoint
+    /// is open
+    CircuitOpenError = 8,
     /// General network error not covered by more specific error types
     NetworkError = 100
   };
 
+  /// Encodings of the bodies of post() and put() requests.
+  enum BodyEncoding
+  {
+    /// "application/x-www-form-urlencoded". The values of a list are sent
+    /// with the same key, maps are sent as JSON text.
+    FormUrlEncoded = 0,
+    /// "application/json"
+    JsonEncoded,
+    /// "application/cbor", requires Qt >= 5.12.
+    CborEncoded
+  };
+
+  /// Policies used to choose the network manager sending a query when
+  /// networkManagerCount() is greater than 1.
+  enum ManagerSelectionPolicy
+  {
+    /// The manager with the fewest queries in progress.
+    LeastLoadedManager = 0,
+    /// A manager chosen from a hash of the URL of the query, so that
+    /// queries to the same URL reuse the same connections.
+    HashedManager
+  };
+
   /// Constructs a qRestAPI object.
   explicit qRestAPI(QObject*parent = 0);
   /// Destructs a qRestAPI object.
@@ -114,12 +227,62 @@ public:
 
   /// Returns the URL of the web application.
   QString serverUrl()const;
-  /// Sets the URL of the web application.
+  /// Sets the URL of the web application. It replaces the server set.
   void setServerUrl(const QString& serverUrl);
 
-  /// Sets the HTTP network proxy that will be used for all queries
+  /// Returns the URLs of the replicas of the web application.
+  QStringList serverUrls()const;
+  /// Sets the URLs of replicas serving the same resources, e.g. Girder
+  /// replicas and mirrors. serverUrl() becomes the first one.
+  ///
+  /// URLs are composed using serverUrl() and rewritten when the request is
+  /// sent:
+  /// - GET and HEAD requests go to the faster of two healthy servers picked
+  ///   at random, using a moving average of their latency, so that the load
+  ///   spreads across the replicas.
+  /// - Other requests stick to one healthy server, in the order of the set,
+  ///   so that writes are read back consistently.
+  /// A server that does not answer or answers with a 5xx status is avoided
+  /// for serverRetryInterval() milliseconds. The query is sent again to
+  /// another server if it is a GET or HEAD request, or if the request could
+  /// not be delivered (connection refused, host not found, open circuit
+  /// breaker), once per other server.
+  /// Queries sent later, e.g. queued or retried by qRestBulkDownloader or
+  /// qGirderUploader, go to healthy servers.
+  void setServerUrls(const QStringList& serverUrls);
+
+  /// Time in milliseconds a failing server is avoided, 30000 by default.
+  int serverRetryInterval()const;
+  void setServerRetryInterval(int msecs);
+
+  /// Returns one map per server with the keys "url", "healthy", "latency"
+  /// (moving average in milliseconds, -1 if unknown) and "failures"
+  /// (consecutive failed queries).
+  QList<QVariantMap> serverStatus()const;
+
+  /// Sets the HTTP network proxy that will be used for all queries.
+  /// The proxy of the shared network manager is set too if it is used.
   void setHttpNetworkProxy(const QNetworkProxy& proxy);
 
+  int networkManagerCount() const;
+  /// Sets the number of network managers. Managers removed from the pool
+  /// are deleted once their queries are finished. The managers share the
+  /// cookie jar and the proxy of the first one.
+  void setNetworkManagerCount(int count);
+
+  bool isSharedNetworkManagerUsed() const;
+  void setSharedNetworkManagerUsed(bool shared);
+  /// Returns the network manager shared by the qRestAPI objects of the
+  /// current thread, created the first time it is requested and deleted
+  /// when the thread finishes. It can be used to set a cache or a cookie jar
+  /// for all the objects.
+  static QNetworkAccessManager* sharedNetworkManager();
+
+  ManagerSelectionPolicy managerSelectionPolicy() const;
+  /// Sets how the network manager of a query is chosen.
+  /// LeastLoadedManager by default.
+  void setManagerSelectionPolicy(ManagerSelectionPolicy policy);
+
   /// Returns the raw headers that are set for every request.
   RawHeaders defaultRawHeaders()const;
   /// Sets the raw headers to be set for every request.
@@ -133,6 +296,95 @@ public:
   void setTimeOut(int msecs);
   int timeOut()const;
 
+  /// Tells if parsers should store results using qRestCompactResult.
+  bool compactResults()const;
+  /// Sets if parsers should store results using qRestCompactResult.
+  void setCompactResults(bool compactResults);
+
+  /// Registers \a parser for its content types, replacing the parsers
+  /// previously registered for them. The parser is owned by the qRestAPI
+  /// object. JSON, CBOR (Qt >= 5.12) and MessagePack parsers are registered
+  /// by default.
+  /// \sa qRestResponseParser, parseRegisteredResponse()
+  void registerResponseParser(qRestResponseParser* parser);
+  /// Removes the parser registered for the media type \a contentType.
+  void unregisterResponseParser(const QByteArray& contentType);
+  /// Returns the parser registered for the media type \a contentType, 0 if
+  /// none.
+  qRestResponseParser* responseParser(const QByteArray& contentType)const;
+
+  /// Media types sent in the Accept header of the requests, by order of
+  /// preference, e.g. "application/msgpack" before "application/json" to
+  /// receive smaller responses from servers supporting it. Empty by
+  /// default: no Accept header is sent. An "Accept" raw header of a request
+  /// takes precedence.
+  QList<QByteArray> acceptedContentTypes()const;
+  void setAcceptedContentTypes(const QList<QByteArray>& contentTypes);
+
+  /// Tells if downloaded files are written using memory mapping.
+  bool memoryMappedDownloads()const;
+  /// Sets if downloaded files are written using memory mapping.
+  void setMemoryMappedDownloads(bool memoryMapped);
+
+  int progressInterval()const;
+  void setProgressInterval(int msecs);
+  /// Sets the minimum interval between two progress() signals of the query
+  /// \a queryId, overriding the progressInterval property.
+  /// Returns false if \a queryId is unknown.
+  bool setProgressInterval(const QUuid& queryId, int msecs);
+
+  bool traceContextPropagation()const;
+  void setTraceContextPropagation(bool propagate);
+
+  /// Returns the "traceparent" value the queries are children of, empty if
+  /// each query starts a new trace.
+  QByteArray parentTraceContext()const;
+  /// Makes the spans of the next queries children of \a traceParent, e.g. the
+  /// context of the operation of the application that sends them. An empty
+  /// value makes each query start a new trace.
+  /// Returns false if \a traceParent is malformed.
+  bool setParentTraceContext(const QByteArray& traceParent);
+
+  /// Receives the spans of the queries. Not owned, 0 by default.
+  qRestTracer* tracer()const;
+  /// Sets the tracer. It must outlive the qRestAPI object or be unset before.
+  void setTracer(qRestTracer* tracer);
+
+  /// Returns the latency histograms and error counts of the finished
+  /// queries, per method and resource pattern.
+  /// \sa qRestResult::timing()
+  qRestMetrics* metrics()const;
+
+  qint64 streamingBufferSize()const;
+  void setStreamingBufferSize(qint64 size);
+
+  qint64 downloadRateLimit()const;
+  void setDownloadRateLimit(qint64 bytesPerSecond);
+  qint64 uploadRateLimit()const;
+  void setUploadRateLimit(qint64 bytesPerSecond);
+
+  /// Limits the download rate of the query \a queryId, in addition to the
+  /// downloadRateLimit shared by all the queries. It can be changed while
+  /// the data is transferred. 0 means no limit.
+  /// Returns false if \a queryId is unknown or is not a download.
+  bool setDownloadRateLimit(const QUuid& queryId, qint64 bytesPerSecond);
+  /// Limits the upload rate of the query \a queryId, in addition to the
+  /// uploadRateLimit shared by all the queries. It can be changed while
+  /// the data is transferred. 0 means no limit.
+  /// Returns false if \a queryId is unknown or is not an upload.
+  bool setUploadRateLimit(const QUuid& queryId, qint64 bytesPerSecond);
+
+  double hedgePercentile()const;
+  void setHedgePercentile(double percentile);
+  int hedgeMinimumDelay()const;
+  void setHedgeMinimumDelay(int msecs);
+  double maximumHedgeRatio()const;
+  void setMaximumHedgeRatio(double ratio);
+  /// Number of hedging requests sent.
+  qint64 hedgesFired()const;
+  /// Number of hedging requests whose response was used.
+  qint64 hedgesWon()const;
+
   /// Sends a GET request to the web service.
   /// The \a resource and \parameters are used to compose the URL.
   /// \a rawHeaders can be used to set the raw headers of the request to send.
@@ -167,7 +419,9 @@ public:
                               const RawHeaders& rawHeaders = RawHeaders());
 
   /// Downloads a file from the web service.
-  /// \a fileName is the name of the output file.
+  /// \a fileName is the name of the output file. The data is written into
+  /// a temporary file renamed into \a fileName once the download succeeded,
+  /// the file is not modified if the download fails.
   /// The \a resource and \parameters are used to compose the URL.
   /// \a rawHeaders can be used to set the raw headers of the request to send.
   /// These headers will be set additionally to those defined by the
@@ -182,6 +436,21 @@ public:
     const Parameters& parameters = Parameters(),
     const RawHeaders& rawHeaders = RawHeaders());
 
+  /// Downloads a file from the web service and verifies its checksum.
+  /// \a expectedChecksum is the hexadecimal digest of the file computed
+  /// using \a algorithm (e.g. the sha512 of a Girder file). The checksum is
+  /// computed while the data is received. If it does not match, the query
+  /// fails with an IntegrityError and \a fileName is not modified.
+  /// If a blob store is set and contains the file, it is retrieved from the
+  /// store instead of being downloaded.
+  /// \sa setExpectedChecksum(), setBlobStore()
+  QUuid download(const QString& fileName,
+    const QString& resource,
+    const Parameters& parameters,
+    const RawHeaders& rawHeaders,
+    const QByteArray& expectedChecksum,
+    QCryptographicHash::Algorithm algorithm);
+
   /// Sends a DELETE request to the web service.
   /// The \a resource and \parameters are used to compose the URL.
   /// \a rawHeaders can be used to set the raw headers of the request to send.
@@ -196,6 +465,23 @@ public:
     const Parameters& parameters = Parameters(),
     const RawHeaders& rawHeaders = RawHeaders());
 
+  /// Creates a template of the requests sent by \a operation to
+  /// \a resource with \a rawHeaders, whose parameters are named
+  /// \a parameterNames. The URL is composed by createUrl().
+  /// \sa execute(), qRestPreparedRequest
+  qRestPreparedRequest prepare(QNetworkAccessManager::Operation operation,
+    const QString& resource,
+    const QStringList& parameterNames = QStringList(),
+    const RawHeaders& rawHeaders = RawHeaders());
+
+  /// Sends a request of the template \a prepared. \a values are the
+  /// values of its parameters, in the order of their names. Missing values
+  /// are sent empty. \a data is the body of PUT and POST requests.
+  /// Returns a unique identifier of the posted query.
+  QUuid execute(const qRestPreparedRequest& prepared,
+    const QStringList& values = QStringList(),
+    const QByteArray& data = QByteArray());
+
   /// Sends a POST request to the web service.
   /// The \a resource and \parameters are used to compose the URL.
   /// \a rawHeaders can be used to set the raw headers of the request to send.
@@ -210,6 +496,36 @@ public:
     const Parameters& parameters = Parameters(),
     const RawHeaders& rawHeaders = RawHeaders());
 
+  /// Sends a POST request whose body is the content of \a input, e.g. a
+  /// chunk of a file. The content is read when the request is sent.
+  /// \sa put(QIODevice*, const QString&, const Parameters&, const RawHeaders&)
+  QUuid post(QIODevice* input,
+    const QString& resource,
+    const Parameters& parameters = Parameters(),
+    const RawHeaders& rawHeaders = RawHeaders());
+
+  /// Sends a POST request whose body is \a body encoded using \a encoding,
+  /// instead of passing the values in the URL. \a parameters are still
+  /// added to the URL. The Content-Type header is set unless \a rawHeaders
+  /// sets it.
+  /// \sa encodeBody()
+  QUuid post(const QString& resource,
+    const QVariantMap& body,
+    BodyEncoding encoding,
+    const Parameters& parameters = Parameters(),
+    const RawHeaders& rawHeaders = RawHeaders());
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+  /// Sends a POST request whose body is \a multiPart, e.g. created by
+  /// createFormData(). Parts whose body is a device are read while the
+  /// request is sent. \a multiPart is deleted with the reply of the query.
+  /// The upload rate limits do not apply to multipart bodies.
+  QUuid post(QHttpMultiPart* multiPart,
+    const QString& resource,
+    const Parameters& parameters = Parameters(),
+    const RawHeaders& rawHeaders = RawHeaders());
+#endif
+
   /// Sends a PUT request to the web service.
   /// The \a resource and \parameters are used to compose the URL.
   /// \a rawHeaders can be used to set the raw headers of the request to send.
@@ -230,11 +546,90 @@ public:
     const Parameters& parameters = Parameters(),
     const RawHeaders& rawHeaders = RawHeaders());
 
+  /// Sends a PUT request whose body is \a body encoded using \a encoding.
+  /// \sa post(const QString&, const QVariantMap&, BodyEncoding, const Parameters&, const RawHeaders&)
+  QUuid put(const QString& resource,
+    const QVariantMap& body,
+    BodyEncoding encoding,
+    const Parameters& parameters = Parameters(),
+    const RawHeaders& rawHeaders = RawHeaders());
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+  /// Sends a PUT request whose body is \a multiPart.
+  /// \sa post(QHttpMultiPart*, const QString&, const Parameters&, const RawHeaders&)
+  QUuid put(QHttpMultiPart* multiPart,
+    const QString& resource,
+    const Parameters& parameters = Parameters(),
+    const RawHeaders& rawHeaders = RawHeaders());
+#endif
+
   QUuid upload(const QString& fileName,
     const QString& resource,
     const Parameters& parameters = Parameters(),
     const RawHeaders& rawHeaders = RawHeaders());
 
+  /// Uploads a file and verifies the checksum of the data sent.
+  /// \a expectedChecksum is the hexadecimal digest computed using
+  /// \a algorithm. If it does not match, the query fails with an
+  /// IntegrityError.
+  QUuid upload(const QString& fileName,
+    const QString& resource,
+    const Parameters& parameters,
+    const RawHeaders& rawHeaders,
+    const QByteArray& expectedChecksum,
+    QCryptographicHash::Algorithm algorithm);
+
+  /// Returns the algorithms used to compute checksums of transferred data.
+  QList<QCryptographicHash::Algorithm> checksumAlgorithms()const;
+  /// Sets the algorithms used to compute checksums of the data transferred
+  /// by get(QIODevice*), download(), put(QIODevice*) and upload().
+  /// The checksums are computed while the data is transferred, they are
+  /// available using qRestResult::checksum().
+  void setChecksumAlgorithms(const QList<QCryptographicHash::Algorithm>& algorithms);
+
+  /// Sets the hexadecimal \a checksum expected for the data transferred by
+  /// the query \a queryId. It must be called before the control returns to
+  /// the event loop. If the checksum computed using \a algorithm does not
+  /// match, the query fails with an IntegrityError.
+  /// Returns false if \a queryId is unknown or already finished.
+  bool setExpectedChecksum(const QUuid& queryId,
+    QCryptographicHash::Algorithm algorithm,
+    const QByteArray& checksum);
+
+  /// Store of the verified downloaded files. Not owned, 0 by default.
+  qRestBlobStore* blobStore()const;
+  /// Sets the store used by download() overloads taking an expected checksum.
+  /// The store must outlive the qRestAPI object or be unset before deletion.
+  void setBlobStore(qRestBlobStore* store);
+
+  /// Circuit breaker of the queries. Not owned, 0 by default.
+  qRestCircuitBreaker* circuitBreaker()const;
+  /// Sets the breaker failing the queries to failing endpoints without
+  /// sending them. The breaker must outlive the qRestAPI object or be unset
+  /// before deletion.
+  void setCircuitBreaker(qRestCircuitBreaker* breaker);
+
+  /// Writes the requests and the responses of the queries that finish from
+  /// now on into \a fileName, with their timing, until stopRecording().
+  /// The file can be replayed using startReplay().
+  /// Returns false if the file can not be created.
+  /// \sa qRestRecord
+  bool startRecording(const QString& fileName);
+  void stopRecording();
+  bool isRecording()const;
+
+  /// Serves the next queries from the recording \a fileName instead of the
+  /// network, until stopReplay(). Responses are delivered after their
+  /// recorded delays divided by \a speed, 0 meaning without delay, and are
+  /// processed as responses received from the network.
+  /// Returns false if the file can not be read.
+  /// \sa qRestReplayNetworkAccessManager
+  bool startReplay(const QString& fileName, double speed = 1.);
+  void stopReplay();
+  /// Returns the network access manager serving the recorded responses,
+  /// 0 if the queries are not replayed.
+  qRestReplayNetworkAccessManager* replayManager()const;
+
   /// Blocks until the result for the uuid \a queryId is available.
   /// Returns false if an error occured.
   /// \sa ErrorType
@@ -290,9 +685,11 @@ public:
 #if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
   static QVariantMap scriptValueToMap(const QJSValue& value);
   static void appendScriptValueToVariantMapList(QList<QVariantMap>& result, const QJSValue& value);
+  static void appendScriptValueToCompactResult(qRestCompactResult& result, const QJSValue& value);
 #else
   static QVariantMap scriptValueToMap(const QScriptValue& value);
   static void appendScriptValueToVariantMapList(QList<QVariantMap>& result, const QScriptValue& value);
+  static void appendScriptValueToCompactResult(qRestCompactResult& result, const QScriptValue& value);
 #endif
 
   /// \brief Flatten a QVariantMap of nested QVariantList, QVariantMap and QVariant.
@@ -343,18 +740,97 @@ public:
   ///
   static QVariantMap qVariantMapFlattened(const QVariantMap& value);
 
+  /// \brief Flatten each QVariantMap of \a list.
+  ///
+  /// Large lists are split into chunks flattened concurrently using the
+  /// global QThreadPool. The order of the maps is preserved.
+  ///
+  /// \sa qVariantMapFlattened(const QVariantMap&)
+  static QList<QVariantMap> qVariantMapListFlattened(const QList<QVariantMap>& list);
+
+  /// Encodes \a body using \a encoding.
+  /// Returns a null QByteArray if the encoding is not supported by the
+  /// version of Qt.
+  static QByteArray encodeBody(const QVariantMap& body, BodyEncoding encoding);
+  /// Returns the media type of the bodies encoded using \a encoding.
+  static QByteArray bodyContentType(BodyEncoding encoding);
+
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+  /// Creates a "multipart/form-data" body made of a text part per value of
+  /// \a fields, encoded as by FormUrlEncoded, and of a part per file of
+  /// \a files (form field name to file name). The files are read while the
+  /// request is sent.
+  /// Returns 0 if a file can not be opened.
+  static QHttpMultiPart* createFormData(const QVariantMap& fields,
+    const QMap<QString, QString>& files = QMap<QString, QString>());
+#endif
+
 signals:
   void finished(const QUuid& queryId);
+  /// Emitted when data of a download or an upload is transferred, at most
+  /// once per progressInterval. \a progress is between 0 and 1. It is not
+  /// emitted while the size of the transfer is unknown.
   void progress(const QUuid& queryId, double progress);
+  /// Progress of all the downloads and uploads in progress, emitted at most
+  /// once per progressInterval and when a transfer finishes.
+  /// \a bytesTotal only includes the transfers whose size is known.
+  /// \a bytesPerSecond is a moving average of the transfer rate over a few
+  /// seconds. \a msecsRemaining is an estimate of the time left, -1 if
+  /// unknown.
+  void aggregateProgress(qint64 bytesDone, qint64 bytesTotal,
+                         double bytesPerSecond, qint64 msecsRemaining);
 
 protected:
   QNetworkReply* sendRequest(QNetworkAccessManager::Operation operation,
       const QUrl& url,
       const RawHeaders& rawHeaders = RawHeaders(),
       const QByteArray& data = QByteArray());
+  /// Sends a PUT or POST request whose body is read from \a data.
+  /// If \a data is sequential and no content length is set, the content
+  /// length is set to the bytes available in \a data.
+  QNetworkReply* sendRequest(QNetworkAccessManager::Operation operation,
+      const QUrl& url,
+      const RawHeaders& rawHeaders,
+      QIODevice* data);
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+  /// Sends a PUT or POST request whose body is \a data. The Content-Type
+  /// header, with the boundary of \a data, is set unless \a rawHeaders sets
+  /// it.
+  QNetworkReply* sendRequest(QNetworkAccessManager::Operation operation,
+      const QUrl& url,
+      const RawHeaders& rawHeaders,
+      QHttpMultiPart* data);
+#endif
 
   virtual QUrl createUrl(const QString& method, const qRestAPI::Parameters& parameters);
+  /// Parses the response of a successful query. The default implementation
+  /// calls parseRegisteredResponse(): JSON, MessagePack and CBOR responses
+  /// are parsed, the responses of other content types give an empty result.
   virtual void parseResponse(qRestResult* restResult, const QByteArray& response);
+  /// Parses \a response using the parser registered for the content type of
+  /// \a restResult, or for \a defaultContentType if there is none, and sets
+  /// its results, or its error if \a response is malformed.
+  /// Returns false if no parser is registered for either content type.
+  bool parseRegisteredResponse(qRestResult* restResult, const QByteArray& response,
+                               const QByteArray& defaultContentType = QByteArray());
+
+  /// Called when the request of the query \a queryId fails with a network
+  /// error (see QNetworkReply::error()), if the request can be sent again:
+  /// its body is not read from a device and its response is not written
+  /// into one.
+  /// Returning true holds the query: it is not finished until resendQuery()
+  /// or failQuery() is called. The default implementation returns false.
+  virtual bool holdFailedQuery(const QUuid& queryId, QNetworkReply* reply);
+  /// Returns false if \a request must not be sent twice when hedging is
+  /// enabled, e.g. a login request. The default implementation returns true.
+  /// \sa hedgePercentile
+  virtual bool canHedgeQuery(const QNetworkRequest& request);
+  /// Sends again the request of a held query, with the current default raw
+  /// headers. Returns false if the query is unknown, finished or can not be
+  /// sent again.
+  bool resendQuery(const QUuid& queryId);
+  /// Finishes a held query with an error.
+  void failQuery(const QUuid& queryId, const QString& error, ErrorType errorCode);
 
 private:
   QScopedPointer<qRestAPIPrivate> d_ptr;
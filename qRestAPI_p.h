@@ -22,18 +22,31 @@
 #define __qRestAPI_p_h
 
 // Qt includes
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QFile>
 #if QT_VERSION >= 0x050000
 #include <QHash>
 #endif
+#include <QMap>
 #include <QNetworkAccessManager>
+#include <QNetworkProxy>
 #include <QNetworkReply>
+#include <QSharedPointer>
 #include <QSslError>
 
 // qRestAPI includes
 #include "qRestAPI.h"
+#include "qRestMetrics.h"
+#include "qRestTokenBucket.h"
+#include "qRestTracer.h"
 
 class QIODevice;
+class QTimer;
+class qRestBlobStore;
+class qRestCircuitBreaker;
+class qRestReplayNetworkAccessManager;
+class qRestResponseParser;
 
 #if (QT_VERSION < QT_VERSION_CHECK(5, 3, 0))
 #ifdef QT_NO_OPENSSL
@@ -49,6 +62,55 @@ class QIODevice;
 struct QSslError{};
 #endif
 
+// --------------------------------------------------------------------------
+/// Read-only sequential device sending \a data no faster than its token
+/// buckets allow. When no token is available, read() returns 0 and
+/// readyRead() is emitted once tokens are available again.
+class qRestThrottledDevice : public QIODevice
+{
+  Q_OBJECT
+
+public:
+  qRestThrottledDevice(const QByteArray& data, QObject* parent = 0);
+
+  /// Adds a bucket limiting the rate. \a bucket is not owned.
+  void addBucket(qRestTokenBucket* bucket);
+
+  virtual bool isSequential() const;
+  virtual bool atEnd() const;
+  virtual qint64 bytesAvailable() const;
+
+protected:
+  virtual qint64 readData(char* data, qint64 maxSize);
+  virtual qint64 writeData(const char* data, qint64 maxSize);
+
+protected slots:
+  void resume();
+
+private:
+  QByteArray Data;
+  qint64 Offset;
+  QList<qRestTokenBucket*> Buckets;
+  QTimer* ResumeTimer;
+};
+
+// --------------------------------------------------------------------------
+/// Health of a server of the server set.
+struct qRestServerState
+{
+  qRestServerState() : Latency(0.), Samples(0), Failures(0), UnhealthyUntil(0) {}
+
+  /// Encoded URL of the server, URLs of requests starting with it are sent
+  /// to it.
+  QByteArray Url;
+  /// Exponentially weighted moving average of the latency in milliseconds.
+  double Latency;
+  int Samples;
+  int Failures;
+  /// Time until which the server is avoided, see qRestTiming::now().
+  qint64 UnhealthyUntil;
+};
+
 // --------------------------------------------------------------------------
 class qRestAPIPrivate : public QObject
 {
@@ -75,13 +137,152 @@ public:
 
   virtual void init();
 
+  /// Returns the span of a new query, invalid if the queries are not traced.
+  qRestSpan createSpan() const;
+  /// Creates a request for \a url with the default and given raw headers,
+  /// and the traceparent header of \a span if trace context propagation
+  /// is enabled.
+  QNetworkRequest createRequest(const QUrl& url, const qRestAPI::RawHeaders& rawHeaders,
+                                const qRestSpan& span);
+  /// Creates a request with the default and given raw headers, without URL
+  /// nor trace context.
+  QNetworkRequest createBaseRequest(const qRestAPI::RawHeaders& rawHeaders) const;
+  /// Sets the traceparent header of \a span if trace context propagation
+  /// is enabled.
+  void setTraceContext(QNetworkRequest& request, const qRestSpan& span) const;
+  /// Sets up the timeout and the query id of a reply just sent, and creates
+  /// its result. \a queued is the time the query was created.
+  /// If \a result is not null, the reply is a new attempt of its query.
+  void registerReply(QNetworkReply* queryReply,
+                     QNetworkAccessManager::Operation operation,
+                     qint64 queued, const qRestSpan& span,
+                     qRestResult* result = NULL);
+  /// Sets up the manager load, the shared reply signals and the timeout of
+  /// a reply just sent.
+  void trackReply(QNetworkReply* queryReply);
+  /// Sends a hedging request of \a queryReply after a delay, if hedging is
+  /// enabled and enough queries were recorded by the metrics.
+  void scheduleHedge(QNetworkReply* queryReply);
+  /// Connects the signals of a reply used to monitor its progress.
+  void connectReply(QNetworkReply* queryReply);
+  /// Returns the index of the server of \a encodedUrl, -1 if none.
+  int serverIndex(const QByteArray& encodedUrl) const;
+  /// Returns the server receiving the next GET or HEAD request.
+  int readServer();
+  /// Returns the server receiving the next request that modifies data.
+  int writeServer();
+  /// Rewrites the URL of \a request to the server selected for
+  /// \a operation.
+  void selectServer(QNetworkAccessManager::Operation operation, QNetworkRequest& request);
+  /// Updates the health and the latency of the server of \a reply.
+  void recordServerResult(QNetworkReply* reply, qRestResult* result);
+  /// Sends again the query of the failed \a reply to another server.
+  /// Returns false if the query can not fail over.
+  bool failOver(const QUuid& queryId, QNetworkReply* reply, qRestResult* result);
+  /// Returns a reply failing with CircuitOpenError if the circuit breaker
+  /// rejects \a request, 0 if the request can be sent. \a trial is set to
+  /// true if the request is a trial of a half open endpoint.
+  QNetworkReply* rejectQuery(QNetworkAccessManager::Operation operation,
+                             const QNetworkRequest& request, bool* trial);
+  /// Marks \a reply as a trial of the circuit breaker if \a trial is true,
+  /// or gives the trial back if \a request could not be sent.
+  void tagTrial(QNetworkReply* reply, const QNetworkRequest& request, bool trial);
+  /// Sends \a request to the selected server using the network manager,
+  /// unless the circuit breaker rejects it. \a data, a QByteArray, a
+  /// QIODevice* or a QHttpMultiPart*, is the body of PUT and POST requests.
+  /// Returns 0 if \a operation is not supported.
+  template <typename Body>
+  QNetworkReply* sendQuery(QNetworkAccessManager::Operation operation,
+                           const QNetworkRequest& request, const Body& data);
+  /// Emits finished() for a query whose result is set, and records its
+  /// timing.
+  void reportFinished(const QUuid& queryId, qRestResult* restResult);
+
+  /// Updates the progress of \a result, emits progress() and
+  /// aggregateProgress() unless they were emitted less than the progress
+  /// interval ago.
+  void updateProgress(qRestResult* result, qint64 bytesDone, qint64 bytesTotal);
+  /// Removes a finished query from the aggregated progress.
+  void finishProgress(qRestResult* result);
+  void updateAggregateProgress(bool force);
+
+  /// Creates a network manager of the pool.
+  QNetworkAccessManager* createNetworkManager();
+  /// Returns the manager sending a request to \a url: the replay manager if
+  /// the queries are replayed, the shared manager of the thread if it is
+  /// used, otherwise a manager of the pool, created the first time.
+  QNetworkAccessManager* networkManager(const QUrl& url);
+
+  /// Writes the request and the response of a finished query into the
+  /// recording. \a body is the response body.
+  void recordReply(qRestResult* result, QNetworkReply* reply, const QByteArray& body);
+
+  /// Returns the result of the query sent using \a reply.
+  qRestResult* replyResult(QNetworkReply* reply) const;
+  /// Restarts the time out of \a reply, if any.
+  void postponeTimeOut(QNetworkReply* reply);
+
+  /// Sends the content of \a input using a PUT or POST request.
+  /// If \a expectedChecksumAlgorithm is a QCryptographicHash::Algorithm,
+  /// the checksum of the data sent is compared to \a expectedChecksum.
+  /// \sa qRestAPI::put(QIODevice*, const QString&, const qRestAPI::Parameters&, const qRestAPI::RawHeaders&)
+  QUuid sendDevice(QNetworkAccessManager::Operation operation,
+                   QIODevice* input, const QString& resource,
+                   const qRestAPI::Parameters& parameters,
+                   const qRestAPI::RawHeaders& rawHeaders,
+                   int expectedChecksumAlgorithm = -1,
+                   const QByteArray& expectedChecksum = QByteArray());
+  /// Sends \a body encoded using \a encoding using a PUT or POST request.
+  QUuid sendBody(QNetworkAccessManager::Operation operation,
+                 const QString& resource, const QVariantMap& body,
+                 qRestAPI::BodyEncoding encoding,
+                 const qRestAPI::Parameters& parameters,
+                 const qRestAPI::RawHeaders& rawHeaders);
+#if (QT_VERSION >= QT_VERSION_CHECK(4,8,0))
+  QUuid sendMultiPart(QNetworkAccessManager::Operation operation,
+                      QHttpMultiPart* multiPart, const QString& resource,
+                      const qRestAPI::Parameters& parameters,
+                      const qRestAPI::RawHeaders& rawHeaders);
+#endif
+  /// Returns the id of a query completed without sending any request, e.g.
+  /// served from the blob store. It failed with \a error if \a errorCode is
+  /// not UnknownError. It is finished by reportFinished() when the event
+  /// loop is entered. Queries without \a method are not recorded in the
+  /// metrics nor traced.
+  QUuid unsentQuery(const QByteArray& method, const QUrl& url,
+                    const QString& error, qRestAPI::ErrorType errorCode);
+  /// Returns the id of a query that failed before being sent.
+  /// \sa unsentQuery()
+  QUuid failedQuery(const QString& error, qRestAPI::ErrorType errorCode);
+
 public slots:
+  /// Updates the load of the manager of \a reply and deletes the manager if
+  /// it was removed from the pool and has no more queries.
+  void releaseManager(QNetworkReply* reply);
   void processReply(QNetworkReply* reply);
+  /// Processes a reply not reported by a manager of the pool, e.g. of the
+  /// shared network manager.
+  /// Note: sender() is used.
+  void processSharedReply();
+  /// Finishes a query created by unsentQuery().
+  void finishUnsentQuery(const QUuid& queryId);
+  /// Sends the hedging request of a query.
+  /// Note: sender() is used.
+  void sendHedge();
+  void onSharedReplySslErrors(const QList<QSslError>& errors);
   /// Called when a query hasn't had any progress for a given TimeOut time.
   /// Note: sender() is used.
   void queryTimeOut();
-  void queryProgress(qint64 bytesReceived, qint64 bytesTotal);
-  void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+  /// Record the timing of the replies and postpone their time out.
+  /// Note: sender() is used.
+  void queryMetaDataChanged();
+  void queryDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+  void queryUploadProgress(qint64 bytesSent, qint64 bytesTotal);
+  void queryEncrypted();
+  void queryRequestSent();
+  /// Reports the progress of the data written by a qRestResult into its
+  /// output device. Note: sender() is used.
+  void downloadProgress(qint64 bytesWritten, qint64 bytesTotal);
   void uploadProgress(qint64 bytesSent, qint64 bytesTotal);
 
   void onSslErrors(QNetworkReply* reply, const QList<QSslError>& errors);
@@ -90,11 +291,75 @@ public slots:
 
 public:
   QString ServerUrl;
+  QList<qRestServerState> Servers;
+  /// Server of the requests that modify data.
+  int WriteServer;
+  int ServerRetryInterval;
+  /// Number of times the queries in progress failed over.
+  QMap<QUuid, int> FailOvers;
+  /// Changed when the server URL or the headers of the requests change,
+  /// prepared requests are then built again. Generations are unique across
+  /// the qRestAPI objects.
+  int RequestGeneration;
 
+  /// First manager of the pool, its cookie jar is shared.
   QNetworkAccessManager* NetworkManager;
+  /// Managers of the pool, empty until the first query is sent.
+  QList<QNetworkAccessManager*> NetworkManagers;
+  int NetworkManagerCount;
+  /// Queries in progress by manager, including the managers removed from
+  /// the pool that still have queries in progress.
+  QHash<QNetworkAccessManager*, int> ManagerLoads;
+  qRestAPI::ManagerSelectionPolicy ManagerSelection;
+  QNetworkProxy Proxy;
+  bool SharedNetworkManager;
   int TimeOut;
   qRestAPI::RawHeaders DefaultRawHeaders;
   bool SuppressSslErrors;
+  bool CompactResults;
+  /// Parsers by media type.
+  QHash<QByteArray, QSharedPointer<qRestResponseParser> > ResponseParsers;
+  QList<QByteArray> AcceptedContentTypes;
+  /// Value of the Accept header built from AcceptedContentTypes.
+  QByteArray AcceptHeader;
+  bool MemoryMappedDownloads;
+  QList<QCryptographicHash::Algorithm> ChecksumAlgorithms;
+  qRestBlobStore* BlobStore;
+  qRestCircuitBreaker* CircuitBreaker;
+  double HedgePercentile;
+  int HedgeMinimumDelay;
+  double MaximumHedgeRatio;
+  /// Queries scheduled to be hedged, hedging requests sent and used.
+  qint64 HedgesScheduled;
+  qint64 HedgesFired;
+  qint64 HedgesWon;
+  qint64 StreamingBufferSize;
+  QScopedPointer<qRestMetrics> Metrics;
+  bool TraceContextPropagation;
+  qRestTracer* Tracer;
+  /// Context of the spans of the queries, set from a traceparent header.
+  qRestSpan ParentSpan;
+
+  int ProgressInterval;
+  /// Aggregated progress of the transfers in progress.
+  int ActiveTransfers;
+  qint64 ProgressDone;
+  qint64 ProgressTotal;
+  /// Bytes transferred since the creation of the object, used to compute
+  /// the transfer rate.
+  qint64 TransferredBytes;
+  qint64 LastTransferredBytes;
+  qint64 LastAggregateProgress;
+  /// Bytes per second.
+  double TransferRate;
+  qRestTokenBucket DownloadBucket;
+  qRestTokenBucket UploadBucket;
+
+  QScopedPointer<QFile> RecordingFile;
+  QDataStream RecordingStream;
+  /// Time the recording started, offsets of the records are relative to it.
+  qint64 RecordingStart;
+  qRestReplayNetworkAccessManager* ReplayManager;
 
   qRestAPI::ErrorType ErrorCode;
   QString ErrorString;
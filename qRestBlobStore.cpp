@@ -0,0 +1,489 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QUuid>
+
+// qRestAPI includes
+#include "qRestBlobStore.h"
+#include "qRestFileSink.h"
+
+// STD includes
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+const quint32 IndexMagic = 0x71524253; // "qRBS"
+const qint32 IndexVersion = 1;
+
+// --------------------------------------------------------------------------
+QString algorithmName(QCryptographicHash::Algorithm algorithm)
+{
+  switch (algorithm)
+    {
+    case QCryptographicHash::Md4: return "md4";
+    case QCryptographicHash::Md5: return "md5";
+    case QCryptographicHash::Sha1: return "sha1";
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    case QCryptographicHash::Sha224: return "sha224";
+    case QCryptographicHash::Sha256: return "sha256";
+    case QCryptographicHash::Sha384: return "sha384";
+    case QCryptographicHash::Sha512: return "sha512";
+#endif
+    default: return QString("algorithm%1").arg(static_cast<int>(algorithm));
+    }
+}
+
+// --------------------------------------------------------------------------
+int hashLength(QCryptographicHash::Algorithm algorithm)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+  return QCryptographicHash::hashLength(algorithm);
+#else
+  return QCryptographicHash::hash(QByteArray(), algorithm).size();
+#endif
+}
+
+// --------------------------------------------------------------------------
+/// Returns true if \a hex is a checksum computed using \a algorithm in
+/// lowercase hexadecimal digits.
+bool isChecksum(const QByteArray& hex, QCryptographicHash::Algorithm algorithm)
+{
+  if (hex.size() != 2 * hashLength(algorithm))
+    {
+    return false;
+    }
+  for (int index = 0; index < hex.size(); ++index)
+    {
+    char digit = hex.at(index);
+    if (!((digit >= '0' && digit <= '9') || (digit >= 'a' && digit <= 'f')))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool hardLink(const QString& source, const QString& target)
+{
+#if defined(Q_OS_WIN)
+  return ::CreateHardLinkW(
+        reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(target).utf16()),
+        reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(source).utf16()),
+        NULL) != 0;
+#else
+  return ::link(QFile::encodeName(source).constData(),
+                QFile::encodeName(target).constData()) == 0;
+#endif
+}
+
+}
+
+// --------------------------------------------------------------------------
+class qRestBlobStorePrivate
+{
+public:
+  struct Entry
+  {
+    qint64 Size;
+    /// Time of last use in milliseconds since epoch.
+    qint64 LastUsed;
+  };
+
+  qRestBlobStorePrivate();
+
+  /// Path of the blob relative to the store directory. Returns an empty
+  /// string if \a checksum is not a hexadecimal checksum of \a algorithm, so
+  /// that it can not point outside of the store.
+  QString key(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm) const;
+  QString indexFilePath() const;
+
+  void load();
+  void save();
+  /// Removes least recently used blobs until \a size more bytes fit in
+  /// the store.
+  void evict(qint64 size, const QString& keep = QString());
+  void removeEntry(const QString& key);
+  /// Links or copies \a source into \a target depending on Mode.
+  bool transfer(const QString& source, const QString& target) const;
+
+  QString Directory;
+  qint64 MaximumSize;
+  qRestBlobStore::LinkMode Mode;
+
+  QHash<QString, Entry> Entries;
+  qint64 TotalSize;
+  bool Modified;
+};
+
+// --------------------------------------------------------------------------
+// qRestBlobStorePrivate methods
+
+// --------------------------------------------------------------------------
+qRestBlobStorePrivate::qRestBlobStorePrivate()
+  : MaximumSize(0)
+  , Mode(qRestBlobStore::CopyFiles)
+  , TotalSize(0)
+  , Modified(false)
+{
+}
+
+// --------------------------------------------------------------------------
+QString qRestBlobStorePrivate::key(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm) const
+{
+  QByteArray hex = checksum.toLower();
+  if (!isChecksum(hex, algorithm))
+    {
+    return QString();
+    }
+  return QString("%1/%2/%3").arg(algorithmName(algorithm))
+    .arg(QString::fromLatin1(hex.left(2))).arg(QString::fromLatin1(hex));
+}
+
+// --------------------------------------------------------------------------
+QString qRestBlobStorePrivate::indexFilePath() const
+{
+  return QDir(this->Directory).filePath("index");
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStorePrivate::load()
+{
+  // Times of last use saved by a previous session.
+  QHash<QString, qint64> lastUsed;
+  QFile indexFile(this->indexFilePath());
+  if (indexFile.open(QIODevice::ReadOnly))
+    {
+    QDataStream stream(&indexFile);
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version;
+    if (magic == IndexMagic && version == IndexVersion)
+      {
+      stream >> lastUsed;
+      }
+    }
+
+  // The files found in the store are authoritative, the index may be
+  // outdated if a previous session was interrupted.
+  QDir directory(this->Directory);
+  QDirIterator it(this->Directory, QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext())
+    {
+    it.next();
+    QString key = directory.relativeFilePath(it.filePath());
+    if (key == "index" || key.endsWith(".part"))
+      {
+      continue;
+      }
+    Entry entry;
+    entry.Size = it.fileInfo().size();
+    entry.LastUsed = lastUsed.value(key, it.fileInfo().lastModified().toMSecsSinceEpoch());
+    this->Entries.insert(key, entry);
+    this->TotalSize += entry.Size;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStorePrivate::save()
+{
+  if (!this->Modified)
+    {
+    return;
+    }
+  QHash<QString, qint64> lastUsed;
+  for (QHash<QString, Entry>::const_iterator it = this->Entries.constBegin();
+       it != this->Entries.constEnd(); ++it)
+    {
+    lastUsed.insert(it.key(), it.value().LastUsed);
+    }
+  QFile indexFile(this->indexFilePath());
+  if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return;
+    }
+  QDataStream stream(&indexFile);
+  stream << IndexMagic << IndexVersion << lastUsed;
+  this->Modified = false;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStorePrivate::evict(qint64 size, const QString& keep)
+{
+  if (this->MaximumSize <= 0 || this->TotalSize + size <= this->MaximumSize)
+    {
+    return;
+    }
+  QList<QPair<qint64, QString> > entries;
+  for (QHash<QString, Entry>::const_iterator it = this->Entries.constBegin();
+       it != this->Entries.constEnd(); ++it)
+    {
+    if (it.key() != keep)
+      {
+      entries << qMakePair(it.value().LastUsed, it.key());
+      }
+    }
+  std::sort(entries.begin(), entries.end());
+  for (int index = 0; index < entries.size() && this->TotalSize + size > this->MaximumSize; ++index)
+    {
+    this->removeEntry(entries.at(index).second);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStorePrivate::removeEntry(const QString& key)
+{
+  QHash<QString, Entry>::iterator it = this->Entries.find(key);
+  if (it == this->Entries.end())
+    {
+    return;
+    }
+  QFile::remove(QDir(this->Directory).filePath(key));
+  this->TotalSize -= it.value().Size;
+  this->Entries.erase(it);
+  this->Modified = true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestBlobStorePrivate::transfer(const QString& source, const QString& target) const
+{
+  if (this->Mode == qRestBlobStore::HardLinks && hardLink(source, target))
+    {
+    return true;
+    }
+  return QFile::copy(source, target);
+}
+
+// --------------------------------------------------------------------------
+// qRestBlobStore methods
+
+// --------------------------------------------------------------------------
+qRestBlobStore::qRestBlobStore(const QString& directory, qint64 maximumSize)
+  : d_ptr(new qRestBlobStorePrivate)
+{
+  Q_D(qRestBlobStore);
+  d->Directory = QDir(directory).absolutePath();
+  d->MaximumSize = maximumSize;
+  QDir().mkpath(d->Directory);
+  d->load();
+  d->evict(0);
+}
+
+// --------------------------------------------------------------------------
+qRestBlobStore::~qRestBlobStore()
+{
+  Q_D(qRestBlobStore);
+  d->save();
+}
+
+// --------------------------------------------------------------------------
+QString qRestBlobStore::directory() const
+{
+  Q_D(const qRestBlobStore);
+  return d->Directory;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestBlobStore::maximumSize() const
+{
+  Q_D(const qRestBlobStore);
+  return d->MaximumSize;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStore::setMaximumSize(qint64 size)
+{
+  Q_D(qRestBlobStore);
+  d->MaximumSize = size;
+  d->evict(0);
+  d->save();
+}
+
+// --------------------------------------------------------------------------
+qRestBlobStore::LinkMode qRestBlobStore::linkMode() const
+{
+  Q_D(const qRestBlobStore);
+  return d->Mode;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStore::setLinkMode(LinkMode mode)
+{
+  Q_D(qRestBlobStore);
+  d->Mode = mode;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestBlobStore::size() const
+{
+  Q_D(const qRestBlobStore);
+  return d->TotalSize;
+}
+
+// --------------------------------------------------------------------------
+int qRestBlobStore::count() const
+{
+  Q_D(const qRestBlobStore);
+  return d->Entries.size();
+}
+
+// --------------------------------------------------------------------------
+bool qRestBlobStore::contains(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm) const
+{
+  Q_D(const qRestBlobStore);
+  QString key = d->key(checksum, algorithm);
+  return !key.isEmpty() && d->Entries.contains(key);
+}
+
+// --------------------------------------------------------------------------
+QString qRestBlobStore::filePath(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm) const
+{
+  Q_D(const qRestBlobStore);
+  QString key = d->key(checksum, algorithm);
+  return key.isEmpty() ? QString() : QDir(d->Directory).filePath(key);
+}
+
+// --------------------------------------------------------------------------
+bool qRestBlobStore::retrieve(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm,
+                              const QString& fileName)
+{
+  Q_D(qRestBlobStore);
+  QString key = d->key(checksum, algorithm);
+  QHash<QString, qRestBlobStorePrivate::Entry>::iterator it = d->Entries.find(key);
+  if (key.isEmpty() || it == d->Entries.end())
+    {
+    return false;
+    }
+  QString blobPath = QDir(d->Directory).filePath(key);
+  if (!QFile::exists(blobPath))
+    {
+    // Removed behind our back.
+    d->removeEntry(key);
+    return false;
+    }
+  // The file is replaced only once complete.
+  QFileInfo fileInfo(fileName);
+  QString temporaryPath = fileInfo.absoluteDir().filePath(
+    QString(".%1.%2.part").arg(fileInfo.fileName())
+    .arg(QUuid::createUuid().toString().mid(1, 8)));
+  if (!d->transfer(blobPath, temporaryPath) ||
+      !qRestFileSink::renameOverwrite(temporaryPath, fileName))
+    {
+    QFile::remove(temporaryPath);
+    return false;
+    }
+  // Renaming a hard link onto another link of the same file does nothing.
+  QFile::remove(temporaryPath);
+  it.value().LastUsed = QDateTime::currentMSecsSinceEpoch();
+  d->Modified = true;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestBlobStore::insert(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm,
+                            const QString& fileName)
+{
+  Q_D(qRestBlobStore);
+  QString key = d->key(checksum, algorithm);
+  if (key.isEmpty())
+    {
+    return false;
+    }
+  QHash<QString, qRestBlobStorePrivate::Entry>::iterator it = d->Entries.find(key);
+  if (it != d->Entries.end())
+    {
+    it.value().LastUsed = QDateTime::currentMSecsSinceEpoch();
+    d->Modified = true;
+    return true;
+    }
+
+  QFileInfo fileInfo(fileName);
+  if (!fileInfo.isFile() ||
+      (d->MaximumSize > 0 && fileInfo.size() > d->MaximumSize))
+    {
+    return false;
+    }
+  d->evict(fileInfo.size());
+
+  // The blob is published under its final name only once complete.
+  QString blobPath = QDir(d->Directory).filePath(key);
+  QDir().mkpath(QFileInfo(blobPath).absolutePath());
+  QString temporaryPath = QString("%1.%2.part").arg(blobPath)
+      .arg(QUuid::createUuid().toString().mid(1, 8));
+  if (!d->transfer(fileInfo.absoluteFilePath(), temporaryPath))
+    {
+    QFile::remove(temporaryPath);
+    return false;
+    }
+  if (!QFile::rename(temporaryPath, blobPath))
+    {
+    QFile::remove(temporaryPath);
+    // Another process may have inserted the same blob.
+    if (!QFile::exists(blobPath))
+      {
+      return false;
+      }
+    }
+
+  qRestBlobStorePrivate::Entry entry;
+  entry.Size = fileInfo.size();
+  entry.LastUsed = QDateTime::currentMSecsSinceEpoch();
+  d->Entries.insert(key, entry);
+  d->TotalSize += entry.Size;
+  d->Modified = true;
+  d->save();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestBlobStore::remove(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm)
+{
+  Q_D(qRestBlobStore);
+  QString key = d->key(checksum, algorithm);
+  if (key.isEmpty() || !d->Entries.contains(key))
+    {
+    return false;
+    }
+  d->removeEntry(key);
+  d->save();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlobStore::clear()
+{
+  Q_D(qRestBlobStore);
+  foreach(const QString& key, d->Entries.keys())
+    {
+    d->removeEntry(key);
+    }
+  d->save();
+}
@@ -0,0 +1,119 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestBlobStore_h
+#define __qRestBlobStore_h
+
+// Qt includes
+#include <QCryptographicHash>
+#include <QScopedPointer>
+#include <QString>
+
+#include "qRestAPI_Export.h"
+
+class qRestBlobStorePrivate;
+
+/// qRestBlobStore is a local content-addressed store of downloaded files.
+///
+/// Files are stored under \a directory and keyed by their checksum, e.g. the
+/// sha512 provided by Girder for each file. When a qRestAPI has a blob store,
+/// download() overloads taking an expected checksum first look for the file
+/// in the store and, if found, link or copy it to the requested location
+/// instead of downloading it. Downloaded files whose checksum was verified
+/// are added to the store.
+///
+/// When maximumSize() is reached, the least recently used files are evicted.
+///
+/// Usage:
+/// <code>
+/// qRestBlobStore store(QDir::home().filePath(".cache/girder-blobs"));
+/// store.setMaximumSize(10LL * 1024 * 1024 * 1024);
+/// girderAPI.setBlobStore(&store);
+/// girderAPI.download(fileName, "/file/" + fileId + "/download",
+///                    qRestAPI::Parameters(), qRestAPI::RawHeaders(),
+///                    sha512, QCryptographicHash::Sha512);
+/// </code>
+/// \sa qRestAPI::setBlobStore()
+class qRestAPI_EXPORT qRestBlobStore
+{
+public:
+  enum LinkMode
+  {
+    /// Files are copied in and out of the store.
+    CopyFiles = 0,
+    /// Files are hard linked in and out of the store when possible (same
+    /// file system), copied otherwise. Linked files share their content
+    /// with the store: they must be replaced, not modified in place.
+    HardLinks
+  };
+
+  explicit qRestBlobStore(const QString& directory, qint64 maximumSize = 0);
+  virtual ~qRestBlobStore();
+
+  QString directory() const;
+
+  /// Maximum size in bytes of the files in the store. 0 means no limit.
+  qint64 maximumSize() const;
+  /// Sets the maximum size, evicting least recently used files if needed.
+  void setMaximumSize(qint64 size);
+
+  LinkMode linkMode() const;
+  void setLinkMode(LinkMode mode);
+
+  /// Total size in bytes of the files in the store.
+  qint64 size() const;
+  /// Number of files in the store.
+  int count() const;
+
+  /// Returns true if a file with the hexadecimal \a checksum computed using
+  /// \a algorithm is in the store.
+  /// Checksums that are not made of the expected number of hexadecimal
+  /// digits are rejected by all the methods.
+  bool contains(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm) const;
+
+  /// Returns the location of the file in the store, or an empty string if
+  /// \a checksum is invalid.
+  QString filePath(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm) const;
+
+  /// Links or copies the file with the given checksum to \a fileName,
+  /// replacing it if it exists, and marks it as recently used. The file is
+  /// written next to \a fileName then renamed, \a fileName is left
+  /// untouched if it fails.
+  /// Returns false if the file is not in the store or could not be copied.
+  bool retrieve(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm,
+                const QString& fileName);
+
+  /// Adds \a fileName to the store. Its content is expected to match the
+  /// hexadecimal \a checksum, it is not verified.
+  /// Returns false if the file could not be added, e.g. if it is larger than
+  /// maximumSize().
+  bool insert(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm,
+              const QString& fileName);
+
+  bool remove(const QByteArray& checksum, QCryptographicHash::Algorithm algorithm);
+
+  /// Removes all the files from the store.
+  void clear();
+
+private:
+  QScopedPointer<qRestBlobStorePrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qRestBlobStore);
+  Q_DISABLE_COPY(qRestBlobStore);
+};
+
+#endif
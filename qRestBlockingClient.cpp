@@ -0,0 +1,356 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+// qRestAPI includes
+#include "qRestBlockingClient.h"
+#include "qRestBlockingClient_p.h"
+#include "qRestResult.h"
+
+// STD includes
+#include <climits>
+
+// --------------------------------------------------------------------------
+namespace
+{
+class qRestBlockingSendEvent : public QEvent
+{
+public:
+  qRestBlockingSendEvent(qRestBlockingCall* call)
+    : QEvent(qRestBlockingTransport::sendEventType())
+    , Call(call)
+  {
+  }
+  qRestBlockingCall* Call;
+};
+
+qRestResult* errorResult(const QUuid& queryId, const QString& error,
+                         qRestAPI::ErrorType errorCode)
+{
+  qRestResult* result = new qRestResult(queryId);
+  result->setError(error, errorCode);
+  return result;
+}
+}
+
+// --------------------------------------------------------------------------
+// qRestBlockingCall methods
+
+// --------------------------------------------------------------------------
+qRestBlockingCall::qRestBlockingCall()
+  : Operation(QNetworkAccessManager::GetOperation)
+  , CallerThread(0)
+  , Result(0)
+  , Finished(false)
+  , Abandoned(false)
+{
+}
+
+// --------------------------------------------------------------------------
+// qRestBlockingTransport methods
+
+// --------------------------------------------------------------------------
+qRestBlockingTransport::qRestBlockingTransport(qRestBlockingClientPrivate* client)
+  : Client(client)
+  , RestAPI(0)
+  , ConfigurationGeneration(-1)
+{
+}
+
+// --------------------------------------------------------------------------
+QEvent::Type qRestBlockingTransport::sendEventType()
+{
+  static int type = QEvent::registerEventType();
+  return static_cast<QEvent::Type>(type);
+}
+
+// --------------------------------------------------------------------------
+bool qRestBlockingTransport::event(QEvent* event)
+{
+  if (event->type() == sendEventType())
+    {
+    this->send(static_cast<qRestBlockingSendEvent*>(event)->Call);
+    return true;
+    }
+  return this->QObject::event(event);
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingTransport::send(qRestBlockingCall* call)
+{
+  if (!this->RestAPI)
+    {
+    this->RestAPI = this->Client->Factory ? this->Client->Factory() : new qRestAPI;
+    this->RestAPI->setParent(this);
+    QObject::connect(this->RestAPI, SIGNAL(finished(QUuid)),
+                     this, SLOT(queryFinished(QUuid)));
+    }
+  {
+  QMutexLocker locker(&this->Client->Mutex);
+  if (call->Abandoned)
+    {
+    delete call;
+    return;
+    }
+  if (this->ConfigurationGeneration != this->Client->ConfigurationGeneration)
+    {
+    this->RestAPI->setServerUrl(this->Client->ServerUrl);
+    this->RestAPI->setDefaultRawHeaders(this->Client->DefaultRawHeaders);
+    this->ConfigurationGeneration = this->Client->ConfigurationGeneration;
+    }
+  }
+
+  // The request of the call is not modified once it is posted.
+  QUuid queryId;
+  // The body is read by the qRestAPI object until the query is finished.
+  QBuffer* body = call->Data.isEmpty() ? 0 : new QBuffer(this);
+  if (body)
+    {
+    body->setData(call->Data);
+    }
+  switch (call->Operation)
+    {
+    case QNetworkAccessManager::GetOperation:
+      queryId = this->RestAPI->get(call->Resource, call->Parameters, call->RawHeaders);
+      break;
+    case QNetworkAccessManager::HeadOperation:
+      queryId = this->RestAPI->head(call->Resource, call->Parameters, call->RawHeaders);
+      break;
+    case QNetworkAccessManager::DeleteOperation:
+      queryId = this->RestAPI->del(call->Resource, call->Parameters, call->RawHeaders);
+      break;
+    case QNetworkAccessManager::PutOperation:
+      queryId = !body ?
+        this->RestAPI->put(call->Resource, call->Parameters, call->RawHeaders) :
+        this->RestAPI->put(body, call->Resource, call->Parameters, call->RawHeaders);
+      break;
+    case QNetworkAccessManager::PostOperation:
+      queryId = !body ?
+        this->RestAPI->post(call->Resource, call->Parameters, call->RawHeaders) :
+        this->RestAPI->post(body, call->Resource, call->Parameters, call->RawHeaders);
+      break;
+    default:
+      break;
+    }
+  if (queryId.isNull())
+    {
+    delete body;
+    this->finishCall(call, errorResult(queryId, "Unsupported operation", qRestAPI::UnknownError));
+    return;
+    }
+  this->PendingCalls.insert(queryId, call);
+  if (body)
+    {
+    this->PendingBodies.insert(queryId, body);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingTransport::queryFinished(const QUuid& queryId)
+{
+  qRestBlockingCall* call = this->PendingCalls.take(queryId);
+  if (!call)
+    {
+    return;
+    }
+  QScopedPointer<QBuffer> body(this->PendingBodies.take(queryId));
+  qRestResult* result = this->RestAPI->takeResult(queryId);
+  if (!result)
+    {
+    result = errorResult(queryId, this->RestAPI->errorString(), this->RestAPI->error());
+    }
+  else if (result->ioDevice == body.data())
+    {
+    result->ioDevice = 0;
+    }
+  this->finishCall(call, result);
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingTransport::finishCall(qRestBlockingCall* call, qRestResult* result)
+{
+  QMutexLocker locker(&this->Client->Mutex);
+  if (call->Abandoned)
+    {
+    delete result;
+    delete call;
+    return;
+    }
+  result->moveToThread(call->CallerThread);
+  call->Result = result;
+  call->Finished = true;
+  this->Client->CallFinished.wakeAll();
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingTransport::shutdown()
+{
+  delete this->RestAPI;
+  this->RestAPI = 0;
+  // The network managers are deleted later.
+  QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+  QMutexLocker locker(&this->Client->Mutex);
+  qDeleteAll(this->PendingCalls);
+  this->PendingCalls.clear();
+}
+
+// --------------------------------------------------------------------------
+// qRestBlockingClientPrivate methods
+
+// --------------------------------------------------------------------------
+qRestBlockingClientPrivate::qRestBlockingClientPrivate()
+  : Factory(0)
+  , Transport(0)
+  , ConfigurationGeneration(0)
+  , TimeOut(0)
+{
+}
+
+// --------------------------------------------------------------------------
+// qRestBlockingClient methods
+
+// --------------------------------------------------------------------------
+qRestBlockingClient::qRestBlockingClient(APIFactory factory)
+  : d_ptr(new qRestBlockingClientPrivate)
+{
+  Q_D(qRestBlockingClient);
+  d->Factory = factory;
+  d->Transport = new qRestBlockingTransport(d);
+  d->Transport->moveToThread(&d->Thread);
+  d->Thread.start();
+}
+
+// --------------------------------------------------------------------------
+qRestBlockingClient::~qRestBlockingClient()
+{
+  Q_D(qRestBlockingClient);
+  QMetaObject::invokeMethod(d->Transport, "shutdown", Qt::BlockingQueuedConnection);
+  d->Thread.quit();
+  d->Thread.wait();
+  delete d->Transport;
+}
+
+// --------------------------------------------------------------------------
+QString qRestBlockingClient::serverUrl() const
+{
+  Q_D(const qRestBlockingClient);
+  QMutexLocker locker(&d->Mutex);
+  return d->ServerUrl;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClient::setServerUrl(const QString& serverUrl)
+{
+  Q_D(qRestBlockingClient);
+  QMutexLocker locker(&d->Mutex);
+  d->ServerUrl = serverUrl;
+  ++d->ConfigurationGeneration;
+}
+
+// --------------------------------------------------------------------------
+qRestAPI::RawHeaders qRestBlockingClient::defaultRawHeaders() const
+{
+  Q_D(const qRestBlockingClient);
+  QMutexLocker locker(&d->Mutex);
+  return d->DefaultRawHeaders;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClient::setDefaultRawHeaders(const qRestAPI::RawHeaders& defaultRawHeaders)
+{
+  Q_D(qRestBlockingClient);
+  QMutexLocker locker(&d->Mutex);
+  d->DefaultRawHeaders = defaultRawHeaders;
+  ++d->ConfigurationGeneration;
+}
+
+// --------------------------------------------------------------------------
+int qRestBlockingClient::timeOut() const
+{
+  Q_D(const qRestBlockingClient);
+  QMutexLocker locker(&d->Mutex);
+  return d->TimeOut;
+}
+
+// --------------------------------------------------------------------------
+void qRestBlockingClient::setTimeOut(int msecs)
+{
+  Q_D(qRestBlockingClient);
+  QMutexLocker locker(&d->Mutex);
+  d->TimeOut = qMax(msecs, 0);
+}
+
+// --------------------------------------------------------------------------
+qRestResult* qRestBlockingClient::send(QNetworkAccessManager::Operation operation,
+                                       const QString& resource,
+                                       const qRestAPI::Parameters& parameters,
+                                       const qRestAPI::RawHeaders& rawHeaders,
+                                       const QByteArray& data)
+{
+  Q_D(qRestBlockingClient);
+  qRestBlockingCall* call = new qRestBlockingCall;
+  call->Operation = operation;
+  call->Resource = resource;
+  call->Parameters = parameters;
+  call->RawHeaders = rawHeaders;
+  call->Data = data;
+  call->CallerThread = QThread::currentThread();
+
+  QElapsedTimer timer;
+  timer.start();
+  QMutexLocker locker(&d->Mutex);
+  int timeOut = d->TimeOut;
+  QCoreApplication::postEvent(d->Transport, new qRestBlockingSendEvent(call));
+  while (!call->Finished)
+    {
+    unsigned long remaining = ULONG_MAX;
+    if (timeOut > 0)
+      {
+      qint64 elapsed = timer.elapsed();
+      if (elapsed >= timeOut)
+        {
+        break;
+        }
+      remaining = static_cast<unsigned long>(timeOut - elapsed);
+      }
+    d->CallFinished.wait(&d->Mutex, remaining);
+    }
+
+  if (!call->Finished)
+    {
+    // The transport thread deletes the call.
+    call->Abandoned = true;
+    return errorResult(QUuid(), "Request timed out", qRestAPI::TimeoutError);
+    }
+  qRestResult* result = call->Result;
+  delete call;
+  return result;
+}
+
+// --------------------------------------------------------------------------
+qRestResult* qRestBlockingClient::get(const QString& resource,
+                                      const qRestAPI::Parameters& parameters,
+                                      const qRestAPI::RawHeaders& rawHeaders)
+{
+  return this->send(QNetworkAccessManager::GetOperation, resource, parameters, rawHeaders);
+}
@@ -0,0 +1,113 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestBlockingClient_h
+#define __qRestBlockingClient_h
+
+// Qt includes
+#include <QNetworkAccessManager>
+#include <QScopedPointer>
+#include <QString>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+
+#include "qRestAPI_Export.h"
+
+class qRestBlockingClientPrivate;
+class qRestResult;
+
+/// qRestBlockingClient sends queries and blocks until their results are
+/// received, without running an event loop in the calling thread.
+///
+/// The queries are sent by a qRestAPI object living in an internal
+/// transport thread. The calling thread waits on a wait condition until the
+/// result is received or the time out expires: unlike qRestAPI::sync(), no
+/// slot or event of the calling thread is processed while waiting. The
+/// client can be used from several threads at the same time.
+///
+/// A QCoreApplication object must exist, its event loop does not need to
+/// run.
+///
+/// Usage:
+/// <code>
+/// qRestAPI* createGirderAPI() { return new qGirderAPI; }
+/// ...
+/// qRestBlockingClient client(&createGirderAPI);
+/// client.setServerUrl("https://data.kitware.com/api/v1");
+/// client.setTimeOut(10000);
+/// QScopedPointer<qRestResult> result(client.get("/folder", parameters));
+/// if (result->error().isEmpty())
+///   {
+///   ... result->results() ...
+///   }
+/// </code>
+class qRestAPI_EXPORT qRestBlockingClient
+{
+public:
+  /// Function creating the qRestAPI object of the client. It is called in
+  /// the transport thread.
+  typedef qRestAPI* (*APIFactory)();
+
+  /// Constructs a client sending the queries using a qRestAPI object, or
+  /// an object created by \a factory if any.
+  explicit qRestBlockingClient(APIFactory factory = 0);
+  /// Stops the transport thread, the queries in progress are aborted.
+  /// No call must be waiting.
+  virtual ~qRestBlockingClient();
+
+  QString serverUrl() const;
+  /// Sets the URL of the web application, used by the queries sent after.
+  void setServerUrl(const QString& serverUrl);
+
+  qRestAPI::RawHeaders defaultRawHeaders() const;
+  /// Sets the raw headers of every request, used by the queries sent after.
+  void setDefaultRawHeaders(const qRestAPI::RawHeaders& defaultRawHeaders);
+
+  /// Maximum time in milliseconds a call waits for the result of its query.
+  /// 0 (default) waits until the result is received.
+  /// A query whose result is not waited for anymore is not aborted: it
+  /// finishes in the transport thread, within the time out of the qRestAPI
+  /// object if any, and its result is discarded.
+  int timeOut() const;
+  void setTimeOut(int msecs);
+
+  /// Sends a request and blocks until its result is received or timeOut()
+  /// expires. \a data is the body of PUT and POST requests.
+  /// Returns the result of the query, owned by the caller and never null.
+  /// Its error() is empty if the query succeeded, its errorType() is
+  /// qRestAPI::TimeoutError if timeOut() expired.
+  qRestResult* send(QNetworkAccessManager::Operation operation,
+                    const QString& resource,
+                    const qRestAPI::Parameters& parameters = qRestAPI::Parameters(),
+                    const qRestAPI::RawHeaders& rawHeaders = qRestAPI::RawHeaders(),
+                    const QByteArray& data = QByteArray());
+
+  /// Sends a GET request and blocks until its result is received.
+  /// \sa send()
+  qRestResult* get(const QString& resource,
+                   const qRestAPI::Parameters& parameters = qRestAPI::Parameters(),
+                   const qRestAPI::RawHeaders& rawHeaders = qRestAPI::RawHeaders());
+
+private:
+  QScopedPointer<qRestBlockingClientPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qRestBlockingClient);
+  Q_DISABLE_COPY(qRestBlockingClient);
+};
+
+#endif
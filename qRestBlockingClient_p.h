@@ -0,0 +1,115 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestBlockingClient_p_h
+#define __qRestBlockingClient_p_h
+
+// Qt includes
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QUuid>
+#include <QWaitCondition>
+
+// qRestAPI includes
+#include "qRestBlockingClient.h"
+
+// --------------------------------------------------------------------------
+/// A query of a qRestBlockingClient, shared by the calling thread and the
+/// transport thread. Its state is protected by the mutex of the client.
+struct qRestBlockingCall
+{
+  qRestBlockingCall();
+
+  QNetworkAccessManager::Operation Operation;
+  QString Resource;
+  qRestAPI::Parameters Parameters;
+  qRestAPI::RawHeaders RawHeaders;
+  QByteArray Data;
+  /// Thread the result is moved to.
+  QThread* CallerThread;
+
+  /// Set by the transport thread when the query is finished.
+  qRestResult* Result;
+  bool Finished;
+  /// The calling thread stopped waiting, the transport thread deletes the
+  /// call when the query is finished.
+  bool Abandoned;
+};
+
+class QBuffer;
+class qRestBlockingClientPrivate;
+
+// --------------------------------------------------------------------------
+/// Sends the queries of a qRestBlockingClient, lives in the transport
+/// thread. Calls are received as events.
+class qRestBlockingTransport : public QObject
+{
+  Q_OBJECT
+
+public:
+  qRestBlockingTransport(qRestBlockingClientPrivate* client);
+
+  /// Type of the events carrying a call to send.
+  static QEvent::Type sendEventType();
+
+  bool event(QEvent* event);
+
+public slots:
+  void queryFinished(const QUuid& queryId);
+  /// Deletes the qRestAPI object and its network managers.
+  void shutdown();
+
+protected:
+  void send(qRestBlockingCall* call);
+  /// Hands over \a result to \a call and wakes up the calling threads.
+  void finishCall(qRestBlockingCall* call, qRestResult* result);
+
+  qRestBlockingClientPrivate* const Client;
+  qRestAPI* RestAPI;
+  /// Configuration of the client applied to RestAPI.
+  int ConfigurationGeneration;
+  QHash<QUuid, qRestBlockingCall*> PendingCalls;
+  /// Bodies of the PUT and POST queries in progress.
+  QHash<QUuid, QBuffer*> PendingBodies;
+};
+
+// --------------------------------------------------------------------------
+class qRestBlockingClientPrivate
+{
+public:
+  qRestBlockingClientPrivate();
+
+  qRestBlockingClient::APIFactory Factory;
+  QThread Thread;
+  qRestBlockingTransport* Transport;
+
+  /// Protects the calls and the configuration.
+  mutable QMutex Mutex;
+  /// Signaled when a query is finished.
+  QWaitCondition CallFinished;
+
+  QString ServerUrl;
+  qRestAPI::RawHeaders DefaultRawHeaders;
+  /// Incremented when the configuration changes.
+  int ConfigurationGeneration;
+  int TimeOut;
+};
+
+#endif
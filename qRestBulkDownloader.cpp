@@ -0,0 +1,428 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+
+// qRestAPI includes
+#include "qRestBulkDownloader.h"
+#include "qRestBulkDownloader_p.h"
+#include "qRestResult.h"
+
+// --------------------------------------------------------------------------
+// qRestDownloadEntry methods
+
+// --------------------------------------------------------------------------
+qRestDownloadEntry::qRestDownloadEntry(const QString& resource,
+                                       const QString& fileName,
+                                       const qRestAPI::Parameters& parameters)
+  : Resource(resource)
+  , Parameters(parameters)
+  , FileName(fileName)
+  , Size(-1)
+  , ChecksumAlgorithm(QCryptographicHash::Sha512)
+{
+}
+
+// --------------------------------------------------------------------------
+// qRestBulkDownloaderPrivate methods
+
+// --------------------------------------------------------------------------
+qRestBulkDownloaderPrivate::qRestBulkDownloaderPrivate(qRestBulkDownloader* object)
+  : q_ptr(object)
+  , MaximumConcurrentDownloads(4)
+  , MaximumRetries(2)
+  , RetryDelay(1000)
+  , SkipExisting(true)
+  , Running(false)
+  , Cancelled(false)
+  , Downloaded(0)
+  , Skipped(0)
+  , Failed(0)
+  , Retries(0)
+  , BytesDownloaded(0)
+  , BytesSkipped(0)
+  , Elapsed(0)
+{
+  this->RetryTimer.setSingleShot(true);
+  connect(&this->RetryTimer, SIGNAL(timeout()),
+          this, SLOT(sendQueries()));
+}
+
+// --------------------------------------------------------------------------
+bool qRestBulkDownloaderPrivate::isPresent(const qRestDownloadEntry& entry)
+{
+  QFileInfo fileInfo(entry.FileName);
+  if (!fileInfo.isFile() ||
+      (entry.Size >= 0 && fileInfo.size() != entry.Size))
+    {
+    return false;
+    }
+  if (entry.Checksum.isEmpty())
+    {
+    return true;
+    }
+  QFile file(entry.FileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return false;
+    }
+  QCryptographicHash hash(entry.ChecksumAlgorithm);
+  while (!file.atEnd())
+    {
+    hash.addData(file.read(1024 * 1024));
+    }
+  return hash.result().toHex() == entry.Checksum.toLower();
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderPrivate::sendQueries()
+{
+  // Retries whose time has come are sent first.
+  qint64 now = this->Clock.elapsed();
+  while (!this->RetryQueue.isEmpty() && this->RetryQueue.begin().key() <= now)
+    {
+    this->Queue.prepend(this->RetryQueue.take(this->RetryQueue.begin().key()));
+    }
+
+  while (!this->Cancelled && this->RestAPI && !this->Queue.isEmpty() &&
+         this->PendingQueries.size() < this->MaximumConcurrentDownloads)
+    {
+    this->sendQuery(this->Queue.takeFirst());
+    }
+
+  if (!this->RetryQueue.isEmpty() && !this->Cancelled)
+    {
+    this->RetryTimer.start(static_cast<int>(qMax(Q_INT64_C(0), this->RetryQueue.begin().key() - now)));
+    }
+
+  if (this->PendingQueries.isEmpty() &&
+      (this->Cancelled || !this->RestAPI ||
+       (this->Queue.isEmpty() && this->RetryQueue.isEmpty())))
+    {
+    this->finish();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderPrivate::sendQuery(int index)
+{
+  const qRestDownloadEntry& entry = this->Manifest.at(index);
+  EntryState& state = this->States[index];
+  state.EntryStatus = qRestBulkDownloader::Downloading;
+  ++state.Attempts;
+
+  QUuid queryId;
+  if (entry.Checksum.isEmpty())
+    {
+    queryId = this->RestAPI->download(entry.FileName, entry.Resource,
+                                      entry.Parameters, entry.RawHeaders);
+    }
+  else
+    {
+    queryId = this->RestAPI->download(entry.FileName, entry.Resource,
+                                      entry.Parameters, entry.RawHeaders,
+                                      entry.Checksum.toLower(), entry.ChecksumAlgorithm);
+    }
+  if (queryId.isNull())
+    {
+    this->downloadFailed(index, this->RestAPI->error(), this->RestAPI->errorString());
+    return;
+    }
+  this->PendingQueries.insert(queryId, index);
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderPrivate::queryFinished(const QUuid& queryId)
+{
+  if (!this->PendingQueries.contains(queryId) || !this->RestAPI)
+    {
+    return;
+    }
+  int index = this->PendingQueries.take(queryId);
+  QScopedPointer<qRestResult> result(this->RestAPI->takeResult(queryId));
+  if (result)
+    {
+    this->BytesDownloaded += QFileInfo(this->Manifest.at(index).FileName).size();
+    this->entryDone(index, qRestBulkDownloader::Downloaded);
+    }
+  else
+    {
+    this->downloadFailed(index, this->RestAPI->error(), this->RestAPI->errorString());
+    }
+  this->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderPrivate::downloadFailed(int index, qRestAPI::ErrorType error,
+                                                const QString& errorString)
+{
+  EntryState& state = this->States[index];
+  state.Error = error;
+  state.ErrorString = errorString;
+  // Local errors are not fixed by sending the query again.
+  bool retry = error != qRestAPI::FileError && error != qRestAPI::AuthenticationError;
+  if (retry && !this->Cancelled && state.Attempts <= this->MaximumRetries)
+    {
+    ++this->Retries;
+    state.EntryStatus = qRestBulkDownloader::Pending;
+    qint64 delay = static_cast<qint64>(this->RetryDelay) << (state.Attempts - 1);
+    this->RetryQueue.insert(this->Clock.elapsed() + delay, index);
+    return;
+    }
+  this->Errors << QString("%1: %2").arg(this->Manifest.at(index).Resource).arg(errorString);
+  this->entryDone(index, qRestBulkDownloader::Failed);
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderPrivate::entryDone(int index, qRestBulkDownloader::Status status)
+{
+  Q_Q(qRestBulkDownloader);
+  this->States[index].EntryStatus = status;
+  switch (status)
+    {
+    case qRestBulkDownloader::Downloaded:
+      ++this->Downloaded;
+      break;
+    case qRestBulkDownloader::Skipped:
+      ++this->Skipped;
+      break;
+    case qRestBulkDownloader::Failed:
+      ++this->Failed;
+      break;
+    default:
+      break;
+    }
+  emit q->entryFinished(index, status);
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloaderPrivate::finish()
+{
+  Q_Q(qRestBulkDownloader);
+  if (!this->Running)
+    {
+    return;
+    }
+  this->Running = false;
+  this->RetryTimer.stop();
+  this->Elapsed = this->Clock.elapsed();
+  emit q->finished(!this->Cancelled && this->Failed == 0);
+}
+
+// --------------------------------------------------------------------------
+// qRestBulkDownloader methods
+
+// --------------------------------------------------------------------------
+qRestBulkDownloader::qRestBulkDownloader(qRestAPI* restAPI, QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new qRestBulkDownloaderPrivate(this))
+{
+  Q_D(qRestBulkDownloader);
+  d->RestAPI = restAPI;
+  QObject::connect(restAPI, SIGNAL(finished(QUuid)),
+                   d, SLOT(queryFinished(QUuid)));
+}
+
+// --------------------------------------------------------------------------
+qRestBulkDownloader::~qRestBulkDownloader()
+{
+}
+
+// --------------------------------------------------------------------------
+int qRestBulkDownloader::maximumConcurrentDownloads()const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->MaximumConcurrentDownloads;
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloader::setMaximumConcurrentDownloads(int count)
+{
+  Q_D(qRestBulkDownloader);
+  d->MaximumConcurrentDownloads = qMax(1, count);
+}
+
+// --------------------------------------------------------------------------
+int qRestBulkDownloader::maximumRetries()const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->MaximumRetries;
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloader::setMaximumRetries(int count)
+{
+  Q_D(qRestBulkDownloader);
+  d->MaximumRetries = qMax(0, count);
+}
+
+// --------------------------------------------------------------------------
+int qRestBulkDownloader::retryDelay()const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->RetryDelay;
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloader::setRetryDelay(int milliseconds)
+{
+  Q_D(qRestBulkDownloader);
+  d->RetryDelay = qMax(0, milliseconds);
+}
+
+// --------------------------------------------------------------------------
+bool qRestBulkDownloader::skipExisting()const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->SkipExisting;
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloader::setSkipExisting(bool skip)
+{
+  Q_D(qRestBulkDownloader);
+  d->SkipExisting = skip;
+}
+
+// --------------------------------------------------------------------------
+bool qRestBulkDownloader::start(const QList<qRestDownloadEntry>& manifest)
+{
+  Q_D(qRestBulkDownloader);
+  if (d->Running || !d->RestAPI)
+    {
+    return false;
+    }
+  d->Manifest = manifest;
+  d->States.clear();
+  d->Queue.clear();
+  d->RetryQueue.clear();
+  d->Downloaded = 0;
+  d->Skipped = 0;
+  d->Failed = 0;
+  d->Retries = 0;
+  d->BytesDownloaded = 0;
+  d->BytesSkipped = 0;
+  d->Elapsed = 0;
+  d->Errors.clear();
+  d->Cancelled = false;
+  d->Running = true;
+  d->Clock.start();
+
+  for (int index = 0; index < d->Manifest.size(); ++index)
+    {
+    d->States << qRestBulkDownloaderPrivate::EntryState();
+    const qRestDownloadEntry& entry = d->Manifest.at(index);
+    if (d->SkipExisting && qRestBulkDownloaderPrivate::isPresent(entry))
+      {
+      d->BytesSkipped += QFileInfo(entry.FileName).size();
+      d->entryDone(index, Skipped);
+      continue;
+      }
+    d->Queue << index;
+    }
+  d->sendQueries();
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qRestBulkDownloader::cancel()
+{
+  Q_D(qRestBulkDownloader);
+  if (!d->Running)
+    {
+    return;
+    }
+  d->Cancelled = true;
+  d->RetryTimer.stop();
+  d->sendQueries();
+}
+
+// --------------------------------------------------------------------------
+bool qRestBulkDownloader::isRunning()const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->Running;
+}
+
+// --------------------------------------------------------------------------
+bool qRestBulkDownloader::wait()
+{
+  Q_D(qRestBulkDownloader);
+  if (d->Running)
+    {
+    QEventLoop eventLoop;
+    QObject::connect(this, SIGNAL(finished(bool)),
+                     &eventLoop, SLOT(quit()));
+    eventLoop.exec();
+    }
+  return !d->Cancelled && d->Failed == 0;
+}
+
+// --------------------------------------------------------------------------
+QList<qRestDownloadEntry> qRestBulkDownloader::manifest()const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->Manifest;
+}
+
+// --------------------------------------------------------------------------
+qRestBulkDownloader::Status qRestBulkDownloader::status(int index)const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->States.value(index).EntryStatus;
+}
+
+// --------------------------------------------------------------------------
+int qRestBulkDownloader::attempts(int index)const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->States.value(index).Attempts;
+}
+
+// --------------------------------------------------------------------------
+qRestAPI::ErrorType qRestBulkDownloader::error(int index)const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->States.value(index).Error;
+}
+
+// --------------------------------------------------------------------------
+QString qRestBulkDownloader::errorString(int index)const
+{
+  Q_D(const qRestBulkDownloader);
+  return d->States.value(index).ErrorString;
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qRestBulkDownloader::summary()const
+{
+  Q_D(const qRestBulkDownloader);
+  QVariantMap summary;
+  summary["entries"] = d->Manifest.size();
+  summary["downloaded"] = d->Downloaded;
+  summary["skipped"] = d->Skipped;
+  summary["failed"] = d->Failed;
+  summary["retries"] = d->Retries;
+  summary["bytesDownloaded"] = d->BytesDownloaded;
+  summary["bytesSkipped"] = d->BytesSkipped;
+  summary["elapsed"] = d->Running ? d->Clock.elapsed() : d->Elapsed;
+  summary["errors"] = d->Errors;
+  return summary;
+}
@@ -0,0 +1,160 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestBulkDownloader_h
+#define __qRestBulkDownloader_h
+
+// Qt includes
+#include <QCryptographicHash>
+#include <QList>
+#include <QObject>
+#include <QScopedPointer>
+#include <QVariantMap>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+
+#include "qRestAPI_Export.h"
+
+class qRestBulkDownloaderPrivate;
+
+/// qRestDownloadEntry is a file to download by qRestBulkDownloader.
+struct qRestAPI_EXPORT qRestDownloadEntry
+{
+  qRestDownloadEntry(const QString& resource = QString(),
+                     const QString& fileName = QString(),
+                     const qRestAPI::Parameters& parameters = qRestAPI::Parameters());
+
+  QString Resource;
+  qRestAPI::Parameters Parameters;
+  qRestAPI::RawHeaders RawHeaders;
+  /// Local file the resource is written to.
+  QString FileName;
+  /// Expected size in bytes, -1 (default) if unknown.
+  qint64 Size;
+  /// Expected hexadecimal checksum computed with ChecksumAlgorithm, empty
+  /// (default) if unknown. It is verified while downloading.
+  QByteArray Checksum;
+  QCryptographicHash::Algorithm ChecksumAlgorithm;
+};
+
+/// qRestBulkDownloader downloads a manifest of resources to local files.
+///
+/// Entries are downloaded by qRestAPI::download() with at most
+/// maximumConcurrentDownloads() queries in progress. Failed downloads are
+/// retried after retryDelay(), doubled at each attempt. Files that already
+/// exist locally with the expected size and checksum are skipped.
+///
+/// finished() is emitted once all the entries are done, the status of each
+/// entry is then available by index.
+///
+/// Usage:
+/// <code>
+/// QList<qRestDownloadEntry> manifest;
+/// foreach(const QString& bitstreamId, bitstreamIds)
+///   {
+///   manifest << qRestDownloadEntry("/bitstream/" + bitstreamId + "/download",
+///                                  dir.filePath(bitstreamId));
+///   }
+/// qRestBulkDownloader downloader(&restAPI);
+/// downloader.start(manifest);
+/// downloader.wait();
+/// </code>
+class qRestAPI_EXPORT qRestBulkDownloader : public QObject
+{
+  Q_OBJECT
+
+  /// Maximum number of downloads in progress at the same time. Default is 4.
+  Q_PROPERTY(int maximumConcurrentDownloads READ maximumConcurrentDownloads WRITE setMaximumConcurrentDownloads)
+
+  /// Number of times a failed download is sent again. Default is 2.
+  Q_PROPERTY(int maximumRetries READ maximumRetries WRITE setMaximumRetries)
+
+  /// Milliseconds before the first retry of a download, doubled at each
+  /// retry. Default is 1000.
+  Q_PROPERTY(int retryDelay READ retryDelay WRITE setRetryDelay)
+
+  /// Skip the entries whose file exists and matches the expected size and
+  /// checksum, if any. Default is true.
+  Q_PROPERTY(bool skipExisting READ skipExisting WRITE setSkipExisting)
+
+  typedef QObject Superclass;
+
+public:
+  enum Status
+  {
+    Pending = 0,
+    Downloading,
+    Downloaded,
+    Skipped,
+    Failed
+  };
+
+  explicit qRestBulkDownloader(qRestAPI* restAPI, QObject* parent = 0);
+  virtual ~qRestBulkDownloader();
+
+  int maximumConcurrentDownloads()const;
+  void setMaximumConcurrentDownloads(int count);
+
+  int maximumRetries()const;
+  void setMaximumRetries(int count);
+
+  int retryDelay()const;
+  void setRetryDelay(int milliseconds);
+
+  bool skipExisting()const;
+  void setSkipExisting(bool skip);
+
+  /// Starts downloading the entries of \a manifest.
+  /// Returns false if a download is in progress.
+  bool start(const QList<qRestDownloadEntry>& manifest);
+  /// Stops sending queries. The downloads in progress are completed before
+  /// finished() is emitted, the other entries are left Pending.
+  void cancel();
+  bool isRunning()const;
+
+  /// Blocks until all the entries are done. Returns true if they were all
+  /// downloaded or skipped.
+  bool wait();
+
+  /// Entries of the current or last manifest.
+  QList<qRestDownloadEntry> manifest()const;
+  Status status(int index)const;
+  /// Number of queries sent for the entry \a index.
+  int attempts(int index)const;
+  /// Error of the last attempt of a Failed entry.
+  qRestAPI::ErrorType error(int index)const;
+  QString errorString(int index)const;
+
+  /// Counts of the current or last manifest: "entries", "downloaded",
+  /// "skipped", "failed", "retries", "bytesDownloaded", "bytesSkipped",
+  /// "elapsed" (milliseconds) and "errors" (list of strings).
+  QVariantMap summary()const;
+
+signals:
+  /// Emitted when the entry \a index is downloaded, skipped or failed.
+  void entryFinished(int index, int status);
+  void finished(bool success);
+
+private:
+  QScopedPointer<qRestBulkDownloaderPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qRestBulkDownloader);
+  Q_DISABLE_COPY(qRestBulkDownloader);
+};
+
+#endif
@@ -0,0 +1,102 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestBulkDownloader_p_h
+#define __qRestBulkDownloader_p_h
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMultiMap>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QUuid>
+
+// qRestAPI includes
+#include "qRestBulkDownloader.h"
+
+// --------------------------------------------------------------------------
+class qRestBulkDownloaderPrivate : public QObject
+{
+  Q_OBJECT
+
+  Q_DECLARE_PUBLIC(qRestBulkDownloader);
+
+  qRestBulkDownloader* const q_ptr;
+
+public:
+  qRestBulkDownloaderPrivate(qRestBulkDownloader* object);
+
+  struct EntryState
+  {
+    EntryState() : EntryStatus(qRestBulkDownloader::Pending), Attempts(0),
+      Error(qRestAPI::UnknownError) {}
+    qRestBulkDownloader::Status EntryStatus;
+    int Attempts;
+    qRestAPI::ErrorType Error;
+    QString ErrorString;
+  };
+
+  /// Returns true if the file of \a entry exists with the expected size
+  /// and checksum.
+  static bool isPresent(const qRestDownloadEntry& entry);
+
+  void sendQuery(int index);
+  /// Retries the entry \a index or marks it as Failed.
+  void downloadFailed(int index, qRestAPI::ErrorType error, const QString& errorString);
+  void entryDone(int index, qRestBulkDownloader::Status status);
+  void finish();
+
+public slots:
+  /// Sends queries until MaximumConcurrentDownloads are in progress.
+  void sendQueries();
+  void queryFinished(const QUuid& queryId);
+
+public:
+  QPointer<qRestAPI> RestAPI;
+  int MaximumConcurrentDownloads;
+  int MaximumRetries;
+  int RetryDelay;
+  bool SkipExisting;
+
+  bool Running;
+  bool Cancelled;
+  QElapsedTimer Clock;
+
+  QList<qRestDownloadEntry> Manifest;
+  QList<EntryState> States;
+  /// Indexes of the entries to send.
+  QList<int> Queue;
+  /// Indexes of the entries to send again, by time of the retry.
+  QMultiMap<qint64, int> RetryQueue;
+  QTimer RetryTimer;
+  QHash<QUuid, int> PendingQueries;
+
+  int Downloaded;
+  int Skipped;
+  int Failed;
+  int Retries;
+  qint64 BytesDownloaded;
+  qint64 BytesSkipped;
+  qint64 Elapsed;
+  QStringList Errors;
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QTimer>
+
+// qRestAPI includes
+#include "qRestCannedReply.h"
+
+// STD includes
+#include <cstring>
+
+// --------------------------------------------------------------------------
+qRestCannedReply::qRestCannedReply(QNetworkAccessManager::Operation operation,
+                                   const QNetworkRequest& request, QObject* parent)
+  : Superclass(parent)
+  , StatusCode(0)
+  , Offset(0)
+  , Error(QNetworkReply::NoError)
+  , FirstByteDelay(0)
+  , LastByteDelay(0)
+  , HeadersDelivered(false)
+  , FinishTimer(new QTimer(this))
+{
+  this->setOperation(operation);
+  this->setRequest(request);
+  this->setUrl(request.url());
+  this->FinishTimer->setSingleShot(true);
+  QObject::connect(this->FinishTimer, SIGNAL(timeout()),
+                   this, SLOT(finishReply()));
+}
+
+// --------------------------------------------------------------------------
+qRestCannedReply::~qRestCannedReply()
+{
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::setHttpStatus(int statusCode, const QByteArray& reasonPhrase)
+{
+  this->StatusCode = statusCode;
+  this->ReasonPhrase = reasonPhrase;
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::setResponseHeaders(const RawHeaderPairs& headers)
+{
+  this->Headers = headers;
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::setBody(const QByteArray& body)
+{
+  this->Body = body;
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::setNetworkError(QNetworkReply::NetworkError error, const QString& errorString)
+{
+  this->Error = error;
+  this->ErrorString = errorString;
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::setDelays(int firstByteDelay, int lastByteDelay)
+{
+  this->FirstByteDelay = qMax(0, firstByteDelay);
+  this->LastByteDelay = qMax(this->FirstByteDelay, lastByteDelay);
+}
+
+// --------------------------------------------------------------------------
+int qRestCannedReply::firstByteDelay() const
+{
+  return this->FirstByteDelay;
+}
+
+// --------------------------------------------------------------------------
+int qRestCannedReply::lastByteDelay() const
+{
+  return this->LastByteDelay;
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::start()
+{
+  this->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+  QTimer::singleShot(this->FirstByteDelay, this, SLOT(deliverHeaders()));
+  this->FinishTimer->start(this->LastByteDelay);
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::abort()
+{
+  if (this->isFinished())
+    {
+    return;
+    }
+  this->Error = QNetworkReply::OperationCanceledError;
+  this->ErrorString = "Operation canceled";
+  this->Body.clear();
+  this->Offset = 0;
+  this->FinishTimer->stop();
+  this->finishReply();
+}
+
+// --------------------------------------------------------------------------
+bool qRestCannedReply::isSequential() const
+{
+  return true;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestCannedReply::bytesAvailable() const
+{
+  qint64 available = this->HeadersDelivered ? this->Body.size() - this->Offset : 0;
+  return available + Superclass::bytesAvailable();
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestCannedReply::readData(char* data, qint64 maxSize)
+{
+  if (!this->HeadersDelivered)
+    {
+    return 0;
+    }
+  qint64 size = qMin(maxSize, this->Body.size() - this->Offset);
+  if (size <= 0)
+    {
+    return this->isFinished() ? -1 : 0;
+    }
+  memcpy(data, this->Body.constData() + this->Offset, size);
+  this->Offset += size;
+  return size;
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::deliverHeaders()
+{
+  if (this->HeadersDelivered || this->isFinished())
+    {
+    return;
+    }
+  this->HeadersDelivered = true;
+  if (this->StatusCode > 0)
+    {
+    this->setAttribute(QNetworkRequest::HttpStatusCodeAttribute, this->StatusCode);
+    this->setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, this->ReasonPhrase);
+    }
+  foreach(const RawHeaderPairs::value_type& header, this->Headers)
+    {
+    this->setRawHeader(header.first, header.second);
+    }
+  if (!this->header(QNetworkRequest::ContentLengthHeader).isValid())
+    {
+    this->setHeader(QNetworkRequest::ContentLengthHeader, this->Body.size());
+    }
+  emit metaDataChanged();
+  this->deliverBody();
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::deliverBody()
+{
+  if (this->Body.isEmpty())
+    {
+    return;
+    }
+  emit readyRead();
+  emit downloadProgress(this->Body.size(), this->Body.size());
+}
+
+// --------------------------------------------------------------------------
+void qRestCannedReply::finishReply()
+{
+  if (this->isFinished())
+    {
+    return;
+    }
+  this->deliverHeaders();
+  if (this->Error != QNetworkReply::NoError)
+    {
+    this->setError(this->Error, this->ErrorString);
+#if (QT_VERSION >= QT_VERSION_CHECK(5,15,0))
+    emit errorOccurred(this->Error);
+#else
+    emit error(this->Error);
+#endif
+    }
+  this->setFinished(true);
+  emit finished();
+}
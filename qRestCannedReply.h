@@ -0,0 +1,93 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestCannedReply_h
+#define __qRestCannedReply_h
+
+// Qt includes
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPair>
+
+#include "qRestAPI_Export.h"
+
+class QTimer;
+
+/// qRestCannedReply is a network reply whose response is known in advance.
+///
+/// It is returned by network access managers that do not send requests,
+/// e.g. to replay recorded responses. Once start() is called, the headers
+/// are delivered after firstByteDelay() and the reply finishes after
+/// lastByteDelay(), emitting the same signals as a network reply.
+/// \sa qRestReplayNetworkAccessManager
+class qRestAPI_EXPORT qRestCannedReply : public QNetworkReply
+{
+  Q_OBJECT
+
+  typedef QNetworkReply Superclass;
+
+public:
+  typedef QList<QPair<QByteArray, QByteArray> > RawHeaderPairs;
+
+  qRestCannedReply(QNetworkAccessManager::Operation operation,
+                   const QNetworkRequest& request, QObject* parent = 0);
+  virtual ~qRestCannedReply();
+
+  void setHttpStatus(int statusCode, const QByteArray& reasonPhrase = QByteArray());
+  void setResponseHeaders(const RawHeaderPairs& headers);
+  void setBody(const QByteArray& body);
+  /// Makes the reply fail with \a error once finished.
+  void setNetworkError(QNetworkReply::NetworkError error, const QString& errorString);
+
+  /// Delays in milliseconds from start() until the headers and the body are
+  /// delivered, and until the reply is finished. Both are 0 by default.
+  void setDelays(int firstByteDelay, int lastByteDelay);
+  int firstByteDelay() const;
+  int lastByteDelay() const;
+
+  /// Starts delivering the response. Signals are always emitted
+  /// asynchronously, from the event loop.
+  void start();
+
+  virtual void abort();
+  virtual bool isSequential() const;
+  virtual qint64 bytesAvailable() const;
+
+protected:
+  virtual qint64 readData(char* data, qint64 maxSize);
+
+protected slots:
+  void deliverHeaders();
+  void deliverBody();
+  void finishReply();
+
+private:
+  int StatusCode;
+  QByteArray ReasonPhrase;
+  RawHeaderPairs Headers;
+  QByteArray Body;
+  qint64 Offset;
+  QNetworkReply::NetworkError Error;
+  QString ErrorString;
+  int FirstByteDelay;
+  int LastByteDelay;
+  bool HeadersDelivered;
+  QTimer* FinishTimer;
+};
+
+#endif
@@ -0,0 +1,422 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+// qRestAPI includes
+#include "qRestCircuitBreaker.h"
+#include "qRestMetrics.h"
+
+namespace
+{
+// --------------------------------------------------------------------------
+struct Endpoint
+{
+  Endpoint() : EndpointState(qRestCircuitBreaker::Closed), Next(0), Count(0),
+    Failures(0), OpenedAt(0), Trials(0), TrialSuccesses(0) {}
+
+  qRestCircuitBreaker::State EndpointState;
+  /// Ring buffer of the last outcomes, true for failures.
+  QVector<bool> Outcomes;
+  int Next;
+  int Count;
+  int Failures;
+  /// Time the endpoint was opened, or half opened.
+  qint64 OpenedAt;
+  /// Trial queries sent and succeeded since the endpoint is HalfOpen.
+  int Trials;
+  int TrialSuccesses;
+};
+}
+
+// --------------------------------------------------------------------------
+class qRestCircuitBreakerPrivate
+{
+public:
+  qRestCircuitBreakerPrivate();
+
+  /// Moves an Open endpoint whose open duration elapsed to HalfOpen.
+  void update(Endpoint& endpoint, qint64 now) const;
+  void open(Endpoint& endpoint, qint64 now) const;
+  void close(Endpoint& endpoint) const;
+  QString key(const QUrl& url) const;
+
+  mutable QMutex Mutex;
+  double FailureRatio;
+  int MinimumRequests;
+  int WindowSize;
+  int SlowCallDuration;
+  int OpenDuration;
+  int HalfOpenRequests;
+  QStringList ResourcePrefixes;
+  /// The state of an endpoint changes when it is read, the endpoints are
+  /// updated by const methods.
+  mutable QHash<QString, Endpoint> Endpoints;
+};
+
+// --------------------------------------------------------------------------
+// qRestCircuitBreakerPrivate methods
+
+// --------------------------------------------------------------------------
+qRestCircuitBreakerPrivate::qRestCircuitBreakerPrivate()
+  : FailureRatio(0.5)
+  , MinimumRequests(10)
+  , WindowSize(20)
+  , SlowCallDuration(0)
+  , OpenDuration(30000)
+  , HalfOpenRequests(1)
+{
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerPrivate::update(Endpoint& endpoint, qint64 now) const
+{
+  if (endpoint.EndpointState == qRestCircuitBreaker::Open &&
+      now - endpoint.OpenedAt >= this->OpenDuration)
+    {
+    endpoint.EndpointState = qRestCircuitBreaker::HalfOpen;
+    endpoint.OpenedAt = now;
+    endpoint.Trials = 0;
+    endpoint.TrialSuccesses = 0;
+    }
+  // Trials whose outcome never came, e.g. because their qRestAPI object
+  // was deleted, do not keep the endpoint half open forever.
+  else if (endpoint.EndpointState == qRestCircuitBreaker::HalfOpen &&
+           endpoint.Trials >= this->HalfOpenRequests &&
+           now - endpoint.OpenedAt >= this->OpenDuration)
+    {
+    endpoint.OpenedAt = now;
+    endpoint.Trials = endpoint.TrialSuccesses;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerPrivate::open(Endpoint& endpoint, qint64 now) const
+{
+  endpoint.EndpointState = qRestCircuitBreaker::Open;
+  endpoint.OpenedAt = now;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreakerPrivate::close(Endpoint& endpoint) const
+{
+  endpoint = Endpoint();
+}
+
+// --------------------------------------------------------------------------
+QString qRestCircuitBreakerPrivate::key(const QUrl& url) const
+{
+  QString endpoint = url.scheme() + QLatin1String("://") + url.host();
+  if (url.port() != -1)
+    {
+    endpoint += QLatin1Char(':') + QString::number(url.port());
+    }
+  QString path = url.path();
+  QString longestPrefix;
+  foreach(const QString& prefix, this->ResourcePrefixes)
+    {
+    if (prefix.size() > longestPrefix.size() && path.startsWith(prefix))
+      {
+      longestPrefix = prefix;
+      }
+    }
+  return endpoint + longestPrefix;
+}
+
+// --------------------------------------------------------------------------
+// qRestCircuitBreaker methods
+
+// --------------------------------------------------------------------------
+qRestCircuitBreaker::qRestCircuitBreaker()
+  : d_ptr(new qRestCircuitBreakerPrivate)
+{
+}
+
+// --------------------------------------------------------------------------
+qRestCircuitBreaker::~qRestCircuitBreaker()
+{
+}
+
+// --------------------------------------------------------------------------
+double qRestCircuitBreaker::failureRatio() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->FailureRatio;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setFailureRatio(double ratio)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->FailureRatio = qBound(0., ratio, 1.);
+}
+
+// --------------------------------------------------------------------------
+int qRestCircuitBreaker::minimumRequests() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->MinimumRequests;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setMinimumRequests(int count)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->MinimumRequests = qBound(1, count, d->WindowSize);
+}
+
+// --------------------------------------------------------------------------
+int qRestCircuitBreaker::windowSize() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->WindowSize;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setWindowSize(int size)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->WindowSize = qMax(size, 1);
+  d->MinimumRequests = qMin(d->MinimumRequests, d->WindowSize);
+  // The outcomes are kept in windows of the previous size.
+  for (QHash<QString, Endpoint>::iterator it = d->Endpoints.begin();
+       it != d->Endpoints.end(); ++it)
+    {
+    it->Outcomes.clear();
+    it->Next = 0;
+    it->Count = 0;
+    it->Failures = 0;
+    }
+}
+
+// --------------------------------------------------------------------------
+int qRestCircuitBreaker::slowCallDuration() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->SlowCallDuration;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setSlowCallDuration(int msecs)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->SlowCallDuration = qMax(msecs, 0);
+}
+
+// --------------------------------------------------------------------------
+int qRestCircuitBreaker::openDuration() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->OpenDuration;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setOpenDuration(int msecs)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->OpenDuration = qMax(msecs, 0);
+}
+
+// --------------------------------------------------------------------------
+int qRestCircuitBreaker::halfOpenRequests() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->HalfOpenRequests;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setHalfOpenRequests(int count)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->HalfOpenRequests = qMax(count, 1);
+}
+
+// --------------------------------------------------------------------------
+QStringList qRestCircuitBreaker::resourcePrefixes() const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->ResourcePrefixes;
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::setResourcePrefixes(const QStringList& prefixes)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->ResourcePrefixes = prefixes;
+  d->Endpoints.clear();
+}
+
+// --------------------------------------------------------------------------
+QString qRestCircuitBreaker::endpoint(const QUrl& url) const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  return d->key(url);
+}
+
+// --------------------------------------------------------------------------
+qRestCircuitBreaker::State qRestCircuitBreaker::state(const QUrl& url) const
+{
+  Q_D(const qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, Endpoint>::iterator endpoint = d->Endpoints.find(d->key(url));
+  if (endpoint == d->Endpoints.end())
+    {
+    return Closed;
+    }
+  d->update(endpoint.value(), qRestTiming::now());
+  return endpoint->EndpointState;
+}
+
+// --------------------------------------------------------------------------
+bool qRestCircuitBreaker::allowRequest(const QUrl& url, bool* trial)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  if (trial)
+    {
+    *trial = false;
+    }
+  QHash<QString, Endpoint>::iterator endpoint = d->Endpoints.find(d->key(url));
+  if (endpoint == d->Endpoints.end())
+    {
+    return true;
+    }
+  d->update(endpoint.value(), qRestTiming::now());
+  switch (endpoint->EndpointState)
+    {
+    case Open:
+      return false;
+    case HalfOpen:
+      if (endpoint->Trials >= d->HalfOpenRequests)
+        {
+        return false;
+        }
+      ++endpoint->Trials;
+      if (trial)
+        {
+        *trial = true;
+        }
+      return true;
+    default:
+      return true;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::recordResult(const QUrl& url, bool networkError,
+                                       int httpStatusCode, qint64 duration,
+                                       bool trial)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  bool failed = (networkError && httpStatusCode == 0) || httpStatusCode >= 500 ||
+    (d->SlowCallDuration > 0 && duration > d->SlowCallDuration);
+
+  qint64 now = qRestTiming::now();
+  Endpoint& endpoint = d->Endpoints[d->key(url)];
+  d->update(endpoint, now);
+  switch (endpoint.EndpointState)
+    {
+    case Open:
+      // Queries sent before the endpoint opened.
+      return;
+    case HalfOpen:
+      if (!trial)
+        {
+        // Queries sent before the endpoint opened do not decide it.
+        return;
+        }
+      if (failed)
+        {
+        d->open(endpoint, now);
+        }
+      else if (++endpoint.TrialSuccesses >= d->HalfOpenRequests)
+        {
+        d->close(endpoint);
+        }
+      return;
+    default:
+      break;
+    }
+
+  if (endpoint.Outcomes.size() != d->WindowSize)
+    {
+    endpoint.Outcomes.fill(false, d->WindowSize);
+    }
+  if (endpoint.Count == d->WindowSize)
+    {
+    endpoint.Failures -= endpoint.Outcomes[endpoint.Next] ? 1 : 0;
+    }
+  else
+    {
+    ++endpoint.Count;
+    }
+  endpoint.Outcomes[endpoint.Next] = failed;
+  endpoint.Failures += failed ? 1 : 0;
+  endpoint.Next = (endpoint.Next + 1) % d->WindowSize;
+
+  if (endpoint.Count >= d->MinimumRequests && endpoint.Failures > 0 &&
+      endpoint.Failures >= d->FailureRatio * endpoint.Count)
+    {
+    d->open(endpoint, now);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::releaseTrial(const QUrl& url)
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, Endpoint>::iterator endpoint = d->Endpoints.find(d->key(url));
+  if (endpoint == d->Endpoints.end())
+    {
+    return;
+    }
+  d->update(endpoint.value(), qRestTiming::now());
+  if (endpoint->EndpointState == HalfOpen &&
+      endpoint->Trials > endpoint->TrialSuccesses)
+    {
+    --endpoint->Trials;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestCircuitBreaker::reset()
+{
+  Q_D(qRestCircuitBreaker);
+  QMutexLocker locker(&d->Mutex);
+  d->Endpoints.clear();
+}
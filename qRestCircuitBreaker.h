@@ -0,0 +1,140 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestCircuitBreaker_h
+#define __qRestCircuitBreaker_h
+
+// Qt includes
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+#include "qRestAPI_Export.h"
+
+class qRestCircuitBreakerPrivate;
+
+/// qRestCircuitBreaker fails the queries to an endpoint immediately while
+/// the endpoint is failing, instead of letting each query wait for its
+/// time out.
+///
+/// Endpoints are keyed by the scheme, host and port of the URL, and by the
+/// longest resource prefix of the path if resource prefixes are set, e.g.
+/// "/api/v1/file" to isolate the file servers of a Girder instance.
+///
+/// Each endpoint is Closed at first: queries are sent and their outcome is
+/// kept over the last windowSize() queries. A query fails if no HTTP
+/// response is received (connection error, time out), if the server
+/// answers with a 5xx status, or if it lasts longer than slowCallDuration().
+/// When at least minimumRequests() outcomes are known and the ratio of
+/// failures reaches failureRatio(), the endpoint is Open: queries fail with
+/// qRestAPI::CircuitOpenError without being sent. After openDuration(), the
+/// endpoint is HalfOpen: up to halfOpenRequests() trial queries are sent.
+/// If they all succeed the endpoint is Closed again, if one fails it is
+/// Open again.
+///
+/// A breaker can be shared by several qRestAPI objects, its methods are
+/// thread-safe.
+///
+/// Usage:
+/// <code>
+/// qRestCircuitBreaker breaker;
+/// breaker.setOpenDuration(10000);
+/// girderAPI.setCircuitBreaker(&breaker);
+/// </code>
+/// \sa qRestAPI::setCircuitBreaker()
+class qRestAPI_EXPORT qRestCircuitBreaker
+{
+public:
+  enum State
+  {
+    Closed = 0,
+    Open,
+    HalfOpen
+  };
+
+  qRestCircuitBreaker();
+  virtual ~qRestCircuitBreaker();
+
+  /// Ratio of failed queries, between 0 and 1, that opens an endpoint.
+  /// 0.5 by default.
+  double failureRatio() const;
+  void setFailureRatio(double ratio);
+
+  /// Minimum number of outcomes in the window before an endpoint can open.
+  /// 10 by default. It is at most windowSize(), so that endpoints can open.
+  int minimumRequests() const;
+  void setMinimumRequests(int count);
+
+  /// Number of the most recent outcomes considered, 20 by default.
+  /// A window smaller than minimumRequests() lowers it to the window size.
+  int windowSize() const;
+  void setWindowSize(int size);
+
+  /// Duration in milliseconds above which a query counts as failed.
+  /// 0 (default) means that slow queries do not count as failed.
+  int slowCallDuration() const;
+  void setSlowCallDuration(int msecs);
+
+  /// Time in milliseconds an endpoint stays Open before trial queries are
+  /// sent. 30000 by default.
+  int openDuration() const;
+  void setOpenDuration(int msecs);
+
+  /// Number of trial queries that must succeed to close a HalfOpen
+  /// endpoint. 1 by default.
+  int halfOpenRequests() const;
+  void setHalfOpenRequests(int count);
+
+  /// Path prefixes distinguishing endpoints of the same host.
+  QStringList resourcePrefixes() const;
+  void setResourcePrefixes(const QStringList& prefixes);
+
+  /// Returns the endpoint of \a url, e.g.
+  /// "https://data.kitware.com/api/v1/file".
+  QString endpoint(const QUrl& url) const;
+
+  /// Returns the state of the endpoint of \a url.
+  State state(const QUrl& url) const;
+
+  /// Returns true if a query to \a url can be sent. A HalfOpen endpoint
+  /// admits the query as a trial and sets \a trial to true: its outcome
+  /// must be given to recordResult() or releaseTrial().
+  bool allowRequest(const QUrl& url, bool* trial = 0);
+
+  /// Adds the outcome of a query sent to \a url. \a httpStatusCode is 0
+  /// if no HTTP response was received, \a duration is in milliseconds.
+  /// A HalfOpen endpoint only considers the outcome of its trial queries,
+  /// \a trial is true for the queries admitted as trials by allowRequest().
+  void recordResult(const QUrl& url, bool networkError, int httpStatusCode,
+                    qint64 duration, bool trial = false);
+
+  /// Gives back the place of a trial query whose outcome is unknown, e.g.
+  /// because the client aborted it.
+  void releaseTrial(const QUrl& url);
+
+  /// Closes all the endpoints and forgets their outcomes.
+  void reset();
+
+private:
+  QScopedPointer<qRestCircuitBreakerPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qRestCircuitBreaker);
+  Q_DISABLE_COPY(qRestCircuitBreaker);
+};
+
+#endif
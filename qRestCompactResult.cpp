@@ -0,0 +1,443 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// qRestAPI includes
+#include "qRestCompactResult.h"
+
+// STD includes
+#include <limits>
+
+namespace
+{
+// Strings longer than this are unlikely to be repeated across rows (e.g.
+// descriptions) and are not worth a lookup in the string pool.
+const int MaximumPooledStringLength = 64;
+
+// --------------------------------------------------------------------------
+template <typename T>
+void growVector(QVector<T>& vector, int size)
+{
+  if (vector.size() >= size)
+    {
+    return;
+    }
+  if (vector.capacity() < size)
+    {
+    vector.reserve(qMax(size, 2 * vector.capacity()));
+    }
+  vector.resize(size);
+}
+
+// --------------------------------------------------------------------------
+QVariant integerVariant(qint64 value)
+{
+  if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max())
+    {
+    return QVariant(static_cast<int>(value));
+    }
+  return QVariant(static_cast<qlonglong>(value));
+}
+
+}
+
+// --------------------------------------------------------------------------
+// qRestCompactResult::Row methods
+
+// --------------------------------------------------------------------------
+qRestCompactResult::Row::Row(const qRestCompactResult* result, int index)
+  : Result(result)
+  , Index(index)
+{
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::Row::index() const
+{
+  return this->Index;
+}
+
+// --------------------------------------------------------------------------
+bool qRestCompactResult::Row::contains(const QString& key) const
+{
+  return this->Result->hasValue(this->Index, this->Result->column(key));
+}
+
+// --------------------------------------------------------------------------
+QVariant qRestCompactResult::Row::value(const QString& key, const QVariant& defaultValue) const
+{
+  int column = this->Result->column(key);
+  if (!this->Result->hasValue(this->Index, column))
+    {
+    return defaultValue;
+    }
+  return this->Result->value(this->Index, column);
+}
+
+// --------------------------------------------------------------------------
+QVariant qRestCompactResult::Row::value(int column) const
+{
+  return this->Result->value(this->Index, column);
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qRestCompactResult::Row::toMap() const
+{
+  return this->Result->toMap(this->Index);
+}
+
+// --------------------------------------------------------------------------
+// qRestCompactResult::Column methods
+
+// --------------------------------------------------------------------------
+qRestCompactResult::Column::Column()
+  : Type(qRestCompactResult::NullColumn)
+{
+}
+
+// --------------------------------------------------------------------------
+// qRestCompactResult methods
+
+// --------------------------------------------------------------------------
+qRestCompactResult::qRestCompactResult()
+  : RowCount(0)
+{
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::rowCount() const
+{
+  return this->RowCount;
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::columnCount() const
+{
+  return this->Columns.size();
+}
+
+// --------------------------------------------------------------------------
+bool qRestCompactResult::isEmpty() const
+{
+  return this->RowCount == 0;
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResult::clear()
+{
+  this->Keys.clear();
+  this->KeyColumns.clear();
+  this->Columns.clear();
+  this->StringPool.clear();
+  this->RowCount = 0;
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResult::reserve(int rows)
+{
+  for (int i = 0; i < this->Columns.size(); ++i)
+    {
+    Column& column = this->Columns[i];
+    switch (column.Type)
+      {
+      case BoolColumn: column.Bools.reserve(rows); break;
+      case IntColumn: column.Ints.reserve(rows); break;
+      case DoubleColumn: column.Doubles.reserve(rows); break;
+      case StringColumn: column.Strings.reserve(rows); break;
+      case VariantColumn: column.Variants.reserve(rows); break;
+      default: break;
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+QStringList qRestCompactResult::keys() const
+{
+  return this->Keys;
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::column(const QString& key) const
+{
+  return this->KeyColumns.value(key, -1);
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::internKey(const QString& key)
+{
+  QHash<QString, int>::const_iterator it = this->KeyColumns.constFind(key);
+  if (it != this->KeyColumns.constEnd())
+    {
+    return it.value();
+    }
+  int column = this->Keys.size();
+  this->Keys << key;
+  this->KeyColumns.insert(key, column);
+  this->Columns.append(Column());
+  return column;
+}
+
+// --------------------------------------------------------------------------
+qRestCompactResult::ColumnType qRestCompactResult::columnType(int column) const
+{
+  if (column < 0 || column >= this->Columns.size())
+    {
+    return NullColumn;
+    }
+  return this->Columns.at(column).Type;
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::appendRow()
+{
+  return this->RowCount++;
+}
+
+// --------------------------------------------------------------------------
+int qRestCompactResult::appendMap(const QVariantMap& map)
+{
+  int row = this->appendRow();
+  for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it)
+    {
+    this->setValue(row, this->internKey(it.key()), it.value());
+    }
+  return row;
+}
+
+// --------------------------------------------------------------------------
+qRestCompactResult::ColumnType qRestCompactResult::valueType(const QVariant& value)
+{
+  switch (value.userType())
+    {
+    case QMetaType::Bool:
+      return BoolColumn;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+      return IntColumn;
+    case QMetaType::Double:
+    case QMetaType::Float:
+      return DoubleColumn;
+    case QMetaType::QString:
+      return StringColumn;
+    default:
+      return VariantColumn;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResult::resize(Column& column, int size)
+{
+  if (column.Present.size() < size)
+    {
+    column.Present.resize(qMax(size, 2 * column.Present.size()));
+    }
+  switch (column.Type)
+    {
+    case BoolColumn: growVector(column.Bools, size); break;
+    case IntColumn: growVector(column.Ints, size); break;
+    case DoubleColumn: growVector(column.Doubles, size); break;
+    case StringColumn: growVector(column.Strings, size); break;
+    case VariantColumn: growVector(column.Variants, size); break;
+    default: break;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResult::promote(Column& column, ColumnType type)
+{
+  if (column.Type == type)
+    {
+    return;
+    }
+  if (column.Type == IntColumn && type == DoubleColumn)
+    {
+    column.Doubles.resize(column.Ints.size());
+    for (int row = 0; row < column.Ints.size(); ++row)
+      {
+      column.Doubles[row] = static_cast<double>(column.Ints.at(row));
+      }
+    column.Ints.clear();
+    column.Type = DoubleColumn;
+    return;
+    }
+
+  Q_ASSERT(type == VariantColumn);
+  int size = qMin(column.Present.size(), this->RowCount);
+  column.Variants.resize(size);
+  for (int row = 0; row < size; ++row)
+    {
+    if (!column.Present.testBit(row))
+      {
+      continue;
+      }
+    switch (column.Type)
+      {
+      case BoolColumn: column.Variants[row] = QVariant(column.Bools.at(row)); break;
+      case IntColumn: column.Variants[row] = integerVariant(column.Ints.at(row)); break;
+      case DoubleColumn: column.Variants[row] = QVariant(column.Doubles.at(row)); break;
+      case StringColumn: column.Variants[row] = QVariant(column.Strings.at(row)); break;
+      default: break;
+      }
+    }
+  column.Bools.clear();
+  column.Ints.clear();
+  column.Doubles.clear();
+  column.Strings.clear();
+  column.Type = VariantColumn;
+}
+
+// --------------------------------------------------------------------------
+QString qRestCompactResult::internString(const QString& value)
+{
+  if (value.size() > MaximumPooledStringLength)
+    {
+    return value;
+    }
+  QSet<QString>::const_iterator it = this->StringPool.constFind(value);
+  if (it != this->StringPool.constEnd())
+    {
+    return *it;
+    }
+  this->StringPool.insert(value);
+  return value;
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResult::setValue(int row, int columnIndex, const QVariant& value)
+{
+  if (row < 0 || row >= this->RowCount ||
+      columnIndex < 0 || columnIndex >= this->Columns.size())
+    {
+    return;
+    }
+  Column& column = this->Columns[columnIndex];
+
+  ColumnType type = valueType(value);
+  if (column.Type == NullColumn)
+    {
+    column.Type = type;
+    }
+  else if (column.Type == DoubleColumn && type == IntColumn)
+    {
+    type = DoubleColumn;
+    }
+  else if (column.Type == IntColumn && type == DoubleColumn)
+    {
+    this->promote(column, DoubleColumn);
+    }
+  else if (column.Type != type)
+    {
+    this->promote(column, VariantColumn);
+    }
+
+  this->resize(column, row + 1);
+  switch (column.Type)
+    {
+    case BoolColumn: column.Bools[row] = value.toBool(); break;
+    case IntColumn: column.Ints[row] = value.toLongLong(); break;
+    case DoubleColumn: column.Doubles[row] = value.toDouble(); break;
+    case StringColumn: column.Strings[row] = this->internString(value.toString()); break;
+    default: column.Variants[row] = value; break;
+    }
+  column.Present.setBit(row);
+}
+
+// --------------------------------------------------------------------------
+void qRestCompactResult::setValue(int row, const QString& key, const QVariant& value)
+{
+  this->setValue(row, this->internKey(key), value);
+}
+
+// --------------------------------------------------------------------------
+bool qRestCompactResult::hasValue(int row, int column) const
+{
+  if (row < 0 || row >= this->RowCount ||
+      column < 0 || column >= this->Columns.size())
+    {
+    return false;
+    }
+  const QBitArray& present = this->Columns.at(column).Present;
+  return row < present.size() && present.testBit(row);
+}
+
+// --------------------------------------------------------------------------
+QVariant qRestCompactResult::value(int row, int columnIndex) const
+{
+  if (!this->hasValue(row, columnIndex))
+    {
+    return QVariant();
+    }
+  const Column& column = this->Columns.at(columnIndex);
+  switch (column.Type)
+    {
+    case BoolColumn: return QVariant(column.Bools.at(row));
+    case IntColumn: return integerVariant(column.Ints.at(row));
+    case DoubleColumn: return QVariant(column.Doubles.at(row));
+    case StringColumn: return QVariant(column.Strings.at(row));
+    case VariantColumn: return column.Variants.at(row);
+    default: return QVariant();
+    }
+}
+
+// --------------------------------------------------------------------------
+QVariant qRestCompactResult::value(int row, const QString& key) const
+{
+  return this->value(row, this->column(key));
+}
+
+// --------------------------------------------------------------------------
+qRestCompactResult::Row qRestCompactResult::row(int index) const
+{
+  return Row(this, index);
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qRestCompactResult::toMap(int row) const
+{
+  QVariantMap map;
+  for (int column = 0; column < this->Columns.size(); ++column)
+    {
+    if (this->hasValue(row, column))
+      {
+      map.insert(this->Keys.at(column), this->value(row, column));
+      }
+    }
+  return map;
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qRestCompactResult::toVariantMapList() const
+{
+  QList<QVariantMap> list;
+  list.reserve(this->RowCount);
+  for (int row = 0; row < this->RowCount; ++row)
+    {
+    list << this->toMap(row);
+    }
+  return list;
+}
+
+// --------------------------------------------------------------------------
+qRestCompactResult qRestCompactResult::fromVariantMapList(const QList<QVariantMap>& list)
+{
+  qRestCompactResult result;
+  foreach(const QVariantMap& map, list)
+    {
+    result.appendMap(map);
+    }
+  return result;
+}
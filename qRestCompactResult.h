@@ -0,0 +1,168 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestCompactResult_h
+#define __qRestCompactResult_h
+
+// Qt includes
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+#include "qRestAPI_Export.h"
+
+/// qRestCompactResult is a memory efficient alternative to QList<QVariantMap>
+/// for large listings.
+///
+/// Keys are interned once in a key table shared by all the rows and values
+/// are stored column by column in typed vectors (bool, integer, double or
+/// string). A column falls back to QVariant storage only if it holds values
+/// of mixed or non scalar types.
+///
+/// Parsers can fill the result directly:
+/// <code>
+/// qRestCompactResult result;
+/// int nameColumn = result.internKey("name");
+/// int row = result.appendRow();
+/// result.setValue(row, nameColumn, "foo");
+/// </code>
+///
+/// Rows are accessed through lightweight Row views, and can be converted
+/// on demand to QVariantMap for existing callers.
+/// \sa qRestResult::compactResults()
+class qRestAPI_EXPORT qRestCompactResult
+{
+public:
+  enum ColumnType
+  {
+    /// No value has been set in the column yet.
+    NullColumn = 0,
+    BoolColumn,
+    IntColumn,
+    DoubleColumn,
+    StringColumn,
+    /// Values of mixed or non scalar types (e.g. nested maps or lists).
+    VariantColumn
+  };
+
+  /// Read-only view of a row. It does not copy any value and is only
+  /// valid as long as the result it refers to is not modified or destroyed.
+  class qRestAPI_EXPORT Row
+  {
+  public:
+    Row(const qRestCompactResult* result, int index);
+
+    /// Index of the row in the result.
+    int index() const;
+
+    /// Returns true if a value is set for \a key in this row.
+    bool contains(const QString& key) const;
+
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    QVariant value(int column) const;
+
+    /// Converts the row into a QVariantMap.
+    QVariantMap toMap() const;
+
+  private:
+    const qRestCompactResult* Result;
+    int Index;
+  };
+
+  qRestCompactResult();
+
+  int rowCount() const;
+  int columnCount() const;
+  bool isEmpty() const;
+
+  /// Removes all rows and keys.
+  void clear();
+
+  /// Reserves space for \a rows rows in every existing column.
+  void reserve(int rows);
+
+  /// Returns the keys of the key table, in the order they were interned.
+  QStringList keys() const;
+
+  /// Returns the column associated with \a key or -1 if the key is unknown.
+  int column(const QString& key) const;
+
+  /// Returns the column associated with \a key, adding it to the key table
+  /// if needed.
+  int internKey(const QString& key);
+
+  ColumnType columnType(int column) const;
+
+  /// Appends an empty row and returns its index.
+  int appendRow();
+
+  /// Appends a row initialized from \a map and returns its index.
+  int appendMap(const QVariantMap& map);
+
+  /// Sets the value of the cell at \a row and \a column.
+  /// If \a value type does not match the type of the column, the column is
+  /// promoted (e.g. from integer to double, or to QVariant storage).
+  void setValue(int row, int column, const QVariant& value);
+  void setValue(int row, const QString& key, const QVariant& value);
+
+  /// Returns true if a value was set for the cell at \a row and \a column.
+  bool hasValue(int row, int column) const;
+
+  QVariant value(int row, int column) const;
+  QVariant value(int row, const QString& key) const;
+
+  Row row(int index) const;
+
+  /// Converts \a row into a QVariantMap.
+  QVariantMap toMap(int row) const;
+
+  /// Converts the whole result into the list representation used by
+  /// qRestResult::results().
+  QList<QVariantMap> toVariantMapList() const;
+
+  static qRestCompactResult fromVariantMapList(const QList<QVariantMap>& list);
+
+private:
+  struct Column
+  {
+    Column();
+    ColumnType Type;
+    QBitArray Present;
+    QVector<bool> Bools;
+    QVector<qint64> Ints;
+    QVector<double> Doubles;
+    QVector<QString> Strings;
+    QVector<QVariant> Variants;
+  };
+
+  static ColumnType valueType(const QVariant& value);
+  void promote(Column& column, ColumnType type);
+  void resize(Column& column, int size);
+  QString internString(const QString& value);
+
+  QStringList Keys;
+  QHash<QString, int> KeyColumns;
+  QVector<Column> Columns;
+  QSet<QString> StringPool;
+  int RowCount;
+};
+
+#endif
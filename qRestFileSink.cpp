@@ -0,0 +1,456 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+// qRestAPI includes
+#include "qRestFileSink.h"
+
+// STD includes
+#include <cstdio>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <fcntl.h>
+#endif
+
+namespace
+{
+const qint64 BufferAlignment = 64 * 1024;
+// Size of the memory mapped windows, it bounds the address space used by
+// the sink for large files.
+const qint64 MapWindowSize = 64 * 1024 * 1024;
+// Permissions of the created files, as with the default umask.
+const QFile::Permissions defaultPermissions =
+  QFile::ReadOwner | QFile::WriteOwner | QFile::ReadUser | QFile::WriteUser |
+  QFile::ReadGroup | QFile::ReadOther;
+}
+
+// --------------------------------------------------------------------------
+class qRestFileSinkPrivate
+{
+  Q_DECLARE_PUBLIC(qRestFileSink);
+
+protected:
+  qRestFileSink* const q_ptr;
+
+public:
+  qRestFileSinkPrivate(qRestFileSink& object);
+
+  /// Writes \a size bytes at FileOffset using the file API.
+  bool writeToFile(const char* data, qint64 size);
+  /// Copies \a size bytes at FileOffset into the mapped windows.
+  bool writeToMap(const char* data, qint64 size);
+  bool flushBuffer();
+  void unmap();
+  /// Closes and removes or renames the temporary file.
+  bool finish(bool commit);
+
+  QString FileName;
+  qRestFileSink::WriteMode WriteMode;
+  qint64 BufferSize;
+
+  QScopedPointer<QTemporaryFile> File;
+  QByteArray Buffer;
+  qint64 Preallocated;
+  /// Number of bytes accepted by the sink.
+  qint64 BytesWritten;
+  /// Number of bytes stored in the file, either written or mapped.
+  qint64 FileOffset;
+
+  uchar* Map;
+  qint64 MapOffset;
+  qint64 MapSize;
+
+  bool Cancelled;
+  bool Committed;
+};
+
+// --------------------------------------------------------------------------
+// qRestFileSinkPrivate methods
+
+// --------------------------------------------------------------------------
+qRestFileSinkPrivate::qRestFileSinkPrivate(qRestFileSink& object)
+  : q_ptr(&object)
+  , WriteMode(qRestFileSink::BufferedWrites)
+  , BufferSize(1024 * 1024)
+  , Preallocated(0)
+  , BytesWritten(0)
+  , FileOffset(0)
+  , Map(0)
+  , MapOffset(0)
+  , MapSize(0)
+  , Cancelled(false)
+  , Committed(false)
+{
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSinkPrivate::writeToFile(const char* data, qint64 size)
+{
+  if (this->File->pos() != this->FileOffset && !this->File->seek(this->FileOffset))
+    {
+    return false;
+    }
+  while (size > 0)
+    {
+    qint64 written = this->File->write(data, size);
+    if (written <= 0)
+      {
+      return false;
+      }
+    data += written;
+    size -= written;
+    this->FileOffset += written;
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSinkPrivate::writeToMap(const char* data, qint64 size)
+{
+  while (size > 0)
+    {
+    if (!this->Map ||
+        this->FileOffset < this->MapOffset ||
+        this->FileOffset >= this->MapOffset + this->MapSize)
+      {
+      this->unmap();
+      this->MapOffset = this->FileOffset - this->FileOffset % MapWindowSize;
+      this->MapSize = qMin(MapWindowSize, this->Preallocated - this->MapOffset);
+      this->Map = this->File->map(this->MapOffset, this->MapSize);
+      if (!this->Map)
+        {
+        return false;
+        }
+      }
+    qint64 count = qMin(size, this->MapOffset + this->MapSize - this->FileOffset);
+    memcpy(this->Map + (this->FileOffset - this->MapOffset), data, count);
+    data += count;
+    size -= count;
+    this->FileOffset += count;
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSinkPrivate::flushBuffer()
+{
+  if (this->Buffer.isEmpty())
+    {
+    return true;
+    }
+  bool success = this->writeToFile(this->Buffer.constData(), this->Buffer.size());
+  this->Buffer.resize(0);
+  return success;
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSinkPrivate::unmap()
+{
+  if (this->Map)
+    {
+    this->File->unmap(this->Map);
+    this->Map = 0;
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSinkPrivate::finish(bool commit)
+{
+  bool success = commit && this->flushBuffer();
+  this->unmap();
+  // Drop the preallocated bytes that were not used.
+  if (success && this->File->size() != this->FileOffset)
+    {
+    success = this->File->resize(this->FileOffset);
+    }
+  if (success)
+    {
+    success = this->File->flush();
+    }
+  QString errorString = this->File->errorString();
+  this->File->close();
+  if (success)
+    {
+    // Temporary files are only accessible by their owner, the target file
+    // keeps its permissions or gets the usual ones.
+    QFile::Permissions permissions = QFile::exists(this->FileName) ?
+      QFile::permissions(this->FileName) : defaultPermissions;
+    this->File->setPermissions(permissions);
+    success = qRestFileSink::renameOverwrite(this->File->fileName(), this->FileName);
+    if (success)
+      {
+      // The temporary file does not exist anymore.
+      this->File->setAutoRemove(false);
+      }
+    else
+      {
+      errorString = QString("Failed to rename %1 into %2")
+          .arg(this->File->fileName()).arg(this->FileName);
+      }
+    }
+  if (!success && commit)
+    {
+    Q_Q(qRestFileSink);
+    q->setErrorString(errorString);
+    }
+  // Removes the temporary file unless it was renamed.
+  this->File.reset();
+  this->Committed = success;
+  return success;
+}
+
+// --------------------------------------------------------------------------
+// qRestFileSink methods
+
+// --------------------------------------------------------------------------
+qRestFileSink::qRestFileSink(const QString& fileName, QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new qRestFileSinkPrivate(*this))
+{
+  Q_D(qRestFileSink);
+  d->FileName = fileName;
+}
+
+// --------------------------------------------------------------------------
+qRestFileSink::~qRestFileSink()
+{
+  Q_D(qRestFileSink);
+  if (d->File)
+    {
+    d->finish(false);
+    }
+}
+
+// --------------------------------------------------------------------------
+QString qRestFileSink::fileName() const
+{
+  Q_D(const qRestFileSink);
+  return d->FileName;
+}
+
+// --------------------------------------------------------------------------
+qRestFileSink::WriteMode qRestFileSink::writeMode() const
+{
+  Q_D(const qRestFileSink);
+  return d->WriteMode;
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSink::setWriteMode(WriteMode mode)
+{
+  Q_D(qRestFileSink);
+  d->WriteMode = mode;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestFileSink::bufferSize() const
+{
+  Q_D(const qRestFileSink);
+  return d->BufferSize;
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSink::setBufferSize(qint64 size)
+{
+  Q_D(qRestFileSink);
+  size = qMax(size, BufferAlignment);
+  d->BufferSize = ((size + BufferAlignment - 1) / BufferAlignment) * BufferAlignment;
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSink::preallocate(qint64 size)
+{
+  Q_D(qRestFileSink);
+  if (!d->File || size <= d->FileOffset)
+    {
+    return false;
+    }
+#if defined(Q_OS_LINUX)
+  // Reserve the blocks when the file system supports it. Unlike
+  // posix_fallocate(), fallocate() does not fall back to writing zeros.
+  ::fallocate(d->File->handle(), 0, 0, size);
+#endif
+  if (d->File->size() != size && !d->File->resize(size))
+    {
+    return false;
+    }
+  d->Preallocated = size;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestFileSink::preallocatedSize() const
+{
+  Q_D(const qRestFileSink);
+  return d->Preallocated;
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSink::cancel()
+{
+  Q_D(qRestFileSink);
+  d->Cancelled = true;
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSink::isCommitted() const
+{
+  Q_D(const qRestFileSink);
+  return d->Committed;
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSink::open(OpenMode mode)
+{
+  Q_D(qRestFileSink);
+  if (this->isOpen() || (mode & ReadOnly) || !(mode & WriteOnly))
+    {
+    return false;
+    }
+  QFileInfo fileInfo(d->FileName);
+  d->File.reset(new QTemporaryFile(
+    fileInfo.absoluteDir().filePath(QString(".%1.XXXXXX.part").arg(fileInfo.fileName()))));
+  // The temporary file is opened in read-write mode which is required to
+  // map it.
+  if (!d->File->open())
+    {
+    this->setErrorString(d->File->errorString());
+    d->File.reset();
+    return false;
+    }
+  d->Buffer.reserve(d->BufferSize);
+  d->Preallocated = 0;
+  d->BytesWritten = 0;
+  d->FileOffset = 0;
+  d->Cancelled = false;
+  d->Committed = false;
+  return this->Superclass::open(mode | Unbuffered);
+}
+
+// --------------------------------------------------------------------------
+void qRestFileSink::close()
+{
+  Q_D(qRestFileSink);
+  if (!this->isOpen())
+    {
+    return;
+    }
+  if (d->File)
+    {
+    d->finish(!d->Cancelled);
+    }
+  this->Superclass::close();
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSink::isSequential() const
+{
+  return true;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestFileSink::size() const
+{
+  Q_D(const qRestFileSink);
+  return d->BytesWritten;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestFileSink::readData(char* data, qint64 maxSize)
+{
+  Q_UNUSED(data);
+  Q_UNUSED(maxSize);
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestFileSink::writeData(const char* data, qint64 maxSize)
+{
+  Q_D(qRestFileSink);
+  if (!d->File)
+    {
+    return -1;
+    }
+
+  if (d->WriteMode == MemoryMappedWrites && d->Buffer.isEmpty() &&
+      d->FileOffset + maxSize <= d->Preallocated)
+    {
+    if (d->writeToMap(data, maxSize))
+      {
+      d->BytesWritten += maxSize;
+      return maxSize;
+      }
+    // The file can not be mapped, data not copied yet is written using
+    // buffered writes.
+    d->unmap();
+    d->WriteMode = BufferedWrites;
+    qint64 mapped = d->FileOffset - d->BytesWritten;
+    d->BytesWritten += mapped;
+    data += mapped;
+    maxSize -= mapped;
+    if (maxSize == 0)
+      {
+      return mapped;
+      }
+    qint64 written = this->writeData(data, maxSize);
+    return written < 0 ? -1 : mapped + written;
+    }
+
+  bool success = true;
+  if (d->Buffer.isEmpty() && maxSize >= d->BufferSize)
+    {
+    // Large chunks are written directly, without copying them.
+    success = d->writeToFile(data, maxSize);
+    }
+  else
+    {
+    d->Buffer.append(data, maxSize);
+    if (d->Buffer.size() >= d->BufferSize)
+      {
+      success = d->flushBuffer();
+      }
+    }
+  if (!success)
+    {
+    this->setErrorString(d->File->errorString());
+    return -1;
+    }
+  d->BytesWritten += maxSize;
+  return maxSize;
+}
+
+// --------------------------------------------------------------------------
+bool qRestFileSink::renameOverwrite(const QString& source, const QString& target)
+{
+#if defined(Q_OS_WIN)
+  return ::MoveFileExW(
+        reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(source).utf16()),
+        reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(target).utf16()),
+        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return ::rename(QFile::encodeName(source).constData(),
+                  QFile::encodeName(target).constData()) == 0;
+#endif
+}
@@ -0,0 +1,110 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestFileSink_h
+#define __qRestFileSink_h
+
+// Qt includes
+#include <QIODevice>
+#include <QScopedPointer>
+
+#include "qRestAPI_Export.h"
+
+class qRestFileSinkPrivate;
+
+/// qRestFileSink is a write-only device used by qRestAPI::download() to
+/// store downloaded data into a file.
+///
+/// Data is written to a temporary file located next to the target file. The
+/// temporary file is renamed to the target file name when the sink is closed,
+/// so that a partially-written file is never visible under the target name.
+/// If cancel() is called before close(), the temporary file is removed and
+/// the target file is left untouched.
+///
+/// When the size of the data is known (e.g. from the Content-Length header
+/// of the reply), the file can be preallocated using preallocate(). Data is
+/// then either accumulated into large buffers before being written
+/// (BufferedWrites) or copied into memory mapped windows of the preallocated
+/// file (MemoryMappedWrites).
+class qRestAPI_EXPORT qRestFileSink : public QIODevice
+{
+  Q_OBJECT
+
+  typedef QIODevice Superclass;
+
+public:
+  enum WriteMode
+  {
+    BufferedWrites = 0,
+    /// Falls back to BufferedWrites if the file is not preallocated or if
+    /// the file can not be mapped.
+    MemoryMappedWrites
+  };
+
+  explicit qRestFileSink(const QString& fileName, QObject* parent = 0);
+  /// Destructs the sink. If the sink is still open, the data written so far
+  /// is discarded.
+  virtual ~qRestFileSink();
+
+  /// Name of the target file.
+  QString fileName() const;
+
+  WriteMode writeMode() const;
+  void setWriteMode(WriteMode mode);
+
+  /// Size of the buffer used to accumulate data before writing it to the
+  /// file. It is rounded up to a multiple of 64 KiB. Default is 1 MiB.
+  qint64 bufferSize() const;
+  void setBufferSize(qint64 size);
+
+  /// Reserves \a size bytes for the file. It must be called after open().
+  /// Returns false if the space could not be reserved.
+  bool preallocate(qint64 size);
+  qint64 preallocatedSize() const;
+
+  /// Discards the data written so far. The temporary file is removed when
+  /// the sink is closed.
+  void cancel();
+
+  /// Returns true if the data was successfully moved to the target file.
+  bool isCommitted() const;
+
+  /// Only QIODevice::WriteOnly is supported.
+  virtual bool open(OpenMode mode);
+  /// Flushes the data and renames the temporary file into the target file,
+  /// unless cancel() was called.
+  virtual void close();
+  virtual bool isSequential() const;
+  /// Returns the number of bytes written so far.
+  virtual qint64 size() const;
+
+  /// Renames \a source into \a target, atomically replacing \a target if it
+  /// exists.
+  static bool renameOverwrite(const QString& source, const QString& target);
+
+protected:
+  virtual qint64 readData(char* data, qint64 maxSize);
+  virtual qint64 writeData(const char* data, qint64 maxSize);
+
+private:
+  QScopedPointer<qRestFileSinkPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qRestFileSink);
+  Q_DISABLE_COPY(qRestFileSink);
+};
+
+#endif
@@ -0,0 +1,376 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QVector>
+
+// qRestAPI includes
+#include "qRestMetrics.h"
+
+// STD includes
+#include <cmath>
+#include <limits>
+
+namespace
+{
+const int BucketsPerPowerOfTwo = 4;
+const int BucketCount = 128;
+
+// --------------------------------------------------------------------------
+int bucketIndex(qint64 milliseconds)
+{
+  if (milliseconds <= 1)
+    {
+    return 0;
+    }
+  int index = static_cast<int>(std::ceil(BucketsPerPowerOfTwo * std::log(static_cast<double>(milliseconds)) / std::log(2.)));
+  return qMin(index, BucketCount - 1);
+}
+
+// --------------------------------------------------------------------------
+qint64 bucketUpperBound(int index)
+{
+  return static_cast<qint64>(std::floor(std::pow(2., static_cast<double>(index) / BucketsPerPowerOfTwo)));
+}
+
+// --------------------------------------------------------------------------
+bool isHexDigit(QChar c)
+{
+  return (c >= QLatin1Char('0') && c <= QLatin1Char('9')) ||
+      (c >= QLatin1Char('a') && c <= QLatin1Char('f')) ||
+      (c >= QLatin1Char('A') && c <= QLatin1Char('F'));
+}
+
+// --------------------------------------------------------------------------
+/// Returns true for numbers, object ids (e.g. Girder ids) and uuids.
+bool isIdentifier(const QString& segment)
+{
+  if (segment.isEmpty())
+    {
+    return false;
+    }
+  bool digits = true;
+  bool hexDigits = true;
+  int dashes = 0;
+  foreach(QChar c, segment)
+    {
+    if (c == QLatin1Char('-'))
+      {
+      ++dashes;
+      digits = false;
+      continue;
+      }
+    digits = digits && c.isDigit();
+    hexDigits = hexDigits && isHexDigit(c);
+    }
+  if (digits)
+    {
+    return true;
+    }
+  if (!hexDigits)
+    {
+    return false;
+    }
+  return (dashes == 0 && segment.size() >= 16) ||
+      (dashes == 4 && segment.size() == 36);
+}
+
+// --------------------------------------------------------------------------
+struct MetricSeries
+{
+  MetricSeries()
+    : Count(0), Errors(0), BytesReceived(0), BytesSent(0),
+      LatencyCount(0), LatencySum(0), LatencyMin(0), LatencyMax(0),
+      Histogram(BucketCount, 0)
+  {
+  }
+
+  qint64 percentile(double percentile) const
+  {
+    if (this->LatencyCount == 0)
+      {
+      return -1;
+      }
+    qint64 rank = static_cast<qint64>(std::ceil(qBound(0., percentile, 1.) * this->LatencyCount));
+    qint64 cumulated = 0;
+    for (int index = 0; index < BucketCount; ++index)
+      {
+      cumulated += this->Histogram[index];
+      if (cumulated >= rank && cumulated > 0)
+        {
+        return qBound(this->LatencyMin, bucketUpperBound(index), this->LatencyMax);
+        }
+      }
+    return this->LatencyMax;
+  }
+
+  QByteArray Method;
+  QString Resource;
+  qint64 Count;
+  qint64 Errors;
+  QMap<int, qint64> ErrorCounts;
+  qint64 BytesReceived;
+  qint64 BytesSent;
+  qint64 LatencyCount;
+  qint64 LatencySum;
+  qint64 LatencyMin;
+  qint64 LatencyMax;
+  QVector<qint64> Histogram;
+};
+
+// --------------------------------------------------------------------------
+QElapsedTimer startedTimer()
+{
+  QElapsedTimer timer;
+  timer.start();
+  return timer;
+}
+
+// --------------------------------------------------------------------------
+/// The clock is started once, whatever the thread reading it first.
+const QElapsedTimer& timingClock()
+{
+  static const QElapsedTimer timer = startedTimer();
+  return timer;
+}
+}
+
+// --------------------------------------------------------------------------
+// qRestTiming methods
+
+// --------------------------------------------------------------------------
+qRestTiming::qRestTiming()
+  : QueuedWallTime(-1)
+  , Queued(-1)
+  , Dispatched(-1)
+  , Encrypted(-1)
+  , RequestSent(-1)
+  , FirstByte(-1)
+  , LastByte(-1)
+  , ParseStarted(-1)
+  , ParseFinished(-1)
+  , FinishedDelivered(-1)
+  , BytesReceived(0)
+  , BytesSent(0)
+{
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestTiming::interval(qint64 from, qint64 to)
+{
+  if (from < 0 || to < 0)
+    {
+    return -1;
+    }
+  return to - from;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestTiming::totalTime() const
+{
+  qint64 last = this->FinishedDelivered;
+  last = last >= 0 ? last : this->ParseFinished;
+  last = last >= 0 ? last : this->LastByte;
+  return interval(this->Queued, last);
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestTiming::now()
+{
+  return timingClock().elapsed();
+}
+
+// --------------------------------------------------------------------------
+QVariantMap qRestTiming::toMap() const
+{
+  QVariantMap map;
+  map["queuedWallTime"] = this->QueuedWallTime;
+  map["dispatch"] = interval(this->Queued, this->Dispatched);
+  map["encrypted"] = interval(this->Queued, this->Encrypted);
+  map["requestSent"] = interval(this->Queued, this->RequestSent);
+  map["firstByte"] = interval(this->Queued, this->FirstByte);
+  map["lastByte"] = interval(this->Queued, this->LastByte);
+  map["parse"] = interval(this->ParseStarted, this->ParseFinished);
+  map["finishedDelivered"] = interval(this->Queued, this->FinishedDelivered);
+  map["total"] = this->totalTime();
+  map["bytesReceived"] = this->BytesReceived;
+  map["bytesSent"] = this->BytesSent;
+  return map;
+}
+
+// --------------------------------------------------------------------------
+class qRestMetricsPrivate
+{
+public:
+  mutable QMutex Mutex;
+  /// Series by method and resource pattern.
+  QHash<QString, MetricSeries> Series;
+
+  static QString key(const QByteArray& method, const QString& pattern)
+  {
+    return QString::fromLatin1(method) + QLatin1Char(' ') + pattern;
+  }
+};
+
+// --------------------------------------------------------------------------
+// qRestMetrics methods
+
+// --------------------------------------------------------------------------
+qRestMetrics::qRestMetrics()
+  : d_ptr(new qRestMetricsPrivate)
+{
+}
+
+// --------------------------------------------------------------------------
+qRestMetrics::~qRestMetrics()
+{
+}
+
+// --------------------------------------------------------------------------
+void qRestMetrics::record(const QByteArray& method, const QString& resource,
+                          const qRestTiming& timing, qRestAPI::ErrorType errorCode)
+{
+  Q_D(qRestMetrics);
+  QString pattern = resourcePattern(resource);
+  qint64 latency = timing.totalTime();
+
+  QMutexLocker locker(&d->Mutex);
+  MetricSeries& series = d->Series[qRestMetricsPrivate::key(method, pattern)];
+  if (series.Count == 0)
+    {
+    series.Method = method;
+    series.Resource = pattern;
+    }
+  ++series.Count;
+  if (errorCode != qRestAPI::UnknownError)
+    {
+    ++series.Errors;
+    ++series.ErrorCounts[errorCode];
+    }
+  series.BytesReceived += timing.BytesReceived;
+  series.BytesSent += timing.BytesSent;
+  if (latency >= 0)
+    {
+    series.LatencyMin = series.LatencyCount ? qMin(series.LatencyMin, latency) : latency;
+    series.LatencyMax = series.LatencyCount ? qMax(series.LatencyMax, latency) : latency;
+    ++series.LatencyCount;
+    series.LatencySum += latency;
+    ++series.Histogram[bucketIndex(latency)];
+    }
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestMetrics::count(const QByteArray& method, const QString& resource) const
+{
+  Q_D(const qRestMetrics);
+  QMutexLocker locker(&d->Mutex);
+  return d->Series.value(qRestMetricsPrivate::key(method, resourcePattern(resource))).Count;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestMetrics::latencyPercentile(const QByteArray& method, const QString& resource,
+                                       double percentile) const
+{
+  Q_D(const qRestMetrics);
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, MetricSeries>::const_iterator it =
+      d->Series.constFind(qRestMetricsPrivate::key(method, resourcePattern(resource)));
+  if (it == d->Series.constEnd())
+    {
+    return -1;
+    }
+  return it.value().percentile(percentile);
+}
+
+// --------------------------------------------------------------------------
+QList<QVariantMap> qRestMetrics::snapshot() const
+{
+  Q_D(const qRestMetrics);
+  QMutexLocker locker(&d->Mutex);
+  QList<QVariantMap> result;
+  foreach(const MetricSeries& series, d->Series)
+    {
+    QVariantMap map;
+    map["method"] = QString::fromLatin1(series.Method);
+    map["resource"] = series.Resource;
+    map["count"] = series.Count;
+    map["errors"] = series.Errors;
+    QVariantMap errorCounts;
+    for (QMap<int, qint64>::const_iterator it = series.ErrorCounts.constBegin();
+         it != series.ErrorCounts.constEnd(); ++it)
+      {
+      errorCounts[QString::number(it.key())] = it.value();
+      }
+    map["errorCounts"] = errorCounts;
+    map["bytesReceived"] = series.BytesReceived;
+    map["bytesSent"] = series.BytesSent;
+    if (series.LatencyCount > 0)
+      {
+      map["latencyMin"] = series.LatencyMin;
+      map["latencyMax"] = series.LatencyMax;
+      map["latencyMean"] = static_cast<double>(series.LatencySum) / series.LatencyCount;
+      map["latencyP50"] = series.percentile(0.5);
+      map["latencyP90"] = series.percentile(0.9);
+      map["latencyP99"] = series.percentile(0.99);
+      }
+    QVariantList histogram;
+    for (int index = 0; index < BucketCount; ++index)
+      {
+      if (series.Histogram[index] > 0)
+        {
+        QVariantMap bucket;
+        bucket["le"] = bucketUpperBound(index);
+        bucket["count"] = series.Histogram[index];
+        histogram << bucket;
+        }
+      }
+    map["histogram"] = histogram;
+    result << map;
+    }
+  return result;
+}
+
+// --------------------------------------------------------------------------
+void qRestMetrics::reset()
+{
+  Q_D(qRestMetrics);
+  QMutexLocker locker(&d->Mutex);
+  d->Series.clear();
+}
+
+// --------------------------------------------------------------------------
+QString qRestMetrics::resourcePattern(const QString& resource)
+{
+  int end = resource.indexOf(QLatin1Char('?'));
+  QString path = end >= 0 ? resource.left(end) : resource;
+  QStringList segments = path.split(QLatin1Char('/'));
+  for (int index = 0; index < segments.size(); ++index)
+    {
+    if (isIdentifier(segments[index]))
+      {
+      segments[index] = QLatin1String("{id}");
+      }
+    }
+  return segments.join(QLatin1String("/"));
+}
@@ -0,0 +1,134 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestMetrics_h
+#define __qRestMetrics_h
+
+// Qt includes
+#include <QByteArray>
+#include <QList>
+#include <QScopedPointer>
+#include <QString>
+#include <QVariantMap>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+
+#include "qRestAPI_Export.h"
+
+class qRestMetricsPrivate;
+
+/// qRestTiming is the latency breakdown of a query.
+///
+/// Times are read from a monotonic clock, in milliseconds (see now()). They
+/// are -1 when the step did not happen, e.g. ParseStarted for a failed query
+/// or Encrypted for a plain HTTP query.
+/// \sa qRestResult::timing()
+struct qRestAPI_EXPORT qRestTiming
+{
+  qRestTiming();
+
+  /// Wall clock time when the query was queued, in milliseconds since epoch.
+  qint64 QueuedWallTime;
+
+  /// The query was created by qRestAPI.
+  qint64 Queued;
+  /// The request was handed to the network access manager.
+  qint64 Dispatched;
+  /// The TLS handshake completed.
+  qint64 Encrypted;
+  /// The request was sent, available with Qt >= 6.3.
+  qint64 RequestSent;
+  /// The first bytes of the response were received.
+  qint64 FirstByte;
+  /// The response was fully received.
+  qint64 LastByte;
+  qint64 ParseStarted;
+  qint64 ParseFinished;
+  /// The qRestAPI::finished() signal returned.
+  qint64 FinishedDelivered;
+
+  qint64 BytesReceived;
+  qint64 BytesSent;
+
+  /// Milliseconds from \a from to \a to, -1 if either time is unknown.
+  static qint64 interval(qint64 from, qint64 to);
+  /// Milliseconds from Queued to the last known step.
+  qint64 totalTime() const;
+
+  /// Returns the current time of the clock used for the timings.
+  static qint64 now();
+
+  QVariantMap toMap() const;
+};
+
+/// qRestMetrics aggregates the timings of the queries of a qRestAPI object.
+///
+/// Queries are grouped by HTTP method and resource pattern. The pattern is
+/// the path of the URL where identifiers (numbers, object ids, uuids) are
+/// replaced by "{id}", e.g. "/api/v1/item/{id}/files".
+///
+/// For each group, the number of queries, the errors by type, the bytes
+/// transferred and a latency histogram are kept. Histogram buckets are
+/// logarithmic (4 buckets per power of two), so that percentiles are
+/// estimated within 20% using a fixed amount of memory.
+///
+/// Recording and snapshots are thread-safe.
+/// \sa qRestAPI::metrics()
+class qRestAPI_EXPORT qRestMetrics
+{
+public:
+  qRestMetrics();
+  virtual ~qRestMetrics();
+
+  /// Adds a finished query.
+  /// \a errorCode is qRestAPI::UnknownError if the query succeeded.
+  void record(const QByteArray& method, const QString& resource,
+              const qRestTiming& timing, qRestAPI::ErrorType errorCode);
+
+  /// Returns the number of queries recorded for \a method and the pattern
+  /// of \a resource.
+  qint64 count(const QByteArray& method, const QString& resource) const;
+
+  /// Estimates the latency in milliseconds under which \a percentile
+  /// (between 0 and 1) of the queries of \a method and the pattern of
+  /// \a resource complete. Returns -1 if no query was recorded.
+  qint64 latencyPercentile(const QByteArray& method, const QString& resource,
+                           double percentile) const;
+
+  /// Returns one map per method and resource pattern with the keys
+  /// "method", "resource", "count", "errors", "errorCounts" (error code to
+  /// count), "bytesReceived", "bytesSent", "latencyMin", "latencyMax",
+  /// "latencyMean", "latencyP50", "latencyP90", "latencyP99" and "histogram"
+  /// (list of maps with the bucket upper bound "le" and its "count").
+  QList<QVariantMap> snapshot() const;
+
+  /// Removes all the recorded queries.
+  void reset();
+
+  /// Returns the path of \a resource where identifiers are replaced by
+  /// "{id}". The query string, if any, is removed.
+  static QString resourcePattern(const QString& resource);
+
+private:
+  QScopedPointer<qRestMetricsPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(qRestMetrics);
+  Q_DISABLE_COPY(qRestMetrics);
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// qRestAPI includes
+#include "qRestPreparedRequest.h"
+
+// --------------------------------------------------------------------------
+qRestPreparedRequest::qRestPreparedRequest()
+  : Valid(false)
+  , Operation(QNetworkAccessManager::GetOperation)
+  , Generation(-1)
+{
+}
+
+// --------------------------------------------------------------------------
+bool qRestPreparedRequest::isValid() const
+{
+  return this->Valid;
+}
+
+// --------------------------------------------------------------------------
+QNetworkAccessManager::Operation qRestPreparedRequest::operation() const
+{
+  return this->Operation;
+}
+
+// --------------------------------------------------------------------------
+QString qRestPreparedRequest::resource() const
+{
+  return this->Resource;
+}
+
+// --------------------------------------------------------------------------
+QStringList qRestPreparedRequest::parameterNames() const
+{
+  return this->ParameterNames;
+}
+
+// --------------------------------------------------------------------------
+qRestAPI::RawHeaders qRestPreparedRequest::rawHeaders() const
+{
+  return this->RawHeaders;
+}
@@ -0,0 +1,88 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestPreparedRequest_h
+#define __qRestPreparedRequest_h
+
+// Qt includes
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QStringList>
+#include <QUrl>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+
+#include "qRestAPI_Export.h"
+
+/// qRestPreparedRequest is a request template created by qRestAPI::prepare()
+/// and sent by qRestAPI::execute().
+///
+/// The URL of the resource, the encoded names of the parameters and the
+/// request with its raw headers are built once. Executing the template only
+/// encodes the values of the parameters. The template is built again on its
+/// next execution if the server URL, the default raw headers or the
+/// accepted content types of the qRestAPI object change.
+///
+/// The built request is cached in the template by execute(): a template
+/// must not be executed by several threads at the same time, each thread
+/// uses its own copy.
+///
+/// Usage:
+/// <code>
+/// qRestPreparedRequest status = girderAPI.prepare(
+///   QNetworkAccessManager::GetOperation, "/job", QStringList() << "statuses");
+/// ...
+/// QUuid queryId = girderAPI.execute(status, QStringList() << "[2]");
+/// </code>
+class qRestAPI_EXPORT qRestPreparedRequest
+{
+public:
+  /// Constructs an invalid template.
+  qRestPreparedRequest();
+
+  /// Returns false if the template was not created by qRestAPI::prepare().
+  bool isValid() const;
+
+  QNetworkAccessManager::Operation operation() const;
+  QString resource() const;
+  QStringList parameterNames() const;
+  qRestAPI::RawHeaders rawHeaders() const;
+
+private:
+  friend class qRestAPI;
+
+  bool Valid;
+  QNetworkAccessManager::Operation Operation;
+  QString Resource;
+  QStringList ParameterNames;
+  qRestAPI::RawHeaders RawHeaders;
+
+  /// Built by the qRestAPI object whose request generation was
+  /// \a Generation.
+  mutable int Generation;
+  /// URL of the resource without its query, and its encoded query.
+  mutable QUrl BaseUrl;
+  mutable QByteArray BaseQuery;
+  /// Encoded parameter names followed by '='.
+  mutable QList<QByteArray> EncodedNames;
+  /// Request with the default and the template raw headers.
+  mutable QNetworkRequest Request;
+};
+
+#endif
@@ -0,0 +1,245 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDataStream>
+#include <QFile>
+#include <QNetworkRequest>
+
+// qRestAPI includes
+#include "qRestCannedReply.h"
+#include "qRestReplay.h"
+
+// STD includes
+#include <cmath>
+
+// "qRRC"
+const quint32 qRestRecord::FileMagic = 0x71525243;
+const qint32 qRestRecord::FileVersion = 1;
+
+// --------------------------------------------------------------------------
+// qRestRecord methods
+
+// --------------------------------------------------------------------------
+qRestRecord::qRestRecord()
+  : RequestSize(0)
+  , HttpStatusCode(0)
+  , NetworkError(0)
+  , Offset(0)
+  , FirstByteDelay(0)
+  , LastByteDelay(0)
+{
+}
+
+// --------------------------------------------------------------------------
+void qRestRecord::writeHeader(QDataStream& stream)
+{
+  // A fixed version keeps the recordings readable with any Qt version.
+  stream.setVersion(QDataStream::Qt_4_6);
+  stream << FileMagic << FileVersion;
+}
+
+// --------------------------------------------------------------------------
+bool qRestRecord::readHeader(QDataStream& stream)
+{
+  stream.setVersion(QDataStream::Qt_4_6);
+  quint32 magic = 0;
+  qint32 version = 0;
+  stream >> magic >> version;
+  return stream.status() == QDataStream::Ok &&
+         magic == FileMagic && version == FileVersion;
+}
+
+// --------------------------------------------------------------------------
+QDataStream& operator<<(QDataStream& stream, const qRestRecord& record)
+{
+  stream << record.Method << record.Url << record.RequestHeaders
+         << record.RequestSize
+         << static_cast<qint32>(record.HttpStatusCode) << record.ReasonPhrase
+         << record.ResponseHeaders << record.Body
+         << static_cast<qint32>(record.NetworkError) << record.ErrorString
+         << record.Offset << record.FirstByteDelay << record.LastByteDelay;
+  return stream;
+}
+
+// --------------------------------------------------------------------------
+QDataStream& operator>>(QDataStream& stream, qRestRecord& record)
+{
+  qint32 httpStatusCode = 0;
+  qint32 networkError = 0;
+  stream >> record.Method >> record.Url >> record.RequestHeaders
+         >> record.RequestSize
+         >> httpStatusCode >> record.ReasonPhrase
+         >> record.ResponseHeaders >> record.Body
+         >> networkError >> record.ErrorString
+         >> record.Offset >> record.FirstByteDelay >> record.LastByteDelay;
+  record.HttpStatusCode = httpStatusCode;
+  record.NetworkError = networkError;
+  return stream;
+}
+
+// --------------------------------------------------------------------------
+// qRestReplayNetworkAccessManager methods
+
+// --------------------------------------------------------------------------
+qRestReplayNetworkAccessManager::qRestReplayNetworkAccessManager(QObject* parent)
+  : Superclass(parent)
+  , RecordCount(0)
+  , Speed(1.)
+  , ServedCount(0)
+  , UnmatchedCount(0)
+{
+}
+
+// --------------------------------------------------------------------------
+qRestReplayNetworkAccessManager::~qRestReplayNetworkAccessManager()
+{
+}
+
+// --------------------------------------------------------------------------
+bool qRestReplayNetworkAccessManager::load(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return false;
+    }
+  QDataStream stream(&file);
+  if (!qRestRecord::readHeader(stream))
+    {
+    return false;
+    }
+  QList<qRestRecord> records;
+  while (!stream.atEnd())
+    {
+    qRestRecord record;
+    stream >> record;
+    if (stream.status() != QDataStream::Ok)
+      {
+      // A recording interrupted while a record was written is truncated.
+      break;
+      }
+    records << record;
+    }
+  foreach(const qRestRecord& record, records)
+    {
+    this->addRecord(record);
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayNetworkAccessManager::addRecord(const qRestRecord& record)
+{
+  this->Records[recordKey(record.Method, record.Url)].Records << record;
+  ++this->RecordCount;
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayNetworkAccessManager::clear()
+{
+  this->Records.clear();
+  this->RecordCount = 0;
+}
+
+// --------------------------------------------------------------------------
+int qRestReplayNetworkAccessManager::count() const
+{
+  return this->RecordCount;
+}
+
+// --------------------------------------------------------------------------
+double qRestReplayNetworkAccessManager::speed() const
+{
+  return this->Speed;
+}
+
+// --------------------------------------------------------------------------
+void qRestReplayNetworkAccessManager::setSpeed(double speed)
+{
+  this->Speed = speed;
+}
+
+// --------------------------------------------------------------------------
+int qRestReplayNetworkAccessManager::servedCount() const
+{
+  return this->ServedCount;
+}
+
+// --------------------------------------------------------------------------
+int qRestReplayNetworkAccessManager::unmatchedCount() const
+{
+  return this->UnmatchedCount;
+}
+
+// --------------------------------------------------------------------------
+QString qRestReplayNetworkAccessManager::recordKey(const QByteArray& method, const QString& url)
+{
+  return QString::fromLatin1(method) + ' ' + url;
+}
+
+// --------------------------------------------------------------------------
+QNetworkReply* qRestReplayNetworkAccessManager::createRequest(Operation operation,
+                                                              const QNetworkRequest& request,
+                                                              QIODevice* outgoingData)
+{
+  Q_UNUSED(outgoingData);
+  QByteArray method;
+  switch (operation)
+    {
+  case QNetworkAccessManager::GetOperation: method = "GET"; break;
+  case QNetworkAccessManager::HeadOperation: method = "HEAD"; break;
+  case QNetworkAccessManager::PutOperation: method = "PUT"; break;
+  case QNetworkAccessManager::PostOperation: method = "POST"; break;
+  case QNetworkAccessManager::DeleteOperation: method = "DELETE"; break;
+  default:
+    method = request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray();
+    }
+
+  qRestCannedReply* reply = new qRestCannedReply(operation, request, this);
+  QHash<QString, RecordQueue>::iterator queue =
+    this->Records.find(recordKey(method, request.url().toString()));
+  if (queue == this->Records.end() || queue->Records.isEmpty())
+    {
+    ++this->UnmatchedCount;
+    reply->setNetworkError(QNetworkReply::ContentNotFoundError,
+                           QString("No recorded response for %1 %2")
+                           .arg(QString::fromLatin1(method)).arg(request.url().toString()));
+    reply->start();
+    return reply;
+    }
+
+  const qRestRecord& record = queue->Records.at(queue->Next);
+  queue->Next = (queue->Next + 1) % queue->Records.size();
+  ++this->ServedCount;
+
+  reply->setHttpStatus(record.HttpStatusCode, record.ReasonPhrase);
+  reply->setResponseHeaders(record.ResponseHeaders);
+  reply->setBody(record.Body);
+  if (record.NetworkError != QNetworkReply::NoError)
+    {
+    reply->setNetworkError(static_cast<QNetworkReply::NetworkError>(record.NetworkError),
+                           record.ErrorString);
+    }
+  if (this->Speed > 0.)
+    {
+    reply->setDelays(static_cast<int>(std::floor(record.FirstByteDelay / this->Speed + 0.5)),
+                     static_cast<int>(std::floor(record.LastByteDelay / this->Speed + 0.5)));
+    }
+  reply->start();
+  return reply;
+}
@@ -0,0 +1,137 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestReplay_h
+#define __qRestReplay_h
+
+// Qt includes
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QPair>
+#include <QString>
+
+#include "qRestAPI_Export.h"
+
+class QDataStream;
+
+/// qRestRecord is a request and its response, as written by
+/// qRestAPI::startRecording().
+struct qRestAPI_EXPORT qRestRecord
+{
+  typedef QList<QPair<QByteArray, QByteArray> > RawHeaderPairs;
+
+  qRestRecord();
+
+  QByteArray Method;
+  QString Url;
+  RawHeaderPairs RequestHeaders;
+  /// Size of the request body. The body itself is not recorded.
+  qint64 RequestSize;
+
+  int HttpStatusCode;
+  QByteArray ReasonPhrase;
+  RawHeaderPairs ResponseHeaders;
+  QByteArray Body;
+  /// QNetworkReply::NetworkError of the reply.
+  int NetworkError;
+  QString ErrorString;
+
+  /// Milliseconds from the start of the recording until the query was
+  /// created.
+  qint64 Offset;
+  /// Milliseconds from the dispatch of the request until its first and last
+  /// bytes were received.
+  qint64 FirstByteDelay;
+  qint64 LastByteDelay;
+
+  /// Magic number and version of the recording files.
+  static const quint32 FileMagic;
+  static const qint32 FileVersion;
+
+  /// Writes the header of a recording file into \a stream.
+  static void writeHeader(QDataStream& stream);
+  /// Reads the header of a recording file, returns false if \a stream is
+  /// not a supported recording.
+  static bool readHeader(QDataStream& stream);
+};
+
+qRestAPI_EXPORT QDataStream& operator<<(QDataStream& stream, const qRestRecord& record);
+qRestAPI_EXPORT QDataStream& operator>>(QDataStream& stream, qRestRecord& record);
+
+/// qRestReplayNetworkAccessManager serves recorded responses instead of
+/// sending requests.
+///
+/// Requests are matched with the records by method and URL. Records with
+/// the same method and URL are served in the order they were recorded, and
+/// again from the first one once all were served. Requests without any
+/// record fail with QNetworkReply::ContentNotFoundError.
+///
+/// Responses are delivered by qRestCannedReply objects after the recorded
+/// delays divided by speed(), so that they are processed by qRestAPI as if
+/// they were received from the network.
+/// \sa qRestAPI::startReplay()
+class qRestAPI_EXPORT qRestReplayNetworkAccessManager : public QNetworkAccessManager
+{
+  Q_OBJECT
+
+  typedef QNetworkAccessManager Superclass;
+
+public:
+  explicit qRestReplayNetworkAccessManager(QObject* parent = 0);
+  virtual ~qRestReplayNetworkAccessManager();
+
+  /// Adds the records of the recording file \a fileName.
+  /// Returns false if the file can not be read.
+  bool load(const QString& fileName);
+  void addRecord(const qRestRecord& record);
+  void clear();
+  /// Number of records.
+  int count() const;
+
+  /// Replay speed relative to the recording. 1 reproduces the recorded
+  /// delays, 10 makes them ten times shorter. 0 (or less) delivers the
+  /// responses without delay. Default is 1.
+  double speed() const;
+  void setSpeed(double speed);
+
+  /// Number of requests served from a record, and without record.
+  int servedCount() const;
+  int unmatchedCount() const;
+
+protected:
+  virtual QNetworkReply* createRequest(Operation operation,
+                                       const QNetworkRequest& request,
+                                       QIODevice* outgoingData = 0);
+
+private:
+  static QString recordKey(const QByteArray& method, const QString& url);
+
+  struct RecordQueue
+  {
+    RecordQueue() : Next(0) {}
+    QList<qRestRecord> Records;
+    int Next;
+  };
+  QHash<QString, RecordQueue> Records;
+  int RecordCount;
+  double Speed;
+  int ServedCount;
+  int UnmatchedCount;
+};
+
+#endif
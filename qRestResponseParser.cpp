@@ -0,0 +1,603 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDateTime>
+#include <QtEndian>
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+#include <QCborValue>
+#endif
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+#include <QJsonArray>
+#include <QJsonDocument>
+#else
+#include <QScriptEngine>
+#endif
+
+// qRestAPI includes
+#include "qRestCompactResult.h"
+#include "qRestResponseParser.h"
+
+// STD includes
+#include <cstring>
+#include <limits>
+
+// --------------------------------------------------------------------------
+// qRestResponseParser methods
+
+// --------------------------------------------------------------------------
+qRestResponseParser::~qRestResponseParser()
+{
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParser::appendToVariantMapList(QList<QVariantMap>& result, const QVariant& value)
+{
+  if (value.userType() == QMetaType::QVariantList)
+    {
+    foreach(const QVariant& item, value.toList())
+      {
+      QVariantMap map = item.toMap();
+      if (!map.isEmpty())
+        {
+        result << map;
+        }
+      }
+    return;
+    }
+  QVariantMap map = value.toMap();
+  if (!map.isEmpty())
+    {
+    result << map;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestResponseParser::appendToCompactResult(qRestCompactResult& result, const QVariant& value)
+{
+  QVariantList items;
+  if (value.userType() == QMetaType::QVariantList)
+    {
+    items = value.toList();
+    }
+  else
+    {
+    items << value;
+    }
+  result.reserve(result.rowCount() + items.size());
+  foreach(const QVariant& item, items)
+    {
+    QVariantMap map = item.toMap();
+    if (map.isEmpty())
+      {
+      continue;
+      }
+    int row = result.appendRow();
+    for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it)
+      {
+      result.setValue(row, result.internKey(it.key()), it.value());
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+// qRestJsonParser methods
+
+// --------------------------------------------------------------------------
+QList<QByteArray> qRestJsonParser::contentTypes() const
+{
+  return QList<QByteArray>() << "application/json";
+}
+
+// --------------------------------------------------------------------------
+bool qRestJsonParser::parse(const QByteArray& response, QVariant& value, QString& error) const
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+  // The response is wrapped into an array so that scalars are accepted by
+  // all the versions of QJsonDocument.
+  QJsonParseError parseError;
+  QJsonDocument document = QJsonDocument::fromJson("[" + response + "]", &parseError);
+  if (parseError.error != QJsonParseError::NoError)
+    {
+    error = QString("Invalid JSON at offset %1: %2")
+      .arg(qMax(0, parseError.offset - 1)).arg(parseError.errorString());
+    return false;
+    }
+  QJsonArray array = document.array();
+  value = array.isEmpty() ? QVariant() : array.first().toVariant();
+#else
+  if (response.trimmed().isEmpty())
+    {
+    value = QVariant();
+    return true;
+    }
+  QScriptEngine scriptEngine;
+  QScriptValue scriptValue = scriptEngine
+    .evaluate("JSON.parse")
+    .call(QScriptValue(), QScriptValueList() << QString::fromUtf8(response));
+  if (scriptEngine.hasUncaughtException())
+    {
+    error = QString("Invalid JSON: %1").arg(scriptValue.toString());
+    return false;
+    }
+  value = scriptValue.toVariant();
+#endif
+  return true;
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+// --------------------------------------------------------------------------
+// qRestCborParser methods
+
+// --------------------------------------------------------------------------
+QList<QByteArray> qRestCborParser::contentTypes() const
+{
+  return QList<QByteArray>() << "application/cbor";
+}
+
+// --------------------------------------------------------------------------
+bool qRestCborParser::parse(const QByteArray& response, QVariant& value, QString& error) const
+{
+  if (response.isEmpty())
+    {
+    value = QVariant();
+    return true;
+    }
+  QCborParserError parseError;
+  QCborValue cborValue = QCborValue::fromCbor(response, &parseError);
+  if (parseError.error != QCborError::NoError)
+    {
+    error = QString("Invalid CBOR at offset %1: %2")
+      .arg(parseError.offset).arg(parseError.errorString());
+    return false;
+    }
+  value = cborValue.toVariant();
+  return true;
+}
+#endif
+
+// --------------------------------------------------------------------------
+// qRestMessagePackParser methods
+
+namespace
+{
+// --------------------------------------------------------------------------
+class MessagePackReader
+{
+public:
+  MessagePackReader(const QByteArray& data)
+    : Data(reinterpret_cast<const uchar*>(data.constData()))
+    , Size(data.size())
+    , Position(0)
+  {
+  }
+
+  bool read(QVariant& value, int depth);
+  bool atEnd() const { return this->Position >= this->Size; }
+
+  QString Error;
+
+private:
+  bool fail(const QString& error)
+  {
+    this->Error = QString("%1 at offset %2").arg(error).arg(this->Position);
+    return false;
+  }
+  bool has(qint64 length) const
+  {
+    return length >= 0 && length <= this->Size - this->Position;
+  }
+  template <typename T> bool readInteger(T& integer)
+  {
+    if (!this->has(sizeof(T)))
+      {
+      return this->fail("Truncated integer");
+      }
+    integer = qFromBigEndian<T>(this->Data + this->Position);
+    this->Position += sizeof(T);
+    return true;
+  }
+  bool readLength(int lengthSize, qint64& length);
+  bool readBytes(qint64 length, QByteArray& bytes);
+  bool readArray(qint64 length, QVariant& value, int depth);
+  bool readMap(qint64 length, QVariant& value, int depth);
+  bool readExtension(qint64 length, QVariant& value);
+
+  const uchar* Data;
+  qint64 Size;
+  qint64 Position;
+};
+
+/// Nesting limit of arrays and maps.
+const int maximumDepth = 512;
+
+// --------------------------------------------------------------------------
+bool MessagePackReader::readLength(int lengthSize, qint64& length)
+{
+  switch (lengthSize)
+    {
+    case 1:
+      {
+      quint8 value;
+      if (!this->readInteger(value))
+        {
+        return false;
+        }
+      length = value;
+      return true;
+      }
+    case 2:
+      {
+      quint16 value;
+      if (!this->readInteger(value))
+        {
+        return false;
+        }
+      length = value;
+      return true;
+      }
+    default:
+      {
+      quint32 value;
+      if (!this->readInteger(value))
+        {
+        return false;
+        }
+      length = value;
+      return true;
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+bool MessagePackReader::readBytes(qint64 length, QByteArray& bytes)
+{
+  if (!this->has(length))
+    {
+    return this->fail("Truncated data");
+    }
+  bytes = QByteArray(reinterpret_cast<const char*>(this->Data + this->Position),
+                     static_cast<int>(length));
+  this->Position += length;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool MessagePackReader::readArray(qint64 length, QVariant& value, int depth)
+{
+  if (depth >= maximumDepth)
+    {
+    return this->fail("Too deeply nested");
+    }
+  // Each element takes at least one byte.
+  if (!this->has(length))
+    {
+    return this->fail("Truncated array");
+    }
+  QVariantList list;
+  list.reserve(static_cast<int>(length));
+  for (qint64 index = 0; index < length; ++index)
+    {
+    QVariant item;
+    if (!this->read(item, depth + 1))
+      {
+      return false;
+      }
+    list << item;
+    }
+  value = list;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool MessagePackReader::readMap(qint64 length, QVariant& value, int depth)
+{
+  if (depth >= maximumDepth)
+    {
+    return this->fail("Too deeply nested");
+    }
+  if (!this->has(2 * length))
+    {
+    return this->fail("Truncated map");
+    }
+  QVariantMap map;
+  for (qint64 index = 0; index < length; ++index)
+    {
+    QVariant key;
+    QVariant item;
+    if (!this->read(key, depth + 1) || !this->read(item, depth + 1))
+      {
+      return false;
+      }
+    map.insert(key.toString(), item);
+    }
+  value = map;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool MessagePackReader::readExtension(qint64 length, QVariant& value)
+{
+  qint8 type;
+  QByteArray data;
+  if (!this->readInteger(type) || !this->readBytes(length, data))
+    {
+    return false;
+    }
+  if (type != -1)
+    {
+    value = data;
+    return true;
+    }
+  // Timestamp: seconds and nanoseconds since epoch.
+  const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+  qint64 seconds = 0;
+  qint64 nanoseconds = 0;
+  switch (data.size())
+    {
+    case 4:
+      seconds = qFromBigEndian<quint32>(bytes);
+      break;
+    case 8:
+      {
+      quint64 value64 = qFromBigEndian<quint64>(bytes);
+      nanoseconds = static_cast<qint64>(value64 >> 34);
+      seconds = static_cast<qint64>(value64 & Q_UINT64_C(0x3ffffffff));
+      break;
+      }
+    case 12:
+      nanoseconds = qFromBigEndian<quint32>(bytes);
+      seconds = qFromBigEndian<qint64>(bytes + 4);
+      break;
+    default:
+      return this->fail("Invalid timestamp");
+    }
+  value = QDateTime::fromMSecsSinceEpoch(seconds * 1000 + nanoseconds / 1000000, Qt::UTC);
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool MessagePackReader::read(QVariant& value, int depth)
+{
+  quint8 type;
+  if (!this->readInteger(type))
+    {
+    return false;
+    }
+  qint64 length = 0;
+  // Fixed size types.
+  if (type <= 0x7f)
+    {
+    value = static_cast<qlonglong>(type);
+    return true;
+    }
+  if (type >= 0xe0)
+    {
+    value = static_cast<qlonglong>(static_cast<qint8>(type));
+    return true;
+    }
+  if ((type & 0xf0) == 0x80)
+    {
+    return this->readMap(type & 0x0f, value, depth);
+    }
+  if ((type & 0xf0) == 0x90)
+    {
+    return this->readArray(type & 0x0f, value, depth);
+    }
+  if ((type & 0xe0) == 0xa0)
+    {
+    QByteArray bytes;
+    if (!this->readBytes(type & 0x1f, bytes))
+      {
+      return false;
+      }
+    value = QString::fromUtf8(bytes);
+    return true;
+    }
+
+  switch (type)
+    {
+    case 0xc0:
+      value = QVariant();
+      return true;
+    case 0xc2:
+      value = false;
+      return true;
+    case 0xc3:
+      value = true;
+      return true;
+    case 0xc4: case 0xc5: case 0xc6:
+      {
+      QByteArray bytes;
+      if (!this->readLength(1 << (type - 0xc4), length) ||
+          !this->readBytes(length, bytes))
+        {
+        return false;
+        }
+      value = bytes;
+      return true;
+      }
+    case 0xc7: case 0xc8: case 0xc9:
+      return this->readLength(1 << (type - 0xc7), length) &&
+        this->readExtension(length, value);
+    case 0xca:
+      {
+      quint32 bits;
+      if (!this->readInteger(bits))
+        {
+        return false;
+        }
+      float number;
+      memcpy(&number, &bits, sizeof(number));
+      value = static_cast<double>(number);
+      return true;
+      }
+    case 0xcb:
+      {
+      quint64 bits;
+      if (!this->readInteger(bits))
+        {
+        return false;
+        }
+      double number;
+      memcpy(&number, &bits, sizeof(number));
+      value = number;
+      return true;
+      }
+    case 0xcc:
+      {
+      quint8 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xcd:
+      {
+      quint16 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xce:
+      {
+      quint32 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xcf:
+      {
+      quint64 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      if (number > static_cast<quint64>(std::numeric_limits<qint64>::max()))
+        {
+        value = static_cast<qulonglong>(number);
+        }
+      else
+        {
+        value = static_cast<qlonglong>(number);
+        }
+      return true;
+      }
+    case 0xd0:
+      {
+      qint8 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xd1:
+      {
+      qint16 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xd2:
+      {
+      qint32 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xd3:
+      {
+      qint64 number;
+      if (!this->readInteger(number))
+        {
+        return false;
+        }
+      value = static_cast<qlonglong>(number);
+      return true;
+      }
+    case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+      return this->readExtension(1 << (type - 0xd4), value);
+    case 0xd9: case 0xda: case 0xdb:
+      {
+      QByteArray bytes;
+      if (!this->readLength(1 << (type - 0xd9), length) ||
+          !this->readBytes(length, bytes))
+        {
+        return false;
+        }
+      value = QString::fromUtf8(bytes);
+      return true;
+      }
+    case 0xdc: case 0xdd:
+      return this->readLength(type == 0xdc ? 2 : 4, length) &&
+        this->readArray(length, value, depth);
+    case 0xde: case 0xdf:
+      return this->readLength(type == 0xde ? 2 : 4, length) &&
+        this->readMap(length, value, depth);
+    default:
+      --this->Position;
+      return this->fail(QString("Invalid type 0x%1").arg(type, 2, 16, QChar('0')));
+    }
+}
+}
+
+// --------------------------------------------------------------------------
+QList<QByteArray> qRestMessagePackParser::contentTypes() const
+{
+  return QList<QByteArray>()
+    << "application/msgpack"
+    << "application/x-msgpack"
+    << "application/vnd.msgpack";
+}
+
+// --------------------------------------------------------------------------
+bool qRestMessagePackParser::parse(const QByteArray& response, QVariant& value, QString& error) const
+{
+  value = QVariant();
+  if (response.isEmpty())
+    {
+    return true;
+    }
+  MessagePackReader reader(response);
+  if (!reader.read(value, 0))
+    {
+    error = "Invalid MessagePack: " + reader.Error;
+    return false;
+    }
+  if (!reader.atEnd())
+    {
+    error = "Invalid MessagePack: unexpected data after the value";
+    return false;
+    }
+  return true;
+}
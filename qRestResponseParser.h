@@ -0,0 +1,90 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestResponseParser_h
+#define __qRestResponseParser_h
+
+// Qt includes
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+
+#include "qRestAPI_Export.h"
+
+class qRestCompactResult;
+
+/// qRestResponseParser decodes the body of the responses of a given
+/// Content-Type.
+///
+/// Parsers are registered on a qRestAPI object for the media types they
+/// return in contentTypes(). The decoded value is either an object, whose
+/// map becomes the single result, or a list of objects, each becoming a
+/// result. Other values, e.g. a scalar, do not produce any result.
+///
+/// parse() may be called from several threads at the same time.
+/// \sa qRestAPI::registerResponseParser()
+class qRestAPI_EXPORT qRestResponseParser
+{
+public:
+  virtual ~qRestResponseParser();
+
+  /// Media types decoded by the parser, lower case, e.g. "application/json".
+  virtual QList<QByteArray> contentTypes() const = 0;
+
+  /// Decodes \a response into \a value.
+  /// Returns false and sets \a error if \a response is malformed.
+  virtual bool parse(const QByteArray& response, QVariant& value, QString& error) const = 0;
+
+  /// Appends the objects of a decoded \a value to \a result. Empty objects
+  /// are skipped.
+  static void appendToVariantMapList(QList<QVariantMap>& result, const QVariant& value);
+  static void appendToCompactResult(qRestCompactResult& result, const QVariant& value);
+};
+
+/// Decodes "application/json" responses.
+class qRestAPI_EXPORT qRestJsonParser : public qRestResponseParser
+{
+public:
+  virtual QList<QByteArray> contentTypes() const;
+  virtual bool parse(const QByteArray& response, QVariant& value, QString& error) const;
+};
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,12,0))
+/// Decodes "application/cbor" responses (RFC 8949).
+class qRestAPI_EXPORT qRestCborParser : public qRestResponseParser
+{
+public:
+  virtual QList<QByteArray> contentTypes() const;
+  virtual bool parse(const QByteArray& response, QVariant& value, QString& error) const;
+};
+#endif
+
+/// Decodes "application/msgpack" responses.
+///
+/// Strings are decoded as QString, binaries as QByteArray, timestamps
+/// (extension -1) as QDateTime in UTC and other extensions as the
+/// QByteArray of their data. Map keys are converted to strings.
+class qRestAPI_EXPORT qRestMessagePackParser : public qRestResponseParser
+{
+public:
+  virtual QList<QByteArray> contentTypes() const;
+  virtual bool parse(const QByteArray& response, QVariant& value, QString& error) const;
+};
+
+#endif
@@ -19,11 +19,13 @@
 ==============================================================================*/
 
 #include "qRestResult.h"
+#include "qRestFileSink.h"
 
 #include <QDebug>
 #include <QEventLoop>
 #include <QNetworkReply>
 #include <QMetaProperty>
+#include <QTimer>
 
 // --------------------------------------------------------------------------
 // qRestAPIResult methods
@@ -33,13 +35,31 @@ qRestResult::qRestResult(const QUuid& queryId, QObject* parent)
   : QObject(parent)
   , QueryId(queryId)
   , ErrorCode(qRestAPI::UnknownError)
+  , Operation(QNetworkAccessManager::UnknownOperation)
+  , Resendable(false)
   , done(false)
+  , ioDevice(NULL)
+  , DownloadPrepared(false)
+  , TransferErrorCode(qRestAPI::UnknownError)
+  , ExpectedChecksumAlgorithm(-1)
+  , SharedDownloadBucket(NULL)
+  , DrainTimer(NULL)
+  , StreamingBufferSize(0)
+  , BytesDownloaded(0)
+  , DownloadFinishDeferred(false)
+  , RecordDownload(false)
+  , ProgressDone(0)
+  , ProgressTotal(-1)
+  , ProgressActive(false)
+  , ProgressInterval(-1)
+  , LastProgress(-1)
 {
 }
 
 // --------------------------------------------------------------------------
 qRestResult::~qRestResult()
 {
+  qDeleteAll(this->Hashes);
 }
 
 // --------------------------------------------------------------------------
@@ -48,18 +68,44 @@ const QUuid& qRestResult::queryId() const
   return this->QueryId;
 }
 
+// --------------------------------------------------------------------------
+const qRestTiming& qRestResult::timing() const
+{
+  return this->Timing;
+}
+
+// --------------------------------------------------------------------------
+const qRestSpan& qRestResult::span() const
+{
+  return this->Span;
+}
+
 // --------------------------------------------------------------------------
 const QList<QVariantMap>& qRestResult::results() const
 {
+  if (this->Result.isEmpty() && !this->CompactResult.isEmpty())
+    {
+    this->Result = this->CompactResult.toVariantMapList();
+    }
   return this->Result;
 }
 
 // --------------------------------------------------------------------------
 const QVariantMap qRestResult::result() const
 {
+  if (this->Result.isEmpty() && !this->CompactResult.isEmpty())
+    {
+    return this->CompactResult.toMap(0);
+    }
   return this->Result.isEmpty() ? QVariantMap() : this->Result[0];
 }
 
+// --------------------------------------------------------------------------
+const qRestCompactResult& qRestResult::compactResults() const
+{
+  return this->CompactResult;
+}
+
 // --------------------------------------------------------------------------
 const QString& qRestResult::error() const
 {
@@ -88,12 +134,24 @@ QMap<QByteArray, QByteArray> qRestResult::rawHeaders() const
   return this->RawHeaders;
 }
 
+// --------------------------------------------------------------------------
+QByteArray qRestResult::contentType() const
+{
+  return this->ContentType;
+}
+
 // --------------------------------------------------------------------------
 QByteArray qRestResult::response()const
 {
   return this->Reponse;
 }
 
+// --------------------------------------------------------------------------
+QByteArray qRestResult::checksum(QCryptographicHash::Algorithm algorithm) const
+{
+  return this->Checksums.value(algorithm);
+}
+
 // --------------------------------------------------------------------------
 void qRestResult::setResult()
 {
@@ -108,6 +166,16 @@ void qRestResult::setResult(const QList<QVariantMap>& result)
   for (int i = 0; i < result.size(); ++i)
     this->Result.push_back(result[i]);
 //  this->Result = result;
+  this->CompactResult.clear();
+  this->done = true;
+  emit ready();
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::setResult(const qRestCompactResult& result)
+{
+  this->Result.clear();
+  this->CompactResult = result;
   this->done = true;
   emit ready();
 }
@@ -140,20 +208,271 @@ bool qRestResult::waitForDone()
 // --------------------------------------------------------------------------
 void qRestResult::downloadReadyRead()
 {
-  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
-  ioDevice->write(reply->readAll());
+  this->drainDownload();
 }
 
 // --------------------------------------------------------------------------
 void qRestResult::downloadFinished()
 {
-  ioDevice->close();
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  if (this->isDownloadPaced() && reply->error() == QNetworkReply::NoError)
+    {
+    this->drainDownload();
+    return;
+    }
+  this->finishDownload(reply);
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::drainDownload()
+{
+  QNetworkReply* reply = this->DownloadReply;
+  if (!reply || !this->ioDevice || !(this->ioDevice->openMode() & QIODevice::WriteOnly))
+    {
+    return;
+    }
+  this->prepareDownload(reply);
+
+  qint64 size = reply->bytesAvailable();
+  qint64 allowed = qMin(this->DownloadBucket.available(),
+                        this->SharedDownloadBucket ? this->SharedDownloadBucket->available() : size);
+  // Slow devices (sockets, pipes...) buffer the data they can not write
+  // yet, reading is paused until they catch up.
+  bool outputFull = false;
+  if (this->StreamingBufferSize > 0)
+    {
+    qint64 space = this->StreamingBufferSize - this->ioDevice->bytesToWrite();
+    outputFull = space <= 0;
+    allowed = qMin(allowed, qMax(qint64(0), space));
+    }
+  QByteArray data = reply->read(qMin(size, allowed));
+  if (!data.isEmpty())
+    {
+    this->DownloadBucket.consume(data.size());
+    if (this->SharedDownloadBucket)
+      {
+      this->SharedDownloadBucket->consume(data.size());
+      }
+    this->BytesDownloaded += data.size();
+    this->writeDownloadData(data);
+    QVariant contentLength = reply->header(QNetworkRequest::ContentLengthHeader);
+    emit downloadProgress(this->BytesDownloaded,
+                          contentLength.isValid() ? contentLength.toLongLong() : -1);
+    // The data received so far is consumed, the time out is postponed as
+    // for the data received.
+    QTimer* timeOut = reply->findChild<QTimer*>();
+    if (timeOut && timeOut->isActive())
+      {
+      timeOut->start();
+      }
+    }
+
+  qint64 remaining = reply->bytesAvailable();
+  if (remaining > 0)
+    {
+    int delay = this->DownloadBucket.delay(remaining);
+    if (this->SharedDownloadBucket)
+      {
+      delay = qMax(delay, this->SharedDownloadBucket->delay(remaining));
+      }
+    if (outputFull)
+      {
+      // Reading resumes when ioDevice emits bytesWritten(), devices that
+      // do not emit it are polled.
+      delay = qRestTokenBucket::maximumWaitInterval();
+      }
+    if (!this->DrainTimer)
+      {
+      this->DrainTimer = new QTimer(this);
+      this->DrainTimer->setSingleShot(true);
+      QObject::connect(this->DrainTimer, SIGNAL(timeout()),
+                       this, SLOT(drainDownload()));
+      }
+    if (!this->DrainTimer->isActive())
+      {
+      this->DrainTimer->start(qBound(0, delay, qRestTokenBucket::maximumWaitInterval()));
+      }
+    }
+  else if (this->DownloadFinishDeferred)
+    {
+    this->DownloadFinishDeferred = false;
+    emit downloadDrained(reply);
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qRestResult::isDownloadPaced() const
+{
+  return this->StreamingBufferSize > 0 ||
+      this->DownloadBucket.isLimited() ||
+      (this->SharedDownloadBucket && this->SharedDownloadBucket->isLimited());
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::updateReadBufferSize()
+{
+  if (!this->DownloadReply || !this->isDownloadPaced())
+    {
+    return;
+    }
+  qint64 size = this->StreamingBufferSize;
+  if (this->DownloadBucket.isLimited())
+    {
+    qint64 bucketSize = this->DownloadBucket.burstSize();
+    size = size > 0 ? qMin(size, bucketSize) : bucketSize;
+    }
+  if (this->SharedDownloadBucket && this->SharedDownloadBucket->isLimited())
+    {
+    qint64 bucketSize = this->SharedDownloadBucket->burstSize();
+    size = size > 0 ? qMin(size, bucketSize) : bucketSize;
+    }
+  this->DownloadReply->setReadBufferSize(size);
+}
+
+// --------------------------------------------------------------------------
+bool qRestResult::deferDownloadFinish(QNetworkReply* reply)
+{
+  if (reply != this->DownloadReply || !this->isDownloadPaced() ||
+      reply->bytesAvailable() == 0 ||
+      !this->ioDevice || !(this->ioDevice->openMode() & QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  this->DownloadFinishDeferred = true;
+  if (!this->DrainTimer || !this->DrainTimer->isActive())
+    {
+    QTimer::singleShot(0, this, SLOT(drainDownload()));
+    }
+  return true;
 }
 
 // --------------------------------------------------------------------------
 void qRestResult::uploadFinished()
 {
-  ioDevice->close();
+  if (ioDevice)
+    {
+    ioDevice->close();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::prepareDownload(QNetworkReply* reply)
+{
+  if (this->DownloadPrepared)
+    {
+    return;
+    }
+  this->DownloadPrepared = true;
+  qRestFileSink* sink = qobject_cast<qRestFileSink*>(this->ioDevice);
+  QVariant contentLength = reply->header(QNetworkRequest::ContentLengthHeader);
+  if (sink && contentLength.isValid())
+    {
+    sink->preallocate(contentLength.toLongLong());
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::writeDownloadData(const QByteArray& data)
+{
+  if (data.isEmpty() || !this->TransferError.isEmpty())
+    {
+    return;
+    }
+  this->updateChecksums(data);
+  if (this->RecordDownload)
+    {
+    this->RecordedDownload.append(data);
+    }
+  if (this->ioDevice->write(data) != data.size())
+    {
+    this->TransferError = this->ioDevice->errorString();
+    this->TransferErrorCode = qRestAPI::FileError;
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qRestResult::finishDownload(QNetworkReply* reply)
+{
+  if (!this->ioDevice || !(this->ioDevice->openMode() & QIODevice::WriteOnly))
+    {
+    return this->TransferError.isEmpty();
+    }
+  bool replySucceeded = reply->error() == QNetworkReply::NoError;
+  if (replySucceeded)
+    {
+    this->prepareDownload(reply);
+    this->writeDownloadData(reply->readAll());
+    if (this->TransferError.isEmpty())
+      {
+      this->finishChecksums();
+      }
+    }
+  qRestFileSink* sink = qobject_cast<qRestFileSink*>(this->ioDevice);
+  if (sink && (!replySucceeded || !this->TransferError.isEmpty()))
+    {
+    sink->cancel();
+    }
+  this->ioDevice->close();
+  if (sink && replySucceeded && this->TransferError.isEmpty() && !sink->isCommitted())
+    {
+    this->TransferError = sink->errorString();
+    this->TransferErrorCode = qRestAPI::FileError;
+    }
+  return this->TransferError.isEmpty();
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::addChecksumAlgorithm(QCryptographicHash::Algorithm algorithm)
+{
+  if (!this->Hashes.contains(algorithm))
+    {
+    this->Hashes.insert(algorithm, new QCryptographicHash(algorithm));
+    }
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::setExpectedChecksum(QCryptographicHash::Algorithm algorithm, const QByteArray& checksum)
+{
+  this->addChecksumAlgorithm(algorithm);
+  this->ExpectedChecksumAlgorithm = algorithm;
+  this->ExpectedChecksum = checksum;
+}
+
+// --------------------------------------------------------------------------
+void qRestResult::updateChecksums(const QByteArray& data)
+{
+  foreach(QCryptographicHash* hash, this->Hashes)
+    {
+    hash->addData(data);
+    }
+}
+
+// --------------------------------------------------------------------------
+bool qRestResult::finishChecksums()
+{
+  if (this->Hashes.isEmpty() || !this->Checksums.isEmpty())
+    {
+    return this->TransferErrorCode != qRestAPI::IntegrityError;
+    }
+  for (QMap<int, QCryptographicHash*>::const_iterator it = this->Hashes.constBegin();
+       it != this->Hashes.constEnd(); ++it)
+    {
+    this->Checksums.insert(it.key(), it.value()->result());
+    }
+  if (this->ExpectedChecksumAlgorithm < 0)
+    {
+    return true;
+    }
+  QByteArray checksum = this->Checksums.value(this->ExpectedChecksumAlgorithm);
+  if (checksum == QByteArray::fromHex(this->ExpectedChecksum))
+    {
+    return true;
+    }
+  this->TransferError = QString("Checksum mismatch: expected %1, got %2")
+      .arg(QString(this->ExpectedChecksum.toLower()))
+      .arg(QString(checksum.toHex()));
+  this->TransferErrorCode = qRestAPI::IntegrityError;
+  return false;
 }
 
 // --------------------------------------------------------------------------
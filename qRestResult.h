@@ -21,12 +21,23 @@
 #ifndef __qRestResult_h
 #define __qRestResult_h
 
+// Qt includes
+#include <QCryptographicHash>
+#include <QPointer>
+#include <QUrl>
+
 // qRestAPI includes
 #include "qRestAPI.h"
+#include "qRestCompactResult.h"
+#include "qRestMetrics.h"
+#include "qRestTokenBucket.h"
+#include "qRestTracer.h"
 
 #include "qRestAPI_Export.h"
 
 class QIODevice;
+class QNetworkReply;
+class QTimer;
 
 // --------------------------------------------------------------------------
 class qRestAPI_EXPORT qRestResult : public QObject
@@ -38,14 +49,66 @@ class qRestAPI_EXPORT qRestResult : public QObject
 
   QUuid QueryId;
   QByteArray Reponse;
-  QList<QVariantMap> Result;
+  mutable QList<QVariantMap> Result;
+  qRestCompactResult CompactResult;
   QString Error;
   qRestAPI::ErrorType ErrorCode;
 
   QMap<QByteArray, QByteArray> RawHeaders;
+  /// Media type of the response, lower case and without parameters.
+  QByteArray ContentType;
+
+  /// Method and URL of the request.
+  QByteArray Method;
+  QUrl Url;
+  /// Request of the query, kept to send it again when Resendable.
+  /// RequestHeaders does not include the default raw headers.
+  QNetworkAccessManager::Operation Operation;
+  qRestAPI::RawHeaders RequestHeaders;
+  QByteArray RequestBody;
+  bool Resendable;
+  qRestTiming Timing;
+  qRestSpan Span;
 
   bool done;
   QIODevice* ioDevice;
+  bool DownloadPrepared;
+  QString TransferError;
+  qRestAPI::ErrorType TransferErrorCode;
+
+  /// Checksums computed incrementally while data is transferred.
+  QMap<int, QCryptographicHash*> Hashes;
+  QMap<int, QByteArray> Checksums;
+  int ExpectedChecksumAlgorithm;
+  QByteArray ExpectedChecksum;
+
+  /// Reply of get(QIODevice*), its data is written into ioDevice.
+  QPointer<QNetworkReply> DownloadReply;
+  qRestTokenBucket DownloadBucket;
+  /// Bucket shared by all the downloads of the qRestAPI object.
+  qRestTokenBucket* SharedDownloadBucket;
+  qRestTokenBucket UploadBucket;
+  /// Resumes a throttled download when tokens are available.
+  QTimer* DrainTimer;
+  /// Maximum number of bytes buffered by DownloadReply and by ioDevice.
+  /// 0 means no limit.
+  qint64 StreamingBufferSize;
+  qint64 BytesDownloaded;
+  bool DownloadFinishDeferred;
+  /// Copy of the data written into ioDevice, kept while the queries are
+  /// recorded.
+  bool RecordDownload;
+  QByteArray RecordedDownload;
+
+  /// Progress reported by the transfer.
+  qint64 ProgressDone;
+  qint64 ProgressTotal;
+  bool ProgressActive;
+  /// Minimum interval between progress signals, -1 to use the interval of
+  /// the qRestAPI object.
+  int ProgressInterval;
+  /// Time progress() was last emitted.
+  qint64 LastProgress;
 
 public:
   qRestResult(const QUuid& queryId, QObject* parent = 0);
@@ -55,8 +118,17 @@ public:
 
   bool waitForDone();
 
+  /// Returns the results as a list of QVariantMap.
+  /// If the result was set using a qRestCompactResult, the list is created
+  /// on the first call.
   const QList<QVariantMap>& results() const;
   const QVariantMap result() const;
+  /// Returns the results set using setResult(const qRestCompactResult&), or
+  /// an empty compact result otherwise.
+  const qRestCompactResult& compactResults() const;
+  /// Sets the results using the compact representation.
+  /// \sa qRestAPI::compactResults
+  void setResult(const qRestCompactResult& result);
   // FIXME: for consistency with the qRestAPI class, this method should be called errorString()
   const QString& error() const;
   // FIXME: for consistency with the qRestAPI class, this method should be called error()
@@ -64,9 +136,26 @@ public:
 
   QByteArray rawHeader(const QByteArray& name) const;
   QMap<QByteArray, QByteArray> rawHeaders() const;
+  /// Returns the media type of the response, lower case and without
+  /// parameters, e.g. "application/json".
+  QByteArray contentType() const;
 
   QByteArray response()const;
 
+  /// Returns the latency breakdown and the bytes transferred by the query.
+  /// \sa qRestAPI::metrics()
+  const qRestTiming& timing() const;
+
+  /// Returns the trace context of the query. It is invalid unless
+  /// qRestAPI::traceContextPropagation is enabled or a tracer is set.
+  const qRestSpan& span() const;
+
+  /// Returns the digest computed using \a algorithm on the data transferred
+  /// by a download or an upload. It is empty if the checksum was not
+  /// requested or if the transfer is not finished.
+  /// \sa qRestAPI::setChecksumAlgorithms(), qRestAPI::setExpectedChecksum()
+  QByteArray checksum(QCryptographicHash::Algorithm algorithm) const;
+
 public slots:
   void setResult();
   void setResult(const QList<QVariantMap>& result); // FIXME: should be called setResults(), see getters
@@ -78,11 +167,50 @@ public slots:
 
 signals:
   void ready();
+  /// Emitted when downloaded data is written into the output device.
+  void downloadProgress(qint64 bytesWritten, qint64 bytesTotal);
+  /// Emitted when the data of a finished paced download is written.
+  /// \sa deferDownloadFinish()
+  void downloadDrained(QNetworkReply* reply);
+
+private slots:
+  /// Writes as much data of DownloadReply into ioDevice as the token
+  /// buckets and the space left in ioDevice allow.
+  void drainDownload();
 
 private:
 
   void setRawHeader(const QByteArray& name, const QByteArray& value);
 
+  /// Prepares ioDevice for the data of \a reply, e.g. preallocates the
+  /// file of a qRestFileSink.
+  void prepareDownload(QNetworkReply* reply);
+  void writeDownloadData(const QByteArray& data);
+  /// Writes the remaining data of \a reply and closes ioDevice. If the reply
+  /// failed or if the checksum does not match the expected one, the data
+  /// written into a qRestFileSink is discarded.
+  /// Returns false and sets TransferError if the downloaded data could not
+  /// be stored.
+  bool finishDownload(QNetworkReply* reply);
+
+  /// Returns true if the download rate is limited or if the data buffered
+  /// is bounded.
+  bool isDownloadPaced() const;
+  /// Bounds the read buffer of DownloadReply when the download is paced
+  /// so that the network is paced as well.
+  void updateReadBufferSize();
+  /// Returns true if the paced download \a reply still has data to write.
+  /// downloadDrained() is then emitted once the data is written.
+  bool deferDownloadFinish(QNetworkReply* reply);
+
+  void addChecksumAlgorithm(QCryptographicHash::Algorithm algorithm);
+  void setExpectedChecksum(QCryptographicHash::Algorithm algorithm, const QByteArray& checksum);
+  void updateChecksums(const QByteArray& data);
+  /// Computes the checksums of the transferred data and compares the
+  /// expected one, if any.
+  /// Returns false and sets TransferError if the checksum does not match.
+  bool finishChecksums();
+
 };
 
 #endif
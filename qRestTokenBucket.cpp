@@ -0,0 +1,151 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// qRestAPI includes
+#include "qRestMetrics.h"
+#include "qRestTokenBucket.h"
+
+// STD includes
+#include <cmath>
+#include <limits>
+
+namespace
+{
+const qint64 MinimumBurstSize = 16 * 1024;
+const int MaximumWaitInterval = 100;
+}
+
+// --------------------------------------------------------------------------
+qRestTokenBucket::qRestTokenBucket(qint64 rate)
+  : Rate(0)
+  , BurstSize(0)
+  , Tokens(0.)
+  , Clock(&qRestTiming::now)
+  , RefillTime(qRestTiming::now())
+{
+  this->setRate(rate);
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestTokenBucket::rate() const
+{
+  return this->Rate;
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucket::setRate(qint64 bytesPerSecond)
+{
+  this->refill();
+  bool wasLimited = this->isLimited();
+  this->Rate = qMax(qint64(0), bytesPerSecond);
+  if (!wasLimited)
+    {
+    // Start with a full bucket so that transfers do not stall.
+    this->Tokens = static_cast<double>(this->burstSize());
+    }
+  this->Tokens = qMin(this->Tokens, static_cast<double>(this->burstSize()));
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestTokenBucket::burstSize() const
+{
+  if (this->BurstSize > 0)
+    {
+    return this->BurstSize;
+    }
+  return qMax(MinimumBurstSize, this->Rate / 4);
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucket::setBurstSize(qint64 size)
+{
+  this->refill();
+  this->BurstSize = qMax(qint64(0), size);
+  this->Tokens = qMin(this->Tokens, static_cast<double>(this->burstSize()));
+}
+
+// --------------------------------------------------------------------------
+bool qRestTokenBucket::isLimited() const
+{
+  return this->Rate > 0;
+}
+
+// --------------------------------------------------------------------------
+qint64 qRestTokenBucket::available()
+{
+  if (!this->isLimited())
+    {
+    return std::numeric_limits<qint64>::max();
+    }
+  this->refill();
+  return static_cast<qint64>(this->Tokens);
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucket::consume(qint64 bytes)
+{
+  if (!this->isLimited())
+    {
+    return;
+    }
+  this->refill();
+  this->Tokens -= static_cast<double>(bytes);
+}
+
+// --------------------------------------------------------------------------
+int qRestTokenBucket::delay(qint64 bytes)
+{
+  if (!this->isLimited())
+    {
+    return 0;
+    }
+  this->refill();
+  double missing = static_cast<double>(qMin(bytes, this->burstSize())) - this->Tokens;
+  if (missing <= 0.)
+    {
+    return 0;
+    }
+  return static_cast<int>(std::ceil(missing * 1000. / this->Rate));
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucket::setClock(ClockFunction clock)
+{
+  this->refill();
+  this->Clock = clock ? clock : &qRestTiming::now;
+  this->RefillTime = this->Clock();
+}
+
+// --------------------------------------------------------------------------
+int qRestTokenBucket::maximumWaitInterval()
+{
+  return MaximumWaitInterval;
+}
+
+// --------------------------------------------------------------------------
+void qRestTokenBucket::refill()
+{
+  qint64 now = this->Clock();
+  qint64 elapsed = qMax(qint64(0), now - this->RefillTime);
+  this->RefillTime = now;
+  if (!this->isLimited())
+    {
+    return;
+    }
+  this->Tokens = qMin(this->Tokens + elapsed * this->Rate / 1000.,
+                      static_cast<double>(this->burstSize()));
+}
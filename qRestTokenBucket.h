@@ -0,0 +1,83 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestTokenBucket_h
+#define __qRestTokenBucket_h
+
+// Qt includes
+#include <QtGlobal>
+
+#include "qRestAPI_Export.h"
+
+/// qRestTokenBucket limits the rate of a transfer.
+///
+/// Tokens (bytes) are added to the bucket at rate() bytes per second, up to
+/// burstSize() bytes. A transfer may only send or receive as many bytes as
+/// there are tokens available, and consumes them.
+///
+/// A bucket with a rate of 0 is not limited: available() returns the largest
+/// qint64 and delay() returns 0.
+/// \sa qRestAPI::setDownloadRateLimit(), qRestAPI::setUploadRateLimit()
+class qRestAPI_EXPORT qRestTokenBucket
+{
+public:
+  /// Returns the current time in milliseconds of a monotonic clock.
+  typedef qint64 (*ClockFunction)();
+
+  explicit qRestTokenBucket(qint64 rate = 0);
+
+  /// Rate in bytes per second. 0 means no limit.
+  qint64 rate() const;
+  /// Sets the rate. It can be changed while a transfer is in progress, the
+  /// tokens accumulated so far are kept up to the new burst size.
+  void setRate(qint64 bytesPerSecond);
+
+  /// Maximum number of tokens accumulated by the bucket. 0 (default) means
+  /// a quarter of a second worth of tokens, and at least 16 KiB.
+  qint64 burstSize() const;
+  void setBurstSize(qint64 size);
+
+  bool isLimited() const;
+
+  /// Returns the number of bytes that can be transferred now.
+  qint64 available();
+  /// Removes \a bytes tokens from the bucket.
+  void consume(qint64 bytes);
+  /// Returns the time in milliseconds until \a bytes tokens are available.
+  /// \a bytes is clamped to the burst size.
+  int delay(qint64 bytes);
+
+  /// Sets the clock the tokens are added from, e.g. a simulated clock in
+  /// tests. Default (or 0) is qRestTiming::now().
+  void setClock(ClockFunction clock);
+
+  /// Longest time in milliseconds a throttled transfer waits before
+  /// checking its buckets again, so that rate changes are applied promptly.
+  static int maximumWaitInterval();
+
+private:
+  void refill();
+
+  qint64 Rate;
+  qint64 BurstSize;
+  double Tokens;
+  ClockFunction Clock;
+  /// Time of the last refill, read from Clock.
+  qint64 RefillTime;
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QList>
+
+// qRestAPI includes
+#include "qRestTracer.h"
+
+namespace
+{
+// --------------------------------------------------------------------------
+/// Returns \a size random bytes, not all zero, encoded in hexadecimal.
+QByteArray randomId(int size)
+{
+  QByteArray id;
+  while (id.isEmpty() || id.count('\0') == id.size())
+    {
+    id = QUuid::createUuid().toRfc4122().left(size);
+    }
+  return id.toHex();
+}
+
+// --------------------------------------------------------------------------
+bool isLowerHex(const QByteArray& value, int size)
+{
+  if (value.size() != size)
+    {
+    return false;
+    }
+  foreach(char c, value)
+    {
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+      {
+      return false;
+      }
+    }
+  return value.count('0') != size;
+}
+}
+
+// --------------------------------------------------------------------------
+// qRestSpan methods
+
+// --------------------------------------------------------------------------
+qRestSpan::qRestSpan()
+  : Flags(1)
+  , HttpStatusCode(0)
+{
+}
+
+// --------------------------------------------------------------------------
+bool qRestSpan::isValid() const
+{
+  return !this->TraceId.isEmpty() && !this->SpanId.isEmpty();
+}
+
+// --------------------------------------------------------------------------
+QByteArray qRestSpan::traceParent() const
+{
+  QByteArray flags = QByteArray(1, static_cast<char>(this->Flags)).toHex();
+  return "00-" + this->TraceId + "-" + this->SpanId + "-" + flags;
+}
+
+// --------------------------------------------------------------------------
+qRestSpan qRestSpan::fromTraceParent(const QByteArray& traceParent)
+{
+  QList<QByteArray> fields = traceParent.trimmed().split('-');
+  if (fields.size() < 4 || fields[0].size() != 2 || fields[0] == "ff" ||
+      !isLowerHex(fields[1], 32) || !isLowerHex(fields[2], 16) || fields[3].size() != 2)
+    {
+    return qRestSpan();
+    }
+  qRestSpan span;
+  span.TraceId = fields[1];
+  span.ParentSpanId = fields[2];
+  span.Flags = static_cast<quint8>(QByteArray::fromHex(fields[3]).at(0));
+  return span;
+}
+
+// --------------------------------------------------------------------------
+qRestSpan qRestSpan::create(const qRestSpan& parent)
+{
+  qRestSpan span;
+  if (!parent.TraceId.isEmpty())
+    {
+    span.TraceId = parent.TraceId;
+    // A span parsed from a traceparent header only has a parent id.
+    span.ParentSpanId = parent.SpanId.isEmpty() ? parent.ParentSpanId : parent.SpanId;
+    span.Flags = parent.Flags;
+    }
+  else
+    {
+    span.TraceId = randomId(16);
+    }
+  span.SpanId = randomId(8);
+  return span;
+}
+
+// --------------------------------------------------------------------------
+// qRestTracer methods
+
+// --------------------------------------------------------------------------
+qRestTracer::~qRestTracer()
+{
+}
@@ -0,0 +1,92 @@
+/*==============================================================================
+
+  Library: qRestAPI
+
+  Copyright (c) 2026 Kitware Inc.
+
+  See Doc/copyright/copyright.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qRestTracer_h
+#define __qRestTracer_h
+
+// Qt includes
+#include <QByteArray>
+#include <QUrl>
+#include <QUuid>
+
+// qRestAPI includes
+#include "qRestAPI.h"
+#include "qRestMetrics.h"
+
+#include "qRestAPI_Export.h"
+
+/// qRestSpan identifies a query in a distributed trace, following the W3C
+/// Trace Context recommendation (https://www.w3.org/TR/trace-context/).
+/// \sa qRestTracer, qRestAPI::traceContextPropagation
+struct qRestAPI_EXPORT qRestSpan
+{
+  qRestSpan();
+
+  /// Returns true if the span has a trace id and a span id.
+  bool isValid() const;
+
+  /// Returns the value of the "traceparent" header for the span, e.g.
+  /// "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01".
+  QByteArray traceParent() const;
+
+  /// Parses a "traceparent" header value. The returned span has the trace
+  /// id and the flags of \a traceParent, and its span id as ParentSpanId.
+  /// Returns an invalid span if \a traceParent is malformed.
+  static qRestSpan fromTraceParent(const QByteArray& traceParent);
+
+  /// Returns a new span. If \a parent is valid, the span is its child in
+  /// the same trace, otherwise it starts a new trace.
+  static qRestSpan create(const qRestSpan& parent = qRestSpan());
+
+  /// 32 lower case hexadecimal digits.
+  QByteArray TraceId;
+  /// 16 lower case hexadecimal digits.
+  QByteArray SpanId;
+  /// Empty for the root span of a trace.
+  QByteArray ParentSpanId;
+  /// Trace flags, 1 if the trace is sampled.
+  quint8 Flags;
+
+  QUuid QueryId;
+  QByteArray Method;
+  QUrl Url;
+  /// HTTP status code of the response, 0 until the span is finished or if
+  /// no response was received.
+  int HttpStatusCode;
+};
+
+/// qRestTracer receives the spans of the queries of a qRestAPI object, e.g.
+/// to export them to a tracing backend.
+///
+/// The methods are called from the thread of the qRestAPI object.
+/// \sa qRestAPI::setTracer()
+class qRestAPI_EXPORT qRestTracer
+{
+public:
+  virtual ~qRestTracer();
+
+  /// Called right after the request of \a span is sent.
+  virtual void spanStarted(const qRestSpan& span) = 0;
+
+  /// Called once the query is finished and qRestAPI::finished() delivered.
+  /// \a errorCode is qRestAPI::UnknownError if the query succeeded.
+  virtual void spanFinished(const qRestSpan& span, const qRestTiming& timing,
+                            qRestAPI::ErrorType errorCode,
+                            const QString& errorString) = 0;
+};
+
+#endif